@@ -178,6 +178,80 @@ typedef struct Itcl_List {
  */
 typedef struct Itcl_InterpState_ *Itcl_InterpState;
 
+/*
+ *  Events reported to the hooks installed with Itcl_AddEventHook().
+ */
+#define ITCL_EVENT_OBJECT_CREATE  0x01  /* object constructed or failed */
+#define ITCL_EVENT_OBJECT_DELETE  0x02  /* object destroyed */
+#define ITCL_EVENT_METHOD_ENTER   0x04  /* method or proc called */
+#define ITCL_EVENT_METHOD_LEAVE   0x08  /* method or proc returned */
+#define ITCL_EVENT_CLASS_CREATE   0x10  /* class created */
+#define ITCL_EVENT_ALL            0x1f
+
+typedef struct Itcl_EventInfo {
+    int type;                    /* one of the ITCL_EVENT_* bits */
+    Tcl_Obj *classNamePtr;       /* fully qualified name of the class */
+    Tcl_Obj *objectNamePtr;      /* name of the object or NULL */
+    Tcl_Obj *methodNamePtr;      /* fully qualified name of the method
+                                  * or NULL */
+    int result;                  /* completion code of the creation or
+                                  * of the call, TCL_OK otherwise */
+} Itcl_EventInfo;
+
+typedef void (Itcl_EventHookProc) (void *clientData, Tcl_Interp *interp,
+        const Itcl_EventInfo *eventPtr);
+
+/*
+ *  Descriptors of a class for Itcl_DefineClass().  Each array of members
+ *  ends with an entry whose name is NULL; a NULL array has no entries.
+ *  A protection of 0 means the default of the class body: public for
+ *  methods and procs, protected for variables and commons.
+ */
+#define ITCL_MEMBER_COMMON        0x01  /* variable is a common, method
+                                         * is a proc */
+#define ITCL_DEFINE_EXTENDED      0x01  /* class is an itcl::extendedclass */
+
+typedef struct Itcl_VariableSpec {
+    const char *name;            /* simple name of the variable */
+    int protection;              /* ITCL_PUBLIC, ... or 0 */
+    int flags;                   /* ITCL_MEMBER_COMMON or 0 */
+    const char *init;            /* initial value or NULL */
+    const char *config;          /* config code of a public variable with
+                                  * an initial value, or NULL */
+} Itcl_VariableSpec;
+
+typedef struct Itcl_MethodSpec {
+    const char *name;            /* simple name of the method or proc, or
+                                  * "constructor" or "destructor" */
+    int protection;              /* ITCL_PUBLIC, ... or 0 */
+    int flags;                   /* ITCL_MEMBER_COMMON or 0 */
+    const char *args;            /* argument list or NULL */
+    const char *body;            /* Tcl body, "@name" of a procedure
+                                  * registered with Itcl_RegisterObjC(),
+                                  * or NULL */
+    Tcl_ObjCmdProc *objProc;     /* C implementation if body is NULL, or
+                                  * NULL for a declaration only */
+    void *clientData;            /* argument for objProc */
+} Itcl_MethodSpec;
+
+typedef struct Itcl_OptionSpec {
+    const char *name;            /* name of the option, like "-color" */
+    const char *resourceName;    /* resource name or NULL */
+    const char *className;       /* resource class or NULL */
+    const char *defaultValue;    /* default value or NULL */
+} Itcl_OptionSpec;
+
+typedef struct Itcl_ClassSpec {
+    const char *name;            /* name of the class */
+    int flags;                   /* ITCL_DEFINE_EXTENDED or 0 */
+    const char *const *bases;    /* names of the base classes, ending
+                                  * with NULL, or NULL */
+    const Itcl_VariableSpec *variables;
+    const Itcl_MethodSpec *methods;
+    const Itcl_OptionSpec *options;
+                                 /* only for ITCL_DEFINE_EXTENDED */
+} Itcl_ClassSpec;
+
 
 /*
  * Include all the public API, generated from itcl.decls.
@@ -359,6 +359,42 @@ Itcl_TclOOObjectName(
     return namePtr;
 }
 
+/*
+ * ----------------------------------------------------------------------
+ *
+ * Itcl_GetClassChain --
+ *
+ *	Returns a new list of the filters of a class, or of the full names
+ *	of its mixins, as currently defined in TclOO.
+ *
+ * ----------------------------------------------------------------------
+ */
+
+Tcl_Obj *
+Itcl_GetClassChain(
+    Tcl_Interp *interp,
+    Tcl_Class clsPtr,
+    int mixins)
+{
+    Class *classPtr = (Class *)clsPtr;
+    Tcl_Obj *listPtr;
+    Tcl_Size i;
+
+    listPtr = Tcl_NewListObj(0, NULL);
+    if (mixins) {
+        for (i = 0; i < classPtr->mixins.num; i++) {
+            Tcl_ListObjAppendElement(NULL, listPtr, Itcl_TclOOObjectName(
+                    interp, classPtr->mixins.list[i]->thisPtr));
+        }
+    } else {
+        for (i = 0; i < classPtr->filters.num; i++) {
+            Tcl_ListObjAppendElement(NULL, listPtr,
+                    classPtr->filters.list[i]);
+        }
+    }
+    return listPtr;
+}
+
 int
 Itcl_SelfCmd(
     TCL_UNUSED(void *),
@@ -24,6 +24,8 @@ MODULE_SCOPE int Itcl_PublicObjectCmd(void *clientData, Tcl_Interp *interp,
         Tcl_Class clsPtr, Tcl_Size objc, Tcl_Obj *const *objv);
 MODULE_SCOPE Tcl_Method Itcl_NewForwardClassMethod(Tcl_Interp *interp,
         Tcl_Class clsPtr, int flags, Tcl_Obj *nameObj, Tcl_Obj *prefixObj);
+MODULE_SCOPE Tcl_Obj *Itcl_GetClassChain(Tcl_Interp *interp,
+        Tcl_Class clsPtr, int mixins);
 MODULE_SCOPE int Itcl_SelfCmd(void *clientData, Tcl_Interp *interp,
         int objc, Tcl_Obj *const *objv);
 MODULE_SCOPE int Itcl_IsMethodCallFrame(Tcl_Interp *interp);
@@ -241,6 +241,7 @@ Initialize (
     Tcl_InitHashTable(&infoPtr->instances, TCL_STRING_KEYS);
     Tcl_InitHashTable(&infoPtr->frameContext, TCL_ONE_WORD_KEYS);
     Tcl_InitObjHashTable(&infoPtr->classTypes);
+    Tcl_InitHashTable(&infoPtr->argLists, TCL_STRING_KEYS);
 
     infoPtr->ensembleInfo = (EnsembleInfo *)ckalloc(sizeof(EnsembleInfo));
     memset(infoPtr->ensembleInfo, 0, sizeof(EnsembleInfo));
@@ -253,6 +254,7 @@ Initialize (
     infoPtr->typeDestructorArgumentPtr = Tcl_NewStringObj("", TCL_INDEX_NONE);
     Tcl_IncrRefCount(infoPtr->typeDestructorArgumentPtr);
     infoPtr->lastIoPtr = NULL;
+    infoPtr->doubleTypePtr = Tcl_GetObjType("double");
 
     Tcl_SetVar2(interp, ITCL_NAMESPACE"::internal::dicts::classes", NULL, "", 0);
     Tcl_SetVar2(interp, ITCL_NAMESPACE"::internal::dicts::objects", NULL, "", 0);
@@ -354,6 +356,49 @@ Initialize (
         return TCL_ERROR;
     }
 
+    /*
+     *  Add the "itcl::profile" command for profiling method calls.
+     */
+    if (ItclProfileInit(interp, infoPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+
+    /*
+     *  Add the "itcl::stats" command for the internal cache counters.
+     */
+    if (ItclStatsInit(interp, infoPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+
+    /*
+     *  Add the "itcl::trace" command for tracing object lifecycles.
+     */
+    if (ItclTraceInit(interp, infoPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+
+    /*
+     *  Add the "itcl::index" command for finding objects by value.
+     */
+    if (ItclIndexInit(interp, infoPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+
+    /*
+     *  Add the "itcl::serialize" and "itcl::deserialize" commands for
+     *  saving and restoring objects.
+     */
+    if (ItclSerializeInit(interp, infoPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+
+    /*
+     *  Add the "itcl::memo" command for the caches of memoized methods.
+     */
+    if (ItclMemoInit(interp, infoPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+
     /*
      *  Export all commands in the "itcl" namespace so that they
      *  can be imported with something like "namespace import itcl::*"
@@ -638,6 +683,11 @@ FreeItclObjectInfo(
 	infoPtr->typeDestructorArgumentPtr = NULL;
     }
 
+    ItclFinishArgLists(infoPtr);
+    ItclProfileFinish(infoPtr);
+    ItclTraceFinish(infoPtr);
+    ItclHookFinish(infoPtr);
+
     /* cleanup ensemble info */
     if (infoPtr->ensembleInfo) {
 	Tcl_DeleteHashTable(&infoPtr->ensembleInfo->ensembles);
@@ -89,6 +89,7 @@ static char initHullCmdsScript[] =
 "}";
 
 static Tcl_ObjCmdProc Itcl_BiDestroyCmd;
+static Tcl_ObjCmdProc Itcl_BiCloneCmd;
 static Tcl_ObjCmdProc ItclExtendedConfigure;
 static Tcl_ObjCmdProc ItclExtendedCget;
 static Tcl_ObjCmdProc ItclExtendedSetGet;
@@ -135,6 +136,12 @@ static const BiMethod BiMethodList[] = {
         Itcl_BiCgetCmd,
 	ITCL_CLASS|ITCL_ECLASS|ITCL_TYPE|ITCL_WIDGET|ITCL_WIDGETADAPTOR
     },
+    { "clone",
+        "?newName|#auto?",
+        "@itcl-builtin-clone",
+        Itcl_BiCloneCmd,
+	ITCL_CLASS
+    },
     { "configure",
         "?-option? ?value -option value...?",
         "@itcl-builtin-configure",
@@ -543,6 +550,100 @@ Itcl_BiIsaCmd(
     return TCL_OK;
 }
 
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_BiCloneCmd()
+ *
+ *  Invoked whenever the user issues the "clone" method for an object.
+ *  Handles the following syntax:
+ *
+ *    <objName> clone ?<newName>?
+ *
+ *  Creates a copy of the object without running its constructors, as
+ *  described for ItclCloneObject().  If <newName> contains "#auto",
+ *  that part is replaced by a unique string built from the class name,
+ *  which is also the default.  Returns the name of the new object.
+ * ------------------------------------------------------------------------
+ */
+
+static int
+Itcl_BiCloneCmd(
+    TCL_UNUSED(void *),      /* class definition */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    ItclClass *contextIclsPtr;
+    ItclObject *contextIoPtr;
+    ItclObject *newIoPtr;
+    Tcl_CallFrame frame;
+    Tcl_Obj *namePtr;
+    Tcl_DString buffer;
+    Tcl_DString autoName;
+    const char *name;
+    const char *pos;
+    int result;
+
+    contextIclsPtr = NULL;
+    if (Itcl_GetContext(interp, &contextIclsPtr, &contextIoPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (contextIoPtr == NULL) {
+        Tcl_AppendResult(interp,
+            "improper usage: should be \"object clone ?newName?\"", NULL);
+        return TCL_ERROR;
+    }
+    if (objc > 2) {
+        Tcl_AppendResult(interp,
+            "wrong # args: should be \"object clone ?newName?\"", NULL);
+        return TCL_ERROR;
+    }
+
+    name = (objc == 2) ? Tcl_GetString(objv[1]) : "#auto";
+    Tcl_DStringInit(&buffer);
+    pos = strstr(name, "#auto");
+    if (pos != NULL) {
+        Tcl_DStringInit(&autoName);
+        Tcl_DStringAppend(&buffer, name, pos - name);
+        Tcl_DStringAppend(&buffer,
+            ItclAutoObjectName(interp, contextIoPtr->iclsPtr, &autoName),
+            TCL_INDEX_NONE);
+        Tcl_DStringAppend(&buffer, pos + 5, TCL_INDEX_NONE);
+        Tcl_DStringFree(&autoName);
+        name = Tcl_DStringValue(&buffer);
+    }
+    if (*name == '\0') {
+        Tcl_AppendResult(interp, "object name must not be empty", NULL);
+        Tcl_DStringFree(&buffer);
+        return TCL_ERROR;
+    }
+
+    /*
+     *  Relative names are created in the namespace of the caller,
+     *  just like objects created by the class command.
+     */
+    if (Itcl_PushCallFrame(interp, &frame, Itcl_GetUplevelNamespace(interp, 1),
+            /*isProcCallFrame*/0) != TCL_OK) {
+        Tcl_DStringFree(&buffer);
+        return TCL_ERROR;
+    }
+    if (Tcl_FindCommand(interp, name, NULL, 0) != NULL) {
+        Tcl_AppendResult(interp, "command \"", name, "\" already exists",
+            NULL);
+        result = TCL_ERROR;
+    } else {
+        result = ItclCloneObject(interp, contextIoPtr, name, &newIoPtr);
+    }
+    Itcl_PopCallFrame(interp);
+    if (result == TCL_OK) {
+        namePtr = Tcl_NewObj();
+        Tcl_GetCommandFullName(interp, newIoPtr->accessCmd, namePtr);
+        Tcl_SetObjResult(interp, namePtr);
+    }
+    Tcl_DStringFree(&buffer);
+    return result;
+}
+
 
 /*
  * ------------------------------------------------------------------------
@@ -43,6 +43,7 @@ static void ItclFreeClass (void* cdata);
 static void ItclDeleteFunction(ItclMemberFunc *imPtr);
 static void ItclDeleteComponent(ItclComponent *icPtr);
 static void ItclDeleteOption(char *cdata);
+static void ItclLayoutTypedVars(ItclClass *iclsPtr);
 
 void
 ItclPreserveClass(
@@ -548,6 +549,11 @@ Itcl_CreateClass(
 
     /* FIXME should set the class objects unknown command to Itcl_HandleClass */
 
+    if (infoPtr->eventMask & ITCL_EVENT_CLASS_CREATE) {
+        ItclFireEvent(infoPtr, ITCL_EVENT_CLASS_CREATE, iclsPtr, NULL, NULL,
+		TCL_OK);
+    }
+
     *rPtr = iclsPtr;
     result = TCL_OK;
 errorOut:
@@ -578,12 +584,10 @@ CallDeleteOneObject(
     int result)
 {
     Tcl_HashEntry *hPtr;
-    Tcl_HashSearch place;
     ItclClass *iclsPtr2 = NULL;
-    ItclObject *contextIoPtr;
     ItclClass *iclsPtr = (ItclClass *)data[0];
     ItclObjectInfo *infoPtr = (ItclObjectInfo *)data[1];
-    void *callbackPtr;
+    ItclObject *contextIoPtr = (ItclObject *)data[2];
     int classIsDeleted;
 
     if (result != TCL_OK) {
@@ -598,36 +602,17 @@ CallDeleteOneObject(
         return result;
     }
     /*
-     * Fix 227804: Whenever an object to delete was found we
-     * have to reset the search to the beginning as the
-     * current entry in the search was deleted and accessing it
-     * is therefore not allowed anymore.
+     * The object may have been deleted in the meantime, e.g. by the
+     * destructor of another object.
      */
-
-    hPtr = Tcl_FirstHashEntry(&infoPtr->objects, &place);
-    if (hPtr) {
-        contextIoPtr = (ItclObject*)Tcl_GetHashValue(hPtr);
-
-        while (contextIoPtr->iclsPtr != iclsPtr) {
-            hPtr = Tcl_NextHashEntry(&place);
-            if (hPtr == NULL) {
-                break;
-            }
-        }
-        if (hPtr) {
-	    callbackPtr = Itcl_GetCurrentCallbackPtr(interp);
-            if (Itcl_DeleteObject(interp, contextIoPtr) != TCL_OK) {
-                iclsPtr2 = iclsPtr;
-                goto deleteClassFail;
-            }
-
-            Tcl_NRAddCallback(interp, CallDeleteOneObject, iclsPtr,
-	            infoPtr, NULL, NULL);
-            return Itcl_NRRunCallbacks(interp, callbackPtr);
-        }
-
+    hPtr = Tcl_FindHashEntry(&infoPtr->objects, (char *)contextIoPtr);
+    if (hPtr == NULL) {
+        return TCL_OK;
+    }
+    if (Itcl_DeleteObject(interp, contextIoPtr) != TCL_OK) {
+        iclsPtr2 = iclsPtr;
+        goto deleteClassFail;
     }
-
     return TCL_OK;
 
 deleteClassFail:
@@ -696,6 +681,9 @@ Itcl_DeleteClass(
     Tcl_HashEntry *hPtr;
     ItclObjectInfo *infoPtr;
     ItclClass *iclsPtr2 = NULL;
+    Tcl_HashSearch place;
+    ItclObject *ioPtr;
+    Itcl_List objects;
     Itcl_ListElem *elem;
     void *callbackPtr;
     int result;
@@ -737,19 +725,37 @@ Itcl_DeleteClass(
      *  Note that more specialized objects have already been
      *  destroyed above, when derived classes were destroyed.
      *  Destroy objects and report any errors.
+     *
+     *  Fix 227804: deleting an object deletes its entry in the object
+     *  table, so the search cannot continue after it.  Collect the
+     *  objects first rather than restarting the search after each
+     *  object, which is quadratic in the number of objects.
      */
-    /*
-     * we have to enroll the while loop to fit for NRE
-     * so we add a callback to delete the first element
-     * and run this callback. At the end of the execution of that callback
-     * we add eventually a callback for the next element and run that etc ...
-     * if an error occurs we terminate the enrolled loop and return
-     * otherwise we return at the end of the enrolled loop.
-     */
-    callbackPtr = Itcl_GetCurrentCallbackPtr(interp);
-    Tcl_NRAddCallback(interp, CallDeleteOneObject, iclsPtr,
-            iclsPtr->infoPtr, NULL, NULL);
-    result = Itcl_NRRunCallbacks(interp, callbackPtr);
+    Itcl_InitList(&objects);
+    hPtr = Tcl_FirstHashEntry(&infoPtr->objects, &place);
+    while (hPtr) {
+        ioPtr = (ItclObject*)Tcl_GetHashValue(hPtr);
+        if (ioPtr->iclsPtr == iclsPtr) {
+	    Itcl_PreserveData(ioPtr);
+	    Itcl_AppendList(&objects, ioPtr);
+	}
+        hPtr = Tcl_NextHashEntry(&place);
+    }
+    result = TCL_OK;
+    elem = Itcl_FirstListElem(&objects);
+    while (elem) {
+        ioPtr = (ItclObject*)Itcl_GetListValue(elem);
+        elem = Itcl_NextListElem(elem);
+
+	if (result == TCL_OK) {
+	    callbackPtr = Itcl_GetCurrentCallbackPtr(interp);
+	    Tcl_NRAddCallback(interp, CallDeleteOneObject, iclsPtr,
+		    iclsPtr->infoPtr, ioPtr, NULL);
+	    result = Itcl_NRRunCallbacks(interp, callbackPtr);
+	}
+	Itcl_ReleaseData(ioPtr);
+    }
+    Itcl_DeleteList(&objects);
     if (result != TCL_OK) {
         return result;
     }
@@ -823,6 +829,7 @@ ItclDestroyClassNamesp(
     Tcl_Command cmdPtr;
     ItclClass *iclsPtr;
     ItclObject *ioPtr;
+    Itcl_List objects;
     Itcl_ListElem *elem;
     Itcl_ListElem *belem;
     ItclClass *iclsPtr2;
@@ -861,30 +868,40 @@ ItclDestroyClassNamesp(
     /*
      *  Scan through and find all objects that belong to this class.
      *  Destroy them quietly by deleting their access command.
+     *
+     *  Fix 227804: deleting an object deletes its entry in the object
+     *  table, so the search cannot continue after it.  Rather than
+     *  restarting the search after each object, which is quadratic
+     *  when many objects of other classes exist, collect the objects
+     *  first.  An object may be deleted by the destructor of another,
+     *  so check that it is still in the table before deleting it.
      */
+    Itcl_InitList(&objects);
     hPtr = Tcl_FirstHashEntry(&iclsPtr->infoPtr->objects, &place);
     while (hPtr) {
         ioPtr = (ItclObject*)Tcl_GetHashValue(hPtr);
         if (ioPtr->iclsPtr == iclsPtr) {
-	    if ((ioPtr->accessCmd != NULL) && (!(ioPtr->flags &
-	            (ITCL_OBJECT_IS_DESTRUCTED)))) {
-		Itcl_PreserveData(ioPtr);
-                Tcl_DeleteCommandFromToken(iclsPtr->interp, ioPtr->accessCmd);
-	        ioPtr->accessCmd = NULL;
-		Itcl_ReleaseData(ioPtr);
-	        /*
-	         * Fix 227804: Whenever an object to delete was found we
-	         * have to reset the search to the beginning as the
-	         * current entry in the search was deleted and accessing it
-	         * is therefore not allowed anymore.
-	         */
-
-	        hPtr = Tcl_FirstHashEntry(&iclsPtr->infoPtr->objects, &place);
-	        continue;
-	    }
+	    Itcl_PreserveData(ioPtr);
+	    Itcl_AppendList(&objects, ioPtr);
         }
         hPtr = Tcl_NextHashEntry(&place);
     }
+    elem = Itcl_FirstListElem(&objects);
+    while (elem) {
+        ioPtr = (ItclObject*)Itcl_GetListValue(elem);
+	if ((Tcl_FindHashEntry(&iclsPtr->infoPtr->objects,
+		(char *)ioPtr) != NULL) && (ioPtr->accessCmd != NULL)
+		&& (!(ioPtr->flags & (ITCL_OBJECT_IS_DESTRUCTED)))) {
+            Tcl_DeleteCommandFromToken(iclsPtr->interp, ioPtr->accessCmd);
+	    ioPtr->accessCmd = NULL;
+	}
+	Itcl_ReleaseData(ioPtr);
+        elem = Itcl_NextListElem(elem);
+    }
+    Itcl_DeleteList(&objects);
+    if (iclsPtr->flags & ITCL_RECORD) {
+	ItclDestroyRecord(iclsPtr);
+    }
 
     /*
      * Now there are no objects and inherited classes anymore, they could access a
@@ -927,6 +944,22 @@ ItclDestroyClassNamesp(
         belem = Itcl_NextListElem(belem);
     }
 
+    /*
+     *  Release the names under which Itcl_DefineClass() registered the
+     *  C implementations of the methods, so that the class can be
+     *  defined again.
+     */
+    if (iclsPtr->flags & ITCL_CLASS_FROM_SPEC) {
+	ItclMemberFunc *imPtr;
+
+	hPtr = Tcl_FirstHashEntry(&iclsPtr->functions, &place);
+	while (hPtr) {
+	    imPtr = (ItclMemberFunc*)Tcl_GetHashValue(hPtr);
+	    ItclUnregisterC(iclsPtr->interp, Tcl_GetString(imPtr->fullNamePtr));
+	    hPtr = Tcl_NextHashEntry(&place);
+	}
+    }
+
     /*
      *  Next, destroy the access command associated with the class.
      */
@@ -1153,6 +1186,13 @@ ItclFreeClass(
         Tcl_DecrRefCount(iclsPtr->hullTypePtr);
     }
 
+    /*
+     *  Free up the prefixes of forwarded methods
+     */
+    if (iclsPtr->forwardsPtr != NULL) {
+        Tcl_DecrRefCount(iclsPtr->forwardsPtr);
+    }
+
     /*
      *  Free up the type typeconstrutor code
      */
@@ -1177,6 +1217,19 @@ ItclFreeClass(
         ckfree((char *)iclsPtr->resolvePtr->clientData);
         ckfree((char *)iclsPtr->resolvePtr);
     }
+    if (iclsPtr->constructStatsPtr != NULL) {
+        ckfree((char *)iclsPtr->constructStatsPtr);
+    }
+    if (iclsPtr->typedVars != NULL) {
+        Tcl_DeleteHashTable(iclsPtr->typedVars);
+        ckfree((char *)iclsPtr->typedVars);
+    }
+    if (iclsPtr->recordPtr != NULL) {
+        ItclDeleteRecord(iclsPtr);
+    }
+    if (iclsPtr->indexes != NULL) {
+        ItclDeleteIndexes(iclsPtr);
+    }
     ckfree(iclsPtr);
 }
 
@@ -1401,6 +1454,8 @@ CallCreateObject(
  *  object named <objName> in the appropriate class.  Note that if
  *  <objName> contains "#auto", that part is automatically replaced
  *  by a unique string built from the class name.
+ *
+ *  The command of a record class is handled by ItclRecordCmd() instead.
  * ------------------------------------------------------------------------
  */
 int
@@ -1410,6 +1465,19 @@ Itcl_HandleClass(
     int objc,                /* number of arguments */
     Tcl_Obj *const objv[])   /* argument objects */
 {
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)clientData;
+    Tcl_HashEntry *hPtr;
+    ItclClass *iclsPtr;
+
+    if (objc > 2) {
+	hPtr = Tcl_FindHashEntry(&infoPtr->nameClasses, (char *)objv[2]);
+	if (hPtr != NULL) {
+	    iclsPtr = (ItclClass *)Tcl_GetHashValue(hPtr);
+	    if (iclsPtr->recordPtr != NULL) {
+		return ItclRecordCmd(iclsPtr, interp, objc - 2, objv + 2);
+	    }
+	}
+    }
     if (objc > 3) {
 	const char *token = Tcl_GetString(objv[3]);
 	const char *nsEnd = NULL;
@@ -1611,6 +1679,34 @@ ItclClassCreateObject(
     return Itcl_NRRunCallbacks(interp, callbackPtr);
 }
 
+/*
+ * ------------------------------------------------------------------------
+ *  ItclAutoObjectName()
+ *
+ *  Builds in the given buffer an unused command name for a new object
+ *  of a class, like the one substituted for "#auto" when objects are
+ *  created.  Returns the name.
+ * ------------------------------------------------------------------------
+ */
+const char *
+ItclAutoObjectName(
+    Tcl_Interp *interp,       /* current interpreter */
+    ItclClass *iclsPtr,       /* class of the new object */
+    Tcl_DString *bufferPtr)   /* initialized buffer for the name */
+{
+    char unique[256];    /* buffer used for unique part of object names */
+    Tcl_CmdInfo dummy;
+
+    do {
+        sprintf(unique,"%.200s%" ITCL_Z_MODIFIER "u",
+                Tcl_GetString(iclsPtr->namePtr), iclsPtr->unique++);
+        unique[0] = tolower(UCHAR(unique[0]));
+        Tcl_DStringSetLength(bufferPtr, 0);
+        Tcl_DStringAppend(bufferPtr, unique, TCL_INDEX_NONE);
+    } while (Tcl_GetCommandInfo(interp, unique, &dummy) != 0);
+    return Tcl_DStringValue(bufferPtr);
+}
+
 
 /*
  * ------------------------------------------------------------------------
@@ -1628,6 +1724,7 @@ ItclResolveVarEntry(
 
     /* could be resolved directly */
     if ((reshPtr = Tcl_FindHashEntry(&iclsPtr->resolveVars, lookupName)) != NULL) {
+	ITCL_STATS_INCR(iclsPtr->infoPtr, varLookupHits);
 	return reshPtr;
     } else {
 	/* try to build virtual table for this var */
@@ -1642,6 +1739,8 @@ ItclResolveVarEntry(
 	int newEntry, processAncestors;
 	Tcl_Size varLen;
 
+	ITCL_STATS_INCR(iclsPtr->infoPtr, varLookupMisses);
+
 	/* (de)qualify to simple name */
 	varName = simpleName = lookupName;
 	while(*varName) {
@@ -1727,6 +1826,7 @@ ItclResolveVarEntry(
 			    /* create new (or overwrite) */
 			    vlookup = (ItclVarLookup *)ckalloc(sizeof(ItclVarLookup));
 			    vlookup->usage = 0;
+			    ITCL_STATS_INCR(iclsPtr->infoPtr, varLookupsAllocated);
 
 			setResVar:
 
@@ -1854,6 +1954,7 @@ Itcl_BuildVirtualTables(
     ItclCmdLookup *clookupPtr;
     int newEntry;
 
+    ITCL_STATS_INCR(iclsPtr->infoPtr, virtualTableBuilds);
     Tcl_DStringInit(&buffer);
     Tcl_DStringInit(&buffer2);
 
@@ -1956,10 +2057,88 @@ Itcl_BuildVirtualTables(
     }
     Itcl_DeleteHierIter(&hier);
 
+    ItclLayoutTypedVars(iclsPtr);
+
     Tcl_DStringFree(&buffer);
     Tcl_DStringFree(&buffer2);
 }
 
+/*
+ * ------------------------------------------------------------------------
+ *  ItclLayoutTypedVars()
+ *
+ *  Assigns an offset in the buffer of C values of each object to every
+ *  typed instance variable of a class and its base classes.  Values of
+ *  8 bytes come first, so that none of them needs padding.
+ * ------------------------------------------------------------------------
+ */
+static void
+ItclLayoutTypedVars(
+    ItclClass *iclsPtr)           /* class being updated */
+{
+    ItclHierIter hier;
+    ItclClass *iclsPtr2;
+    ItclVariable *ivPtr;
+    FOREACH_HASH_DECLS;
+    Tcl_HashEntry *hPtr2;
+    Tcl_Size offset;
+    int isNew;
+    int pass;
+
+    if (iclsPtr->typedVars != NULL) {
+	Tcl_DeleteHashTable(iclsPtr->typedVars);
+	ckfree((char *)iclsPtr->typedVars);
+	iclsPtr->typedVars = NULL;
+    }
+    iclsPtr->numTypedVars = 0;
+    iclsPtr->typedSize = 0;
+
+    Itcl_InitHierIter(&hier, iclsPtr);
+    while ((iclsPtr2 = Itcl_AdvanceHierIter(&hier)) != NULL) {
+	FOREACH_HASH_VALUE(ivPtr, &iclsPtr2->variables) {
+	    if ((ivPtr->type != ITCL_VARTYPE_NONE)
+		    && !(ivPtr->flags & ITCL_COMMON)) {
+		iclsPtr->numTypedVars++;
+	    }
+	}
+    }
+    Itcl_DeleteHierIter(&hier);
+    if (iclsPtr->numTypedVars == 0) {
+	return;
+    }
+
+    iclsPtr->typedVars = (Tcl_HashTable *)ckalloc(sizeof(Tcl_HashTable));
+    Tcl_InitHashTable(iclsPtr->typedVars, TCL_ONE_WORD_KEYS);
+    offset = 0;
+    for (pass = 0; pass < 2; pass++) {
+	Itcl_InitHierIter(&hier, iclsPtr);
+	while ((iclsPtr2 = Itcl_AdvanceHierIter(&hier)) != NULL) {
+	    FOREACH_HASH_VALUE(ivPtr, &iclsPtr2->variables) {
+		if ((ivPtr->type == ITCL_VARTYPE_NONE)
+			|| (ivPtr->flags & ITCL_COMMON)) {
+		    continue;
+		}
+		if ((ivPtr->type == ITCL_VARTYPE_DOUBLE)
+			|| (ivPtr->type == ITCL_VARTYPE_WIDEINT)) {
+		    if (pass == 0) {
+			hPtr2 = Tcl_CreateHashEntry(iclsPtr->typedVars,
+				(char *)ivPtr, &isNew);
+			Tcl_SetHashValue(hPtr2, INT2PTR(offset));
+			offset += 8;
+		    }
+		} else if (pass == 1) {
+		    hPtr2 = Tcl_CreateHashEntry(iclsPtr->typedVars,
+			    (char *)ivPtr, &isNew);
+		    Tcl_SetHashValue(hPtr2, INT2PTR(offset));
+		    offset += sizeof(int);
+		}
+	    }
+	}
+	Itcl_DeleteHierIter(&hier);
+    }
+    iclsPtr->typedSize = (offset + 7) & ~(Tcl_Size)7;
+}
+
 
 /*
  * ------------------------------------------------------------------------
@@ -2454,6 +2633,7 @@ ItclDeleteFunction(
 {
     Tcl_HashEntry *hPtr;
 
+    ItclProfileForget(imPtr->infoPtr, imPtr);
     hPtr = Tcl_FindHashEntry(&imPtr->infoPtr->procMethods,
 	    (char *) imPtr->tmPtr);
     if (hPtr != NULL) {
@@ -2473,12 +2653,6 @@ ItclDeleteFunction(
     }
     Tcl_DecrRefCount(imPtr->namePtr);
     Tcl_DecrRefCount(imPtr->fullNamePtr);
-    if (imPtr->usagePtr != NULL) {
-        Tcl_DecrRefCount(imPtr->usagePtr);
-    }
-    if (imPtr->argumentPtr != NULL) {
-        Tcl_DecrRefCount(imPtr->argumentPtr);
-    }
     if (imPtr->origArgsPtr != NULL) {
         Tcl_DecrRefCount(imPtr->origArgsPtr);
     }
@@ -2488,8 +2662,14 @@ ItclDeleteFunction(
     if (imPtr->bodyPtr != NULL) {
         Tcl_DecrRefCount(imPtr->bodyPtr);
     }
-    if (imPtr->argListPtr != NULL) {
-        ItclDeleteArgList(imPtr->argListPtr);
+    ItclReleaseArgList(imPtr->argListPtr);
+    if (imPtr->memoVarsPtr != NULL) {
+        Tcl_DecrRefCount(imPtr->memoVarsPtr);
+    }
+    if (imPtr->nonVirtualPtr != NULL) {
+        Tcl_DecrRefCount(imPtr->nonVirtualPtr->namePtr);
+        Tcl_DecrRefCount(imPtr->nonVirtualPtr->fullNamePtr);
+        Itcl_Free(imPtr->nonVirtualPtr);
     }
     Itcl_Free(imPtr);
 }
@@ -439,7 +439,7 @@ Itcl_FindObjectsCmd(
                 Tcl_CreateHashEntry(&unique, (char*)cmd, &newEntry);
 
                 match = 0;
-		if (newEntry &&
+		if (newEntry && !(contextIoPtr->flags & ITCL_OBJECT_HIDDEN) &&
 			(!pattern || Tcl_StringCaseMatch((const char *)cmdName,
 			pattern, 0))) {
                     if ((iclsPtr == NULL) ||
@@ -1165,10 +1165,167 @@ Itcl_IsClassCmd(
 
 /*
  * ------------------------------------------------------------------------
- *  Itcl_FilterCmd()
+ *  ItclChangeClassChain()
  *
- *  Used to add a filter command to an object which is called just before
- *  a method/proc of a class is executed
+ *  Adds names to or removes names from the filters or mixins of a
+ *  class.  The names are compared with those currently defined in
+ *  TclOO, including those set directly with "oo::define", and the
+ *  TclOO class is only redefined if they actually change.  This
+ *  matters, since every TclOO definition invalidates the cached call
+ *  chains of all methods of all objects of the interpreter, and they
+ *  have to be built again on the next call of each.
+ *
+ *  Returns TCL_OK/TCL_ERROR to indicate success/failure.
+ * ------------------------------------------------------------------------
+ */
+
+int
+ItclChangeClassChain(
+    Tcl_Interp *interp,      /* current interpreter */
+    ItclClass *iclsPtr,      /* class to be changed */
+    int kind,                /* ITCL_CHAIN_FILTER or ITCL_CHAIN_MIXIN */
+    int add,                 /* non-zero => add names, else remove them */
+    Tcl_Size objc,           /* number of names */
+    Tcl_Obj *const objv[])   /* names of filters or mixins */
+{
+    static const char *const kindNames[] = {"filter", "mixin"};
+    Tcl_Obj *listPtr;
+    Tcl_Obj *cmdPtr;
+    Tcl_Obj *namePtr;
+    Tcl_Obj **elemv;
+    Tcl_Object oPtr;
+    Tcl_Size elemc;
+    Tcl_Size i;
+    Tcl_Size j;
+    int changed;
+    int result;
+
+    listPtr = Itcl_GetClassChain(interp, iclsPtr->clsPtr,
+	    kind == ITCL_CHAIN_MIXIN);
+    Tcl_IncrRefCount(listPtr);
+    changed = 0;
+    for (i = 0; i < objc; i++) {
+
+	/*
+	 *  Mixins are listed by TclOO under their full names.
+	 */
+	namePtr = objv[i];
+	if (kind == ITCL_CHAIN_MIXIN) {
+	    oPtr = Tcl_GetObjectFromObj(interp, objv[i]);
+	    if (oPtr == NULL) {
+		Tcl_ResetResult(interp);
+	    } else if (Tcl_GetObjectAsClass(oPtr) != NULL) {
+		namePtr = Tcl_GetObjectName(interp, oPtr);
+	    }
+	}
+        Tcl_ListObjGetElements(NULL, listPtr, &elemc, &elemv);
+        for (j = 0; j < elemc; j++) {
+            if (strcmp(Tcl_GetString(elemv[j]),
+		    Tcl_GetString(namePtr)) == 0) {
+                break;
+            }
+        }
+        if (add) {
+            if (j == elemc) {
+                Tcl_ListObjAppendElement(NULL, listPtr, namePtr);
+                changed = 1;
+            }
+        } else {
+            if (j == elemc) {
+                Tcl_AppendResult(interp, "\"", Tcl_GetString(objv[i]),
+			"\" is no ", kindNames[kind], " of class \"",
+			Tcl_GetString(iclsPtr->fullNamePtr), "\"", NULL);
+                Tcl_DecrRefCount(listPtr);
+                return TCL_ERROR;
+            }
+            Tcl_ListObjReplace(NULL, listPtr, j, 1, 0, NULL);
+            changed = 1;
+        }
+    }
+    if (!changed) {
+        Tcl_DecrRefCount(listPtr);
+        return TCL_OK;
+    }
+
+    cmdPtr = Tcl_NewListObj(0, NULL);
+    Tcl_ListObjAppendElement(NULL, cmdPtr,
+	    Tcl_NewStringObj("::oo::define", TCL_INDEX_NONE));
+    Tcl_ListObjAppendElement(NULL, cmdPtr, iclsPtr->fullNamePtr);
+    Tcl_ListObjAppendElement(NULL, cmdPtr,
+	    Tcl_NewStringObj(kindNames[kind], TCL_INDEX_NONE));
+    Tcl_ListObjAppendElement(NULL, cmdPtr,
+	    Tcl_NewStringObj("-set", TCL_INDEX_NONE));
+    Tcl_ListObjAppendList(NULL, cmdPtr, listPtr);
+    Tcl_IncrRefCount(cmdPtr);
+    result = Tcl_EvalObjEx(interp, cmdPtr, 0);
+    Tcl_DecrRefCount(cmdPtr);
+    if (result != TCL_OK) {
+        Tcl_DecrRefCount(listPtr);
+        return TCL_ERROR;
+    }
+    ITCL_STATS_INCR(iclsPtr->infoPtr, chainChanges);
+    Tcl_DecrRefCount(listPtr);
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclAddForward()
+ *
+ *  Forwards the method "nameObj" of a class to the command prefix
+ *  "prefixObj".  Like ItclChangeClassChain(), this does not redefine
+ *  the TclOO class if the method is already forwarded to the same
+ *  prefix.
+ *
+ *  Returns TCL_OK/TCL_ERROR to indicate success/failure.
+ * ------------------------------------------------------------------------
+ */
+
+int
+ItclAddForward(
+    Tcl_Interp *interp,      /* current interpreter */
+    ItclClass *iclsPtr,      /* class to be changed */
+    Tcl_Obj *nameObj,        /* name of the forwarded method */
+    Tcl_Obj *prefixObj)      /* command prefix it is forwarded to */
+{
+    Tcl_Obj *oldPrefixObj;
+    Tcl_Method mPtr;
+
+    Tcl_IncrRefCount(prefixObj);
+    if (iclsPtr->forwardsPtr == NULL) {
+        iclsPtr->forwardsPtr = Tcl_NewDictObj();
+        Tcl_IncrRefCount(iclsPtr->forwardsPtr);
+    }
+    if ((Tcl_DictObjGet(NULL, iclsPtr->forwardsPtr, nameObj,
+	    &oldPrefixObj) == TCL_OK) && (oldPrefixObj != NULL)
+	    && (strcmp(Tcl_GetString(oldPrefixObj),
+	    Tcl_GetString(prefixObj)) == 0)) {
+        Tcl_DecrRefCount(prefixObj);
+        return TCL_OK;
+    }
+    mPtr = Itcl_NewForwardClassMethod(interp, iclsPtr->clsPtr, 1,
+            nameObj, prefixObj);
+    if (mPtr == NULL) {
+        Tcl_DecrRefCount(prefixObj);
+        return TCL_ERROR;
+    }
+    ITCL_STATS_INCR(iclsPtr->infoPtr, chainChanges);
+    if (Tcl_IsShared(iclsPtr->forwardsPtr)) {
+        Tcl_DecrRefCount(iclsPtr->forwardsPtr);
+        iclsPtr->forwardsPtr = Tcl_DuplicateObj(iclsPtr->forwardsPtr);
+        Tcl_IncrRefCount(iclsPtr->forwardsPtr);
+    }
+    Tcl_DictObjPut(NULL, iclsPtr->forwardsPtr, nameObj, prefixObj);
+    Tcl_DecrRefCount(prefixObj);
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_FilterAddCmd()
+ *
+ *  Used to add filter methods to a class, which are called just before
+ *  a method of the class is executed
  *
  *  Returns TCL_OK/TCL_ERROR to indicate success/failure.
  * ------------------------------------------------------------------------
@@ -1181,36 +1338,27 @@ Itcl_FilterAddCmd(
     int objc,                /* number of arguments */
     Tcl_Obj *const objv[])   /* argument objects */
 {
-    Tcl_Obj **newObjv;
-    int result;
+    ItclClass *iclsPtr;
 
-    ItclShowArgs(1, "Itcl_FilterCmd", objc, objv);
-/*    Tcl_Namespace *contextNs = Tcl_GetCurrentNamespace(interp); */
-/* FIXME need to change the chain command to do the same here as the TclOO next command !! */
+    ItclShowArgs(1, "Itcl_FilterAddCmd", objc, objv);
     if (objc < 3) {
         Tcl_WrongNumArgs(interp, 1, objv, "<className> <filterName> ?<filterName> ...?");
         return TCL_ERROR;
     }
-    newObjv = (Tcl_Obj **)ckalloc(sizeof(Tcl_Obj *)*(objc+1));
-    newObjv[0] = Tcl_NewStringObj("::oo::define", TCL_INDEX_NONE);
-    Tcl_IncrRefCount(newObjv[0]);
-    newObjv[1] = objv[1];
-    newObjv[2] = Tcl_NewStringObj("filter", TCL_INDEX_NONE);
-    Tcl_IncrRefCount(newObjv[2]);
-    memcpy(newObjv+3, objv+2, sizeof(Tcl_Obj *)*(objc-2));
-    ItclShowArgs(1, "Itcl_FilterAddCmd2", objc+1, newObjv);
-    result = Tcl_EvalObjv(interp, objc+1, newObjv, 0);
-    Tcl_DecrRefCount(newObjv[0]);
-    Tcl_DecrRefCount(newObjv[2]);
-
-    return result;
+    iclsPtr = Itcl_FindClass(interp, Tcl_GetString(objv[1]),
+	    /* no autoload */ 0);
+    if (iclsPtr == NULL) {
+        return TCL_ERROR;
+    }
+    return ItclChangeClassChain(interp, iclsPtr, ITCL_CHAIN_FILTER, 1,
+	    objc-2, objv+2);
 }
-
+
 /*
  * ------------------------------------------------------------------------
  *  Itcl_FilterDeleteCmd()
  *
- *  used to delete filter commands of a class or object
+ *  used to delete filter methods of a class
  *
  *  Returns TCL_OK/TCL_ERROR to indicate success/failure.
  * ------------------------------------------------------------------------
@@ -1223,13 +1371,22 @@ Itcl_FilterDeleteCmd(
     int objc,                /* number of arguments */
     Tcl_Obj *const objv[])   /* argument objects */
 {
-    ItclShowArgs(1, "Itcl_FilterDeleteCmd", objc, objv);
-/*    Tcl_Namespace *contextNs = Tcl_GetCurrentNamespace(interp); */
+    ItclClass *iclsPtr;
 
-    Tcl_AppendResult(interp, "::itcl::filter delete command not yet implemented", NULL);
-    return TCL_ERROR;
+    ItclShowArgs(1, "Itcl_FilterDeleteCmd", objc, objv);
+    if (objc < 3) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<className> <filterName> ?<filterName> ...?");
+        return TCL_ERROR;
+    }
+    iclsPtr = Itcl_FindClass(interp, Tcl_GetString(objv[1]),
+	    /* no autoload */ 0);
+    if (iclsPtr == NULL) {
+        return TCL_ERROR;
+    }
+    return ItclChangeClassChain(interp, iclsPtr, ITCL_CHAIN_FILTER, 0,
+	    objc-2, objv+2);
 }
-
+
 /*
  * ------------------------------------------------------------------------
  *  Itcl_ForwardAddCmd()
@@ -1248,8 +1405,6 @@ Itcl_ForwardAddCmd(
     int objc,                /* number of arguments */
     Tcl_Obj *const objv[])   /* argument objects */
 {
-    Tcl_Obj *prefixObj;
-    Tcl_Method mPtr;
     ItclObjectInfo *infoPtr;
     ItclClass *iclsPtr;
 
@@ -1270,15 +1425,10 @@ Itcl_ForwardAddCmd(
 	}
 	iclsPtr = (ItclClass *)Tcl_GetHashValue(hPtr);
     }
-    prefixObj = Tcl_NewListObj(objc-2, objv+2);
-    mPtr = Itcl_NewForwardClassMethod(interp, iclsPtr->clsPtr, 1,
-            objv[1], prefixObj);
-    if (mPtr == NULL) {
-        return TCL_ERROR;
-    }
-    return TCL_OK;
+    return ItclAddForward(interp, iclsPtr, objv[1],
+	    Tcl_NewListObj(objc-2, objv+2));
 }
-
+
 /*
  * ------------------------------------------------------------------------
  *  Itcl_ForwardDeleteCmd()
@@ -1302,7 +1452,7 @@ Itcl_ForwardDeleteCmd(
     Tcl_AppendResult(interp, "::itcl::forward delete command not yet implemented", NULL);
     return TCL_ERROR;
 }
-
+
 /*
  * ------------------------------------------------------------------------
  *  Itcl_MixinAddCmd()
@@ -1320,29 +1470,22 @@ Itcl_MixinAddCmd(
     int objc,                /* number of arguments */
     Tcl_Obj *const objv[])   /* argument objects */
 {
-    Tcl_Obj **newObjv;
-    int result;
+    ItclClass *iclsPtr;
 
     ItclShowArgs(1, "Itcl_MixinAddCmd", objc, objv);
     if (objc < 3) {
         Tcl_WrongNumArgs(interp, 1, objv, "<className> <mixinName> ?<mixinName> ...?");
         return TCL_ERROR;
     }
-    newObjv = (Tcl_Obj **)ckalloc(sizeof(Tcl_Obj *)*(objc+1));
-    newObjv[0] = Tcl_NewStringObj("::oo::define", TCL_INDEX_NONE);
-    Tcl_IncrRefCount(newObjv[0]);
-    newObjv[1] = objv[1];
-    newObjv[2] = Tcl_NewStringObj("mixin", TCL_INDEX_NONE);
-    Tcl_IncrRefCount(newObjv[2]);
-    memcpy(newObjv+3, objv+2, sizeof(Tcl_Obj *)*(objc-2));
-    ItclShowArgs(1, "Itcl_MixinAddCmd2", objc+1, newObjv);
-    result = Tcl_EvalObjv(interp, objc+1, newObjv, 0);
-    Tcl_DecrRefCount(newObjv[0]);
-    Tcl_DecrRefCount(newObjv[2]);
-
-    return result;
+    iclsPtr = Itcl_FindClass(interp, Tcl_GetString(objv[1]),
+	    /* no autoload */ 0);
+    if (iclsPtr == NULL) {
+        return TCL_ERROR;
+    }
+    return ItclChangeClassChain(interp, iclsPtr, ITCL_CHAIN_MIXIN, 1,
+	    objc-2, objv+2);
 }
-
+
 /*
  * ------------------------------------------------------------------------
  *  Itcl_MixinDeleteCmd()
@@ -1360,13 +1503,22 @@ Itcl_MixinDeleteCmd(
     int objc,                /* number of arguments */
     Tcl_Obj *const objv[])   /* argument objects */
 {
-    ItclShowArgs(1, "Itcl_MixinDeleteCmd", objc, objv);
-/*    Tcl_Namespace *contextNs = Tcl_GetCurrentNamespace(interp); */
+    ItclClass *iclsPtr;
 
-    Tcl_AppendResult(interp, "::itcl::mixin delete command not yet implemented", NULL);
-    return TCL_ERROR;
+    ItclShowArgs(1, "Itcl_MixinDeleteCmd", objc, objv);
+    if (objc < 3) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<className> <mixinName> ?<mixinName> ...?");
+        return TCL_ERROR;
+    }
+    iclsPtr = Itcl_FindClass(interp, Tcl_GetString(objv[1]),
+	    /* no autoload */ 0);
+    if (iclsPtr == NULL) {
+        return TCL_ERROR;
+    }
+    return ItclChangeClassChain(interp, iclsPtr, ITCL_CHAIN_MIXIN, 0,
+	    objc-2, objv+2);
 }
-
+
 /*
  * ------------------------------------------------------------------------
  *  Itcl_NWidgetCmd()
@@ -2172,3 +2324,740 @@ Itcl_ClassWidgetClassCmd(
     Tcl_AppendResult(interp, "invalid command name \"widgetclass\"", NULL);
     return TCL_ERROR;
 }
+
+/*
+ *  Flags of the variables which are not part of the state of an object:
+ *  commons and the built-in variables.
+ */
+#define ITCL_STATE_IGNORED_VARS (ITCL_COMMON|ITCL_THIS_VAR|ITCL_OPTIONS_VAR| \
+	ITCL_TYPE_VAR|ITCL_SELF_VAR|ITCL_SELFNS_VAR|ITCL_WIN_VAR| \
+	ITCL_HULL_VAR|ITCL_OPTION_COMP_VAR)
+
+static const char *const stateGetOptions[] = {
+    "-all", "-class", "-public", NULL
+};
+enum StateGetOption {
+    STATE_GET_ALL, STATE_GET_CLASS, STATE_GET_PUBLIC
+};
+static const char *const stateSetOptions[] = {
+    "-class", "-configure", NULL
+};
+enum StateSetOption {
+    STATE_SET_CLASS, STATE_SET_CONFIGURE
+};
+
+/*
+ * ------------------------------------------------------------------------
+ *  StateFindObject()
+ *
+ *  Returns the object with the given name, or NULL (along with an error
+ *  message in the interpreter) if there is no such object.
+ * ------------------------------------------------------------------------
+ */
+static ItclObject *
+StateFindObject(
+    Tcl_Interp *interp,      /* current interpreter */
+    Tcl_Obj *namePtr)        /* name of the object */
+{
+    ItclObject *ioPtr = NULL;
+
+    if (Itcl_FindObject(interp, Tcl_GetString(namePtr), &ioPtr) != TCL_OK) {
+	return NULL;
+    }
+    if (ioPtr == NULL) {
+	Tcl_AppendResult(interp, "object \"", Tcl_GetString(namePtr),
+		"\" not found", NULL);
+    }
+    return ioPtr;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  StateFindClass()
+ *
+ *  Returns the class with the given name, which must be a class of the
+ *  object, or NULL (along with an error message in the interpreter).
+ * ------------------------------------------------------------------------
+ */
+static ItclClass *
+StateFindClass(
+    Tcl_Interp *interp,      /* current interpreter */
+    ItclObject *ioPtr,       /* object */
+    Tcl_Obj *namePtr)        /* name of the class */
+{
+    ItclClass *iclsPtr;
+
+    iclsPtr = Itcl_FindClass(interp, Tcl_GetString(namePtr),
+	    /* autoload */ 1);
+    if (iclsPtr == NULL) {
+	return NULL;
+    }
+    if (!Itcl_ObjectIsa(ioPtr, iclsPtr)) {
+	Tcl_AppendResult(interp, "object \"", Tcl_GetString(ioPtr->namePtr),
+		"\" is not of class \"", Tcl_GetString(iclsPtr->fullNamePtr),
+		"\"", NULL);
+	return NULL;
+    }
+    return iclsPtr;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  StateVarName()
+ *
+ *  Returns the name of an instance variable in the state of an object:
+ *  its simple name, unless that name refers to another variable in the
+ *  class of the object, in which case its fully qualified name.
+ * ------------------------------------------------------------------------
+ */
+static Tcl_Obj *
+StateVarName(
+    ItclClass *iclsPtr,      /* class in which names are resolved */
+    ItclVariable *ivPtr)     /* instance variable */
+{
+    Tcl_HashEntry *hPtr;
+
+    hPtr = ItclResolveVarEntry(iclsPtr, Tcl_GetString(ivPtr->namePtr));
+    if ((hPtr != NULL)
+	    && (((ItclVarLookup *)Tcl_GetHashValue(hPtr))->ivPtr == ivPtr)) {
+	return ivPtr->namePtr;
+    }
+    return ivPtr->fullNamePtr;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  StateAssignVars()
+ *
+ *  Sets instance variables of objects to new values.  Either all of
+ *  them are set, or none: if a value cannot be set, the variables set
+ *  so far get back their previous values.
+ *
+ *  Returns TCL_OK, or TCL_ERROR (along with an error message in the
+ *  interpreter) if a value cannot be set.
+ * ------------------------------------------------------------------------
+ */
+static int
+StateAssignVars(
+    Tcl_Interp *interp,      /* current interpreter */
+    Tcl_Size numVars,        /* number of variables */
+    ItclVariable *const *ivPtrs, /* definitions of the variables */
+    const Tcl_Var *varPtrs,  /* the variables */
+    Tcl_Obj *const *valuePtrs) /* their new values */
+{
+    Tcl_Obj **oldValuePtrs;
+    Tcl_InterpState state;
+    Tcl_Size i;
+    int result = TCL_OK;
+
+    oldValuePtrs = (Tcl_Obj **)ckalloc(numVars * sizeof(Tcl_Obj *));
+    for (i = 0; i < numVars; i++) {
+	oldValuePtrs[i] = TclIsVarUndefined((Var *)varPtrs[i]) ? NULL
+		: TclPtrGetVar(interp, varPtrs[i], NULL, ivPtrs[i]->namePtr,
+		NULL, 0);
+	if (oldValuePtrs[i] != NULL) {
+	    Tcl_IncrRefCount(oldValuePtrs[i]);
+	}
+	if (TclPtrSetVar(interp, varPtrs[i], NULL, ivPtrs[i]->namePtr, NULL,
+		valuePtrs[i], TCL_LEAVE_ERR_MSG) == NULL) {
+	    result = TCL_ERROR;
+	    break;
+	}
+    }
+    if (result != TCL_OK) {
+	Tcl_AppendObjToErrorInfo(interp, Tcl_ObjPrintf(
+		"\n    (setting instance variable \"%s\")",
+		Tcl_GetString(ivPtrs[i]->fullNamePtr)));
+	state = Tcl_SaveInterpState(interp, TCL_ERROR);
+	for (numVars = i + 1; i >= 0; i--) {
+	    if (oldValuePtrs[i] != NULL) {
+		TclPtrSetVar(interp, varPtrs[i], NULL, ivPtrs[i]->namePtr,
+			NULL, oldValuePtrs[i], 0);
+	    } else if (!TclIsVarUndefined((Var *)varPtrs[i])) {
+		TclPtrUnsetVar(interp, varPtrs[i], NULL, ivPtrs[i]->namePtr,
+			NULL, 0);
+	    }
+	}
+	Tcl_RestoreInterpState(interp, state);
+    }
+    for (i = 0; i < numVars; i++) {
+	if (oldValuePtrs[i] != NULL) {
+	    Tcl_DecrRefCount(oldValuePtrs[i]);
+	}
+    }
+    ckfree(oldValuePtrs);
+    return result;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_StateGetCmd()
+ *
+ *  Returns the instance variables of an object as a dictionary.
+ *  Handles the following syntax:
+ *
+ *    itcl::state get <object> ?-public|-all? ?-class <className>?
+ *
+ *  Commons, built-in variables, arrays and variables without a value
+ *  are left out.  Variables are named as by StateVarName(), or by
+ *  their simple names if they are restricted to a single class.
+ *
+ *  Returns TCL_OK/TCL_ERROR to indicate success/failure.
+ * ------------------------------------------------------------------------
+ */
+int
+Itcl_StateGetCmd(
+    TCL_UNUSED(void *),      /* infoPtr */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    ItclObject *ioPtr;
+    ItclClass *iclsPtr;
+    ItclClass *classPtr = NULL;
+    ItclVariable *ivPtr;
+    ItclHierIter hier;
+    Tcl_HashEntry *entryPtr;
+    FOREACH_HASH_DECLS;
+    Tcl_Obj *resultPtr;
+    Tcl_Obj *valuePtr;
+    Var *varPtr;
+    int publicOnly = 0;
+    int index;
+    int i;
+
+    ItclShowArgs(1, "Itcl_StateGetCmd", objc, objv);
+    if (objc < 2) {
+	Tcl_WrongNumArgs(interp, 1, objv,
+		"object ?-public|-all? ?-class className?");
+	return TCL_ERROR;
+    }
+    ioPtr = StateFindObject(interp, objv[1]);
+    if (ioPtr == NULL) {
+	return TCL_ERROR;
+    }
+    for (i = 2; i < objc; i++) {
+	if (Tcl_GetIndexFromObj(interp, objv[i], stateGetOptions, "option",
+		0, &index) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	switch ((enum StateGetOption)index) {
+	case STATE_GET_ALL:
+	    publicOnly = 0;
+	    break;
+	case STATE_GET_PUBLIC:
+	    publicOnly = 1;
+	    break;
+	case STATE_GET_CLASS:
+	    if (++i >= objc) {
+		Tcl_AppendResult(interp, "missing value for -class", NULL);
+		return TCL_ERROR;
+	    }
+	    classPtr = StateFindClass(interp, ioPtr, objv[i]);
+	    if (classPtr == NULL) {
+		return TCL_ERROR;
+	    }
+	    break;
+	}
+    }
+
+    resultPtr = Tcl_NewDictObj();
+    Itcl_InitHierIter(&hier, ioPtr->iclsPtr);
+    while ((iclsPtr = Itcl_AdvanceHierIter(&hier)) != NULL) {
+	if ((classPtr != NULL) && (iclsPtr != classPtr)) {
+	    continue;
+	}
+	FOREACH_HASH_VALUE(ivPtr, &iclsPtr->variables) {
+	    if ((ivPtr->flags & ITCL_STATE_IGNORED_VARS)
+		    || (publicOnly && (ivPtr->protection != ITCL_PUBLIC))) {
+		continue;
+	    }
+	    entryPtr = Tcl_FindHashEntry(&ioPtr->objectVariables,
+		    (char *)ivPtr);
+	    if (entryPtr == NULL) {
+		continue;
+	    }
+	    varPtr = (Var *)Tcl_GetHashValue(entryPtr);
+	    if (TclIsVarUndefined(varPtr) || TclIsVarArray(varPtr)) {
+		continue;
+	    }
+	    valuePtr = TclPtrGetVar(interp, (Tcl_Var)varPtr, NULL,
+		    ivPtr->namePtr, NULL, TCL_LEAVE_ERR_MSG);
+	    if (valuePtr == NULL) {
+		Itcl_DeleteHierIter(&hier);
+		Tcl_DecrRefCount(resultPtr);
+		return TCL_ERROR;
+	    }
+	    Tcl_DictObjPut(NULL, resultPtr, (classPtr != NULL)
+		    ? ivPtr->namePtr : StateVarName(ioPtr->iclsPtr, ivPtr),
+		    valuePtr);
+	}
+    }
+    Itcl_DeleteHierIter(&hier);
+    Tcl_SetObjResult(interp, resultPtr);
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_StateSetCmd()
+ *
+ *  Sets instance variables of an object from a dictionary.  Handles the
+ *  following syntax:
+ *
+ *    itcl::state set <object> <dict> ?-class <className>? ?-configure?
+ *
+ *  Names are resolved in the class of the object, or in <className>.
+ *  Either all variables are set, or none, as by StateAssignVars().  With
+ *  -configure, the "config" code of the public variables which were
+ *  set is then run once, as by a single "configure" of the object.
+ *
+ *  Returns TCL_OK/TCL_ERROR to indicate success/failure.
+ * ------------------------------------------------------------------------
+ */
+int
+Itcl_StateSetCmd(
+    TCL_UNUSED(void *),      /* infoPtr */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    ItclObject *ioPtr;
+    ItclClass *classPtr;
+    ItclVariable *ivPtr;
+    ItclVariable **ivPtrs;
+    ItclMemberFunc *imPtr;
+    Tcl_HashEntry *hPtr;
+    Tcl_DictSearch search;
+    Tcl_Obj *keyPtr;
+    Tcl_Obj *valuePtr;
+    Tcl_Obj **valuePtrs;
+    Tcl_Obj *configPtr;
+    Tcl_Obj *optionPtr;
+    Tcl_Obj **configv;
+    Tcl_Var *varPtrs;
+    Tcl_Size numVars;
+    Tcl_Size configc;
+    Tcl_Size i;
+    int configure = 0;
+    int done;
+    int index;
+    int result = TCL_OK;
+
+    ItclShowArgs(1, "Itcl_StateSetCmd", objc, objv);
+    if (objc < 3) {
+	Tcl_WrongNumArgs(interp, 1, objv,
+		"object dict ?-class className? ?-configure?");
+	return TCL_ERROR;
+    }
+    ioPtr = StateFindObject(interp, objv[1]);
+    if (ioPtr == NULL) {
+	return TCL_ERROR;
+    }
+    classPtr = ioPtr->iclsPtr;
+    for (i = 3; i < objc; i++) {
+	if (Tcl_GetIndexFromObj(interp, objv[i], stateSetOptions, "option",
+		0, &index) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	switch ((enum StateSetOption)index) {
+	case STATE_SET_CLASS:
+	    if (++i >= objc) {
+		Tcl_AppendResult(interp, "missing value for -class", NULL);
+		return TCL_ERROR;
+	    }
+	    classPtr = StateFindClass(interp, ioPtr, objv[i]);
+	    if (classPtr == NULL) {
+		return TCL_ERROR;
+	    }
+	    break;
+	case STATE_SET_CONFIGURE:
+	    configure = 1;
+	    break;
+	}
+    }
+    if (Tcl_DictObjSize(interp, objv[2], &numVars) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (numVars == 0) {
+	return TCL_OK;
+    }
+
+    /*
+     *  Resolve all names before anything is set.
+     */
+    ivPtrs = (ItclVariable **)ckalloc(numVars * (sizeof(ItclVariable *)
+	    + sizeof(Tcl_Var) + sizeof(Tcl_Obj *)));
+    varPtrs = (Tcl_Var *)(ivPtrs + numVars);
+    valuePtrs = (Tcl_Obj **)(varPtrs + numVars);
+    Tcl_DictObjFirst(NULL, objv[2], &search, &keyPtr, &valuePtr, &done);
+    for (i = 0; !done; i++) {
+	hPtr = ItclResolveVarEntry(classPtr, Tcl_GetString(keyPtr));
+	ivPtr = (hPtr != NULL)
+		? ((ItclVarLookup *)Tcl_GetHashValue(hPtr))->ivPtr : NULL;
+	hPtr = ((ivPtr == NULL) || (ivPtr->flags & ITCL_STATE_IGNORED_VARS))
+		? NULL : Tcl_FindHashEntry(&ioPtr->objectVariables,
+		(char *)ivPtr);
+	if (hPtr == NULL) {
+	    Tcl_AppendResult(interp, "\"", Tcl_GetString(keyPtr),
+		    "\" is not an instance variable of object \"",
+		    Tcl_GetString(ioPtr->namePtr), "\"", NULL);
+	    Tcl_DictObjDone(&search);
+	    ckfree(ivPtrs);
+	    return TCL_ERROR;
+	}
+	ivPtrs[i] = ivPtr;
+	varPtrs[i] = (Tcl_Var)Tcl_GetHashValue(hPtr);
+	valuePtrs[i] = valuePtr;
+	Tcl_DictObjNext(&search, &keyPtr, &valuePtr, &done);
+    }
+
+    Itcl_PreserveData(ioPtr);
+    result = StateAssignVars(interp, numVars, ivPtrs, varPtrs, valuePtrs);
+
+    /*
+     *  Run the "config" code of the public variables through the
+     *  "configure" method of the object.
+     */
+    if ((result == TCL_OK) && configure) {
+	configPtr = Tcl_NewListObj(0, NULL);
+	Tcl_IncrRefCount(configPtr);
+	for (i = 0; i < numVars; i++) {
+	    ivPtr = ivPtrs[i];
+	    if ((ivPtr->protection != ITCL_PUBLIC) || (ivPtr->codePtr == NULL)
+		    || !Itcl_IsMemberCodeImplemented(ivPtr->codePtr)) {
+		continue;
+	    }
+	    optionPtr = Tcl_NewStringObj("-", 1);
+	    Tcl_AppendObjToObj(optionPtr,
+		    StateVarName(ioPtr->iclsPtr, ivPtr));
+	    Tcl_ListObjAppendElement(NULL, configPtr, optionPtr);
+	    Tcl_ListObjAppendElement(NULL, configPtr, valuePtrs[i]);
+	}
+	Tcl_ListObjGetElements(NULL, configPtr, &configc, &configv);
+	if (configc > 0) {
+	    imPtr = Itcl_LookupMethod(interp, ioPtr->iclsPtr, "configure");
+	    result = (imPtr == NULL) ? TCL_ERROR
+		    : Itcl_InvokeMethod(interp, ioPtr, imPtr, configc, configv);
+	}
+	Tcl_DecrRefCount(configPtr);
+	if (result == TCL_OK) {
+	    Tcl_ResetResult(interp);
+	}
+    }
+    Itcl_ReleaseData(ioPtr);
+    ckfree(ivPtrs);
+    return result;
+}
+
+static const char *const columnOptions[] = {
+    "-isa", "-objects", NULL
+};
+enum ColumnOption {
+    COLUMN_ISA, COLUMN_OBJECTS
+};
+
+/*
+ * ------------------------------------------------------------------------
+ *  ColumnParseArgs()
+ *
+ *  Parses the arguments common to "itcl::column get" and "itcl::column
+ *  set": the class, the name of an instance variable of the class, and
+ *  the options from objv[firstOption] on.
+ *
+ *  Returns TCL_OK, or TCL_ERROR (along with an error message in the
+ *  interpreter) if anything goes wrong.
+ * ------------------------------------------------------------------------
+ */
+static int
+ColumnParseArgs(
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[],   /* argument objects */
+    int firstOption,         /* index of the first option */
+    ItclClass **iclsPtrPtr,  /* returns the class */
+    ItclVariable **ivPtrPtr, /* returns the variable */
+    int *isaPtr,             /* returns 1 if -isa was given */
+    int *objectsPtr)         /* returns 1 if -objects was given */
+{
+    ItclClass *iclsPtr;
+    Tcl_HashEntry *hPtr;
+    ItclVariable *ivPtr = NULL;
+    int index;
+    int i;
+
+    *isaPtr = *objectsPtr = 0;
+    for (i = firstOption; i < objc; i++) {
+	if (Tcl_GetIndexFromObj(interp, objv[i], columnOptions, "option", 0,
+		&index) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	switch ((enum ColumnOption)index) {
+	case COLUMN_ISA:
+	    *isaPtr = 1;
+	    break;
+	case COLUMN_OBJECTS:
+	    *objectsPtr = 1;
+	    break;
+	}
+    }
+    iclsPtr = Itcl_FindClass(interp, Tcl_GetString(objv[1]),
+	    /* autoload */ 1);
+    if (iclsPtr == NULL) {
+	return TCL_ERROR;
+    }
+    hPtr = ItclResolveVarEntry(iclsPtr, Tcl_GetString(objv[2]));
+    if (hPtr != NULL) {
+	ivPtr = ((ItclVarLookup *)Tcl_GetHashValue(hPtr))->ivPtr;
+    }
+    if ((ivPtr == NULL) || (ivPtr->flags & ITCL_STATE_IGNORED_VARS)) {
+	Tcl_AppendResult(interp, "\"", Tcl_GetString(objv[2]),
+		"\" is not an instance variable of class \"",
+		Tcl_GetString(iclsPtr->fullNamePtr), "\"", NULL);
+	return TCL_ERROR;
+    }
+    *iclsPtrPtr = iclsPtr;
+    *ivPtrPtr = ivPtr;
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ColumnIncludes()
+ *
+ *  Returns 1 if an object is a live instance of a class, or with isa,
+ *  of a class derived from it, and 0 otherwise.
+ * ------------------------------------------------------------------------
+ */
+static int
+ColumnIncludes(
+    ItclObject *ioPtr,       /* object */
+    ItclClass *iclsPtr,      /* class */
+    int isa)                 /* non-zero to include derived classes */
+{
+    if (ioPtr->flags & (ITCL_OBJECT_IS_DELETED|ITCL_OBJECT_IS_DESTRUCTED|
+	    ITCL_OBJECT_IS_DESTROYED|ITCL_OBJECT_HIDDEN)) {
+	return 0;
+    }
+    return isa ? Itcl_ObjectIsa(ioPtr, iclsPtr) : (ioPtr->iclsPtr == iclsPtr);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_ColumnGetCmd()
+ *
+ *  Returns the values of an instance variable for all instances of a
+ *  class.  Handles the following syntax:
+ *
+ *    itcl::column get <className> <varName> ?-isa? ?-objects?
+ *
+ *  Scans the table of all objects once, without looking up their
+ *  access commands.  Returns a list with one value per instance, empty
+ *  if the variable has no value, or with -objects, a dictionary
+ *  mapping the fully qualified names of the instances to the values,
+ *  without the variables which have no value.
+ *
+ *  Returns TCL_OK/TCL_ERROR to indicate success/failure.
+ * ------------------------------------------------------------------------
+ */
+int
+Itcl_ColumnGetCmd(
+    void *clientData,        /* infoPtr */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)clientData;
+    ItclObject *ioPtr;
+    ItclClass *iclsPtr;
+    ItclVariable *ivPtr;
+    Tcl_HashEntry *entryPtr;
+    Tcl_Obj *resultPtr;
+    Tcl_Obj *valuePtr;
+    Tcl_Obj *namePtr;
+    Var *varPtr;
+    int isa;
+    int objects;
+    FOREACH_HASH_DECLS;
+
+    ItclShowArgs(1, "Itcl_ColumnGetCmd", objc, objv);
+    if (objc < 3) {
+	Tcl_WrongNumArgs(interp, 1, objv,
+		"className varName ?-isa? ?-objects?");
+	return TCL_ERROR;
+    }
+    if (ColumnParseArgs(interp, objc, objv, 3, &iclsPtr, &ivPtr, &isa,
+	    &objects) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    resultPtr = Tcl_NewListObj(0, NULL);
+    FOREACH_HASH_VALUE(ioPtr, &infoPtr->objects) {
+	if (!ColumnIncludes(ioPtr, iclsPtr, isa)) {
+	    continue;
+	}
+	valuePtr = NULL;
+	entryPtr = Tcl_FindHashEntry(&ioPtr->objectVariables, (char *)ivPtr);
+	if (entryPtr != NULL) {
+	    varPtr = (Var *)Tcl_GetHashValue(entryPtr);
+	    if (!TclIsVarUndefined(varPtr) && !TclIsVarArray(varPtr)) {
+		valuePtr = TclPtrGetVar(interp, (Tcl_Var)varPtr, NULL,
+			ivPtr->namePtr, NULL, TCL_LEAVE_ERR_MSG);
+		if (valuePtr == NULL) {
+		    Tcl_DecrRefCount(resultPtr);
+		    return TCL_ERROR;
+		}
+	    }
+	}
+	if (!objects) {
+	    Tcl_ListObjAppendElement(NULL, resultPtr,
+		    (valuePtr != NULL) ? valuePtr : Tcl_NewObj());
+	} else if (valuePtr != NULL) {
+	    namePtr = Tcl_NewObj();
+	    Tcl_GetCommandFullName(interp, ioPtr->accessCmd, namePtr);
+	    Tcl_ListObjAppendElement(NULL, resultPtr, namePtr);
+	    Tcl_ListObjAppendElement(NULL, resultPtr, valuePtr);
+	}
+    }
+    Tcl_SetObjResult(interp, resultPtr);
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_ColumnSetCmd()
+ *
+ *  Sets an instance variable for many instances of a class.  Handles
+ *  the following syntax:
+ *
+ *    itcl::column set <className> <varName> <values> ?-isa? ?-objects?
+ *
+ *  <values> is a list with one value per instance, in the order of
+ *  "itcl::column get", or with -objects, a dictionary mapping instances
+ *  to their values.  The order is the one of the table of all objects,
+ *  which changes when objects are created or deleted, so only the
+ *  dictionary form is stable across such changes.  Either all values are set, or none, as by
+ *  StateAssignVars().
+ *
+ *  Returns TCL_OK/TCL_ERROR to indicate success/failure.
+ * ------------------------------------------------------------------------
+ */
+int
+Itcl_ColumnSetCmd(
+    void *clientData,        /* infoPtr */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)clientData;
+    ItclObject *ioPtr;
+    ItclClass *iclsPtr;
+    ItclVariable *ivPtr;
+    ItclVariable **ivPtrs;
+    Tcl_HashEntry *entryPtr;
+    Tcl_DictSearch dictSearch;
+    Tcl_Obj *keyPtr;
+    Tcl_Obj *valuePtr;
+    Tcl_Obj **valuePtrs;
+    Tcl_Var *varPtrs;
+    Tcl_Size numValues;
+    Tcl_Size numVars = 0;
+    int isa;
+    int objects;
+    int done;
+    int result = TCL_OK;
+    FOREACH_HASH_DECLS;
+
+    ItclShowArgs(1, "Itcl_ColumnSetCmd", objc, objv);
+    if (objc < 4) {
+	Tcl_WrongNumArgs(interp, 1, objv,
+		"className varName values ?-isa? ?-objects?");
+	return TCL_ERROR;
+    }
+    if (ColumnParseArgs(interp, objc, objv, 4, &iclsPtr, &ivPtr, &isa,
+	    &objects) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (objects) {
+	if (Tcl_DictObjSize(interp, objv[3], &numValues) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+    } else if (Tcl_ListObjGetElements(interp, objv[3], &numValues,
+	    &valuePtrs) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (objects && (numValues == 0)) {
+	return TCL_OK;
+    }
+
+    /*
+     *  An empty list of values is still checked against the number of
+     *  instances below.
+     */
+    ivPtrs = (ItclVariable **)ckalloc((numValues + 1)
+	    * (sizeof(ItclVariable *) + sizeof(Tcl_Var)));
+    varPtrs = (Tcl_Var *)(ivPtrs + numValues);
+
+    /*
+     *  Find all variables before anything is set.
+     */
+    if (objects) {
+	valuePtrs = (Tcl_Obj **)ckalloc(numValues * sizeof(Tcl_Obj *));
+	Tcl_DictObjFirst(NULL, objv[3], &dictSearch, &keyPtr, &valuePtr, &done);
+	for ( ; !done; numVars++) {
+	    ioPtr = NULL;
+	    if (Itcl_FindObject(interp, Tcl_GetString(keyPtr), &ioPtr)
+		    != TCL_OK) {
+		result = TCL_ERROR;
+		break;
+	    }
+	    entryPtr = ((ioPtr == NULL) || !ColumnIncludes(ioPtr, iclsPtr, isa))
+		    ? NULL : Tcl_FindHashEntry(&ioPtr->objectVariables,
+		    (char *)ivPtr);
+	    if (entryPtr == NULL) {
+		Tcl_AppendResult(interp, "object \"", Tcl_GetString(keyPtr),
+			"\" is not an instance of class \"",
+			Tcl_GetString(iclsPtr->fullNamePtr), "\"", NULL);
+		result = TCL_ERROR;
+		break;
+	    }
+	    ivPtrs[numVars] = ivPtr;
+	    varPtrs[numVars] = (Tcl_Var)Tcl_GetHashValue(entryPtr);
+	    valuePtrs[numVars] = valuePtr;
+	    Tcl_DictObjNext(&dictSearch, &keyPtr, &valuePtr, &done);
+	}
+	Tcl_DictObjDone(&dictSearch);
+    } else {
+	FOREACH_HASH_VALUE(ioPtr, &infoPtr->objects) {
+	    if (!ColumnIncludes(ioPtr, iclsPtr, isa)) {
+		continue;
+	    }
+	    entryPtr = Tcl_FindHashEntry(&ioPtr->objectVariables,
+		    (char *)ivPtr);
+	    if (entryPtr == NULL) {
+		continue;
+	    }
+	    if (numVars < numValues) {
+		ivPtrs[numVars] = ivPtr;
+		varPtrs[numVars] = (Tcl_Var)Tcl_GetHashValue(entryPtr);
+	    }
+	    numVars++;
+	}
+	if (numVars != numValues) {
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "expected %" TCL_LL_MODIFIER "d values but got %"
+		    TCL_LL_MODIFIER "d", (Tcl_WideInt)numVars,
+		    (Tcl_WideInt)numValues));
+	    result = TCL_ERROR;
+	}
+    }
+
+    if (result == TCL_OK) {
+	result = StateAssignVars(interp, numVars, ivPtrs, varPtrs, valuePtrs);
+    }
+    if (objects) {
+	ckfree(valuePtrs);
+    }
+    ckfree(ivPtrs);
+    return result;
+}
@@ -0,0 +1,469 @@
+/*
+ * itclCxx.h --
+ *
+ *	This file contains an optional, header-only C++ binding for
+ *	Itcl_RegisterObjC().  It registers typed C++ functions as the
+ *	implementation of [incr Tcl] methods and procs:
+ *
+ *	    static double Area(ItclObject *self, int width, double height);
+ *
+ *	    itcl::RegisterFunction(interp, "Shape_area", Area);
+ *
+ *	    itcl::class Shape {
+ *		method area {width height} @Shape_area
+ *	    }
+ *
+ *	Templates generate the argument count check, the conversion of
+ *	each argument from its Tcl_Obj and the conversion of the result at
+ *	compile time.  Parameters of type Tcl_Interp *, ItclObject * and
+ *	ItclClass * take no argument; they receive the interpreter, the
+ *	object and the class of the call.  Other types are converted by
+ *	itcl::ArgTraits, which applications may specialize for their own
+ *	types.  A C++ exception thrown by the function becomes a Tcl error.
+ *
+ *	Data members are read and written with itcl::Variable, a typed
+ *	wrapper around the handles of Itcl_LookupMemberVar().
+ *
+ *	The header needs C++11.  It is not used by [incr Tcl] itself.
+ *
+ * See the file "license.terms" for information on usage and redistribution of
+ * this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ */
+
+#ifndef ITCLCXX_H_INCLUDED
+#define ITCLCXX_H_INCLUDED
+
+#ifndef __cplusplus
+#   error "itclCxx.h needs a C++ compiler"
+#endif
+
+#include "itclInt.h"
+
+#include <cstddef>
+#include <exception>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+namespace itcl {
+
+/*
+ * ------------------------------------------------------------------------
+ *  CallInfo
+ *
+ *  What a function knows about its call, besides its arguments.  The
+ *  object is NULL for procs.
+ * ------------------------------------------------------------------------
+ */
+struct CallInfo {
+    Tcl_Interp *interp;
+    ItclObject *ioPtr;
+    ItclClass *iclsPtr;
+};
+
+/*
+ * ------------------------------------------------------------------------
+ *  ArgTraits<T>
+ *
+ *  Converts values of type T from and to Tcl objects.  Each
+ *  specialization has:
+ *
+ *    words         number of command arguments consumed, 0 or 1
+ *    Usage()       name of the argument in "wrong # args" messages
+ *    Get()         stores the value of the argument objPtr, or of the
+ *                  call information if words is 0, in value and returns
+ *                  TCL_OK, or TCL_ERROR with an error message
+ *    NewObj()      returns a new Tcl object for a result of type T
+ *
+ *  A type which only appears as a result needs no Get(), and one which
+ *  only appears as a parameter needs no NewObj().
+ * ------------------------------------------------------------------------
+ */
+template <typename T, typename Enable = void>
+struct ArgTraits;
+
+template <>
+struct ArgTraits<int> {
+    static const int words = 1;
+    static const char *Usage() { return "int"; }
+    static int Get(const CallInfo &info, Tcl_Obj *objPtr, int &value) {
+	return Tcl_GetIntFromObj(info.interp, objPtr, &value);
+    }
+    static Tcl_Obj *NewObj(int value) { return Tcl_NewIntObj(value); }
+};
+
+#ifndef TCL_WIDE_INT_IS_LONG
+template <>
+struct ArgTraits<long> {
+    static const int words = 1;
+    static const char *Usage() { return "int"; }
+    static int Get(const CallInfo &info, Tcl_Obj *objPtr, long &value) {
+	return Tcl_GetLongFromObj(info.interp, objPtr, &value);
+    }
+    static Tcl_Obj *NewObj(long value) { return Tcl_NewLongObj(value); }
+};
+#endif
+
+template <>
+struct ArgTraits<Tcl_WideInt> {
+    static const int words = 1;
+    static const char *Usage() { return "int"; }
+    static int Get(const CallInfo &info, Tcl_Obj *objPtr,
+	    Tcl_WideInt &value) {
+	return Tcl_GetWideIntFromObj(info.interp, objPtr, &value);
+    }
+    static Tcl_Obj *NewObj(Tcl_WideInt value) {
+	return Tcl_NewWideIntObj(value);
+    }
+};
+
+template <>
+struct ArgTraits<double> {
+    static const int words = 1;
+    static const char *Usage() { return "double"; }
+    static int Get(const CallInfo &info, Tcl_Obj *objPtr, double &value) {
+	return Tcl_GetDoubleFromObj(info.interp, objPtr, &value);
+    }
+    static Tcl_Obj *NewObj(double value) { return Tcl_NewDoubleObj(value); }
+};
+
+template <>
+struct ArgTraits<bool> {
+    static const int words = 1;
+    static const char *Usage() { return "boolean"; }
+    static int Get(const CallInfo &info, Tcl_Obj *objPtr, bool &value) {
+	int b;
+
+	if (Tcl_GetBooleanFromObj(info.interp, objPtr, &b) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	value = (b != 0);
+	return TCL_OK;
+    }
+    static Tcl_Obj *NewObj(bool value) { return Tcl_NewBooleanObj(value); }
+};
+
+/*
+ *  Strings are passed without copying for const char *, which stays
+ *  valid during the call only.
+ */
+template <>
+struct ArgTraits<const char *> {
+    static const int words = 1;
+    static const char *Usage() { return "string"; }
+    static int Get(const CallInfo &, Tcl_Obj *objPtr, const char *&value) {
+	value = Tcl_GetString(objPtr);
+	return TCL_OK;
+    }
+    static Tcl_Obj *NewObj(const char *value) {
+	return Tcl_NewStringObj(value, TCL_INDEX_NONE);
+    }
+};
+
+template <>
+struct ArgTraits<std::string> {
+    static const int words = 1;
+    static const char *Usage() { return "string"; }
+    static int Get(const CallInfo &, Tcl_Obj *objPtr, std::string &value) {
+	Tcl_Size length;
+	const char *bytes = Tcl_GetStringFromObj(objPtr, &length);
+
+	value.assign(bytes, length);
+	return TCL_OK;
+    }
+    static Tcl_Obj *NewObj(const std::string &value) {
+	return Tcl_NewStringObj(value.data(), (Tcl_Size)value.size());
+    }
+};
+
+/*
+ *  Tcl objects are passed as they are.  A result object may be new or
+ *  shared; it becomes the result of the interpreter.
+ */
+template <>
+struct ArgTraits<Tcl_Obj *> {
+    static const int words = 1;
+    static const char *Usage() { return "value"; }
+    static int Get(const CallInfo &, Tcl_Obj *objPtr, Tcl_Obj *&value) {
+	value = objPtr;
+	return TCL_OK;
+    }
+    static Tcl_Obj *NewObj(Tcl_Obj *value) {
+	return (value != NULL) ? value : Tcl_NewObj();
+    }
+};
+
+/*
+ *  Parameters which receive the context of the call.  An ItclObject *
+ *  parameter makes the function a method: calling it without an
+ *  object is an error.
+ */
+template <>
+struct ArgTraits<Tcl_Interp *> {
+    static const int words = 0;
+    static const char *Usage() { return NULL; }
+    static int Get(const CallInfo &info, Tcl_Obj *, Tcl_Interp *&value) {
+	value = info.interp;
+	return TCL_OK;
+    }
+};
+
+template <>
+struct ArgTraits<ItclObject *> {
+    static const int words = 0;
+    static const char *Usage() { return NULL; }
+    static int Get(const CallInfo &info, Tcl_Obj *, ItclObject *&value) {
+	if (info.ioPtr == NULL) {
+	    Tcl_AppendResult(info.interp, "cannot access object-specific ",
+		    "info without an object context", NULL);
+	    return TCL_ERROR;
+	}
+	value = info.ioPtr;
+	return TCL_OK;
+    }
+};
+
+template <>
+struct ArgTraits<ItclClass *> {
+    static const int words = 0;
+    static const char *Usage() { return NULL; }
+    static int Get(const CallInfo &info, Tcl_Obj *, ItclClass *&value) {
+	value = info.iclsPtr;
+	return TCL_OK;
+    }
+};
+
+/*
+ * ------------------------------------------------------------------------
+ *  Variable<T>
+ *
+ *  A data member of type T, looked up once with Lookup() and then read
+ *  and written on any object of the class with Get() and Set(), which
+ *  return TCL_OK or TCL_ERROR with an error message in the interpreter.
+ * ------------------------------------------------------------------------
+ */
+template <typename T>
+class Variable {
+public:
+    Variable() : ivPtr(NULL) {}
+
+    int Lookup(Tcl_Interp *interp, ItclClass *iclsPtr, const char *name) {
+	ivPtr = Itcl_LookupMemberVar(interp, iclsPtr, name);
+	return (ivPtr != NULL) ? TCL_OK : TCL_ERROR;
+    }
+    int Get(Tcl_Interp *interp, ItclObject *ioPtr, T &value) const {
+	CallInfo info = { interp, ioPtr, NULL };
+	Tcl_Obj *objPtr = Itcl_GetVarByHandle(interp, ioPtr, ivPtr);
+
+	if (objPtr == NULL) {
+	    return TCL_ERROR;
+	}
+	return ArgTraits<T>::Get(info, objPtr, value);
+    }
+    int Set(Tcl_Interp *interp, ItclObject *ioPtr, const T &value) const {
+	Tcl_Obj *objPtr = ArgTraits<T>::NewObj(value);
+	Tcl_Obj *resultPtr;
+
+	Tcl_IncrRefCount(objPtr);
+	resultPtr = Itcl_SetVarByHandle(interp, ioPtr, ivPtr, objPtr);
+	Tcl_DecrRefCount(objPtr);
+	return (resultPtr != NULL) ? TCL_OK : TCL_ERROR;
+    }
+    ItclVariable *Handle() const { return ivPtr; }
+
+private:
+    ItclVariable *ivPtr;
+};
+
+namespace detail {
+
+template <std::size_t... I>
+struct Indices {};
+
+template <std::size_t N, std::size_t... I>
+struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+
+template <std::size_t... I>
+struct MakeIndices<0, I...> {
+    typedef Indices<I...> type;
+};
+
+template <typename T>
+struct Traits : ArgTraits<typename std::decay<T>::type> {};
+
+/*
+ *  Words<A...>::value is the number of command arguments taken by the
+ *  parameters A, and Offset<I, A...>::value the index of the argument
+ *  of parameter I.
+ */
+template <typename... A>
+struct Words {
+    static const int value = 0;
+};
+
+template <typename A0, typename... A>
+struct Words<A0, A...> {
+    static const int value = Traits<A0>::words + Words<A...>::value;
+};
+
+template <std::size_t I, typename... A>
+struct Offset;
+
+template <typename A0, typename... A>
+struct Offset<0, A0, A...> {
+    static const int value = 0;
+};
+
+template <std::size_t I, typename A0, typename... A>
+struct Offset<I, A0, A...> {
+    static const int value = Traits<A0>::words + Offset<I - 1, A...>::value;
+};
+
+/*
+ *  Calls the function and converts its result, if any.
+ */
+template <typename R>
+struct Result {
+    template <typename F, typename Tuple, std::size_t... I>
+    static void Call(Tcl_Interp *interp, F fn, Tuple &args, Indices<I...>) {
+	Tcl_SetObjResult(interp, Traits<R>::NewObj(fn(std::get<I>(args)...)));
+    }
+};
+
+template <>
+struct Result<void> {
+    template <typename F, typename Tuple, std::size_t... I>
+    static void Call(Tcl_Interp *, F fn, Tuple &args, Indices<I...>) {
+	fn(std::get<I>(args)...);
+    }
+};
+
+template <typename R, typename... A>
+class Binding {
+public:
+    typedef R (*Function)(A...);
+
+    Binding(Function fn, const char *usage) : fn(fn) {
+	if (usage != NULL) {
+	    this->usage = usage;
+	} else {
+	    const char *words[] = { Traits<A>::Usage()..., NULL };
+	    std::size_t i;
+
+	    for (i = 0; i < sizeof...(A); i++) {
+		if (words[i] != NULL) {
+		    if (!this->usage.empty()) {
+			this->usage += ' ';
+		    }
+		    this->usage += words[i];
+		}
+	    }
+	}
+    }
+
+    static int Invoke(void *clientData, Tcl_Interp *interp, int objc,
+	    Tcl_Obj *const objv[]) {
+	Binding *bindingPtr = static_cast<Binding *>(clientData);
+	typedef typename MakeIndices<sizeof...(A)>::type Params;
+
+	if (objc != Words<A...>::value + 1) {
+	    Tcl_WrongNumArgs(interp, 1, objv, bindingPtr->usage.c_str());
+	    return TCL_ERROR;
+	}
+	return bindingPtr->Call(interp, objv, Params());
+    }
+
+    static void Free(void *clientData) {
+	delete static_cast<Binding *>(clientData);
+    }
+
+private:
+    template <std::size_t... I>
+    int Call(Tcl_Interp *interp, Tcl_Obj *const objv[], Indices<I...> params) {
+	CallInfo info = { interp, NULL, NULL };
+	std::tuple<typename std::decay<A>::type...> args;
+	int ok = 1;
+
+	/*
+	 *  The object context is only looked up if it is used.  Methods
+	 *  implemented in C run in the class which defines them.
+	 */
+	if (NeedsContext<A...>::value) {
+	    Itcl_GetContext(interp, &info.iclsPtr, &info.ioPtr);
+	    Tcl_ResetResult(interp);
+	}
+
+	/*
+	 *  Converts the arguments from left to right and stops at the first
+	 *  error, whose message is left in the interpreter.
+	 */
+	int dummy[] = { 0, (ok = ok && (Traits<A>::Get(info,
+		Traits<A>::words ? objv[1 + Offset<I, A...>::value] : NULL,
+		std::get<I>(args)) == TCL_OK))... };
+	(void)dummy;
+	if (!ok) {
+	    return TCL_ERROR;
+	}
+	try {
+	    Result<R>::Call(interp, fn, args, params);
+	} catch (const std::exception &e) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(e.what(), TCL_INDEX_NONE));
+	    return TCL_ERROR;
+	} catch (...) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj("unknown C++ exception",
+		    TCL_INDEX_NONE));
+	    return TCL_ERROR;
+	}
+	return TCL_OK;
+    }
+
+    template <typename... T>
+    struct NeedsContext : std::false_type {};
+
+    template <typename T0, typename... T>
+    struct NeedsContext<T0, T...> : std::integral_constant<bool,
+	    std::is_same<typename std::decay<T0>::type, ItclObject *>::value
+	    || std::is_same<typename std::decay<T0>::type, ItclClass *>::value
+	    || NeedsContext<T...>::value> {};
+
+    Function fn;
+    std::string usage;
+};
+
+} /* namespace detail */
+
+/*
+ * ------------------------------------------------------------------------
+ *  RegisterFunction()
+ *
+ *  Registers fn with Itcl_RegisterObjC() under the symbolic name, which
+ *  class definitions refer to as "@name".  The usage is the list of
+ *  arguments in "wrong # args" messages; by default, it is made of the
+ *  types of the parameters.
+ *
+ *  Returns TCL_OK on success, or TCL_ERROR (along with an error message
+ *  in the interpreter) if the name is already used by another handler.
+ * ------------------------------------------------------------------------
+ */
+template <typename R, typename... A>
+int
+RegisterFunction(
+    Tcl_Interp *interp,
+    const char *name,
+    R (*fn)(A...),
+    const char *usage = NULL)
+{
+    typedef detail::Binding<R, A...> Binding;
+    Binding *bindingPtr = new Binding(fn, usage);
+
+    if (Itcl_RegisterObjC(interp, name, Binding::Invoke, bindingPtr,
+	    Binding::Free) != TCL_OK) {
+	delete bindingPtr;
+	return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+} /* namespace itcl */
+
+#endif /* ITCLCXX_H_INCLUDED */
@@ -19,7 +19,7 @@ ITCLAPI const char *Itcl_InitStubs(
 /* !BEGIN!: Do not edit below this line. */
 
 #define ITCL_STUBS_EPOCH 0
-#define ITCL_STUBS_REVISION 152
+#define ITCL_STUBS_REVISION 162
 
 #ifdef __cplusplus
 extern "C" {
@@ -91,6 +91,15 @@ ITCLAPI void		Itcl_DiscardInterpState(Itcl_InterpState state);
 ITCLAPI void *		Itcl_Alloc(size_t size);
 /* 27 */
 ITCLAPI void		Itcl_Free(void *ptr);
+/* 28 */
+ITCLAPI int		Itcl_AddEventHook(Tcl_Interp *interp, int mask,
+				Itcl_EventHookProc *proc, void *clientData);
+/* 29 */
+ITCLAPI void		Itcl_RemoveEventHook(Tcl_Interp *interp,
+				Itcl_EventHookProc *proc, void *clientData);
+/* 30 */
+ITCLAPI int		Itcl_DefineClass(Tcl_Interp *interp,
+				const Itcl_ClassSpec *specPtr);
 
 typedef struct {
     const struct ItclIntStubs *itclIntStubs;
@@ -130,6 +139,9 @@ typedef struct ItclStubs {
     void (*itcl_DiscardInterpState) (Itcl_InterpState state); /* 25 */
     void * (*itcl_Alloc) (size_t size); /* 26 */
     void (*itcl_Free) (void *ptr); /* 27 */
+    int (*itcl_AddEventHook) (Tcl_Interp *interp, int mask, Itcl_EventHookProc *proc, void *clientData); /* 28 */
+    void (*itcl_RemoveEventHook) (Tcl_Interp *interp, Itcl_EventHookProc *proc, void *clientData); /* 29 */
+    int (*itcl_DefineClass) (Tcl_Interp *interp, const Itcl_ClassSpec *specPtr); /* 30 */
 } ItclStubs;
 
 extern const ItclStubs *itclStubsPtr;
@@ -198,6 +210,12 @@ extern const ItclStubs *itclStubsPtr;
 	(itclStubsPtr->itcl_Alloc) /* 26 */
 #define Itcl_Free \
 	(itclStubsPtr->itcl_Free) /* 27 */
+#define Itcl_AddEventHook \
+	(itclStubsPtr->itcl_AddEventHook) /* 28 */
+#define Itcl_RemoveEventHook \
+	(itclStubsPtr->itcl_RemoveEventHook) /* 29 */
+#define Itcl_DefineClass \
+	(itclStubsPtr->itcl_DefineClass) /* 30 */
 
 #endif /* defined(USE_ITCL_STUBS) */
 
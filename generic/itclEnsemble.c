@@ -116,6 +116,8 @@ static void DeleteEnsemble(void *clientData);
 static int FindEnsemblePartIndex (Ensemble *ensData,
     const char *partName, int *posPtr);
 static void ComputeMinChars (Ensemble *ensData, int pos);
+static int UpdateEnsembleMap (Tcl_Interp *interp, Tcl_Command cmd,
+    Tcl_Obj *mapDict);
 static EnsembleParser* GetEnsembleParser (Tcl_Interp *interp);
 static void DeleteEnsParser (void *clientData, Tcl_Interp* interp);
 
@@ -705,6 +707,12 @@ GetEnsemblePartUsage(
     if (ensPart->usage && *ensPart->usage != '\0') {
         Tcl_DStringAppend(&buffer, " ", 1);
         Tcl_DStringAppend(&buffer, ensPart->usage, TCL_INDEX_NONE);
+    } else if ((ensPart->arglistPtr != NULL)
+	    && (ensPart->arglistPtr->numArgs > 0)) {
+        Tcl_DStringAppend(&buffer, " ", 1);
+        Tcl_DStringAppend(&buffer,
+		Tcl_GetString(ItclArgListUsage(ensPart->arglistPtr)),
+		TCL_INDEX_NONE);
     } else {
 
         /*
@@ -875,7 +883,7 @@ CreateEnsemble(
     }
     toObjPtr = Tcl_NewStringObj(Tcl_DStringValue(&buffer), TCL_INDEX_NONE);
     Tcl_DictObjPut(NULL, mapDict, ensData->namePtr, toObjPtr);
-    Tcl_SetEnsembleMappingDict(NULL, parentEnsData->cmdPtr, mapDict);
+    UpdateEnsembleMap(NULL, parentEnsData->cmdPtr, mapDict);
     ensData->cmdPtr = ensPart->cmdPtr;
     ensData->parent = ensPart;
     result = TCL_OK;
@@ -966,7 +974,7 @@ AddEnsemblePart(
         Tcl_DecrRefCount(ensPart->mapNamePtr);
         return TCL_ERROR;
     }
-    Tcl_SetEnsembleMappingDict(interp, ensData->cmdPtr, mapDict);
+    UpdateEnsembleMap(interp, ensData->cmdPtr, mapDict);
     *rVal = ensPart;
     return TCL_OK;
 }
@@ -1162,7 +1170,6 @@ CreateEnsemblePart(
     const char* partName,        /* name of the new part */
     EnsemblePart **ensPartPtr)   /* returns: new ensemble part */
 {
-    int i;
     int pos;
     int size;
     EnsemblePart** partList;
@@ -1193,9 +1200,8 @@ CreateEnsemblePart(
         ensData->maxParts *= 2;
     }
 
-    for (i=ensData->numParts; i > pos; i--) {
-        ensData->parts[i] = ensData->parts[i-1];
-    }
+    memmove(ensData->parts+pos+1, ensData->parts+pos,
+            (size_t)(ensData->numParts-pos)*sizeof(EnsemblePart*));
     ensData->numParts++;
 
     ensPart = (EnsemblePart*)ckalloc(sizeof(EnsemblePart));
@@ -1290,7 +1296,7 @@ DeleteEnsemblePart(
             if (mapDict != NULL) {
 	        Tcl_DictObjRemove(ensPart->interp, mapDict,
 	                ensPart->namePtr);
-	        Tcl_SetEnsembleMappingDict(NULL, ensData2->cmdPtr, mapDict);
+	        UpdateEnsembleMap(NULL, ensData2->cmdPtr, mapDict);
 	    }
 	}
 	Tcl_DecrRefCount(ensPart->subEnsemblePtr);
@@ -1320,7 +1326,7 @@ DeleteEnsemblePart(
         if (mapDict != NULL) {
 	    if (!Tcl_IsShared(mapDict)) {
 	        Tcl_DictObjRemove(ensPart->interp, mapDict, ensPart->namePtr);
-                Tcl_SetEnsembleMappingDict(ensPart->interp, ensData->cmdPtr,
+                UpdateEnsembleMap(ensPart->interp, ensData->cmdPtr,
 	                mapDict);
             }
         }
@@ -1333,6 +1339,7 @@ DeleteEnsemblePart(
     if (ensPart->usage != NULL) {
         ckfree(ensPart->usage);
     }
+    ItclReleaseArgList(ensPart->arglistPtr);
     ckfree(ensPart->name);
     ckfree((char*)ensPart);
 }
@@ -1596,6 +1603,47 @@ ComputeMinChars(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * UpdateEnsembleMap --
+ *
+ *      Installs mapDict as the mapping dict of the ensemble command
+ *      cmd after a part was added or removed.  If it is the dict the
+ *      ensemble already uses, changed in place, Tcl only has to be
+ *      told to rebuild its table of subcommands on the next call:
+ *      Tcl_SetEnsembleMappingDict would check every entry of the dict
+ *      again, which makes adding or removing n parts O(n**2).
+ *
+ * Results:
+ *      Returns TCL_OK if successful, and TCL_ERROR if anything goes
+ *      wrong.
+ *
+ * Side effects:
+ *      None.
+ *
+ *----------------------------------------------------------------------
+ */
+static int
+UpdateEnsembleMap(
+    Tcl_Interp *interp,      /* interpreter containing the ensemble */
+    Tcl_Command cmd,         /* ensemble command */
+    Tcl_Obj *mapDict)        /* new mapping dict */
+{
+    Tcl_Obj *oldDict = NULL;
+    int flags;
+
+    Tcl_GetEnsembleMappingDict(NULL, cmd, &oldDict);
+    if ((oldDict != NULL) && (oldDict == mapDict)
+            && (Tcl_GetEnsembleFlags(NULL, cmd, &flags) == TCL_OK)) {
+        /*
+         * Setting the flags invalidates the subcommand table.
+         */
+        return Tcl_SetEnsembleFlags(interp, cmd, flags);
+    }
+    return Tcl_SetEnsembleMappingDict(interp, cmd, mapDict);
+}
+
 
 /*
  *----------------------------------------------------------------------
@@ -1926,17 +1974,13 @@ Itcl_EnsPartCmd(
     int objc,                /* number of arguments */
     Tcl_Obj *const objv[])   /* argument objects */
 {
-    Tcl_Obj *usagePtr;
     Tcl_Proc procPtr;
     EnsembleParser *ensInfo = (EnsembleParser*)clientData;
     Ensemble *ensData = (Ensemble*)ensInfo->ensData;
     EnsemblePart *ensPart;
     ItclArgList *arglistPtr;
     char *partName;
-    char *usage;
     int result;
-    Tcl_Size argc;
-    Tcl_Size maxArgc;
     Tcl_CmdInfo cmdInfo;
 
     ItclShowArgs(1, "Itcl_EnsPartCmd", objc, objv);
@@ -1957,10 +2001,9 @@ Itcl_EnsPartCmd(
      */
     partName = Tcl_GetString(objv[1]);
 
-    if (ItclCreateArgList(interp, Tcl_GetString(objv[2]), &argc, &maxArgc,
-            &usagePtr, &arglistPtr, NULL, partName) != TCL_OK) {
-	result = TCL_ERROR;
-	goto errorOut;
+    if (ItclCreateArgList(interp, Tcl_GetString(objv[2]), &arglistPtr,
+	    partName) != TCL_OK) {
+	return TCL_ERROR;
     }
     if (Tcl_GetCommandInfoFromToken(ensData->cmdPtr, &cmdInfo) != 1) {
 	result = TCL_ERROR;
@@ -1973,25 +2016,27 @@ Itcl_EnsPartCmd(
 	goto errorOut;
     }
 
-    usage = Tcl_GetString(usagePtr);
-
     /*
      *  Create a new part within the ensemble.  If successful,
      *  plug the command token into the proc; we'll need it later
      *  if we try to compile the Tcl code for the part.  If
-     *  anything goes wrong, clean up before bailing out.
+     *  anything goes wrong, clean up before bailing out.  The
+     *  part keeps the argument list, its usage string is only
+     *  built for error messages.
      */
-    result = AddEnsemblePart(ensInfo->interp, ensData, partName, usage,
+    result = AddEnsemblePart(ensInfo->interp, ensData, partName, NULL,
         Tcl_GetObjInterpProc(), procPtr, _Tcl_ProcDeleteProc,
         ITCL_ENSEMBLE_ENSEMBLE, &ensPart);
     if (result == TCL_ERROR) {
 	_Tcl_ProcDeleteProc(procPtr);
+    } else {
+	ensPart->arglistPtr = arglistPtr;
+	arglistPtr = NULL;
     }
     Tcl_TransferResult(ensInfo->interp, result, interp);
 
 errorOut:
-    Tcl_DecrRefCount(usagePtr);
-    ItclDeleteArgList(arglistPtr);
+    ItclReleaseArgList(arglistPtr);
     return result;
 }
 
@@ -12,7 +12,6 @@
 
 #include "itclInt.h"
 
-void ItclDeleteArgList(ItclArgList *arglistPtr);
 #ifdef ITCL_DEBUG
 int _itcl_debug_level = 0;
 
@@ -70,6 +69,14 @@ Itcl_ProtectionStr(
 /*
  * ------------------------------------------------------------------------
  *  ItclCreateArgList()
+ *
+ *  Parses the argument list "str" of a method, proc or ensemble part.
+ *  Argument lists are interned in the interpreter by their string, so
+ *  that all functions with the same arguments share one immutable
+ *  ItclArgList.  Returns a list in "arglistPtrPtr", which the caller
+ *  must release with ItclReleaseArgList(), or NULL if "str" is NULL.
+ *
+ *  Returns TCL_OK/TCL_ERROR to indicate success/failure.
  * ------------------------------------------------------------------------
  */
 
@@ -77,156 +84,242 @@ int
 ItclCreateArgList(
     Tcl_Interp *interp,		/* interpreter managing this function */
     const char *str,		/* string representing argument list */
-    Tcl_Size *argcPtr,		/* number of mandatory arguments */
-    Tcl_Size *maxArgcPtr,		/* number of arguments parsed */
-    Tcl_Obj **usagePtr,         /* store usage message for arguments here */
     ItclArgList **arglistPtrPtr,
     				/* returns pointer to parsed argument list */
-    TCL_UNUSED(ItclMemberFunc *),
-    const char *commandName)
+    const char *commandName)	/* name used in error messages, or NULL */
 {
+    ItclObjectInfo *infoPtr;
+    Tcl_HashEntry *hPtr;
     Tcl_Size argc;
     Tcl_Size defaultArgc;
     const char **argv;
     const char **defaultArgv;
     ItclArgList *arglistPtr;
-    ItclArgList *lastArglistPtr;
+    ItclArg *argPtr;
     Tcl_Size i;
-    int hadArgsArgument;
+    int isNew;
     int result;
 
     *arglistPtrPtr = NULL;
-    lastArglistPtr = NULL;
-    argc = 0;
-    hadArgsArgument = 0;
+    if (str == NULL) {
+        return TCL_OK;
+    }
+    infoPtr = (ItclObjectInfo *)Tcl_GetAssocData(interp,
+            ITCL_INTERP_DATA, NULL);
+    if (infoPtr != NULL) {
+        hPtr = Tcl_FindHashEntry(&infoPtr->argLists, str);
+        if (hPtr != NULL) {
+            arglistPtr = (ItclArgList *)Tcl_GetHashValue(hPtr);
+            arglistPtr->refCount++;
+            *arglistPtrPtr = arglistPtr;
+            return TCL_OK;
+        }
+    }
+
+    if (Tcl_SplitList(interp, str, &argc, &argv) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    arglistPtr = (ItclArgList *)ckalloc(sizeof(ItclArgList)
+            + ((argc > 1) ? argc-1 : 0) * sizeof(ItclArg));
+    memset(arglistPtr, 0, sizeof(ItclArgList));
+    arglistPtr->refCount = 1;
+    arglistPtr->argumentPtr = Tcl_NewStringObj(str, TCL_INDEX_NONE);
+    Tcl_IncrRefCount(arglistPtr->argumentPtr);
     result = TCL_OK;
-    *maxArgcPtr = 0;
-    *argcPtr = 0;
-    *usagePtr = Tcl_NewStringObj("", TCL_INDEX_NONE);
-    if (str) {
-        if (Tcl_SplitList(interp, (const char *)str, &argc, &argv)
-	        != TCL_OK) {
-	    return TCL_ERROR;
-	}
-	i = 0;
-	if (argc == 0) {
-	   /* signal there are 0 arguments */
-            arglistPtr = (ItclArgList *)ckalloc(sizeof(ItclArgList));
-	    memset(arglistPtr, 0, sizeof(ItclArgList));
-	    *arglistPtrPtr = arglistPtr;
-	}
-        while (i < argc) {
-            if (Tcl_SplitList(interp, argv[i], &defaultArgc, &defaultArgv)
-	            != TCL_OK) {
-	        result = TCL_ERROR;
-	        break;
-	    }
-	    arglistPtr = NULL;
-	    if (defaultArgc == 0 || defaultArgv[0][0] == '\0') {
-		if (commandName != NULL) {
-	            Tcl_AppendResult(interp, "procedure \"",
-		            commandName,
-			    "\" has argument with no name", NULL);
-		} else {
-		    char buf[TCL_INTEGER_SPACE];
-		    sprintf(buf, "%" ITCL_Z_MODIFIER "d", i);
-		    Tcl_AppendResult(interp, "argument #", buf,
-		            " has no name", NULL);
-		}
-		ckfree((char *) defaultArgv);
-	        result = TCL_ERROR;
-	        break;
-	    }
-	    if (defaultArgc > 2) {
-	        Tcl_AppendStringsToObj(Tcl_GetObjResult(interp),
-	            "too many fields in argument specifier \"",
-		    argv[i], "\"",
-		    NULL);
-		ckfree((char *) defaultArgv);
-	        result = TCL_ERROR;
-	        break;
-	    }
-	    if (strstr(defaultArgv[0],"::")) {
-	        Tcl_AppendStringsToObj(Tcl_GetObjResult(interp),
-		        "bad argument name \"", defaultArgv[0], "\"",
-			NULL);
-		ckfree((char *) defaultArgv);
-		result = TCL_ERROR;
-		break;
-	    }
-            arglistPtr = (ItclArgList *)ckalloc(sizeof(ItclArgList));
-	    memset(arglistPtr, 0, sizeof(ItclArgList));
-            if (*arglistPtrPtr == NULL) {
-	         *arglistPtrPtr = arglistPtr;
-	    } else {
-	        lastArglistPtr->nextPtr = arglistPtr;
-	        Tcl_AppendToObj(*usagePtr, " ", 1);
-	    }
-	    arglistPtr->namePtr =
-	            Tcl_NewStringObj(defaultArgv[0], TCL_INDEX_NONE);
-	    Tcl_IncrRefCount(arglistPtr->namePtr);
-	    (*maxArgcPtr)++;
-	    if (defaultArgc == 1) {
-		(*argcPtr)++;
-	        arglistPtr->defaultValuePtr = NULL;
-		if ((strcmp(defaultArgv[0], "args") == 0) && (i == argc-1)) {
-		    hadArgsArgument = 1;
-		    (*argcPtr)--;
-	            Tcl_AppendToObj(*usagePtr, "?arg arg ...?", TCL_INDEX_NONE);
-		} else {
-	            Tcl_AppendToObj(*usagePtr, defaultArgv[0], TCL_INDEX_NONE);
-	        }
-	    } else {
-	        arglistPtr->defaultValuePtr =
-		        Tcl_NewStringObj(defaultArgv[1], TCL_INDEX_NONE);
-		Tcl_IncrRefCount(arglistPtr->defaultValuePtr);
-	        Tcl_AppendToObj(*usagePtr, "?", 1);
-	        Tcl_AppendToObj(*usagePtr, defaultArgv[0], TCL_INDEX_NONE);
-	        Tcl_AppendToObj(*usagePtr, "?", 1);
-	    }
-            lastArglistPtr = arglistPtr;
-	    i++;
-	    ckfree((char *) defaultArgv);
+    for (i = 0; i < argc; i++) {
+        if (Tcl_SplitList(interp, argv[i], &defaultArgc, &defaultArgv)
+                != TCL_OK) {
+            result = TCL_ERROR;
+            break;
+        }
+        if (defaultArgc == 0 || defaultArgv[0][0] == '\0') {
+            if (commandName != NULL) {
+                Tcl_AppendResult(interp, "procedure \"",
+                        commandName,
+                        "\" has argument with no name", NULL);
+            } else {
+                char buf[TCL_INTEGER_SPACE];
+                sprintf(buf, "%" ITCL_Z_MODIFIER "d", i);
+                Tcl_AppendResult(interp, "argument #", buf,
+                        " has no name", NULL);
+            }
+            ckfree((char *) defaultArgv);
+            result = TCL_ERROR;
+            break;
         }
-	ckfree((char *) argv);
+        if (defaultArgc > 2) {
+            Tcl_AppendStringsToObj(Tcl_GetObjResult(interp),
+                "too many fields in argument specifier \"",
+                argv[i], "\"",
+                NULL);
+            ckfree((char *) defaultArgv);
+            result = TCL_ERROR;
+            break;
+        }
+        if (strstr(defaultArgv[0],"::")) {
+            Tcl_AppendStringsToObj(Tcl_GetObjResult(interp),
+                    "bad argument name \"", defaultArgv[0], "\"",
+                    NULL);
+            ckfree((char *) defaultArgv);
+            result = TCL_ERROR;
+            break;
+        }
+        argPtr = &arglistPtr->args[i];
+        argPtr->namePtr = Tcl_NewStringObj(defaultArgv[0], TCL_INDEX_NONE);
+        Tcl_IncrRefCount(argPtr->namePtr);
+        argPtr->defaultValuePtr = NULL;
+        arglistPtr->numArgs++;
+        if (defaultArgc == 1) {
+            if ((strcmp(defaultArgv[0], "args") != 0) || (i != argc-1)) {
+                arglistPtr->argcount++;
+            }
+        } else {
+            argPtr->defaultValuePtr =
+                    Tcl_NewStringObj(defaultArgv[1], TCL_INDEX_NONE);
+            Tcl_IncrRefCount(argPtr->defaultValuePtr);
+        }
+        ckfree((char *) defaultArgv);
     }
+    ckfree((char *) argv);
+
     /*
      *  If anything went wrong, destroy whatever arguments were
      *  created and return an error.
      */
     if (result != TCL_OK) {
-        ItclDeleteArgList(*arglistPtrPtr);
-        *arglistPtrPtr = NULL;
+        ItclReleaseArgList(arglistPtr);
+        return TCL_ERROR;
     }
-    if (hadArgsArgument) {
-        *maxArgcPtr = TCL_INDEX_NONE;
+    arglistPtr->maxargcount = arglistPtr->numArgs;
+    if ((argc > 0) && (arglistPtr->args[argc-1].defaultValuePtr == NULL)
+            && (strcmp(Tcl_GetString(arglistPtr->args[argc-1].namePtr),
+            "args") == 0)) {
+        arglistPtr->maxargcount = TCL_INDEX_NONE;
     }
-    return result;
+    if (infoPtr != NULL) {
+        hPtr = Tcl_CreateHashEntry(&infoPtr->argLists, str, &isNew);
+        Tcl_SetHashValue(hPtr, arglistPtr);
+        arglistPtr->hPtr = hPtr;
+        arglistPtr->refCount++;
+    }
+    *arglistPtrPtr = arglistPtr;
+    return TCL_OK;
 }
 
 /*
  * ------------------------------------------------------------------------
- *  ItclDeleteArgList()
+ *  ItclArgListUsage()
+ *
+ *  Returns the usage string of an argument list, like "x ?y? ?arg arg
+ *  ...?".  It is only needed for error messages and introspection, so
+ *  it is built on the first call and then kept with the list.
+ * ------------------------------------------------------------------------
+ */
+
+Tcl_Obj *
+ItclArgListUsage(
+    ItclArgList *arglistPtr)	/* parsed argument list */
+{
+    ItclArg *argPtr;
+    const char *name;
+    Tcl_Size i;
+
+    if (arglistPtr->usagePtr != NULL) {
+        return arglistPtr->usagePtr;
+    }
+    arglistPtr->usagePtr = Tcl_NewObj();
+    Tcl_IncrRefCount(arglistPtr->usagePtr);
+    for (i = 0; i < arglistPtr->numArgs; i++) {
+        argPtr = &arglistPtr->args[i];
+        name = Tcl_GetString(argPtr->namePtr);
+        if (i > 0) {
+            Tcl_AppendToObj(arglistPtr->usagePtr, " ", 1);
+        }
+        if (argPtr->defaultValuePtr != NULL) {
+            Tcl_AppendStringsToObj(arglistPtr->usagePtr, "?", name, "?",
+                    NULL);
+        } else if ((i == arglistPtr->numArgs-1)
+                && (strcmp(name, "args") == 0)) {
+            Tcl_AppendToObj(arglistPtr->usagePtr, "?arg arg ...?",
+                    TCL_INDEX_NONE);
+        } else {
+            Tcl_AppendToObj(arglistPtr->usagePtr, name, TCL_INDEX_NONE);
+        }
+    }
+    return arglistPtr->usagePtr;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclReleaseArgList()
+ *
+ *  Releases an argument list returned by ItclCreateArgList(), and
+ *  frees it if it is no longer used.
  * ------------------------------------------------------------------------
  */
 
 void
-ItclDeleteArgList(
-    ItclArgList *arglistPtr)	/* first argument in arg list chain */
+ItclReleaseArgList(
+    ItclArgList *arglistPtr)	/* parsed argument list, or NULL */
 {
-    ItclArgList *currPtr;
-    ItclArgList *nextPtr;
+    ItclArg *argPtr;
+    Tcl_Size i;
 
-    for (currPtr=arglistPtr; currPtr; currPtr=nextPtr) {
-	if (currPtr->defaultValuePtr != NULL) {
-	    Tcl_DecrRefCount(currPtr->defaultValuePtr);
-	}
-	if (currPtr->namePtr != NULL) {
-	    Tcl_DecrRefCount(currPtr->namePtr);
-	}
-        nextPtr = currPtr->nextPtr;
-        ckfree((char *)currPtr);
+    if (arglistPtr == NULL) {
+        return;
+    }
+    if (arglistPtr->hPtr != NULL) {
+        /*
+         *  The interned list is kept for reuse, while it is used.
+         */
+        if (--arglistPtr->refCount > 1) {
+            return;
+        }
+        Tcl_DeleteHashEntry(arglistPtr->hPtr);
+        arglistPtr->hPtr = NULL;
+    }
+    if (--arglistPtr->refCount > 0) {
+        return;
+    }
+    for (i = 0; i < arglistPtr->numArgs; i++) {
+        argPtr = &arglistPtr->args[i];
+        if (argPtr->defaultValuePtr != NULL) {
+            Tcl_DecrRefCount(argPtr->defaultValuePtr);
+        }
+        Tcl_DecrRefCount(argPtr->namePtr);
+    }
+    Tcl_DecrRefCount(arglistPtr->argumentPtr);
+    if (arglistPtr->usagePtr != NULL) {
+        Tcl_DecrRefCount(arglistPtr->usagePtr);
     }
+    ckfree((char *)arglistPtr);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclFinishArgLists()
+ *
+ *  Called when the interpreter is deleted.  Argument lists still in
+ *  use are no longer interned, and freed by their last release.
+ * ------------------------------------------------------------------------
+ */
+
+void
+ItclFinishArgLists(
+    ItclObjectInfo *infoPtr)
+{
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch place;
+    ItclArgList *arglistPtr;
+
+    hPtr = Tcl_FirstHashEntry(&infoPtr->argLists, &place);
+    while (hPtr != NULL) {
+        arglistPtr = (ItclArgList *)Tcl_GetHashValue(hPtr);
+        arglistPtr->hPtr = NULL;
+        ItclReleaseArgList(arglistPtr);
+        hPtr = Tcl_NextHashEntry(&place);
+    }
+    Tcl_DeleteHashTable(&infoPtr->argLists);
 }
 
 
@@ -1352,9 +1445,9 @@ ItclAddClassFunctionDictInfo(
                 return TCL_ERROR;
             }
 	}
-        if (imPtr->codePtr->usagePtr != NULL) {
+        if (imPtr->codePtr->argListPtr != NULL) {
             if (AddDictEntry(interp, valuePtr2, "-usage",
-	            imPtr->codePtr->usagePtr) != TCL_OK) {
+	            ItclArgListUsage(imPtr->codePtr->argListPtr)) != TCL_OK) {
                 return TCL_ERROR;
             }
 	}
@@ -0,0 +1,222 @@
+/*
+ * itclHook.c --
+ *
+ *	This file contains the event hooks of [incr Tcl], a C interface
+ *	for applications embedding [incr Tcl] which want to observe the
+ *	creation and deletion of objects and classes and the calls of
+ *	methods without Tcl-level traces.  Hooks are installed with
+ *	Itcl_AddEventHook() and removed with Itcl_RemoveEventHook().
+ *
+ *	Each event site checks the mask of all hooks in the ItclObjectInfo
+ *	before calling ItclFireEvent(), so that an event nobody listens to
+ *	costs a single test.
+ *
+ * See the file "license.terms" for information on usage and redistribution of
+ * this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ */
+
+#include "itclInt.h"
+
+/*
+ * One hook installed with Itcl_AddEventHook().  Hooks removed while an
+ * event is fired have a NULL proc until they can be freed.
+ */
+
+typedef struct ItclEventHook {
+    int mask;                     /* ITCL_EVENT_* bits of interest */
+    Itcl_EventHookProc *proc;     /* procedure called, NULL if removed */
+    void *clientData;             /* argument for proc */
+    struct ItclEventHook *nextPtr;/* next hook, in order of installation */
+} ItclEventHook;
+
+static void UpdateEventMask(ItclObjectInfo *infoPtr);
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_AddEventHook()
+ *
+ *  Installs a procedure which is called for every event of a type in
+ *  mask, a combination of the ITCL_EVENT_* bits, occurring in interp.
+ *  Hooks are called in the order of their installation.  If the same
+ *  proc and clientData are installed again, their mask is replaced.
+ *
+ *  Returns TCL_OK on success, or TCL_ERROR (along with an error message
+ *  in the interpreter) if [incr Tcl] is not loaded in interp.
+ * ------------------------------------------------------------------------
+ */
+int
+Itcl_AddEventHook(
+    Tcl_Interp *interp,           /* interpreter to observe */
+    int mask,                     /* ITCL_EVENT_* bits of interest */
+    Itcl_EventHookProc *proc,     /* procedure to call for each event */
+    void *clientData)             /* argument for proc */
+{
+    ItclObjectInfo *infoPtr;
+    ItclEventHook *hookPtr;
+    ItclEventHook **hookPtrPtr;
+
+    infoPtr = (ItclObjectInfo *)Tcl_GetAssocData(interp, ITCL_INTERP_DATA,
+	    NULL);
+    if (infoPtr == NULL) {
+	Tcl_AppendResult(interp, "[incr Tcl] is not loaded", NULL);
+	return TCL_ERROR;
+    }
+    for (hookPtrPtr = &infoPtr->eventHooks; *hookPtrPtr != NULL;
+	    hookPtrPtr = &(*hookPtrPtr)->nextPtr) {
+	hookPtr = *hookPtrPtr;
+	if ((hookPtr->proc == proc) && (hookPtr->clientData == clientData)) {
+	    hookPtr->mask = mask & ITCL_EVENT_ALL;
+	    UpdateEventMask(infoPtr);
+	    return TCL_OK;
+	}
+    }
+    hookPtr = (ItclEventHook *)ckalloc(sizeof(ItclEventHook));
+    hookPtr->mask = mask & ITCL_EVENT_ALL;
+    hookPtr->proc = proc;
+    hookPtr->clientData = clientData;
+    hookPtr->nextPtr = NULL;
+    *hookPtrPtr = hookPtr;
+    UpdateEventMask(infoPtr);
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_RemoveEventHook()
+ *
+ *  Removes the hook installed with the same proc and clientData, if
+ *  any.  A hook may remove itself or other hooks while it is called.
+ * ------------------------------------------------------------------------
+ */
+void
+Itcl_RemoveEventHook(
+    Tcl_Interp *interp,           /* interpreter observed */
+    Itcl_EventHookProc *proc,     /* procedure given to Itcl_AddEventHook */
+    void *clientData)             /* argument given to Itcl_AddEventHook */
+{
+    ItclObjectInfo *infoPtr;
+    ItclEventHook *hookPtr;
+    ItclEventHook **hookPtrPtr;
+
+    infoPtr = (ItclObjectInfo *)Tcl_GetAssocData(interp, ITCL_INTERP_DATA,
+	    NULL);
+    if (infoPtr == NULL) {
+	return;
+    }
+    for (hookPtrPtr = &infoPtr->eventHooks; *hookPtrPtr != NULL;
+	    hookPtrPtr = &(*hookPtrPtr)->nextPtr) {
+	hookPtr = *hookPtrPtr;
+	if ((hookPtr->proc == proc) && (hookPtr->clientData == clientData)) {
+	    if (infoPtr->eventsFiring > 0) {
+		hookPtr->proc = NULL;
+		hookPtr->mask = 0;
+	    } else {
+		*hookPtrPtr = hookPtr->nextPtr;
+		ckfree((char *)hookPtr);
+	    }
+	    break;
+	}
+    }
+    UpdateEventMask(infoPtr);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclFireEvent()
+ *
+ *  Calls the hooks interested in an event.  Called at the event sites
+ *  only if the type is in the eventMask of the ItclObjectInfo.  The
+ *  class, object and method may be NULL if they do not apply.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclFireEvent(
+    ItclObjectInfo *infoPtr,
+    int type,                     /* one of the ITCL_EVENT_* bits */
+    ItclClass *iclsPtr,           /* class concerned or NULL */
+    ItclObject *ioPtr,            /* object concerned or NULL */
+    ItclMemberFunc *imPtr,        /* method called or NULL */
+    int result)                   /* completion code */
+{
+    Itcl_EventInfo event;
+    ItclEventHook *hookPtr;
+    ItclEventHook **hookPtrPtr;
+
+    if ((iclsPtr == NULL) && (ioPtr != NULL)) {
+	iclsPtr = ioPtr->iclsPtr;
+    }
+    if ((iclsPtr == NULL) && (imPtr != NULL)) {
+	iclsPtr = imPtr->iclsPtr;
+    }
+    event.type = type;
+    event.classNamePtr = (iclsPtr != NULL) ? iclsPtr->fullNamePtr : NULL;
+    event.objectNamePtr = (ioPtr != NULL) ? ioPtr->namePtr : NULL;
+    event.methodNamePtr = (imPtr != NULL) ? imPtr->fullNamePtr : NULL;
+    event.result = result;
+
+    /*
+     * Hooks removed by a hook are only marked, so that the walk stays
+     * valid; they are freed when the outermost event is done.
+     */
+    infoPtr->eventsFiring++;
+    for (hookPtr = infoPtr->eventHooks; hookPtr != NULL;
+	    hookPtr = hookPtr->nextPtr) {
+	if ((hookPtr->mask & type) && (hookPtr->proc != NULL)) {
+	    hookPtr->proc(hookPtr->clientData, infoPtr->interp, &event);
+	}
+    }
+    if (--infoPtr->eventsFiring == 0) {
+	hookPtrPtr = &infoPtr->eventHooks;
+	while (*hookPtrPtr != NULL) {
+	    hookPtr = *hookPtrPtr;
+	    if (hookPtr->proc == NULL) {
+		*hookPtrPtr = hookPtr->nextPtr;
+		ckfree((char *)hookPtr);
+	    } else {
+		hookPtrPtr = &hookPtr->nextPtr;
+	    }
+	}
+    }
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclHookFinish()
+ *
+ *  Frees the hooks when the ItclObjectInfo is deleted.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclHookFinish(
+    ItclObjectInfo *infoPtr)
+{
+    ItclEventHook *hookPtr;
+
+    while (infoPtr->eventHooks != NULL) {
+	hookPtr = infoPtr->eventHooks;
+	infoPtr->eventHooks = hookPtr->nextPtr;
+	ckfree((char *)hookPtr);
+    }
+    infoPtr->eventMask = 0;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  UpdateEventMask()
+ *
+ *  Recomputes the mask of the events some hook is interested in.
+ * ------------------------------------------------------------------------
+ */
+static void
+UpdateEventMask(
+    ItclObjectInfo *infoPtr)
+{
+    ItclEventHook *hookPtr;
+    int mask = 0;
+
+    for (hookPtr = infoPtr->eventHooks; hookPtr != NULL;
+	    hookPtr = hookPtr->nextPtr) {
+	mask |= hookPtr->mask;
+    }
+    infoPtr->eventMask = mask;
+}
@@ -0,0 +1,789 @@
+/*
+ * itclIndex.c --
+ *
+ *	This file implements "itcl::index", which maintains for an instance
+ *	variable of a class a table from the values of the variable to the
+ *	objects of the class and its derived classes holding them, so that
+ *	objects can be found by value without scanning all instances.
+ *
+ *	Each indexed variable of each object carries a write/unset trace
+ *	which moves the object to the entry of its new value.  Objects are
+ *	added to the indexes of their classes by ItclInitObjectVariables()
+ *	and removed from them by ItclIndexForgetObject().
+ *
+ * See the file "license.terms" for information on usage and redistribution of
+ * this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ */
+
+#include "tclInt.h"
+#include "itclInt.h"
+
+/*
+ *  Flags of the variables which cannot be indexed: commons and the
+ *  built-in variables.
+ */
+#define ITCL_INDEX_IGNORED_VARS (ITCL_COMMON|ITCL_THIS_VAR|ITCL_OPTIONS_VAR| \
+	ITCL_TYPE_VAR|ITCL_SELF_VAR|ITCL_SELFNS_VAR|ITCL_WIN_VAR| \
+	ITCL_HULL_VAR|ITCL_OPTION_COMP_VAR)
+
+/*
+ * The index of an instance variable in a class.  The values table maps
+ * values to the object holding them for a unique index, and otherwise
+ * to a table of the objects holding them.
+ */
+
+typedef struct ItclIndex {
+    ItclClass *iclsPtr;           /* class of the index */
+    ItclVariable *ivPtr;          /* indexed variable */
+    int unique;                   /* non-zero if values are unique */
+    Tcl_HashTable values;         /* value -> ItclObject * if unique, else
+                                   * value -> Tcl_HashTable * of objects */
+    Tcl_HashTable objects;        /* ItclObject * -> ItclIndexSlot * */
+} ItclIndex;
+
+/*
+ * An object in an index.  It is the client data of the trace on the
+ * indexed variable of the object.
+ */
+
+typedef struct ItclIndexSlot {
+    ItclIndex *indexPtr;          /* index */
+    ItclObject *ioPtr;            /* object */
+    Tcl_HashEntry *valuePtr;      /* entry of the current value in the
+                                   * values table, or NULL */
+    int traced;                   /* non-zero while the trace is set */
+} ItclIndexSlot;
+
+static const char *const indexOptions[] = {
+    "create", "delete", "lookup", "names", NULL
+};
+enum IndexOption {
+    INDEX_CREATE, INDEX_DELETE, INDEX_LOOKUP, INDEX_NAMES
+};
+
+static Tcl_ObjCmdProc Itcl_IndexCmd;
+static int FindIndexedVar(Tcl_Interp *interp, ItclClass *iclsPtr,
+	Tcl_Obj *namePtr, ItclVariable **ivPtrPtr);
+static ItclIndex *FindIndex(Tcl_Interp *interp, ItclClass *iclsPtr,
+	ItclVariable *ivPtr);
+static int AddObject(Tcl_Interp *interp, ItclIndex *indexPtr,
+	ItclObject *ioPtr);
+static void ForgetSlot(ItclIndexSlot *slotPtr);
+static void DeleteIndex(ItclIndex *indexPtr);
+static ItclObject *InsertValue(ItclIndexSlot *slotPtr, const char *value);
+static void RemoveValue(ItclIndexSlot *slotPtr);
+static Tcl_Var IndexedVar(ItclIndexSlot *slotPtr);
+static void TraceSlot(Tcl_Interp *interp, ItclIndexSlot *slotPtr,
+	int untrace);
+static Tcl_Obj *DuplicateValueObj(ItclIndexSlot *slotPtr,
+	const char *value, ItclObject *otherPtr);
+static char *ItclTraceIndexedVar(void *cdata, Tcl_Interp *interp,
+	const char *name1, const char *name2, int flags);
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclIndexInit()
+ *
+ *  Invoked by Itcl_Init() to install the "itcl::index" command.
+ * ------------------------------------------------------------------------
+ */
+int
+ItclIndexInit(
+    Tcl_Interp *interp,          /* interpreter to be updated */
+    ItclObjectInfo *infoPtr)     /* info regarding all known objects */
+{
+    Tcl_CreateObjCommand(interp, "::itcl::index", Itcl_IndexCmd,
+        infoPtr, Itcl_ReleaseData);
+    Itcl_PreserveData(infoPtr);
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_IndexCmd()
+ *
+ *  Creates, deletes and queries indexes of instance variables.
+ *  Handles the following syntax:
+ *
+ *    itcl::index create <className> <varName> ?-unique?
+ *    itcl::index delete <className> <varName>
+ *    itcl::index lookup <className> <varName> <value>
+ *    itcl::index names <className>
+ *
+ *  Returns TCL_OK/TCL_ERROR to indicate success/failure.
+ * ------------------------------------------------------------------------
+ */
+static int
+Itcl_IndexCmd(
+    void *clientData,        /* infoPtr */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)clientData;
+    ItclClass *iclsPtr;
+    ItclVariable *ivPtr;
+    ItclIndex *indexPtr;
+    ItclObject *ioPtr;
+    Tcl_HashEntry *entryPtr;
+    Tcl_HashTable *setPtr;
+    Tcl_Obj *resultPtr;
+    Tcl_Obj *namePtr;
+    int index;
+    int unique;
+    int isNew;
+    FOREACH_HASH_DECLS;
+
+    if (objc < 3) {
+	Tcl_WrongNumArgs(interp, 1, objv, "option className ?arg ...?");
+	return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[1], indexOptions, "option", 0,
+	    &index) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    iclsPtr = Itcl_FindClass(interp, Tcl_GetString(objv[2]),
+	    /* autoload */ 1);
+    if (iclsPtr == NULL) {
+	return TCL_ERROR;
+    }
+
+    switch ((enum IndexOption)index) {
+    case INDEX_CREATE:
+	if ((objc < 4) || (objc > 5) || ((objc == 5)
+		&& (strcmp(Tcl_GetString(objv[4]), "-unique") != 0))) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "className varName ?-unique?");
+	    return TCL_ERROR;
+	}
+	unique = (objc == 5);
+	if (iclsPtr->flags & ITCL_RECORD) {
+	    Tcl_AppendResult(interp, "cannot index record \"",
+		    Tcl_GetString(iclsPtr->fullNamePtr), "\"", NULL);
+	    return TCL_ERROR;
+	}
+	if (FindIndexedVar(interp, iclsPtr, objv[3], &ivPtr) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	if (iclsPtr->indexes == NULL) {
+	    iclsPtr->indexes = (Tcl_HashTable *)ckalloc(sizeof(Tcl_HashTable));
+	    Tcl_InitHashTable(iclsPtr->indexes, TCL_ONE_WORD_KEYS);
+	}
+	entryPtr = Tcl_CreateHashEntry(iclsPtr->indexes, (char *)ivPtr,
+		&isNew);
+	if (!isNew) {
+	    Tcl_AppendResult(interp, "variable \"", Tcl_GetString(objv[3]),
+		    "\" of class \"", Tcl_GetString(iclsPtr->fullNamePtr),
+		    "\" is already indexed", NULL);
+	    return TCL_ERROR;
+	}
+	indexPtr = (ItclIndex *)ckalloc(sizeof(ItclIndex));
+	indexPtr->iclsPtr = iclsPtr;
+	indexPtr->ivPtr = ivPtr;
+	indexPtr->unique = unique;
+	Tcl_InitHashTable(&indexPtr->values, TCL_STRING_KEYS);
+	Tcl_InitHashTable(&indexPtr->objects, TCL_ONE_WORD_KEYS);
+	Tcl_SetHashValue(entryPtr, indexPtr);
+
+	FOREACH_HASH_VALUE(ioPtr, &infoPtr->objects) {
+	    if ((ioPtr->flags & (ITCL_OBJECT_IS_DELETED|
+		    ITCL_OBJECT_IS_DESTRUCTED|ITCL_OBJECT_IS_DESTROYED))
+		    || !Itcl_ObjectIsa(ioPtr, iclsPtr)) {
+		continue;
+	    }
+	    if (AddObject(interp, indexPtr, ioPtr) != TCL_OK) {
+		Tcl_DeleteHashEntry(entryPtr);
+		DeleteIndex(indexPtr);
+		return TCL_ERROR;
+	    }
+	}
+	return TCL_OK;
+
+    case INDEX_DELETE:
+	if (objc != 4) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "className varName");
+	    return TCL_ERROR;
+	}
+	if (FindIndexedVar(interp, iclsPtr, objv[3], &ivPtr) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	indexPtr = FindIndex(interp, iclsPtr, ivPtr);
+	if (indexPtr == NULL) {
+	    return TCL_ERROR;
+	}
+	Tcl_DeleteHashEntry(Tcl_FindHashEntry(iclsPtr->indexes,
+		(char *)ivPtr));
+	DeleteIndex(indexPtr);
+	return TCL_OK;
+
+    case INDEX_LOOKUP:
+	if (objc != 5) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "className varName value");
+	    return TCL_ERROR;
+	}
+	if (FindIndexedVar(interp, iclsPtr, objv[3], &ivPtr) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	indexPtr = FindIndex(interp, iclsPtr, ivPtr);
+	if (indexPtr == NULL) {
+	    return TCL_ERROR;
+	}
+	entryPtr = Tcl_FindHashEntry(&indexPtr->values,
+		Tcl_GetString(objv[4]));
+	if (entryPtr == NULL) {
+	    return TCL_OK;
+	}
+	if (indexPtr->unique) {
+	    ioPtr = (ItclObject *)Tcl_GetHashValue(entryPtr);
+	    namePtr = Tcl_NewObj();
+	    Tcl_GetCommandFullName(interp, ioPtr->accessCmd, namePtr);
+	    Tcl_SetObjResult(interp, namePtr);
+	    return TCL_OK;
+	}
+	setPtr = (Tcl_HashTable *)Tcl_GetHashValue(entryPtr);
+	resultPtr = Tcl_NewListObj(0, NULL);
+	FOREACH_HASH_VALUE(ioPtr, setPtr) {
+	    namePtr = Tcl_NewObj();
+	    Tcl_GetCommandFullName(interp, ioPtr->accessCmd, namePtr);
+	    Tcl_ListObjAppendElement(NULL, resultPtr, namePtr);
+	}
+	Tcl_SetObjResult(interp, resultPtr);
+	return TCL_OK;
+
+    case INDEX_NAMES:
+	if (objc != 3) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "className");
+	    return TCL_ERROR;
+	}
+	resultPtr = Tcl_NewListObj(0, NULL);
+	if (iclsPtr->indexes != NULL) {
+	    FOREACH_HASH_VALUE(indexPtr, iclsPtr->indexes) {
+		Tcl_ListObjAppendElement(NULL, resultPtr,
+			indexPtr->ivPtr->fullNamePtr);
+	    }
+	}
+	Tcl_SetObjResult(interp, resultPtr);
+	return TCL_OK;
+    }
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  FindIndexedVar()
+ *
+ *  Resolves the name of an instance variable in a class.  Returns
+ *  TCL_OK, or TCL_ERROR (along with an error message in the
+ *  interpreter) if it is not an instance variable of the class.
+ * ------------------------------------------------------------------------
+ */
+static int
+FindIndexedVar(
+    Tcl_Interp *interp,      /* current interpreter */
+    ItclClass *iclsPtr,      /* class */
+    Tcl_Obj *namePtr,        /* name of the variable */
+    ItclVariable **ivPtrPtr) /* returns the variable */
+{
+    Tcl_HashEntry *hPtr;
+    ItclVariable *ivPtr = NULL;
+
+    hPtr = ItclResolveVarEntry(iclsPtr, Tcl_GetString(namePtr));
+    if (hPtr != NULL) {
+	ivPtr = ((ItclVarLookup *)Tcl_GetHashValue(hPtr))->ivPtr;
+    }
+    if ((ivPtr == NULL) || (ivPtr->flags & ITCL_INDEX_IGNORED_VARS)
+	    || (ivPtr->arrayInitPtr != NULL)) {
+	Tcl_AppendResult(interp, "\"", Tcl_GetString(namePtr),
+		"\" is not an instance variable of class \"",
+		Tcl_GetString(iclsPtr->fullNamePtr), "\"", NULL);
+	return TCL_ERROR;
+    }
+    *ivPtrPtr = ivPtr;
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  FindIndex()
+ *
+ *  Returns the index of a variable in a class, or NULL (along with an
+ *  error message in the interpreter) if it is not indexed.
+ * ------------------------------------------------------------------------
+ */
+static ItclIndex *
+FindIndex(
+    Tcl_Interp *interp,      /* current interpreter */
+    ItclClass *iclsPtr,      /* class */
+    ItclVariable *ivPtr)     /* variable */
+{
+    Tcl_HashEntry *hPtr = NULL;
+
+    if (iclsPtr->indexes != NULL) {
+	hPtr = Tcl_FindHashEntry(iclsPtr->indexes, (char *)ivPtr);
+    }
+    if (hPtr == NULL) {
+	Tcl_AppendResult(interp, "variable \"",
+		Tcl_GetString(ivPtr->namePtr), "\" of class \"",
+		Tcl_GetString(iclsPtr->fullNamePtr), "\" is not indexed",
+		NULL);
+	return NULL;
+    }
+    return (ItclIndex *)Tcl_GetHashValue(hPtr);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclIndexObject()
+ *
+ *  Invoked by ItclInitObjectVariables() once the variables of a new
+ *  object are initialized, to add the object to the indexes of its
+ *  classes.  Returns TCL_OK, or TCL_ERROR (along with an error message
+ *  in the interpreter) if the initial value of a variable with a
+ *  unique index is already used.
+ * ------------------------------------------------------------------------
+ */
+int
+ItclIndexObject(
+    Tcl_Interp *interp,      /* current interpreter */
+    ItclObject *ioPtr)       /* new object */
+{
+    ItclHierIter hier;
+    ItclClass *iclsPtr;
+    ItclIndex *indexPtr;
+    int result = TCL_OK;
+    FOREACH_HASH_DECLS;
+
+    Itcl_InitHierIter(&hier, ioPtr->iclsPtr);
+    while ((result == TCL_OK)
+	    && ((iclsPtr = Itcl_AdvanceHierIter(&hier)) != NULL)) {
+	if (iclsPtr->indexes == NULL) {
+	    continue;
+	}
+	FOREACH_HASH_VALUE(indexPtr, iclsPtr->indexes) {
+	    result = AddObject(interp, indexPtr, ioPtr);
+	    if (result != TCL_OK) {
+		break;
+	    }
+	}
+    }
+    Itcl_DeleteHierIter(&hier);
+    if (result != TCL_OK) {
+	ItclIndexForgetObject(ioPtr);
+    }
+    return result;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclIndexForgetObject()
+ *
+ *  Invoked when an object is destroyed, to remove it from the indexes
+ *  of its classes.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclIndexForgetObject(
+    ItclObject *ioPtr)       /* object being destroyed */
+{
+    ItclHierIter hier;
+    ItclClass *iclsPtr;
+    ItclIndex *indexPtr;
+    Tcl_HashEntry *entryPtr;
+    FOREACH_HASH_DECLS;
+
+    Itcl_InitHierIter(&hier, ioPtr->iclsPtr);
+    while ((iclsPtr = Itcl_AdvanceHierIter(&hier)) != NULL) {
+	if (iclsPtr->indexes == NULL) {
+	    continue;
+	}
+	FOREACH_HASH_VALUE(indexPtr, iclsPtr->indexes) {
+	    entryPtr = Tcl_FindHashEntry(&indexPtr->objects, (char *)ioPtr);
+	    if (entryPtr != NULL) {
+		ForgetSlot((ItclIndexSlot *)Tcl_GetHashValue(entryPtr));
+	    }
+	}
+    }
+    Itcl_DeleteHierIter(&hier);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclDeleteIndexes()
+ *
+ *  Invoked by ItclFreeClass() to delete the indexes of a class.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclDeleteIndexes(
+    ItclClass *iclsPtr)      /* class being freed */
+{
+    ItclIndex *indexPtr;
+    FOREACH_HASH_DECLS;
+
+    FOREACH_HASH_VALUE(indexPtr, iclsPtr->indexes) {
+	DeleteIndex(indexPtr);
+    }
+    Tcl_DeleteHashTable(iclsPtr->indexes);
+    ckfree(iclsPtr->indexes);
+    iclsPtr->indexes = NULL;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  AddObject()
+ *
+ *  Adds an object to an index, with the current value of its variable,
+ *  and puts a trace on the variable.  Returns TCL_OK, or TCL_ERROR
+ *  (along with an error message in the interpreter) if the value is
+ *  already used in a unique index.
+ * ------------------------------------------------------------------------
+ */
+static int
+AddObject(
+    Tcl_Interp *interp,      /* current interpreter */
+    ItclIndex *indexPtr,     /* index */
+    ItclObject *ioPtr)       /* object of the class of the index */
+{
+    ItclIndexSlot *slotPtr;
+    ItclObject *otherPtr;
+    Tcl_HashEntry *hPtr;
+    Tcl_Obj *valuePtr;
+    Var *varPtr;
+    int isNew;
+
+    hPtr = Tcl_FindHashEntry(&ioPtr->objectVariables,
+	    (char *)indexPtr->ivPtr);
+    if (hPtr == NULL) {
+	return TCL_OK;
+    }
+    varPtr = (Var *)Tcl_GetHashValue(hPtr);
+    hPtr = Tcl_CreateHashEntry(&indexPtr->objects, (char *)ioPtr, &isNew);
+    if (!isNew) {
+	return TCL_OK;
+    }
+    slotPtr = (ItclIndexSlot *)ckalloc(sizeof(ItclIndexSlot));
+    slotPtr->indexPtr = indexPtr;
+    slotPtr->ioPtr = ioPtr;
+    slotPtr->valuePtr = NULL;
+    slotPtr->traced = 0;
+    Tcl_SetHashValue(hPtr, slotPtr);
+
+    if (!TclIsVarUndefined(varPtr) && !TclIsVarArray(varPtr)) {
+	valuePtr = TclPtrGetVar(interp, (Tcl_Var)varPtr, NULL,
+		indexPtr->ivPtr->namePtr, NULL, TCL_LEAVE_ERR_MSG);
+	if (valuePtr == NULL) {
+	    ForgetSlot(slotPtr);
+	    return TCL_ERROR;
+	}
+	otherPtr = InsertValue(slotPtr, Tcl_GetString(valuePtr));
+	if (otherPtr != NULL) {
+	    Tcl_SetObjResult(interp, DuplicateValueObj(slotPtr,
+		    Tcl_GetString(valuePtr), otherPtr));
+	    ForgetSlot(slotPtr);
+	    return TCL_ERROR;
+	}
+    }
+    TraceSlot(interp, slotPtr, 0);
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ForgetSlot()
+ *
+ *  Removes an object from an index and removes the trace on its
+ *  variable.
+ * ------------------------------------------------------------------------
+ */
+static void
+ForgetSlot(
+    ItclIndexSlot *slotPtr)  /* object in an index */
+{
+    Tcl_HashEntry *hPtr;
+
+    RemoveValue(slotPtr);
+    if (slotPtr->traced) {
+	TraceSlot(slotPtr->ioPtr->interp, slotPtr, 1);
+    }
+    hPtr = Tcl_FindHashEntry(&slotPtr->indexPtr->objects,
+	    (char *)slotPtr->ioPtr);
+    if (hPtr != NULL) {
+	Tcl_DeleteHashEntry(hPtr);
+    }
+    ckfree(slotPtr);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  DeleteIndex()
+ *
+ *  Removes all objects from an index and frees it.
+ * ------------------------------------------------------------------------
+ */
+static void
+DeleteIndex(
+    ItclIndex *indexPtr)     /* index */
+{
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch search;
+
+    while ((hPtr = Tcl_FirstHashEntry(&indexPtr->objects, &search)) != NULL) {
+	ForgetSlot((ItclIndexSlot *)Tcl_GetHashValue(hPtr));
+    }
+    Tcl_DeleteHashTable(&indexPtr->objects);
+    Tcl_DeleteHashTable(&indexPtr->values);
+    ckfree(indexPtr);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  InsertValue()
+ *
+ *  Records the value of the variable of an object in its index.
+ *  Returns NULL, or if the index is unique and the value is already
+ *  used by another object, that object, in which case nothing changes.
+ * ------------------------------------------------------------------------
+ */
+static ItclObject *
+InsertValue(
+    ItclIndexSlot *slotPtr,  /* object in an index */
+    const char *value)       /* new value */
+{
+    ItclIndex *indexPtr = slotPtr->indexPtr;
+    Tcl_HashEntry *hPtr;
+    Tcl_HashTable *setPtr;
+    ItclObject *otherPtr;
+    int isNew;
+
+    if ((slotPtr->valuePtr != NULL) && (strcmp(value,
+	    Tcl_GetHashKey(&indexPtr->values, slotPtr->valuePtr)) == 0)) {
+	return NULL;
+    }
+    hPtr = Tcl_CreateHashEntry(&indexPtr->values, value, &isNew);
+    if (indexPtr->unique) {
+	if (!isNew) {
+	    otherPtr = (ItclObject *)Tcl_GetHashValue(hPtr);
+	    if (otherPtr != slotPtr->ioPtr) {
+		return otherPtr;
+	    }
+	}
+	RemoveValue(slotPtr);
+	Tcl_SetHashValue(hPtr, slotPtr->ioPtr);
+    } else {
+	RemoveValue(slotPtr);
+	if (isNew) {
+	    setPtr = (Tcl_HashTable *)ckalloc(sizeof(Tcl_HashTable));
+	    Tcl_InitHashTable(setPtr, TCL_ONE_WORD_KEYS);
+	    Tcl_SetHashValue(hPtr, setPtr);
+	} else {
+	    setPtr = (Tcl_HashTable *)Tcl_GetHashValue(hPtr);
+	}
+	Tcl_SetHashValue(Tcl_CreateHashEntry(setPtr, (char *)slotPtr->ioPtr,
+		&isNew), slotPtr->ioPtr);
+    }
+    slotPtr->valuePtr = hPtr;
+    return NULL;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  RemoveValue()
+ *
+ *  Removes the value of the variable of an object from its index.
+ * ------------------------------------------------------------------------
+ */
+static void
+RemoveValue(
+    ItclIndexSlot *slotPtr)  /* object in an index */
+{
+    Tcl_HashTable *setPtr;
+    Tcl_HashEntry *hPtr;
+
+    if (slotPtr->valuePtr == NULL) {
+	return;
+    }
+    if (slotPtr->indexPtr->unique) {
+	Tcl_DeleteHashEntry(slotPtr->valuePtr);
+    } else {
+	setPtr = (Tcl_HashTable *)Tcl_GetHashValue(slotPtr->valuePtr);
+	hPtr = Tcl_FindHashEntry(setPtr, (char *)slotPtr->ioPtr);
+	if (hPtr != NULL) {
+	    Tcl_DeleteHashEntry(hPtr);
+	}
+	if (setPtr->numEntries == 0) {
+	    Tcl_DeleteHashTable(setPtr);
+	    ckfree(setPtr);
+	    Tcl_DeleteHashEntry(slotPtr->valuePtr);
+	}
+    }
+    slotPtr->valuePtr = NULL;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  IndexedVar()
+ *
+ *  Returns the indexed variable of the object of a slot, or NULL if the
+ *  object has none.
+ * ------------------------------------------------------------------------
+ */
+static Tcl_Var
+IndexedVar(
+    ItclIndexSlot *slotPtr)  /* object in an index */
+{
+    Tcl_HashEntry *hPtr;
+
+    hPtr = Tcl_FindHashEntry(&slotPtr->ioPtr->objectVariables,
+	    (char *)slotPtr->indexPtr->ivPtr);
+    return (hPtr != NULL) ? (Tcl_Var)Tcl_GetHashValue(hPtr) : NULL;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  TraceSlot()
+ *
+ *  Puts the trace on the variable of the object of a slot, or removes
+ *  it if untrace is non-zero.
+ * ------------------------------------------------------------------------
+ */
+static void
+TraceSlot(
+    Tcl_Interp *interp,      /* current interpreter */
+    ItclIndexSlot *slotPtr,  /* object in an index */
+    int untrace)             /* non-zero to remove the trace */
+{
+    Tcl_Var varPtr = IndexedVar(slotPtr);
+    Tcl_Obj *namePtr;
+
+    if ((varPtr == NULL) || TclIsVarDeadHash((Var *)varPtr)) {
+	slotPtr->traced = 0;
+	return;
+    }
+    namePtr = Tcl_NewObj();
+    Tcl_IncrRefCount(namePtr);
+    Tcl_GetVariableFullName(interp, varPtr, namePtr);
+    if (untrace) {
+	Tcl_UntraceVar2(interp, Tcl_GetString(namePtr), NULL,
+		TCL_TRACE_WRITES|TCL_TRACE_UNSETS|TCL_TRACE_RESULT_OBJECT,
+		ItclTraceIndexedVar, slotPtr);
+	slotPtr->traced = 0;
+    } else {
+	slotPtr->traced = (Tcl_TraceVar2(interp, Tcl_GetString(namePtr),
+		NULL, TCL_TRACE_WRITES|TCL_TRACE_UNSETS|TCL_TRACE_RESULT_OBJECT,
+		ItclTraceIndexedVar, slotPtr) == TCL_OK);
+    }
+    Tcl_DecrRefCount(namePtr);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  DuplicateValueObj()
+ *
+ *  Returns the error message for a value already used in a unique
+ *  index.
+ * ------------------------------------------------------------------------
+ */
+static Tcl_Obj *
+DuplicateValueObj(
+    ItclIndexSlot *slotPtr,  /* object in a unique index */
+    const char *value,       /* its new value */
+    ItclObject *otherPtr)    /* object already using the value */
+{
+    Tcl_Obj *objPtr;
+
+    objPtr = Tcl_ObjPrintf("value \"%s\" of \"%s\" is already used by "
+	    "object \"", value,
+	    Tcl_GetString(slotPtr->indexPtr->ivPtr->fullNamePtr));
+    Tcl_GetCommandFullName(slotPtr->ioPtr->interp, otherPtr->accessCmd,
+	    objPtr);
+    Tcl_AppendToObj(objPtr, "\"", 1);
+    return objPtr;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclTraceIndexedVar()
+ *
+ *  Invoked to handle write/unset traces on indexed instance variables.
+ *
+ *  On write, this procedure moves the object to the entry of the new
+ *  value in the index.  If the index is unique and another object
+ *  already has the value, the old value is restored and an error is
+ *  returned.  Values rejected by the type of a typed variable are left
+ *  to ItclTraceTypedVar(), which restores the old value.  Other values
+ *  of typed variables are indexed as ItclTraceTypedVar() stores them,
+ *  since this trace runs first.  When the
+ *  variable is unset, the object is removed from the index, and the
+ *  trace is put back unless the object is being destroyed.
+ * ------------------------------------------------------------------------
+ */
+static char *
+ItclTraceIndexedVar(
+    void *cdata,             /* ItclIndexSlot of the variable */
+    Tcl_Interp *interp,      /* interpreter managing this variable */
+    TCL_UNUSED(const char *),   /* variable name */
+    TCL_UNUSED(const char *),   /* element name or NULL */
+    int flags)               /* flags indicating write/unset */
+{
+    ItclIndexSlot *slotPtr = (ItclIndexSlot *)cdata;
+    ItclVariable *ivPtr = slotPtr->indexPtr->ivPtr;
+    ItclObject *otherPtr;
+    union {
+	Tcl_WideInt w;
+	double d;
+    } typedValue;            /* C value of a typed variable */
+    Tcl_Obj *valuePtr;
+    Tcl_Obj *errorPtr;
+    Tcl_Var varPtr;
+    const char *value;
+
+    if (flags & TCL_TRACE_UNSETS) {
+	RemoveValue(slotPtr);
+	slotPtr->traced = 0;
+	if ((flags & TCL_TRACE_DESTROYED) && !(flags & (TCL_INTERP_DESTROYED|
+		TCL_NAMESPACE_ONLY)) && !(slotPtr->ioPtr->flags
+		& (ITCL_OBJECT_IS_DELETED|ITCL_OBJECT_IS_DESTRUCTED|
+		ITCL_OBJECT_IS_DESTROYED))) {
+	    TraceSlot(interp, slotPtr, 0);
+	}
+	return NULL;
+    }
+
+    varPtr = IndexedVar(slotPtr);
+    if (varPtr == NULL) {
+	return NULL;
+    }
+    valuePtr = TclPtrGetVar(interp, varPtr, NULL, ivPtr->namePtr, NULL, 0);
+    if (valuePtr == NULL) {
+	return NULL;
+    }
+    if (ivPtr->type != ITCL_VARTYPE_NONE) {
+	if (ItclGetTypedValue(NULL, ivPtr->type, valuePtr, &typedValue)
+		!= TCL_OK) {
+	    return NULL;
+	}
+
+	/*
+	 *  Doubles written as integers like "3" become "3.0".
+	 */
+	if ((ivPtr->type == ITCL_VARTYPE_DOUBLE)
+		&& (valuePtr->typePtr != slotPtr->ioPtr->infoPtr->doubleTypePtr)) {
+	    valuePtr = Tcl_NewDoubleObj(typedValue.d);
+	}
+    }
+    Tcl_IncrRefCount(valuePtr);
+    value = Tcl_GetString(valuePtr);
+    otherPtr = InsertValue(slotPtr, value);
+    if (otherPtr == NULL) {
+	Tcl_DecrRefCount(valuePtr);
+	return NULL;
+    }
+    errorPtr = DuplicateValueObj(slotPtr, value, otherPtr);
+    Tcl_IncrRefCount(errorPtr);      /* released by Tcl */
+    Tcl_DecrRefCount(valuePtr);
+    if (slotPtr->valuePtr != NULL) {
+	TclPtrSetVar(interp, varPtr, NULL, ivPtr->namePtr, NULL,
+		Tcl_NewStringObj(Tcl_GetHashKey(&slotPtr->indexPtr->values,
+		slotPtr->valuePtr), TCL_INDEX_NONE), 0);
+    }
+    return (char *)errorPtr;
+}
@@ -1150,21 +1150,23 @@ Itcl_BiInfoFunctionCmd(
             switch (iflist[i]) {
                 case BIfArgsIdx:
                     if (mcode && mcode->argListPtr) {
-			if (imPtr->usagePtr == NULL) {
-                            objPtr = Tcl_NewStringObj(
-			            Tcl_GetString(mcode->usagePtr), TCL_INDEX_NONE);
+			if (imPtr->argListPtr == NULL) {
+                            objPtr = Tcl_NewStringObj(Tcl_GetString(
+				    ItclArgListUsage(mcode->argListPtr)),
+				    TCL_INDEX_NONE);
 			} else {
-                            objPtr = Tcl_NewStringObj(
-			            Tcl_GetString(imPtr->usagePtr), TCL_INDEX_NONE);
+                            objPtr = Tcl_NewStringObj(Tcl_GetString(
+				    ItclArgListUsage(imPtr->argListPtr)),
+				    TCL_INDEX_NONE);
 		        }
                     } else {
 		        if ((imPtr->flags & ITCL_ARG_SPEC) != 0) {
-			    if (imPtr->usagePtr == NULL) {
-                                objPtr = Tcl_NewStringObj(
-				        Tcl_GetString(mcode->usagePtr), TCL_INDEX_NONE);
+			    if (imPtr->argListPtr == NULL) {
+                                objPtr = Tcl_NewStringObj("", TCL_INDEX_NONE);
 			    } else {
-			        objPtr = Tcl_NewStringObj(
-				        Tcl_GetString(imPtr->usagePtr), TCL_INDEX_NONE);
+			        objPtr = Tcl_NewStringObj(Tcl_GetString(
+					ItclArgListUsage(imPtr->argListPtr)),
+					TCL_INDEX_NONE);
 			    }
                         } else {
                             objPtr = Tcl_NewStringObj("<undefined>", TCL_INDEX_NONE);
@@ -2002,9 +2004,10 @@ Itcl_BiInfoArgsCmd(
         /*
          *  Return a string describing the argument list.
          */
-        if ((mcode && mcode->argListPtr != NULL)
-		|| ((imPtr->flags & ITCL_ARG_SPEC) != 0)) {
-	    Tcl_SetObjResult(interp, mcode->usagePtr);
+        if (mcode && mcode->argListPtr != NULL) {
+	    Tcl_SetObjResult(interp, ItclArgListUsage(mcode->argListPtr));
+        } else if ((imPtr->flags & ITCL_ARG_SPEC) != 0) {
+	    Tcl_SetObjResult(interp, Tcl_NewObj());
         } else {
 	    Tcl_SetObjResult(interp, Tcl_NewStringObj("<undefined>", TCL_INDEX_NONE));
         }
@@ -3006,6 +3009,8 @@ Itcl_BiInfoDefaultCmd(
     ItclMemberFunc *imPtr;
     ItclDelegatedFunction *idmPtr;
     ItclArgList *argListPtr;
+    ItclArg *argPtr;
+    Tcl_Size i;
     const char *methodName;
     const char *argName;
     const char *what;
@@ -3035,11 +3040,12 @@ Itcl_BiInfoDefaultCmd(
     }
     if (found) {
         argListPtr = imPtr->argListPtr;
-	while (argListPtr != NULL) {
-	    if (strcmp(argName, Tcl_GetString(argListPtr->namePtr)) == 0) {
-	        if (argListPtr->defaultValuePtr != NULL) {
+	for (i = 0; (argListPtr != NULL) && (i < argListPtr->numArgs); i++) {
+	    argPtr = &argListPtr->args[i];
+	    if (strcmp(argName, Tcl_GetString(argPtr->namePtr)) == 0) {
+	        if (argPtr->defaultValuePtr != NULL) {
 		    if (NULL == Tcl_ObjSetVar2(interp, objv[3], NULL,
-			    argListPtr->defaultValuePtr, TCL_LEAVE_ERR_MSG)) {
+			    argPtr->defaultValuePtr, TCL_LEAVE_ERR_MSG)) {
 			return TCL_ERROR;
 		    }
 		    Tcl_SetObjResult(interp, Tcl_NewWideIntObj(1));
@@ -3051,7 +3057,6 @@ Itcl_BiInfoDefaultCmd(
 		    return TCL_ERROR;
 	        }
 	    }
-	    argListPtr = argListPtr->nextPtr;
 	}
     }
     if (! found) {
@@ -3215,21 +3220,23 @@ Itcl_BiInfoMethodCmd(
             switch (iflist[i]) {
                 case BIfArgsIdx:
                     if (mcode && mcode->argListPtr) {
-			if (imPtr->usagePtr == NULL) {
-                            objPtr = Tcl_NewStringObj(
-			            Tcl_GetString(mcode->usagePtr), TCL_INDEX_NONE);
+			if (imPtr->argListPtr == NULL) {
+                            objPtr = Tcl_NewStringObj(Tcl_GetString(
+				    ItclArgListUsage(mcode->argListPtr)),
+				    TCL_INDEX_NONE);
 			} else {
-                            objPtr = Tcl_NewStringObj(
-			            Tcl_GetString(imPtr->usagePtr), TCL_INDEX_NONE);
+                            objPtr = Tcl_NewStringObj(Tcl_GetString(
+				    ItclArgListUsage(imPtr->argListPtr)),
+				    TCL_INDEX_NONE);
 		        }
                     } else {
 		        if ((imPtr->flags & ITCL_ARG_SPEC) != 0) {
-			    if (imPtr->usagePtr == NULL) {
-                                objPtr = Tcl_NewStringObj(
-				        Tcl_GetString(mcode->usagePtr), TCL_INDEX_NONE);
+			    if (imPtr->argListPtr == NULL) {
+                                objPtr = Tcl_NewStringObj("", TCL_INDEX_NONE);
 			    } else {
-			        objPtr = Tcl_NewStringObj(
-				        Tcl_GetString(imPtr->usagePtr), TCL_INDEX_NONE);
+			        objPtr = Tcl_NewStringObj(Tcl_GetString(
+					ItclArgListUsage(imPtr->argListPtr)),
+					TCL_INDEX_NONE);
 			    }
                         } else {
                             objPtr = Tcl_NewStringObj("<undefined>", TCL_INDEX_NONE);
@@ -3785,21 +3792,23 @@ Itcl_BiInfoTypeMethodCmd(
             switch (iflist[i]) {
                 case BIfArgsIdx:
                     if (mcode && mcode->argListPtr) {
-			if (imPtr->usagePtr == NULL) {
-                            objPtr = Tcl_NewStringObj(
-			            Tcl_GetString(mcode->usagePtr), TCL_INDEX_NONE);
+			if (imPtr->argListPtr == NULL) {
+                            objPtr = Tcl_NewStringObj(Tcl_GetString(
+				    ItclArgListUsage(mcode->argListPtr)),
+				    TCL_INDEX_NONE);
 			} else {
-                            objPtr = Tcl_NewStringObj(
-			            Tcl_GetString(imPtr->usagePtr), TCL_INDEX_NONE);
+                            objPtr = Tcl_NewStringObj(Tcl_GetString(
+				    ItclArgListUsage(imPtr->argListPtr)),
+				    TCL_INDEX_NONE);
 		        }
                     } else {
 		        if ((imPtr->flags & ITCL_ARG_SPEC) != 0) {
-			    if (imPtr->usagePtr == NULL) {
-                                objPtr = Tcl_NewStringObj(
-				        Tcl_GetString(mcode->usagePtr), TCL_INDEX_NONE);
+			    if (imPtr->argListPtr == NULL) {
+                                objPtr = Tcl_NewStringObj("", TCL_INDEX_NONE);
 			    } else {
-			        objPtr = Tcl_NewStringObj(
-				        Tcl_GetString(imPtr->usagePtr), TCL_INDEX_NONE);
+			        objPtr = Tcl_NewStringObj(Tcl_GetString(
+					ItclArgListUsage(imPtr->argListPtr)),
+					TCL_INDEX_NONE);
 			    }
                         } else {
                             objPtr = Tcl_NewStringObj("<undefined>", TCL_INDEX_NONE);
@@ -4446,7 +4455,8 @@ Itcl_BiInfoInstancesCmd(
     listPtr = Tcl_NewListObj(0, NULL);
     FOREACH_HASH_VALUE(ioPtr, &infoPtr->objects) {
 	/* FIXME need to scan the inheritance too */
-	if (ioPtr->iclsPtr == iclsPtr) {
+	if ((ioPtr->iclsPtr == iclsPtr)
+		&& !(ioPtr->flags & ITCL_OBJECT_HIDDEN)) {
 	    if (ioPtr->iclsPtr->flags & ITCL_WIDGETADAPTOR) {
 		objPtr = Tcl_NewStringObj(Tcl_GetCommandName(interp,
 		ioPtr->accessCmd), TCL_INDEX_NONE);
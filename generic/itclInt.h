@@ -33,6 +33,7 @@
 
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
 #include <tclOO.h>
 #include "itcl.h"
 #include "itclMigrate2TclCore.h"
@@ -68,6 +69,9 @@
 #if (TCL_MAJOR_VERSION == 8) && (TCL_MINOR_VERSION < 7) && !defined(Tcl_Size)
 #    define Tcl_Size int
 #endif
+#ifndef TCL_SIZE_MAX
+#    define TCL_SIZE_MAX INT_MAX
+#endif
 
 #ifndef JOIN
 #  define JOIN(a,b) JOIN1(a,b)
@@ -139,10 +143,30 @@ typedef struct ItclFoundation {
     Tcl_Command dispatchCommand;
 } ItclFoundation;
 
-typedef struct ItclArgList {
-    struct ItclArgList *nextPtr;        /* pointer to next argument */
+typedef struct ItclArg {
     Tcl_Obj *namePtr;           /* name of the argument */
     Tcl_Obj *defaultValuePtr;   /* default value or NULL if none */
+} ItclArg;
+
+/*
+ *  Parsed argument list of a method, proc or ensemble part.  Lists are
+ *  interned by their string and never changed, so all functions with
+ *  the same arguments, like "args" or "", share one of them.
+ */
+typedef struct ItclArgList {
+    Tcl_Size refCount;          /* number of users of this list */
+    Tcl_HashEntry *hPtr;        /* entry in the argLists of ItclObjectInfo,
+                                 * or NULL if not interned */
+    Tcl_Obj *argumentPtr;       /* the argument list as defined */
+    Tcl_Obj *usagePtr;          /* usage string for error messages, built
+                                 * by ItclArgListUsage() when first
+                                 * needed, or NULL */
+    Tcl_Size argcount;          /* number of mandatory arguments */
+    Tcl_Size maxargcount;       /* max number of arguments, or
+                                 * TCL_INDEX_NONE if the last is "args" */
+    Tcl_Size numArgs;           /* number of elements in args */
+    ItclArg args[1];            /* the arguments, allocated with the
+                                 * list */
 } ItclArgList;
 
 /*
@@ -157,6 +181,69 @@ struct ItclMemberFunc;
 struct EnsembleInfo;
 struct ItclDelegatedOption;
 struct ItclDelegatedFunction;
+struct ItclProfileInfo;
+struct ItclTraceInfo;
+struct ItclEventHook;
+
+/*
+ *  Counters of the internal caches and resolvers, reported by
+ *  "itcl::stats".  They are only incremented with ITCL_STATS_INCR.
+ */
+typedef struct ItclStats {
+    Tcl_WideInt varLookupHits;      /* ItclResolveVarEntry() found the name
+                                     * in resolveVars */
+    Tcl_WideInt varLookupMisses;    /* ItclResolveVarEntry() had to extend
+                                     * resolveVars */
+    Tcl_WideInt varLookupsAllocated;/* ItclVarLookup entries created */
+    Tcl_WideInt contextCacheHits;   /* call contexts reused from the
+                                     * contextCache of an object */
+    Tcl_WideInt contextCacheMisses; /* call contexts allocated */
+    Tcl_WideInt cmdResolverHits;    /* commands resolved by
+                                     * Itcl_ClassCmdResolver() */
+    Tcl_WideInt cmdResolverFallthroughs;
+                                    /* Itcl_ClassCmdResolver() returned
+                                     * TCL_CONTINUE */
+    Tcl_WideInt virtualTableBuilds; /* calls of Itcl_BuildVirtualTables() */
+    Tcl_WideInt memoHits;           /* calls of memoized methods answered
+                                     * from the cache */
+    Tcl_WideInt memoMisses;         /* calls of memoized methods which ran
+                                     * the body */
+    Tcl_WideInt staticCalls;        /* calls of final methods or methods of
+                                     * sealed classes bound without virtual
+                                     * lookup */
+    Tcl_WideInt chainChanges;       /* filters, mixins or forwards whose
+                                     * change redefined a TclOO class */
+} ItclStats;
+
+#ifndef ITCL_NO_STATS
+#define ITCL_STATS_INCR(infoPtr, counter) ((infoPtr)->stats.counter++)
+#else
+#define ITCL_STATS_INCR(infoPtr, counter)
+#endif
+
+/*
+ *  Phases of ItclCreateObject() timed for "itcl::stats construct".
+ */
+#define ITCL_CONSTRUCT_INSTANTIATE  0  /* TclOO object, access command and
+                                        * registration of the object */
+#define ITCL_CONSTRUCT_VARIABLES    1  /* ItclInitObjectVariables() */
+#define ITCL_CONSTRUCT_COMMANDS     2  /* ItclInitObjectCommands() */
+#define ITCL_CONSTRUCT_OPTIONS      3  /* initialization of the options */
+#define ITCL_CONSTRUCT_DELEGATION   4  /* components and DelegationInstall() */
+#define ITCL_CONSTRUCT_CONSTRUCTORS 5  /* the constructors of the classes */
+#define ITCL_CONSTRUCT_DICTINFO     6  /* ItclAddObjectsDictInfo() */
+#define ITCL_CONSTRUCT_PHASES       7
+
+/*
+ *  Time spent constructing the objects of one class, accumulated while
+ *  ITCL_INSTRUMENT_CONSTRUCT is set.
+ */
+typedef struct ItclConstructStats {
+    Tcl_WideInt objects;            /* objects constructed */
+    Tcl_WideInt errors;             /* constructions which failed */
+    Tcl_WideInt phaseTime[ITCL_CONSTRUCT_PHASES];
+                                    /* nanoseconds spent in each phase */
+} ItclConstructStats;
 
 typedef struct ItclObjectInfo {
     Tcl_Interp *interp;             /* interpreter that manages this info */
@@ -226,8 +313,51 @@ typedef struct ItclObjectInfo {
     Tcl_Obj *typeDestructorArgumentPtr;
     struct ItclObject *lastIoPtr;   /* last object constructed */
     Tcl_Command infoCmd;
+    int instrumentFlags;            /* ITCL_INSTRUMENT_* bits for the
+                                     * instrumentation currently active,
+                                     * checked on every method call */
+    struct ItclProfileInfo *profileInfoPtr;
+                                    /* data of the method call profiler
+                                     * or NULL if never started */
+    struct ItclTraceInfo *traceInfoPtr;
+                                    /* data of the event tracer or NULL
+                                     * if never started */
+    struct ItclEventHook *eventHooks;
+                                    /* hooks installed with
+                                     * Itcl_AddEventHook() */
+    int eventMask;                  /* ITCL_EVENT_* bits of all hooks,
+                                     * checked before firing an event */
+    int eventsFiring;               /* number of ItclFireEvent() calls
+                                     * active, hooks removed meanwhile
+                                     * are freed when it drops to 0 */
+    int mapMethodDirect;            /* non-zero => the next method name
+                                     * mapping is skipped, set by
+                                     * Itcl_NRInvokeMethod() and for
+                                     * calls of static methods */
+    int memoLimit;                  /* maximum number of results cached for
+                                     * a memoized method of an object */
+    ItclStats stats;                /* counters for "itcl::stats" */
+    Tcl_HashTable argLists;         /* interned ItclArgList, by their
+                                     * string */
+    const Tcl_ObjType *doubleTypePtr;
+                                    /* Tcl's "double" type, which typed
+                                     * variables of type double keep */
 } ItclObjectInfo;
 
+/*
+ * Flag bits for ItclObjectInfo instrumentFlags:
+ */
+#define ITCL_INSTRUMENT_PROFILE    0x01  /* "itcl::profile" is recording */
+#define ITCL_INSTRUMENT_TRACE      0x02  /* "itcl::trace" is recording */
+#define ITCL_INSTRUMENT_CONSTRUCT  0x04  /* "itcl::stats construct" is
+                                          * timing object construction */
+
+/*
+ * Kinds of object events for ItclTraceObject():
+ */
+#define ITCL_TRACE_CREATE          1
+#define ITCL_TRACE_DESTROY         2
+
 typedef struct EnsembleInfo {
     Tcl_HashTable ensembles;        /* list of all known ensembles */
     Tcl_HashTable subEnsembles;     /* list of all known subensembles */
@@ -258,7 +388,11 @@ typedef struct EnsembleInfo {
 #define ITCL_CLASS_NS_TEARDOWN            0x40000
 #define ITCL_CLASS_NO_VARNS_DELETE        0x80000
 #define ITCL_CLASS_SHOULD_VARNS_DELETE   0x100000
+#define ITCL_RECORD                      0x200000
 #define ITCL_CLASS_DESTRUCTOR_CALLED     0x400000
+#define ITCL_CLASS_SEALED                0x800000
+#define ITCL_CLASS_FROM_SPEC            0x1000000 /* defined by
+                                                   * Itcl_DefineClass() */
 
 
 typedef struct ItclClass {
@@ -333,8 +467,33 @@ typedef struct ItclClass {
     Tcl_Obj *typeConstructorPtr;  /* initialization for types */
     int destructorHasBeenCalled;  /* prevent multiple invocations of destrcutor */
     Tcl_Size refCount;
+    Tcl_Size numInstances;        /* number of objects of this class whose
+                                   * data is not yet freed */
+    Tcl_Size maxInstances;        /* high-water mark of numInstances since
+                                   * the last "itcl::memory -reset" */
+    ItclConstructStats *constructStatsPtr;
+                                  /* construction times of the objects of
+                                   * this class or NULL if never timed */
+    Tcl_HashTable *typedVars;     /* ItclVariable * -> offset in the buffer
+                                   * of C values of the typed instance
+                                   * variables of this class and its bases,
+                                   * or NULL */
+    Tcl_Size numTypedVars;        /* number of entries in typedVars */
+    Tcl_Size typedSize;           /* size of the buffer of their values */
+    struct ItclRecord *recordPtr; /* rows of an "itcl::record" class, or
+                                   * NULL */
+    Tcl_HashTable *indexes;       /* "itcl::index" indexes of instance
+                                   * variables, by ItclVariable, or NULL */
+    Tcl_Obj *forwardsPtr;         /* dict of the prefixes of forwarded
+                                   * methods of this class, or NULL */
 } ItclClass;
 
+/*
+ * Kinds of lists changed by ItclChangeClassChain()
+ */
+#define ITCL_CHAIN_FILTER 0
+#define ITCL_CHAIN_MIXIN  1
+
 typedef struct ItclHierIter {
     ItclClass *current;           /* current position in hierarchy */
     Itcl_Stack stack;             /* stack used for traversal */
@@ -348,6 +507,9 @@ typedef struct ItclHierIter {
 #define ITCL_TCLOO_OBJECT_IS_DELETED     0x20
 #define ITCL_OBJECT_DESTRUCT_ERROR       0x40
 #define ITCL_OBJECT_SHOULD_VARNS_DELETE  0x80
+#define ITCL_OBJECT_HIDDEN              0x100 /* not reported by "find
+                                               * objects", like the
+                                               * cursor of a record */
 #define ITCL_OBJECT_ROOT_METHOD          0x8000
 
 /*
@@ -405,6 +567,10 @@ typedef struct ItclObject {
     int noComponentTrace;         /* don't call component traces if
                                    * setting components in DelegationInstall */
     int hadConstructorError;      /* needed for multiple calls of CallItclObjectCmd */
+    char *typedData;              /* values of the typed variables, followed
+                                   * by their ItclTypedVarSlot, or NULL */
+    Tcl_HashTable *memoCaches;    /* ItclMemberFunc * -> ItclMemoCache * of
+                                   * the memoized methods called, or NULL */
 } ItclObject;
 
 #define ITCL_IGNORE_ERRS  0x002  /* useful for construction/destruction */
@@ -423,9 +589,6 @@ typedef struct ItclResolveInfo {
  */
 typedef struct ItclMemberCode {
     int flags;                  /* flags describing implementation */
-    Tcl_Size argcount;         /* number of args in arglist */
-    Tcl_Size maxargcount;      /* max number of args in arglist */
-    Tcl_Obj *usagePtr;          /* usage string for error messages */
     Tcl_Obj *argumentPtr;       /* the function arguments */
     Tcl_Obj *bodyPtr;           /* the function body */
     ItclArgList *argListPtr;    /* the parsed arguments */
@@ -465,6 +628,17 @@ typedef struct ItclMemberCode {
 #define ITCL_COMPONENT         0x800  /* non-zero => component */
 #define ITCL_TYPE_METHOD       0x1000 /* non-zero => typemethod */
 #define ITCL_METHOD            0x2000 /* non-zero => method */
+#define ITCL_FINAL             0x4000 /* non-zero => "final method" */
+#define ITCL_NONVIRTUAL        0x8000 /* non-zero => handle which calls
+                                       * exactly this implementation */
+
+/*
+ *  Methods which cannot be overridden, so that calls need no virtual
+ *  lookup.
+ */
+#define Itcl_IsStaticMethod(imPtr) \
+    ((((imPtr)->flags & ITCL_FINAL) != 0) || \
+     (((imPtr)->iclsPtr->flags & ITCL_CLASS_SEALED) != 0))
 
 /*
  *  Flag bits for ItclMember: variables
@@ -525,8 +699,6 @@ typedef struct ItclMemberFunc {
     Tcl_Command accessCmd;      /* Tcl command installed for this function */
     Tcl_Size argcount;         /* number of args in arglist */
     Tcl_Size maxargcount;      /* max number of args in arglist */
-    Tcl_Obj *usagePtr;          /* usage string for error messages */
-    Tcl_Obj *argumentPtr;       /* the function arguments */
     Tcl_Obj *builtinArgumentPtr; /* the function arguments for builtin functions */
     Tcl_Obj *origArgsPtr;       /* the argument string of the original definition */
     Tcl_Obj *bodyPtr;           /* the function body */
@@ -535,6 +707,14 @@ typedef struct ItclMemberFunc {
     void *tmPtr;                /* TclOO methodPtr */
     ItclDelegatedFunction *idmPtr;
                                 /* if the function is delegated != NULL */
+    Tcl_Obj *memoVarsPtr;       /* variables listed with "-memoize", or
+                                 * NULL if the method is not memoized */
+    int memoVersion;            /* incremented when the body changes, so
+                                 * that cached results are dropped */
+    struct ItclMemberFunc *nonVirtualPtr;
+                                /* handle for a method looked up by its
+                                 * qualified name, see Itcl_LookupMethod();
+                                 * for such a handle, the method itself */
 } ItclMemberFunc;
 
 /*
@@ -553,8 +733,28 @@ typedef struct ItclVariable {
     int initted;                /* is set when first time initted, to check
                                  * for example itcl_hull var, which can be only
 				 * initialized once */
+    int type;                   /* ITCL_VARTYPE_* of a variable declared
+                                 * with "-type", or ITCL_VARTYPE_NONE */
 } ItclVariable;
 
+/*
+ *  Types of variables declared with "variable name -type type".  The
+ *  values of these variables are mirrored in a buffer of C values in
+ *  each object, laid out by Itcl_BuildVirtualTables().
+ */
+#define ITCL_VARTYPE_NONE     0
+#define ITCL_VARTYPE_DOUBLE   1  /* double */
+#define ITCL_VARTYPE_WIDEINT  2  /* Tcl_WideInt */
+#define ITCL_VARTYPE_INT      3  /* int */
+#define ITCL_VARTYPE_BOOLEAN  4  /* int, 0 or 1 */
+
+typedef struct ItclTypedVarSlot {
+    struct ItclObject *ioPtr;   /* object owning the buffer */
+    ItclVariable *ivPtr;        /* typed variable */
+    Tcl_Var varPtr;             /* the variable of the object, or NULL */
+    void *valuePtr;             /* its value in the buffer */
+} ItclTypedVarSlot;
+
 
 struct ItclOption;
 
@@ -712,13 +912,23 @@ MODULE_SCOPE void ItclReportObjectUsage(Tcl_Interp *interp,
 MODULE_SCOPE int ItclMapMethodNameProc(Tcl_Interp *interp, Tcl_Object oPtr,
 	Tcl_Class *startClsPtr, Tcl_Obj *methodObj);
 MODULE_SCOPE int ItclCreateArgList(Tcl_Interp *interp, const char *str,
-	Tcl_Size *argcPtr, Tcl_Size *maxArgcPtr, Tcl_Obj **usagePtr,
-	ItclArgList **arglistPtrPtr, ItclMemberFunc *imPtr,
-	const char *commandName);
+	ItclArgList **arglistPtrPtr, const char *commandName);
+MODULE_SCOPE Tcl_Obj *ItclArgListUsage(ItclArgList *arglistPtr);
+MODULE_SCOPE void ItclFinishArgLists(ItclObjectInfo *infoPtr);
 MODULE_SCOPE int ItclObjectCmd(void *clientData, Tcl_Interp *interp,
 	Tcl_Object oPtr, Tcl_Class clsPtr, size_t objc, Tcl_Obj *const *objv);
 MODULE_SCOPE int ItclCreateObject (Tcl_Interp *interp, const char* name,
 	ItclClass *iclsPtr, size_t objc, Tcl_Obj *const objv[]);
+MODULE_SCOPE int ItclCreateUnconstructedObject(Tcl_Interp *interp,
+	const char *name, ItclClass *iclsPtr, ItclObject **ioPtrPtr);
+MODULE_SCOPE int ItclCloneObject(Tcl_Interp *interp, ItclObject *ioPtr,
+	const char *name, ItclObject **ioPtrPtr);
+MODULE_SCOPE Tcl_Obj *ItclGetArrayElements(Tcl_Interp *interp,
+	Tcl_Var var);
+MODULE_SCOPE int ItclSetArrayElements(Tcl_Interp *interp, Tcl_Var var,
+	Tcl_Obj *listPtr);
+MODULE_SCOPE const char *ItclAutoObjectName(Tcl_Interp *interp,
+	ItclClass *iclsPtr, Tcl_DString *bufferPtr);
 MODULE_SCOPE void ItclDeleteObjectVariablesNamespace(Tcl_Interp *interp,
 	ItclObject *ioPtr);
 MODULE_SCOPE void ItclDeleteClassVariablesNamespace(Tcl_Interp *interp,
@@ -760,7 +970,7 @@ MODULE_SCOPE int Itcl_WidgetParseInit(Tcl_Interp *interp,
 	ItclObjectInfo *infoPtr);
 MODULE_SCOPE void ItclDeleteObjectMetadata(void *clientData);
 MODULE_SCOPE void ItclDeleteClassMetadata(void *clientData);
-MODULE_SCOPE void ItclDeleteArgList(ItclArgList *arglistPtr);
+MODULE_SCOPE void ItclReleaseArgList(ItclArgList *arglistPtr);
 MODULE_SCOPE int Itcl_ClassOptionCmd(void *clientData, Tcl_Interp *interp,
 	int objc, Tcl_Obj *const objv[]);
 MODULE_SCOPE int DelegatedOptionsInstall(Tcl_Interp *interp,
@@ -822,6 +1032,64 @@ MODULE_SCOPE int ItclClassCreateObject(void *clientData, Tcl_Interp *interp,
 
 MODULE_SCOPE void ItclRestoreInfoVars(void *clientData);
 
+MODULE_SCOPE Tcl_WideInt ItclGetMonotonicTime(void);
+MODULE_SCOPE int ItclProfileInit(Tcl_Interp *interp, ItclObjectInfo *infoPtr);
+MODULE_SCOPE void ItclProfileFinish(ItclObjectInfo *infoPtr);
+MODULE_SCOPE void ItclProfileEnter(ItclObjectInfo *infoPtr,
+	ItclMemberFunc *imPtr);
+MODULE_SCOPE void ItclProfileLeave(ItclObjectInfo *infoPtr,
+	ItclMemberFunc *imPtr, int result);
+MODULE_SCOPE void ItclProfileForget(ItclObjectInfo *infoPtr,
+	ItclMemberFunc *imPtr);
+MODULE_SCOPE int ItclStatsInit(Tcl_Interp *interp, ItclObjectInfo *infoPtr);
+MODULE_SCOPE int ItclTraceInit(Tcl_Interp *interp, ItclObjectInfo *infoPtr);
+MODULE_SCOPE void ItclTraceFinish(ItclObjectInfo *infoPtr);
+MODULE_SCOPE void ItclTraceEnter(ItclObjectInfo *infoPtr,
+	ItclMemberFunc *imPtr, ItclObject *ioPtr);
+MODULE_SCOPE void ItclTraceLeave(ItclObjectInfo *infoPtr,
+	ItclMemberFunc *imPtr, int result);
+MODULE_SCOPE void ItclTraceObject(ItclObjectInfo *infoPtr, int kind,
+	ItclObject *ioPtr, Tcl_WideInt start, int result);
+MODULE_SCOPE void ItclHookFinish(ItclObjectInfo *infoPtr);
+MODULE_SCOPE void ItclFireEvent(ItclObjectInfo *infoPtr, int type,
+	ItclClass *iclsPtr, ItclObject *ioPtr, ItclMemberFunc *imPtr,
+	int result);
+MODULE_SCOPE int ItclGetTypedValue(Tcl_Interp *interp, int type,
+	Tcl_Obj *objPtr, void *valuePtr);
+MODULE_SCOPE Tcl_ObjCmdProc Itcl_RecordCmd;
+MODULE_SCOPE int ItclRecordCmd(ItclClass *iclsPtr, Tcl_Interp *interp,
+	int objc, Tcl_Obj *const objv[]);
+MODULE_SCOPE void ItclDeleteRecord(ItclClass *iclsPtr);
+MODULE_SCOPE void ItclDestroyRecord(ItclClass *iclsPtr);
+MODULE_SCOPE int ItclIndexInit(Tcl_Interp *interp, ItclObjectInfo *infoPtr);
+MODULE_SCOPE int ItclIndexObject(Tcl_Interp *interp, ItclObject *ioPtr);
+MODULE_SCOPE void ItclIndexForgetObject(ItclObject *ioPtr);
+MODULE_SCOPE void ItclDeleteIndexes(ItclClass *iclsPtr);
+MODULE_SCOPE int ItclSerializeInit(Tcl_Interp *interp,
+	ItclObjectInfo *infoPtr);
+MODULE_SCOPE int ItclMemoInit(Tcl_Interp *interp, ItclObjectInfo *infoPtr);
+MODULE_SCOPE int ItclMemoCheckVars(Tcl_Interp *interp,
+	ItclMemberFunc *imPtr);
+MODULE_SCOPE void ItclMemoLookup(Tcl_Interp *interp, ItclObject *ioPtr,
+	ItclMemberFunc *imPtr, Tcl_Size objc, Tcl_Obj *const objv[],
+	int *isFinished);
+MODULE_SCOPE void ItclMemoStore(Tcl_Interp *interp, ItclObject *ioPtr,
+	ItclMemberFunc *imPtr, int result);
+MODULE_SCOPE void ItclMemoClearObject(ItclObject *ioPtr,
+	ItclMemberFunc *imPtr);
+MODULE_SCOPE void ItclMemoForgetObject(ItclObject *ioPtr);
+MODULE_SCOPE void ItclMemoFreeObject(ItclObject *ioPtr);
+MODULE_SCOPE int ItclChangeClassChain(Tcl_Interp *interp,
+	ItclClass *iclsPtr, int kind, int add, Tcl_Size objc,
+	Tcl_Obj *const objv[]);
+MODULE_SCOPE int ItclAddForward(Tcl_Interp *interp, ItclClass *iclsPtr,
+	Tcl_Obj *nameObj, Tcl_Obj *prefixObj);
+MODULE_SCOPE void ItclUnregisterC(Tcl_Interp *interp, const char *name);
+MODULE_SCOPE Tcl_ObjCmdProc Itcl_StateGetCmd;
+MODULE_SCOPE Tcl_ObjCmdProc Itcl_StateSetCmd;
+MODULE_SCOPE Tcl_ObjCmdProc Itcl_ColumnGetCmd;
+MODULE_SCOPE Tcl_ObjCmdProc Itcl_ColumnSetCmd;
+
 MODULE_SCOPE Tcl_ObjCmdProc Itcl_BiMyProcCmd;
 MODULE_SCOPE Tcl_ObjCmdProc Itcl_BiInstallComponentCmd;
 MODULE_SCOPE Tcl_ObjCmdProc Itcl_BiCallInstanceCmd;
@@ -8,7 +8,7 @@
 /* !BEGIN!: Do not edit below this line. */
 
 #define ITCLINT_STUBS_EPOCH 0
-#define ITCLINT_STUBS_REVISION 152
+#define ITCLINT_STUBS_REVISION 162
 
 #ifdef __cplusplus
 extern "C" {
@@ -503,6 +503,30 @@ ITCLAPI void		Itcl_UnsetContext(Tcl_Interp *interp);
 ITCLAPI const char *	ItclGetInstanceVar(Tcl_Interp *interp,
 				const char *name, const char *name2,
 				ItclObject *ioPtr, ItclClass *iclsPtr);
+/* 185 */
+ITCLAPI ItclVariable *	Itcl_LookupMemberVar(Tcl_Interp *interp,
+				ItclClass *iclsPtr, const char *name);
+/* 186 */
+ITCLAPI Tcl_Obj *	Itcl_GetVarByHandle(Tcl_Interp *interp,
+				ItclObject *ioPtr, ItclVariable *ivPtr);
+/* 187 */
+ITCLAPI Tcl_Obj *	Itcl_SetVarByHandle(Tcl_Interp *interp,
+				ItclObject *ioPtr, ItclVariable *ivPtr,
+				Tcl_Obj *valuePtr);
+/* 188 */
+ITCLAPI ItclMemberFunc * Itcl_LookupMethod(Tcl_Interp *interp,
+				ItclClass *iclsPtr, const char *name);
+/* 189 */
+ITCLAPI int		Itcl_InvokeMethod(Tcl_Interp *interp,
+				ItclObject *ioPtr, ItclMemberFunc *imPtr,
+				Tcl_Size objc, Tcl_Obj *const objv[]);
+/* 190 */
+ITCLAPI int		Itcl_NRInvokeMethod(Tcl_Interp *interp,
+				ItclObject *ioPtr, ItclMemberFunc *imPtr,
+				Tcl_Size objc, Tcl_Obj *const objv[]);
+/* 191 */
+ITCLAPI void *		Itcl_GetTypedVarPtr(ItclObject *ioPtr,
+				ItclVariable *ivPtr);
 
 typedef struct ItclIntStubs {
     int magic;
@@ -695,6 +719,13 @@ typedef struct ItclIntStubs {
     void (*itcl_SetContext) (Tcl_Interp *interp, ItclObject *ioPtr); /* 182 */
     void (*itcl_UnsetContext) (Tcl_Interp *interp); /* 183 */
     const char * (*itclGetInstanceVar) (Tcl_Interp *interp, const char *name, const char *name2, ItclObject *ioPtr, ItclClass *iclsPtr); /* 184 */
+    ItclVariable * (*itcl_LookupMemberVar) (Tcl_Interp *interp, ItclClass *iclsPtr, const char *name); /* 185 */
+    Tcl_Obj * (*itcl_GetVarByHandle) (Tcl_Interp *interp, ItclObject *ioPtr, ItclVariable *ivPtr); /* 186 */
+    Tcl_Obj * (*itcl_SetVarByHandle) (Tcl_Interp *interp, ItclObject *ioPtr, ItclVariable *ivPtr, Tcl_Obj *valuePtr); /* 187 */
+    ItclMemberFunc * (*itcl_LookupMethod) (Tcl_Interp *interp, ItclClass *iclsPtr, const char *name); /* 188 */
+    int (*itcl_InvokeMethod) (Tcl_Interp *interp, ItclObject *ioPtr, ItclMemberFunc *imPtr, Tcl_Size objc, Tcl_Obj *const objv[]); /* 189 */
+    int (*itcl_NRInvokeMethod) (Tcl_Interp *interp, ItclObject *ioPtr, ItclMemberFunc *imPtr, Tcl_Size objc, Tcl_Obj *const objv[]); /* 190 */
+    void * (*itcl_GetTypedVarPtr) (ItclObject *ioPtr, ItclVariable *ivPtr); /* 191 */
 } ItclIntStubs;
 
 extern const ItclIntStubs *itclIntStubsPtr;
@@ -1020,6 +1051,20 @@ extern const ItclIntStubs *itclIntStubsPtr;
 	(itclIntStubsPtr->itcl_UnsetContext) /* 183 */
 #define ItclGetInstanceVar \
 	(itclIntStubsPtr->itclGetInstanceVar) /* 184 */
+#define Itcl_LookupMemberVar \
+	(itclIntStubsPtr->itcl_LookupMemberVar) /* 185 */
+#define Itcl_GetVarByHandle \
+	(itclIntStubsPtr->itcl_GetVarByHandle) /* 186 */
+#define Itcl_SetVarByHandle \
+	(itclIntStubsPtr->itcl_SetVarByHandle) /* 187 */
+#define Itcl_LookupMethod \
+	(itclIntStubsPtr->itcl_LookupMethod) /* 188 */
+#define Itcl_InvokeMethod \
+	(itclIntStubsPtr->itcl_InvokeMethod) /* 189 */
+#define Itcl_NRInvokeMethod \
+	(itclIntStubsPtr->itcl_NRInvokeMethod) /* 190 */
+#define Itcl_GetTypedVarPtr \
+	(itclIntStubsPtr->itcl_GetTypedVarPtr) /* 191 */
 
 #endif /* defined(USE_ITCL_STUBS) */
 
@@ -260,6 +260,41 @@ Itcl_FindC(
 }
 
 
+/*
+ * ------------------------------------------------------------------------
+ *  ItclUnregisterC()
+ *
+ *  Removes the procedure registered under a symbolic name by
+ *  Itcl_RegisterC() or Itcl_RegisterObjC(), if any, so that the name
+ *  can be registered again with another procedure.  Members already
+ *  defined with the procedure keep it.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclUnregisterC(
+    Tcl_Interp *interp,           /* interpreter handling this registration */
+    const char *name)             /* symbolic name for procedure */
+{
+    Tcl_HashEntry *entry;
+    Tcl_HashTable *procTable;
+    ItclCfunc *cfunc;
+
+    procTable = (Tcl_HashTable*)Tcl_GetAssocData(interp, "itcl_RegC", NULL);
+    if (procTable == NULL) {
+        return;
+    }
+    entry = Tcl_FindHashEntry(procTable, name);
+    if (entry) {
+        cfunc = (ItclCfunc*)Tcl_GetHashValue(entry);
+        if (cfunc->deleteProc != NULL) {
+            (*cfunc->deleteProc)(cfunc->clientData);
+        }
+        ckfree((char*)cfunc);
+        Tcl_DeleteHashEntry(entry);
+    }
+}
+
+
 /*
  * ------------------------------------------------------------------------
  *  ItclGetRegisteredProcs()
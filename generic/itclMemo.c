@@ -0,0 +1,683 @@
+/*
+ * itclMemo.c --
+ *
+ *	This file implements memoized methods, declared in a class with
+ *
+ *	    method name args -memoize varList ?body?
+ *
+ *	The results of these methods are cached per object, keyed by the
+ *	values of the arguments.  The cache of a method in an object is
+ *	created by its first call, and puts a write/unset trace on each
+ *	instance variable of varList, which drops all cached results as
+ *	soon as one of them changes.  The caches are cleared and limited
+ *	with "itcl::memo".
+ *
+ * See the file "license.terms" for information on usage and redistribution of
+ * this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ */
+
+#include "tclInt.h"
+#include "itclInt.h"
+
+/*
+ *  Flags of the variables which cannot be listed: commons and the
+ *  built-in variables.
+ */
+#define ITCL_MEMO_IGNORED_VARS (ITCL_COMMON|ITCL_THIS_VAR|ITCL_OPTIONS_VAR| \
+	ITCL_TYPE_VAR|ITCL_SELF_VAR|ITCL_SELFNS_VAR|ITCL_WIN_VAR| \
+	ITCL_HULL_VAR|ITCL_OPTION_COMP_VAR)
+
+/*
+ *  Default for the number of results cached for one method of one
+ *  object, see "itcl::memo limit".
+ */
+#define ITCL_MEMO_DEFAULT_LIMIT 1000
+
+/*
+ * The cached results of a memoized method in an object.  It is the
+ * client data of the traces on the listed variables of the object.
+ */
+
+typedef struct ItclMemoCache {
+    ItclObject *ioPtr;            /* object */
+    ItclMemberFunc *imPtr;        /* memoized method */
+    int version;                  /* memoVersion of the method the results
+                                   * were computed with */
+    Tcl_WideInt epoch;            /* incremented whenever the results are
+                                   * dropped */
+    Tcl_HashTable results;        /* argument list -> Tcl_Obj * result */
+    Tcl_Obj *tracedPtr;           /* full names of the traced variables,
+                                   * or NULL while there are no traces */
+    Itcl_Stack calls;             /* ItclMemoCall of the active calls,
+                                   * innermost on top */
+} ItclMemoCache;
+
+/*
+ * An active call of a memoized method which missed the cache.
+ */
+
+typedef struct ItclMemoCall {
+    Tcl_Obj *keyPtr;              /* argument list, or NULL if the result
+                                   * must not be cached */
+    Tcl_WideInt epoch;            /* epoch of the cache when called */
+} ItclMemoCall;
+
+static const char *const memoOptions[] = {
+    "clear", "limit", "size", NULL
+};
+enum MemoOption {
+    MEMO_CLEAR, MEMO_LIMIT, MEMO_SIZE
+};
+
+static Tcl_ObjCmdProc Itcl_MemoCmd;
+static int FindMemoVar(Tcl_Interp *interp, ItclMemberFunc *imPtr,
+	Tcl_Obj *namePtr, ItclVariable **ivPtrPtr);
+static int FindMemoObject(Tcl_Interp *interp, Tcl_Obj *namePtr,
+	Tcl_Obj *methodPtr, ItclObject **ioPtrPtr, ItclMemberFunc **imPtrPtr);
+static ItclMemoCache *GetCache(ItclObject *ioPtr, ItclMemberFunc *imPtr);
+static void DropResults(ItclMemoCache *cachePtr);
+static void ClearResults(ItclMemoCache *cachePtr);
+static void TraceCache(ItclMemoCache *cachePtr, int untrace);
+static char *ItclTraceMemoVar(void *cdata, Tcl_Interp *interp,
+	const char *name1, const char *name2, int flags);
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclMemoInit()
+ *
+ *  Invoked by Itcl_Init() to install the "itcl::memo" command.
+ * ------------------------------------------------------------------------
+ */
+int
+ItclMemoInit(
+    Tcl_Interp *interp,          /* interpreter to be updated */
+    ItclObjectInfo *infoPtr)     /* info regarding all known objects */
+{
+    infoPtr->memoLimit = ITCL_MEMO_DEFAULT_LIMIT;
+    Tcl_CreateObjCommand(interp, "::itcl::memo", Itcl_MemoCmd,
+        infoPtr, Itcl_ReleaseData);
+    Itcl_PreserveData(infoPtr);
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_MemoCmd()
+ *
+ *  Manages the caches of memoized methods.  Handles the following
+ *  syntax:
+ *
+ *    itcl::memo clear ?<objName>? ?<methodName>?
+ *    itcl::memo limit ?<size>?
+ *    itcl::memo size <objName> ?<methodName>?
+ *
+ *  Returns TCL_OK/TCL_ERROR to indicate success/failure.
+ * ------------------------------------------------------------------------
+ */
+static int
+Itcl_MemoCmd(
+    void *clientData,        /* infoPtr */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)clientData;
+    ItclObject *ioPtr;
+    ItclMemberFunc *imPtr;
+    ItclMemoCache *cachePtr;
+    Tcl_WideInt size;
+    int index;
+    int limit;
+    FOREACH_HASH_DECLS;
+
+    if (objc < 2) {
+	Tcl_WrongNumArgs(interp, 1, objv, "option ?arg ...?");
+	return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[1], memoOptions, "option", 0,
+	    &index) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    switch ((enum MemoOption)index) {
+    case MEMO_CLEAR:
+	if (objc > 4) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "?objName? ?methodName?");
+	    return TCL_ERROR;
+	}
+	if (objc == 2) {
+	    FOREACH_HASH_VALUE(ioPtr, &infoPtr->objects) {
+		ItclMemoClearObject(ioPtr, NULL);
+	    }
+	    return TCL_OK;
+	}
+	if (FindMemoObject(interp, objv[2], (objc == 4) ? objv[3] : NULL,
+		&ioPtr, &imPtr) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	ItclMemoClearObject(ioPtr, imPtr);
+	return TCL_OK;
+
+    case MEMO_LIMIT:
+	if (objc > 3) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "?size?");
+	    return TCL_ERROR;
+	}
+	if (objc == 3) {
+	    if (Tcl_GetIntFromObj(interp, objv[2], &limit) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    if (limit < 1) {
+		Tcl_AppendResult(interp, "bad size \"", Tcl_GetString(objv[2]),
+			"\": must be a positive integer", NULL);
+		return TCL_ERROR;
+	    }
+	    infoPtr->memoLimit = limit;
+	}
+	Tcl_SetObjResult(interp, Tcl_NewIntObj(infoPtr->memoLimit));
+	return TCL_OK;
+
+    case MEMO_SIZE:
+	if ((objc < 3) || (objc > 4)) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "objName ?methodName?");
+	    return TCL_ERROR;
+	}
+	if (FindMemoObject(interp, objv[2], (objc == 4) ? objv[3] : NULL,
+		&ioPtr, &imPtr) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	size = 0;
+	if (ioPtr->memoCaches != NULL) {
+	    FOREACH_HASH_VALUE(cachePtr, ioPtr->memoCaches) {
+		if ((imPtr == NULL) || (cachePtr->imPtr == imPtr)) {
+		    size += cachePtr->results.numEntries;
+		}
+	    }
+	}
+	Tcl_SetObjResult(interp, Tcl_NewWideIntObj(size));
+	return TCL_OK;
+    }
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  FindMemoObject()
+ *
+ *  Looks up the object and, if methodPtr is not NULL, the memoized
+ *  method named in the arguments of "itcl::memo".  Returns TCL_OK, or
+ *  TCL_ERROR (along with an error message in the interpreter) if the
+ *  object does not exist or has no such memoized method.
+ * ------------------------------------------------------------------------
+ */
+static int
+FindMemoObject(
+    Tcl_Interp *interp,           /* current interpreter */
+    Tcl_Obj *namePtr,             /* name of the object */
+    Tcl_Obj *methodPtr,           /* name of a method or NULL */
+    ItclObject **ioPtrPtr,        /* returns the object */
+    ItclMemberFunc **imPtrPtr)    /* returns the method or NULL */
+{
+    ItclObject *ioPtr = NULL;
+    ItclMemberFunc *imPtr = NULL;
+
+    if ((Itcl_FindObject(interp, Tcl_GetString(namePtr), &ioPtr) != TCL_OK)
+	    || (ioPtr == NULL)) {
+	Tcl_ResetResult(interp);
+	Tcl_AppendResult(interp, "object \"", Tcl_GetString(namePtr),
+		"\" not found", NULL);
+	return TCL_ERROR;
+    }
+    if (methodPtr != NULL) {
+	imPtr = Itcl_LookupMethod(NULL, ioPtr->iclsPtr,
+		Tcl_GetString(methodPtr));
+	if ((imPtr == NULL) || (imPtr->memoVarsPtr == NULL)) {
+	    Tcl_AppendResult(interp, "method \"", Tcl_GetString(methodPtr),
+		    "\" of object \"", Tcl_GetString(namePtr),
+		    "\" is not memoized", NULL);
+	    return TCL_ERROR;
+	}
+    }
+    *ioPtrPtr = ioPtr;
+    *imPtrPtr = imPtr;
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  FindMemoVar()
+ *
+ *  Resolves the name of a variable listed for a memoized method in the
+ *  class of the method.  Returns TCL_OK, or TCL_ERROR (along with an
+ *  error message in the interpreter) if it is not an instance variable.
+ * ------------------------------------------------------------------------
+ */
+static int
+FindMemoVar(
+    Tcl_Interp *interp,      /* current interpreter or NULL */
+    ItclMemberFunc *imPtr,   /* memoized method */
+    Tcl_Obj *namePtr,        /* name of the variable */
+    ItclVariable **ivPtrPtr) /* returns the variable */
+{
+    Tcl_HashEntry *hPtr;
+    ItclVariable *ivPtr = NULL;
+
+    hPtr = ItclResolveVarEntry(imPtr->iclsPtr, Tcl_GetString(namePtr));
+    if (hPtr != NULL) {
+	ivPtr = ((ItclVarLookup *)Tcl_GetHashValue(hPtr))->ivPtr;
+    }
+    if ((ivPtr == NULL) || (ivPtr->flags & ITCL_MEMO_IGNORED_VARS)) {
+	if (interp != NULL) {
+	    Tcl_AppendResult(interp, "\"", Tcl_GetString(namePtr),
+		    "\" is not an instance variable of class \"",
+		    Tcl_GetString(imPtr->iclsPtr->fullNamePtr), "\"", NULL);
+	}
+	return TCL_ERROR;
+    }
+    *ivPtrPtr = ivPtr;
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclMemoCheckVars()
+ *
+ *  Invoked once the definition of a class is parsed, to check that the
+ *  variables listed for a memoized method are instance variables.
+ *  Returns TCL_OK, or TCL_ERROR (along with an error message in the
+ *  interpreter) if one is not.
+ * ------------------------------------------------------------------------
+ */
+int
+ItclMemoCheckVars(
+    Tcl_Interp *interp,      /* current interpreter */
+    ItclMemberFunc *imPtr)   /* memoized method */
+{
+    ItclVariable *ivPtr;
+    Tcl_Obj **namev;
+    Tcl_Size namec;
+    Tcl_Size i;
+
+    if (Tcl_ListObjGetElements(interp, imPtr->memoVarsPtr, &namec, &namev)
+	    != TCL_OK) {
+	return TCL_ERROR;
+    }
+    for (i = 0; i < namec; i++) {
+	if (FindMemoVar(interp, imPtr, namev[i], &ivPtr) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+    }
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclMemoLookup()
+ *
+ *  Invoked by ItclCheckCallMethod() before the body of a memoized
+ *  method is run, with the arguments of the call.  If a result is
+ *  cached for them, it is left in the interpreter and isFinished is
+ *  set, so that the body is skipped.  Otherwise the call is recorded
+ *  for ItclMemoStore().
+ * ------------------------------------------------------------------------
+ */
+void
+ItclMemoLookup(
+    Tcl_Interp *interp,      /* current interpreter */
+    ItclObject *ioPtr,       /* object */
+    ItclMemberFunc *imPtr,   /* memoized method */
+    Tcl_Size objc,           /* number of arguments, or -1 if unknown */
+    Tcl_Obj *const objv[],   /* arguments */
+    int *isFinished)         /* set if a cached result is returned */
+{
+    ItclMemoCache *cachePtr;
+    ItclMemoCall *callPtr;
+    Tcl_HashEntry *hPtr;
+    Tcl_Obj *keyPtr = NULL;
+
+    *isFinished = 0;
+    cachePtr = GetCache(ioPtr, imPtr);
+    if (cachePtr->version != imPtr->memoVersion) {
+	DropResults(cachePtr);
+	cachePtr->version = imPtr->memoVersion;
+    }
+    if ((objc >= 0) && (cachePtr->tracedPtr != NULL)) {
+	keyPtr = Tcl_NewListObj(objc, objv);
+	Tcl_IncrRefCount(keyPtr);
+	hPtr = Tcl_FindHashEntry(&cachePtr->results, Tcl_GetString(keyPtr));
+	if (hPtr != NULL) {
+	    ITCL_STATS_INCR(imPtr->infoPtr, memoHits);
+	    Tcl_SetObjResult(interp, (Tcl_Obj *)Tcl_GetHashValue(hPtr));
+	    Tcl_DecrRefCount(keyPtr);
+	    *isFinished = 1;
+	    return;
+	}
+	ITCL_STATS_INCR(imPtr->infoPtr, memoMisses);
+    }
+    callPtr = (ItclMemoCall *)ckalloc(sizeof(ItclMemoCall));
+    callPtr->keyPtr = keyPtr;
+    callPtr->epoch = cachePtr->epoch;
+    Itcl_PushStack(callPtr, &cachePtr->calls);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclMemoStore()
+ *
+ *  Invoked by ItclAfterCallMethod() once the body of a memoized method
+ *  recorded by ItclMemoLookup() has run.  The result in the
+ *  interpreter is cached, unless the call failed or a listed variable
+ *  changed meanwhile.  If the cache is full, it is emptied first.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclMemoStore(
+    Tcl_Interp *interp,      /* current interpreter */
+    ItclObject *ioPtr,       /* object */
+    ItclMemberFunc *imPtr,   /* memoized method */
+    int result)              /* completion code of the body */
+{
+    ItclMemoCache *cachePtr;
+    ItclMemoCall *callPtr;
+    Tcl_HashEntry *hPtr = NULL;
+    Tcl_Obj *valuePtr;
+    int isNew;
+
+    if (ioPtr->memoCaches != NULL) {
+	hPtr = Tcl_FindHashEntry(ioPtr->memoCaches, (char *)imPtr);
+    }
+    if (hPtr == NULL) {
+	return;
+    }
+    cachePtr = (ItclMemoCache *)Tcl_GetHashValue(hPtr);
+    callPtr = (ItclMemoCall *)Itcl_PopStack(&cachePtr->calls);
+    if (callPtr == NULL) {
+	return;
+    }
+    if ((result == TCL_OK) && (callPtr->keyPtr != NULL)
+	    && (callPtr->epoch == cachePtr->epoch)
+	    && (cachePtr->tracedPtr != NULL)) {
+	if (cachePtr->results.numEntries >= imPtr->infoPtr->memoLimit) {
+	    ClearResults(cachePtr);
+	}
+	hPtr = Tcl_CreateHashEntry(&cachePtr->results,
+		Tcl_GetString(callPtr->keyPtr), &isNew);
+	if (!isNew) {
+	    Tcl_DecrRefCount((Tcl_Obj *)Tcl_GetHashValue(hPtr));
+	}
+	valuePtr = Tcl_GetObjResult(interp);
+	Tcl_IncrRefCount(valuePtr);
+	Tcl_SetHashValue(hPtr, valuePtr);
+    }
+    if (callPtr->keyPtr != NULL) {
+	Tcl_DecrRefCount(callPtr->keyPtr);
+    }
+    ckfree(callPtr);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclMemoClearObject()
+ *
+ *  Drops the cached results of a memoized method of an object, or of
+ *  all its memoized methods if imPtr is NULL.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclMemoClearObject(
+    ItclObject *ioPtr,       /* object */
+    ItclMemberFunc *imPtr)   /* memoized method or NULL */
+{
+    ItclMemoCache *cachePtr;
+    FOREACH_HASH_DECLS;
+
+    if (ioPtr->memoCaches == NULL) {
+	return;
+    }
+    FOREACH_HASH_VALUE(cachePtr, ioPtr->memoCaches) {
+	if ((imPtr == NULL) || (cachePtr->imPtr == imPtr)) {
+	    DropResults(cachePtr);
+	}
+    }
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclMemoForgetObject()
+ *
+ *  Invoked when an object is destroyed, to remove the traces of its
+ *  caches and drop the cached results.  The caches themselves are
+ *  freed by ItclMemoFreeObject(), once no call is active any more.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclMemoForgetObject(
+    ItclObject *ioPtr)       /* object being destroyed */
+{
+    ItclMemoCache *cachePtr;
+    FOREACH_HASH_DECLS;
+
+    if (ioPtr->memoCaches == NULL) {
+	return;
+    }
+    FOREACH_HASH_VALUE(cachePtr, ioPtr->memoCaches) {
+	TraceCache(cachePtr, 1);
+	DropResults(cachePtr);
+    }
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclMemoFreeObject()
+ *
+ *  Invoked by FreeObject() to free the caches of an object.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclMemoFreeObject(
+    ItclObject *ioPtr)       /* object being freed */
+{
+    ItclMemoCache *cachePtr;
+    ItclMemoCall *callPtr;
+    FOREACH_HASH_DECLS;
+
+    if (ioPtr->memoCaches == NULL) {
+	return;
+    }
+    FOREACH_HASH_VALUE(cachePtr, ioPtr->memoCaches) {
+	TraceCache(cachePtr, 1);
+	ClearResults(cachePtr);
+	Tcl_DeleteHashTable(&cachePtr->results);
+	while ((callPtr = (ItclMemoCall *)Itcl_PopStack(&cachePtr->calls))
+		!= NULL) {
+	    if (callPtr->keyPtr != NULL) {
+		Tcl_DecrRefCount(callPtr->keyPtr);
+	    }
+	    ckfree(callPtr);
+	}
+	Itcl_DeleteStack(&cachePtr->calls);
+	ckfree(cachePtr);
+    }
+    Tcl_DeleteHashTable(ioPtr->memoCaches);
+    ckfree(ioPtr->memoCaches);
+    ioPtr->memoCaches = NULL;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  GetCache()
+ *
+ *  Returns the cache of a memoized method in an object.  It is created
+ *  on first use, with the traces on the listed variables, unless the
+ *  object is being destroyed.
+ * ------------------------------------------------------------------------
+ */
+static ItclMemoCache *
+GetCache(
+    ItclObject *ioPtr,       /* object */
+    ItclMemberFunc *imPtr)   /* memoized method */
+{
+    ItclMemoCache *cachePtr;
+    Tcl_HashEntry *hPtr;
+    int isNew;
+
+    if (ioPtr->memoCaches == NULL) {
+	ioPtr->memoCaches = (Tcl_HashTable *)ckalloc(sizeof(Tcl_HashTable));
+	Tcl_InitHashTable(ioPtr->memoCaches, TCL_ONE_WORD_KEYS);
+    }
+    hPtr = Tcl_CreateHashEntry(ioPtr->memoCaches, (char *)imPtr, &isNew);
+    if (!isNew) {
+	return (ItclMemoCache *)Tcl_GetHashValue(hPtr);
+    }
+    cachePtr = (ItclMemoCache *)ckalloc(sizeof(ItclMemoCache));
+    cachePtr->ioPtr = ioPtr;
+    cachePtr->imPtr = imPtr;
+    cachePtr->version = imPtr->memoVersion;
+    cachePtr->epoch = 0;
+    Tcl_InitHashTable(&cachePtr->results, TCL_STRING_KEYS);
+    cachePtr->tracedPtr = NULL;
+    Itcl_InitStack(&cachePtr->calls);
+    Tcl_SetHashValue(hPtr, cachePtr);
+    if (!(ioPtr->flags & (ITCL_OBJECT_IS_DELETED|ITCL_OBJECT_IS_DESTRUCTED|
+	    ITCL_OBJECT_IS_DESTROYED))) {
+	TraceCache(cachePtr, 0);
+    }
+    return cachePtr;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  DropResults()
+ *
+ *  Drops the cached results of a cache, and makes sure that the calls
+ *  active meanwhile do not cache theirs.
+ * ------------------------------------------------------------------------
+ */
+static void
+DropResults(
+    ItclMemoCache *cachePtr) /* cache of a method in an object */
+{
+    cachePtr->epoch++;
+    ClearResults(cachePtr);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ClearResults()
+ *
+ *  Frees the cached results of a cache.
+ * ------------------------------------------------------------------------
+ */
+static void
+ClearResults(
+    ItclMemoCache *cachePtr) /* cache of a method in an object */
+{
+    Tcl_Obj *valuePtr;
+    FOREACH_HASH_DECLS;
+
+    FOREACH_HASH_VALUE(valuePtr, &cachePtr->results) {
+	Tcl_DecrRefCount(valuePtr);
+    }
+    Tcl_DeleteHashTable(&cachePtr->results);
+    Tcl_InitHashTable(&cachePtr->results, TCL_STRING_KEYS);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  TraceCache()
+ *
+ *  Puts the traces of a cache on the listed variables of its object,
+ *  or removes them if untrace is non-zero.  Results are only cached
+ *  while the traces are set.
+ * ------------------------------------------------------------------------
+ */
+static void
+TraceCache(
+    ItclMemoCache *cachePtr, /* cache of a method in an object */
+    int untrace)             /* non-zero to remove the traces */
+{
+    Tcl_Interp *interp = cachePtr->ioPtr->interp;
+    ItclVariable *ivPtr;
+    Tcl_HashEntry *hPtr;
+    Tcl_Obj **namev;
+    Tcl_Obj *namePtr;
+    Tcl_Var varPtr;
+    Tcl_Size namec;
+    Tcl_Size i;
+
+    if (untrace) {
+	if (cachePtr->tracedPtr == NULL) {
+	    return;
+	}
+	Tcl_ListObjGetElements(NULL, cachePtr->tracedPtr, &namec, &namev);
+	for (i = 0; i < namec; i++) {
+	    Tcl_UntraceVar2(interp, Tcl_GetString(namev[i]), NULL,
+		    TCL_TRACE_WRITES|TCL_TRACE_UNSETS, ItclTraceMemoVar,
+		    cachePtr);
+	}
+	Tcl_DecrRefCount(cachePtr->tracedPtr);
+	cachePtr->tracedPtr = NULL;
+	return;
+    }
+
+    if ((cachePtr->tracedPtr != NULL) || (Tcl_ListObjGetElements(NULL,
+	    cachePtr->imPtr->memoVarsPtr, &namec, &namev) != TCL_OK)) {
+	return;
+    }
+    cachePtr->tracedPtr = Tcl_NewListObj(0, NULL);
+    Tcl_IncrRefCount(cachePtr->tracedPtr);
+    for (i = 0; i < namec; i++) {
+	if (FindMemoVar(NULL, cachePtr->imPtr, namev[i], &ivPtr) != TCL_OK) {
+	    continue;
+	}
+	hPtr = Tcl_FindHashEntry(&cachePtr->ioPtr->objectVariables,
+		(char *)ivPtr);
+	if (hPtr == NULL) {
+	    continue;
+	}
+	varPtr = (Tcl_Var)Tcl_GetHashValue(hPtr);
+	if (TclIsVarDeadHash((Var *)varPtr)) {
+	    continue;
+	}
+	namePtr = Tcl_NewObj();
+	Tcl_GetVariableFullName(interp, varPtr, namePtr);
+	if (Tcl_TraceVar2(interp, Tcl_GetString(namePtr), NULL,
+		TCL_TRACE_WRITES|TCL_TRACE_UNSETS, ItclTraceMemoVar,
+		cachePtr) == TCL_OK) {
+	    Tcl_ListObjAppendElement(NULL, cachePtr->tracedPtr, namePtr);
+	} else {
+	    Tcl_DecrRefCount(namePtr);
+	}
+    }
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclTraceMemoVar()
+ *
+ *  Invoked to handle write/unset traces on the variables listed for a
+ *  memoized method.  Drops the cached results of the method.  When a
+ *  variable is unset, its trace is gone, so the traces are put back
+ *  unless the object is being destroyed.
+ * ------------------------------------------------------------------------
+ */
+static char *
+ItclTraceMemoVar(
+    void *cdata,             /* ItclMemoCache of the variable */
+    TCL_UNUSED(Tcl_Interp *),   /* interpreter managing this variable */
+    TCL_UNUSED(const char *),   /* variable name */
+    TCL_UNUSED(const char *),   /* element name or NULL */
+    int flags)               /* flags indicating write/unset */
+{
+    ItclMemoCache *cachePtr = (ItclMemoCache *)cdata;
+
+    DropResults(cachePtr);
+    if ((flags & TCL_TRACE_DESTROYED) && !(flags & TCL_INTERP_DESTROYED)) {
+	TraceCache(cachePtr, 1);
+	if (!(flags & TCL_NAMESPACE_ONLY) && !(cachePtr->ioPtr->flags & (ITCL_OBJECT_IS_DELETED|
+		ITCL_OBJECT_IS_DESTRUCTED|ITCL_OBJECT_IS_DESTROYED))) {
+	    TraceCache(cachePtr, 0);
+	}
+    }
+    return NULL;
+}
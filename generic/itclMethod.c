@@ -512,10 +512,14 @@ ItclCreateMemberFunc(
         imPtr->flags |= ITCL_ARG_SPEC;
     }
     if (mcode->argListPtr) {
-        ItclCreateArgList(interp, arglist, &imPtr->argcount,
-	        &imPtr->maxargcount, &imPtr->usagePtr,
-		&imPtr->argListPtr, imPtr, NULL);
-        Tcl_IncrRefCount(imPtr->usagePtr);
+        /*
+         *  The function keeps the argument list of its first definition,
+         *  shared with the implementation.
+         */
+        imPtr->argListPtr = mcode->argListPtr;
+        imPtr->argListPtr->refCount++;
+        imPtr->argcount = imPtr->argListPtr->argcount;
+        imPtr->maxargcount = imPtr->argListPtr->maxargcount;
     }
 
     name = Tcl_GetString(namePtr);
@@ -531,6 +535,10 @@ ItclCreateMemberFunc(
 	}
 	if (strcmp(name, "isa") == 0) {
 	}
+	if (strcmp(name, "clone") == 0) {
+	    imPtr->argcount = 0;
+	    imPtr->maxargcount = 1;
+	}
 	if (strcmp(name, "createhull") == 0) {
 	    imPtr->argcount = 0;
 	    imPtr->maxargcount = -1;
@@ -763,6 +771,7 @@ Itcl_ChangeMemberFunc(
     Itcl_PreserveData(mcode);
     Itcl_ReleaseData(imPtr->codePtr);
     imPtr->codePtr = mcode;
+    imPtr->memoVersion++;
     if (mcode->flags & ITCL_IMPLEMENT_TCL) {
 	void *pmPtr;
 	imPtr->tmPtr = Itcl_NewProcClassMethod(interp,
@@ -816,12 +825,10 @@ ItclCreateMemberCode(
     Tcl_Obj *namePtr,
     int flags)
 {
-    Tcl_Size argc;
-    Tcl_Size maxArgc;
-    Tcl_Obj *usagePtr;
     ItclArgList *argListPtr;
     ItclMemberCode *mcode;
     const char *const *cPtrPtr;
+    Tcl_Size i;
     int haveError;
 
     /*
@@ -831,27 +838,22 @@ ItclCreateMemberCode(
     Itcl_EventuallyFree(mcode, (Tcl_FreeProc *)FreeMemberCode);
 
     if (arglist) {
-        if (ItclCreateArgList(interp, arglist, &argc, &maxArgc, &usagePtr,
-	        &argListPtr, NULL, NULL) != TCL_OK) {
+        if (ItclCreateArgList(interp, arglist, &argListPtr, NULL)
+		!= TCL_OK) {
 	    Itcl_PreserveData(mcode);
 	    Itcl_ReleaseData(mcode);
             return TCL_ERROR;
         }
-        mcode->argcount = argc;
-        mcode->maxargcount = maxArgc;
         mcode->argListPtr = argListPtr;
-        mcode->usagePtr = usagePtr;
-	Tcl_IncrRefCount(mcode->usagePtr);
-	mcode->argumentPtr = Tcl_NewStringObj((const char *)arglist, TCL_INDEX_NONE);
+	mcode->argumentPtr = argListPtr->argumentPtr;
 	Tcl_IncrRefCount(mcode->argumentPtr);
 	if (iclsPtr->flags & (ITCL_TYPE|ITCL_WIDGETADAPTOR)) {
 	    haveError = 0;
-	    while (argListPtr != NULL) {
+	    for (i = 0; i < argListPtr->numArgs; i++) {
 		cPtrPtr = &type_reserved_words[0];
 		while (*cPtrPtr != NULL) {
-	            if ((argListPtr->namePtr != NULL) &&
-		            (strcmp(Tcl_GetString(argListPtr->namePtr),
-		            *cPtrPtr) == 0)) {
+	            if (strcmp(Tcl_GetString(argListPtr->args[i].namePtr),
+		            *cPtrPtr) == 0) {
 		        haveError = 1;
 		    }
 		    if ((flags & ITCL_COMMON) != 0) {
@@ -883,13 +885,9 @@ ItclCreateMemberCode(
 		    }
 		    cPtrPtr++;
 	        }
-	        argListPtr = argListPtr->nextPtr;
 	    }
 	}
         mcode->flags   |= ITCL_ARG_SPEC;
-    } else {
-        argc = 0;
-        argListPtr = NULL;
     }
 
     if (body) {
@@ -923,6 +921,9 @@ ItclCreateMemberCode(
 	    if (strcmp(body, "@itcl-builtin-isa") == 0) {
 	        isDone = 1;
 	    }
+	    if (strcmp(body, "@itcl-builtin-clone") == 0) {
+	        isDone = 1;
+	    }
 	    if (strcmp(body, "@itcl-builtin-createhull") == 0) {
 	        isDone = 1;
 	    }
@@ -1085,12 +1086,7 @@ void FreeMemberCode (
     if (mCodePtr == NULL) {
         return;
     }
-    if (mCodePtr->argListPtr != NULL) {
-        ItclDeleteArgList(mCodePtr->argListPtr);
-    }
-    if (mCodePtr->usagePtr != NULL) {
-        Tcl_DecrRefCount(mCodePtr->usagePtr);
-    }
+    ItclReleaseArgList(mCodePtr->argListPtr);
     if (mCodePtr->argumentPtr != NULL) {
         Tcl_DecrRefCount(mCodePtr->argumentPtr);
     }
@@ -1323,57 +1319,45 @@ EquivArgLists(
     ItclArgList *origArgs,
     ItclArgList *realArgs)
 {
-    ItclArgList *currPtr;
-    char *argName;
-
-    for (currPtr=origArgs; currPtr != NULL; currPtr=currPtr->nextPtr) {
-	if ((realArgs != NULL) && (realArgs->namePtr == NULL)) {
-            if (currPtr->namePtr != NULL) {
-		if (strcmp(Tcl_GetString(currPtr->namePtr), "args") != 0) {
-		    /* the definition has more arguments */
-	            return 0;
-	        }
-            }
-	}
-	if (realArgs == NULL) {
+    ItclArg *currPtr;
+    const char *argName;
+    Tcl_Size i;
+
+    for (i = 0; i < origArgs->numArgs; i++) {
+        currPtr = &origArgs->args[i];
+	argName = Tcl_GetString(currPtr->namePtr);
+	if (i >= realArgs->numArgs) {
 	    if (currPtr->defaultValuePtr != NULL) {
 	       /* default args must be there ! */
 	       return 0;
 	    }
-            if (currPtr->namePtr != NULL) {
-		if (strcmp(Tcl_GetString(currPtr->namePtr), "args") != 0) {
-		    /* the definition has more arguments */
-	            return 0;
-	        }
-	    }
-	    return 1;
-	}
-	if (currPtr->namePtr == NULL) {
-	    /* no args defined */
-            if (realArgs->namePtr != NULL) {
+	    if (strcmp(argName, "args") != 0) {
+		/* the definition has more arguments */
 	        return 0;
 	    }
+	    if ((i == 0) && (i < origArgs->numArgs-1)) {
+	        /* "args" which is not the last argument */
+	        continue;
+	    }
 	    return 1;
 	}
-	argName = Tcl_GetString(currPtr->namePtr);
 	if (strcmp(argName, "args") == 0) {
-	    if (currPtr->nextPtr == NULL) {
+	    if (i == origArgs->numArgs-1) {
 	        /* this is the last arument */
 	        return 1;
 	    }
 	}
 	if (currPtr->defaultValuePtr != NULL) {
-	    if (realArgs->defaultValuePtr != NULL) {
+	    if (realArgs->args[i].defaultValuePtr != NULL) {
 	        /* default values must be the same */
 		if (strcmp(Tcl_GetString(currPtr->defaultValuePtr),
-		        Tcl_GetString(realArgs->defaultValuePtr)) != 0) {
+		        Tcl_GetString(realArgs->args[i].defaultValuePtr)) != 0) {
 		    return 0;
 	        }
 	    }
 	}
-        realArgs = realArgs->nextPtr;
     }
-    if ((currPtr == NULL) && (realArgs != NULL)) {
+    if (i < realArgs->numArgs) {
        /* new definition has more args then the old one */
        return 0;
     }
@@ -1596,14 +1580,15 @@ Itcl_GetMemberFuncUsage(
      *  Add the argument usage info.
      */
     if (imPtr->codePtr) {
-	if (imPtr->codePtr->usagePtr != NULL) {
-            arglist = Tcl_GetString(imPtr->codePtr->usagePtr);
+	if (imPtr->codePtr->argListPtr != NULL) {
+            arglist = Tcl_GetString(
+		    ItclArgListUsage(imPtr->codePtr->argListPtr));
 	} else {
 	    arglist = NULL;
 	}
     } else {
         if (imPtr->argListPtr != NULL) {
-            arglist = Tcl_GetString(imPtr->usagePtr);
+            arglist = Tcl_GetString(ItclArgListUsage(imPtr->argListPtr));
         } else {
             arglist = NULL;
         }
@@ -1679,10 +1664,14 @@ NRExecMethod(
      *
      *  To implement the "virtual" behavior, find the most-specific
      *  implementation for the method by looking in the "resolveCmds"
-     *  table for this class.
+     *  table for this class.  Final methods and methods of sealed
+     *  classes cannot be overridden, so they are already the
+     *  most-specific implementation.
      */
     token = Tcl_GetString(objv[0]);
-    if (strstr(token, "::") == NULL) {
+    if (Itcl_IsStaticMethod(imPtr)) {
+        ITCL_STATS_INCR(imPtr->infoPtr, staticCalls);
+    } else if (strstr(token, "::") == NULL) {
 	if (ioPtr != NULL) {
             entry = Tcl_FindHashEntry(&ioPtr->iclsPtr->resolveCmds,
                 (char *)imPtr->namePtr);
@@ -2038,6 +2027,254 @@ Itcl_InvokeMethodIfExists(
     return result;
 }
 
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_LookupMethod()
+ *
+ *  Resolves the name of a method once, so that C code can call it on
+ *  many objects with Itcl_InvokeMethod() without looking it up again.
+ *  The name is resolved like a method name in the scope of the class.
+ *  A simple name gives a virtual handle, which calls the implementation
+ *  of the class of the object, while a name qualified by a class gives
+ *  a handle which always calls the implementation of that class, as
+ *  "$obj Base::method" does.  The handle returned stays valid as long
+ *  as the class defining the method exists.
+ *
+ *  Returns the method, or NULL (along with an error message in the
+ *  interpreter, if it is not NULL) if the class has no such method.
+ * ------------------------------------------------------------------------
+ */
+static ItclMemberFunc *
+NonVirtualHandle(
+    ItclMemberFunc *imPtr)
+{
+    ItclMemberFunc *handlePtr;
+
+    /*
+     *  The handle is a copy of the identifying parts of the method,
+     *  made once and freed with the method.
+     */
+    if (imPtr->nonVirtualPtr == NULL) {
+	handlePtr = (ItclMemberFunc *)Itcl_Alloc(sizeof(ItclMemberFunc));
+	handlePtr->namePtr = imPtr->namePtr;
+	Tcl_IncrRefCount(handlePtr->namePtr);
+	handlePtr->fullNamePtr = imPtr->fullNamePtr;
+	Tcl_IncrRefCount(handlePtr->fullNamePtr);
+	handlePtr->iclsPtr = imPtr->iclsPtr;
+	handlePtr->protection = imPtr->protection;
+	handlePtr->flags = imPtr->flags | ITCL_NONVIRTUAL;
+	handlePtr->infoPtr = imPtr->infoPtr;
+	handlePtr->declaringClassPtr = imPtr->declaringClassPtr;
+	handlePtr->nonVirtualPtr = imPtr;
+	imPtr->nonVirtualPtr = handlePtr;
+    }
+    return imPtr->nonVirtualPtr;
+}
+
+ItclMemberFunc *
+Itcl_LookupMethod(
+    Tcl_Interp *interp,           /* interpreter for error messages or NULL */
+    ItclClass *iclsPtr,           /* class scope for the name */
+    const char *name)             /* simple or qualified method name */
+{
+    Tcl_HashEntry *hPtr;
+    Tcl_Obj *objPtr;
+    ItclMemberFunc *imPtr;
+
+    objPtr = Tcl_NewStringObj(name, TCL_INDEX_NONE);
+    hPtr = Tcl_FindHashEntry(&iclsPtr->resolveCmds, (char *)objPtr);
+    Tcl_DecrRefCount(objPtr);
+    imPtr = NULL;
+    if (hPtr != NULL) {
+	imPtr = ((ItclCmdLookup *)Tcl_GetHashValue(hPtr))->imPtr;
+	if (imPtr->flags & (ITCL_COMMON|ITCL_CONSTRUCTOR|ITCL_DESTRUCTOR)) {
+	    imPtr = NULL;
+	} else if (strstr(name, "::") != NULL) {
+	    imPtr = NonVirtualHandle(imPtr);
+	}
+    }
+    if ((imPtr == NULL) && (interp != NULL)) {
+	Tcl_AppendResult(interp, "method \"", name,
+		"\" not found in class \"",
+		Tcl_GetString(iclsPtr->fullNamePtr), "\"", NULL);
+    }
+    return imPtr;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_NRInvokeMethod()
+ *
+ *  Calls a method found by Itcl_LookupMethod() on an object, with the
+ *  arguments (objc,objv), which do not include the object and method
+ *  name.  The call is dispatched as "$obj method args" would be, and
+ *  the most-specific implementation for the object, or the one of the
+ *  class of a handle looked up by a qualified name, is run with the
+ *  object context set up by ItclCheckCallMethod(), but the object
+ *  command and the method name are not looked up, and the protection
+ *  level of the method is not checked.
+ *
+ *  This procedure only schedules the call on the NRE stack, so it must
+ *  be called from a command implemented with Tcl_NRCreateCommand(),
+ *  which returns its result.  Itcl_InvokeMethod() calls the method and
+ *  waits for its completion.
+ *
+ *  Returns TCL_OK on success; otherwise, this procedure returns
+ *  TCL_ERROR along with an error message in the interpreter.
+ * ------------------------------------------------------------------------
+ */
+static int
+CheckMethodHandle(
+    Tcl_Interp *interp,
+    ItclObject *ioPtr,
+    ItclMemberFunc *imPtr)
+{
+    if ((ioPtr->oPtr == NULL) || (ioPtr->flags & ITCL_OBJECT_IS_DELETED)) {
+	Tcl_AppendResult(interp, "object \"", Tcl_GetString(ioPtr->namePtr),
+		"\" is deleted", NULL);
+	return TCL_ERROR;
+    }
+    if (!Itcl_ObjectIsa(ioPtr, imPtr->iclsPtr)) {
+	Tcl_AppendResult(interp, "method \"",
+		Tcl_GetString(imPtr->fullNamePtr),
+		"\" is not a member of object \"",
+		Tcl_GetString(ioPtr->namePtr), "\"", NULL);
+	return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+static int
+InvokeResolvedMethod(
+    Tcl_Interp *interp,
+    ItclObject *ioPtr,
+    ItclMemberFunc *imPtr,
+    Tcl_Size objc,                /* number of words, with object and */
+    Tcl_Obj *const objv[])        /* method name in objv[0] and objv[1] */
+{
+    ItclObjectInfo *infoPtr = imPtr->infoPtr;
+    Tcl_Class clsPtr = NULL;
+    int result;
+
+    /*
+     *  The method is already resolved, so ItclMapMethodNameProc() is
+     *  told to leave its name alone.  TclOO calls it once, before
+     *  anything else.  A non-virtual handle starts the call chain at
+     *  its class, as ItclMapMethodNameProc() does for "Base::method".
+     */
+    if (imPtr->flags & ITCL_NONVIRTUAL) {
+	clsPtr = imPtr->iclsPtr->clsPtr;
+    }
+    infoPtr->mapMethodDirect = 1;
+    result = Itcl_PublicObjectCmd(ioPtr->oPtr, interp, clsPtr, objc, objv);
+    infoPtr->mapMethodDirect = 0;
+    return result;
+}
+
+static int
+FreeMethodArgs(
+    void *data[],
+    TCL_UNUSED(Tcl_Interp *),
+    int result)
+{
+    ckfree(data[0]);
+    return result;
+}
+
+int
+Itcl_NRInvokeMethod(
+    Tcl_Interp *interp,           /* current interpreter */
+    ItclObject *ioPtr,            /* object to call the method on */
+    ItclMemberFunc *imPtr,        /* method from Itcl_LookupMethod() */
+    Tcl_Size objc,                /* number of arguments */
+    Tcl_Obj *const objv[])        /* argument objects */
+{
+    Tcl_Obj **cmdv;
+
+    if (CheckMethodHandle(interp, ioPtr, imPtr) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    /*
+     *  The arguments must stay valid until the method returns, which is
+     *  after this procedure returns.
+     */
+    cmdv = (Tcl_Obj **)ckalloc(sizeof(Tcl_Obj *) * (objc + 2));
+    cmdv[0] = ioPtr->namePtr;
+    cmdv[1] = imPtr->namePtr;
+    if (objc > 0) {
+	memcpy(cmdv + 2, objv, sizeof(Tcl_Obj *) * objc);
+    }
+    Tcl_NRAddCallback(interp, FreeMethodArgs, cmdv, NULL, NULL, NULL);
+    return InvokeResolvedMethod(interp, ioPtr, imPtr, objc + 2, cmdv);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_InvokeMethod()
+ *
+ *  Calls a method found by Itcl_LookupMethod() on an object like
+ *  Itcl_NRInvokeMethod(), and returns when the method has returned.
+ *  The result of the method is left in the interpreter.
+ * ------------------------------------------------------------------------
+ */
+typedef struct InvokeMethodData {
+    ItclObject *ioPtr;
+    ItclMemberFunc *imPtr;
+} InvokeMethodData;
+
+static int
+NRInvokeMethod(
+    void *clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const *objv)
+{
+    InvokeMethodData *dataPtr = (InvokeMethodData *)clientData;
+
+    return InvokeResolvedMethod(interp, dataPtr->ioPtr, dataPtr->imPtr,
+	    objc, objv);
+}
+
+int
+Itcl_InvokeMethod(
+    Tcl_Interp *interp,           /* current interpreter */
+    ItclObject *ioPtr,            /* object to call the method on */
+    ItclMemberFunc *imPtr,        /* method from Itcl_LookupMethod() */
+    Tcl_Size objc,                /* number of arguments */
+    Tcl_Obj *const objv[])        /* argument objects */
+{
+    InvokeMethodData data;
+    Tcl_Obj *staticv[8];
+    Tcl_Obj **cmdv;
+    int result;
+
+    if (CheckMethodHandle(interp, ioPtr, imPtr) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    /*
+     *  The method returns before this procedure, so short argument
+     *  lists can live on the C stack.
+     */
+    cmdv = staticv;
+    if (objc + 2 > (Tcl_Size)(sizeof(staticv) / sizeof(staticv[0]))) {
+	cmdv = (Tcl_Obj **)ckalloc(sizeof(Tcl_Obj *) * (objc + 2));
+    }
+    cmdv[0] = ioPtr->namePtr;
+    cmdv[1] = imPtr->namePtr;
+    if (objc > 0) {
+	memcpy(cmdv + 2, objv, sizeof(Tcl_Obj *) * objc);
+    }
+    data.ioPtr = ioPtr;
+    data.imPtr = imPtr;
+    result = Tcl_NRCallObjProc(interp, NRInvokeMethod, &data, objc + 2, cmdv);
+    if (cmdv != staticv) {
+	ckfree(cmdv);
+    }
+    return result;
+}
 
 /*
  * ------------------------------------------------------------------------
@@ -2120,6 +2357,9 @@ Itcl_CmdAliasProc(
 	if (strcmp(cmdName, "@itcl-builtin-isa") == 0) {
 	    return Tcl_FindCommand(interp, "::itcl::builtin::isa", NULL, 0);
 	}
+	if (strcmp(cmdName, "@itcl-builtin-clone") == 0) {
+	    return Tcl_FindCommand(interp, "::itcl::builtin::clone", NULL, 0);
+	}
 	if (strcmp(cmdName, "@itcl-builtin-createhull") == 0) {
 	    return Tcl_FindCommand(interp, "::itcl::builtin::createhull", NULL, 0);
 	}
@@ -2318,6 +2558,8 @@ ItclCheckCallMethod(
 
     oPtr = NULL;
     hPtr = NULL;
+    cObjc = 0;
+    cObjv = NULL;
     imPtr = (ItclMemberFunc *)clientData;
     Itcl_PreserveData(imPtr);
     if (imPtr->flags & ITCL_CONSTRUCTOR) {
@@ -2330,6 +2572,19 @@ ItclCheckCallMethod(
                     Itcl_SetCallFrameResolver(interp,
                             imPtr->iclsPtr->resolvePtr);
                 }
+                if (imPtr->iclsPtr->infoPtr->instrumentFlags
+			& ITCL_INSTRUMENT_PROFILE) {
+                    ItclProfileEnter(imPtr->iclsPtr->infoPtr, imPtr);
+                }
+                if (imPtr->iclsPtr->infoPtr->instrumentFlags
+			& ITCL_INSTRUMENT_TRACE) {
+                    ItclTraceEnter(imPtr->iclsPtr->infoPtr, imPtr, NULL);
+                }
+                if (imPtr->iclsPtr->infoPtr->eventMask
+			& ITCL_EVENT_METHOD_ENTER) {
+                    ItclFireEvent(imPtr->iclsPtr->infoPtr,
+			    ITCL_EVENT_METHOD_ENTER, NULL, NULL, imPtr, TCL_OK);
+                }
                 if (isFinished != NULL) {
                     *isFinished = 0;
                 }
@@ -2373,7 +2628,8 @@ ItclCheckCallMethod(
     if (min_allowed_args < imPtr->argcount) {
 	Tcl_AppendResult(interp, "wrong # args: should be \"",
 		Tcl_GetString(cObjv[0]), " ", Tcl_GetString(imPtr->namePtr),
-		" ", Tcl_GetString(imPtr->usagePtr), "\"", NULL);
+		" ", Tcl_GetString(ItclArgListUsage(imPtr->argListPtr)), "\"",
+		NULL);
         if (isFinished != NULL) {
             *isFinished = 1;
         }
@@ -2381,6 +2637,31 @@ ItclCheckCallMethod(
 	goto finishReturn;
     }
   }
+    if ((imPtr->memoVarsPtr != NULL) && (ioPtr != NULL)
+	    && !(imPtr->flags & (ITCL_CONSTRUCTOR|ITCL_DESTRUCTOR))) {
+	/*
+	 *  Memoized methods return a cached result if there is one for
+	 *  the arguments, without running the body.
+	 */
+	int memoFinished;
+
+	if (framePtr && (contextPtr != NULL)) {
+	    Tcl_Size skip = Tcl_ObjectContextSkippedArgs(contextPtr);
+
+	    ItclMemoLookup(interp, ioPtr, imPtr, cObjc - skip, cObjv + skip,
+		    &memoFinished);
+	} else {
+	    ItclMemoLookup(interp, ioPtr, imPtr, TCL_INDEX_NONE, NULL,
+		    &memoFinished);
+	}
+	if (memoFinished) {
+	    if (isFinished != NULL) {
+		*isFinished = 1;
+	    }
+	    result = TCL_OK;
+	    goto finishReturn;
+	}
+    }
     isNew = 0;
     callContextPtr = NULL;
     currNsPtr = Tcl_GetCurrentNamespace(interp);
@@ -2389,6 +2670,7 @@ ItclCheckCallMethod(
         if (!isNew) {
 	    callContextPtr2 = (ItclCallContext *)Tcl_GetHashValue(hPtr);
 	    if (callContextPtr2->refCount == 0) {
+	        ITCL_STATS_INCR(imPtr->iclsPtr->infoPtr, contextCacheHits);
 	        callContextPtr = callContextPtr2;
                 callContextPtr->objectFlags = ioPtr->flags;
                 callContextPtr->nsPtr = Tcl_GetCurrentNamespace(interp);
@@ -2398,6 +2680,7 @@ ItclCheckCallMethod(
 	    } else {
 	      if ((callContextPtr2->objectFlags == ioPtr->flags)
 		    && (callContextPtr2->nsPtr == currNsPtr)) {
+	        ITCL_STATS_INCR(imPtr->iclsPtr->infoPtr, contextCacheHits);
 	        callContextPtr = callContextPtr2;
                 callContextPtr->refCount++;
               }
@@ -2405,6 +2688,7 @@ ItclCheckCallMethod(
         }
     }
     if (callContextPtr == NULL) {
+        ITCL_STATS_INCR(imPtr->iclsPtr->infoPtr, contextCacheMisses);
         callContextPtr = (ItclCallContext *)ckalloc(
                 sizeof(ItclCallContext));
 	if (ioPtr == NULL) {
@@ -2462,6 +2746,16 @@ ItclCheckCallMethod(
     if (!imPtr->iclsPtr->infoPtr->useOldResolvers) {
         Itcl_SetCallFrameResolver(interp, ioPtr->resolvePtr);
     }
+    if (infoPtr->instrumentFlags & ITCL_INSTRUMENT_PROFILE) {
+        ItclProfileEnter(infoPtr, imPtr);
+    }
+    if (infoPtr->instrumentFlags & ITCL_INSTRUMENT_TRACE) {
+        ItclTraceEnter(infoPtr, imPtr, ioPtr);
+    }
+    if (infoPtr->eventMask & ITCL_EVENT_METHOD_ENTER) {
+        ItclFireEvent(infoPtr, ITCL_EVENT_METHOD_ENTER, NULL, ioPtr, imPtr,
+		TCL_OK);
+    }
     result = TCL_OK;
 
     if (isFinished != NULL) {
@@ -2496,6 +2790,31 @@ ItclAfterCallMethod(
     int result;
 
     imPtr = (ItclMemberFunc *)clientData;
+    if ((imPtr->memoVarsPtr != NULL) && (contextPtr != NULL)
+	    && !(imPtr->flags & (ITCL_CONSTRUCTOR|ITCL_DESTRUCTOR))) {
+	ioPtr = (ItclObject *)Tcl_ObjectGetMetadata(
+		Tcl_ObjectContextObject(contextPtr),
+		imPtr->infoPtr->object_meta_type);
+	if (ioPtr != NULL) {
+	    ItclMemoStore(interp, ioPtr, imPtr, call_result);
+	}
+    }
+    if (imPtr->infoPtr->instrumentFlags & ITCL_INSTRUMENT_PROFILE) {
+	ItclProfileLeave(imPtr->infoPtr, imPtr, call_result);
+    }
+    if (imPtr->infoPtr->instrumentFlags & ITCL_INSTRUMENT_TRACE) {
+	ItclTraceLeave(imPtr->infoPtr, imPtr, call_result);
+    }
+    if (imPtr->infoPtr->eventMask & ITCL_EVENT_METHOD_LEAVE) {
+	ioPtr = NULL;
+	if (contextPtr != NULL) {
+	    ioPtr = (ItclObject *)Tcl_ObjectGetMetadata(
+		    Tcl_ObjectContextObject(contextPtr),
+		    imPtr->infoPtr->object_meta_type);
+	}
+	ItclFireEvent(imPtr->infoPtr, ITCL_EVENT_METHOD_LEAVE, NULL, ioPtr,
+		imPtr, call_result);
+    }
     callContextPtr = NULL;
     if (contextPtr != NULL) {
     ItclObjectInfo *infoPtr = imPtr->infoPtr;
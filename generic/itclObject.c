@@ -51,6 +51,8 @@ static char* ItclTraceComponentVar(void *cdata, Tcl_Interp *interp,
 	const char *name1, const char *name2, int flags);
 static char* ItclTraceItclHullVar(void *cdata, Tcl_Interp *interp,
 	const char *name1, const char *name2, int flags);
+static char* ItclTraceTypedVar(void *cdata, Tcl_Interp *interp,
+	const char *name1, const char *name2, int flags);
 
 static void ItclDestroyObject(void *clientData);
 static void FreeObject(char *cdata);
@@ -60,6 +62,11 @@ static int ItclDestructBase(Tcl_Interp *interp, ItclObject *contextObj,
 
 static int ItclInitObjectVariables(Tcl_Interp *interp, ItclObject *ioPtr,
         ItclClass *iclsPtr);
+static int ItclInitTypedVars(Tcl_Interp *interp, ItclObject *ioPtr);
+static int CreateObject(Tcl_Interp *interp, const char *name,
+	ItclClass *iclsPtr, size_t objc, Tcl_Obj *const objv[],
+	int construct);
+static Tcl_Obj *NewTypedValueObj(ItclTypedVarSlot *slotPtr);
 static int ItclInitObjectCommands(Tcl_Interp *interp, ItclObject *ioPtr,
         ItclClass *iclsPtr, const char *name);
 static int ItclInitExtendedClassOptions(Tcl_Interp *interp, ItclObject *ioPtr);
@@ -69,6 +76,10 @@ static const char * GetConstructorVar(Tcl_Interp *interp, ItclClass *iclsPtr,
         const char *varName);
 static ItclClass * GetClassFromClassName(Tcl_Interp *interp,
 	const char *className, ItclClass *iclsPtr);
+static void ConstructPhase(ItclClass *iclsPtr, int *phasePtr,
+	Tcl_WideInt *markPtr, int nextPhase);
+static void ConstructDone(ItclClass *iclsPtr, int phase, Tcl_WideInt mark,
+	int result);
 
 
 /*
@@ -175,6 +186,60 @@ Itcl_CreateObject(
     return result;
 }
 
+/*
+ * ------------------------------------------------------------------------
+ *  ConstructPhase()
+ *
+ *  Used by ItclCreateObject() while "itcl::stats construct" is enabled.
+ *  Charges the time since *markPtr to the current phase and starts the
+ *  next one.  Does nothing if timing did not start, which is flagged by
+ *  a zero mark.
+ * ------------------------------------------------------------------------
+ */
+static void
+ConstructPhase(
+    ItclClass *iclsPtr,      /* class of the object constructed */
+    int *phasePtr,           /* in/out: ITCL_CONSTRUCT_* phase running */
+    Tcl_WideInt *markPtr,    /* in/out: start of the phase running */
+    int nextPhase)           /* phase starting now */
+{
+    Tcl_WideInt now;
+
+    if (*markPtr == 0) {
+        return;
+    }
+    now = ItclGetMonotonicTime();
+    iclsPtr->constructStatsPtr->phaseTime[*phasePtr] += now - *markPtr;
+    *markPtr = now;
+    *phasePtr = nextPhase;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ConstructDone()
+ *
+ *  Ends the timing of a construction started by ItclCreateObject() and
+ *  counts it as an object constructed or as an error.
+ * ------------------------------------------------------------------------
+ */
+static void
+ConstructDone(
+    ItclClass *iclsPtr,      /* class of the object constructed */
+    int phase,               /* ITCL_CONSTRUCT_* phase running */
+    Tcl_WideInt mark,        /* start of the phase running */
+    int result)              /* result of the construction */
+{
+    if (mark == 0) {
+        return;
+    }
+    ConstructPhase(iclsPtr, &phase, &mark, phase);
+    if (result == TCL_OK) {
+        iclsPtr->constructStatsPtr->objects++;
+    } else {
+        iclsPtr->constructStatsPtr->errors++;
+    }
+}
+
 /*
  * ------------------------------------------------------------------------
  *  ItclCreateObject()
@@ -201,6 +266,295 @@ ItclCreateObject(
     ItclClass *iclsPtr,        /* class for new object */
     size_t objc,                /* number of arguments */
     Tcl_Obj *const objv[])   /* argument objects */
+{
+    return CreateObject(interp, name, iclsPtr, objc, objv, 1);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclCreateUnconstructedObject()
+ *
+ *  Creates a new object instance belonging to the given class like
+ *  ItclCreateObject(), with its data members set to their initial
+ *  values, but without invoking any constructor.  Used to restore or
+ *  copy objects whose variables are set afterwards.  Only plain
+ *  "itcl::class" objects can be created this way.
+ *
+ *  Returns TCL_OK and the new object in *ioPtrPtr, or TCL_ERROR (along
+ *  with an error message in the interpreter).
+ * ------------------------------------------------------------------------
+ */
+int
+ItclCreateUnconstructedObject(
+    Tcl_Interp *interp,      /* interpreter mananging new object */
+    const char* name,        /* name of new object */
+    ItclClass *iclsPtr,      /* class for new object */
+    ItclObject **ioPtrPtr)   /* returns the new object */
+{
+    int result;
+
+    if (!(iclsPtr->flags & ITCL_CLASS) || (iclsPtr->flags & ITCL_RECORD)) {
+        Tcl_AppendResult(interp, "cannot create objects of \"",
+                Tcl_GetString(iclsPtr->fullNamePtr),
+                "\" without constructors", NULL);
+        return TCL_ERROR;
+    }
+    result = CreateObject(interp, name, iclsPtr, 0, NULL, 0);
+    if (result == TCL_OK) {
+        *ioPtrPtr = iclsPtr->infoPtr->lastIoPtr;
+    }
+    return result;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclGetArrayElements()
+ *
+ *  Returns a new list of the names and values of the elements of an
+ *  array variable, as "array get" does, but without evaluating the
+ *  "array" command, which the application may have renamed or traced.
+ *  Read traces on the elements are invoked.
+ *
+ *  Returns NULL (along with an error message in the interpreter) if an
+ *  element cannot be read.
+ * ------------------------------------------------------------------------
+ */
+Tcl_Obj *
+ItclGetArrayElements(
+    Tcl_Interp *interp,      /* current interpreter */
+    Tcl_Var var)             /* array variable */
+{
+    Var *varPtr = (Var *)var;
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch place;
+    Tcl_Obj *namePtr;
+    Tcl_Obj *keysPtr;
+    Tcl_Obj *listPtr;
+    Tcl_Obj *valuePtr;
+    Tcl_Obj **keyv;
+    Tcl_Size keyc;
+    Tcl_Size i;
+
+    namePtr = Tcl_NewObj();
+    Tcl_IncrRefCount(namePtr);
+    Tcl_GetVariableFullName(interp, var, namePtr);
+
+    /*
+     *  Collect the names first, since traces may change the array.
+     */
+    keysPtr = Tcl_NewListObj(0, NULL);
+    Tcl_IncrRefCount(keysPtr);
+    if (TclIsVarArray(varPtr) && (varPtr->value.tablePtr != NULL)) {
+	for (hPtr = Tcl_FirstHashEntry(&varPtr->value.tablePtr->table,
+		&place); hPtr != NULL; hPtr = Tcl_NextHashEntry(&place)) {
+	    if (!TclIsVarUndefined((Var *)((char *)hPtr
+		    - offsetof(VarInHash, entry)))) {
+		Tcl_ListObjAppendElement(NULL, keysPtr,
+			(Tcl_Obj *)hPtr->key.objPtr);
+	    }
+	}
+    }
+    listPtr = Tcl_NewListObj(0, NULL);
+    Tcl_ListObjGetElements(NULL, keysPtr, &keyc, &keyv);
+    for (i = 0; i < keyc; i++) {
+	valuePtr = Tcl_ObjGetVar2(interp, namePtr, keyv[i],
+		TCL_GLOBAL_ONLY|TCL_LEAVE_ERR_MSG);
+	if (valuePtr == NULL) {
+	    Tcl_DecrRefCount(listPtr);
+	    listPtr = NULL;
+	    break;
+	}
+	Tcl_ListObjAppendElement(NULL, listPtr, keyv[i]);
+	Tcl_ListObjAppendElement(NULL, listPtr, valuePtr);
+    }
+    Tcl_DecrRefCount(keysPtr);
+    Tcl_DecrRefCount(namePtr);
+    return listPtr;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclSetArrayElements()
+ *
+ *  Sets elements of an array variable from a list of names and values,
+ *  as "array set" does, but without evaluating the "array" command.
+ *  The variable is made an array even if the list is empty.
+ *
+ *  Returns TCL_OK/TCL_ERROR to indicate success/failure.
+ * ------------------------------------------------------------------------
+ */
+int
+ItclSetArrayElements(
+    Tcl_Interp *interp,      /* current interpreter */
+    Tcl_Var var,             /* array variable, or unset variable */
+    Tcl_Obj *listPtr)        /* names and values of the elements */
+{
+    Tcl_Obj *namePtr;
+    Tcl_Obj **elemv;
+    Tcl_Size elemc;
+    Tcl_Size i;
+    int result = TCL_OK;
+
+    if (Tcl_ListObjGetElements(interp, listPtr, &elemc, &elemv) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (elemc % 2) {
+	Tcl_AppendResult(interp, "list must have an even number of elements",
+		NULL);
+	return TCL_ERROR;
+    }
+    namePtr = Tcl_NewObj();
+    Tcl_IncrRefCount(namePtr);
+    Tcl_GetVariableFullName(interp, var, namePtr);
+    if ((elemc == 0) && !TclIsVarArray((Var *)var)) {
+	/*
+	 *  There is no API to create an empty array: create it with an
+	 *  element, which is then removed.
+	 */
+	if (Tcl_SetVar2(interp, Tcl_GetString(namePtr), "", "",
+		TCL_GLOBAL_ONLY|TCL_LEAVE_ERR_MSG) == NULL) {
+	    result = TCL_ERROR;
+	} else {
+	    Tcl_UnsetVar2(interp, Tcl_GetString(namePtr), "",
+		    TCL_GLOBAL_ONLY);
+	}
+    }
+    for (i = 0; (i < elemc) && (result == TCL_OK); i += 2) {
+	if (Tcl_ObjSetVar2(interp, namePtr, elemv[i], elemv[i+1],
+		TCL_GLOBAL_ONLY|TCL_LEAVE_ERR_MSG) == NULL) {
+	    result = TCL_ERROR;
+	}
+    }
+    Tcl_DecrRefCount(namePtr);
+    return result;
+}
+
+/*
+ *  Flags of the variables which ItclCloneObject() does not copy: commons
+ *  and the built-in variables, which are set up for the new object.
+ */
+#define ITCL_CLONE_IGNORED_VARS (ITCL_COMMON|ITCL_THIS_VAR|ITCL_OPTIONS_VAR| \
+	ITCL_TYPE_VAR|ITCL_SELF_VAR|ITCL_SELFNS_VAR|ITCL_WIN_VAR| \
+	ITCL_HULL_VAR|ITCL_OPTION_COMP_VAR)
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclCloneObject()
+ *
+ *  Creates a copy of an object with ItclCreateUnconstructedObject() and
+ *  copies the values of all its instance variables, sharing the value
+ *  objects.  Then invokes the "postclone" method of the copy, if its
+ *  class has one.
+ *
+ *  Returns TCL_OK and the copy in *ioPtrPtr, or TCL_ERROR (along with
+ *  an error message in the interpreter), in which case the copy is
+ *  deleted again.
+ * ------------------------------------------------------------------------
+ */
+int
+ItclCloneObject(
+    Tcl_Interp *interp,      /* current interpreter */
+    ItclObject *ioPtr,       /* object to copy */
+    const char *name,        /* name of the copy */
+    ItclObject **ioPtrPtr)   /* returns the copy */
+{
+    FOREACH_HASH_DECLS;
+    Tcl_HashEntry *entryPtr;
+    ItclObject *newIoPtr;
+    ItclVariable *ivPtr;
+    ItclMemberFunc *imPtr;
+    Itcl_InterpState istate;
+    Tcl_Obj *valuePtr;
+    Var *varPtr;
+    Var *newVarPtr;
+    int result = TCL_OK;
+
+    if (ItclCreateUnconstructedObject(interp, name, ioPtr->iclsPtr,
+            &newIoPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    Itcl_PreserveData(newIoPtr);
+    FOREACH_HASH(ivPtr, varPtr, &ioPtr->objectVariables) {
+        if ((ivPtr->flags & ITCL_CLONE_IGNORED_VARS)
+                || TclIsVarDeadHash(varPtr)) {
+            continue;
+        }
+        entryPtr = Tcl_FindHashEntry(&newIoPtr->objectVariables,
+                (char *)ivPtr);
+        if (entryPtr == NULL) {
+            continue;
+        }
+        newVarPtr = (Var *)Tcl_GetHashValue(entryPtr);
+        if (TclIsVarArray(varPtr)) {
+            /*
+             *  Copying the elements keeps sharing their values.
+             */
+            valuePtr = ItclGetArrayElements(interp, (Tcl_Var)varPtr);
+            if (valuePtr == NULL) {
+                result = TCL_ERROR;
+            } else {
+                Tcl_IncrRefCount(valuePtr);
+                TclPtrUnsetVar(interp, (Tcl_Var)newVarPtr, NULL,
+                        ivPtr->namePtr, NULL, 0);
+                result = ItclSetArrayElements(interp, (Tcl_Var)newVarPtr,
+                        valuePtr);
+                Tcl_DecrRefCount(valuePtr);
+            }
+        } else if (TclIsVarUndefined(varPtr)) {
+            TclPtrUnsetVar(interp, (Tcl_Var)newVarPtr, NULL, ivPtr->namePtr,
+                    NULL, 0);
+        } else {
+            valuePtr = TclPtrGetVar(interp, (Tcl_Var)varPtr, NULL,
+                    ivPtr->namePtr, NULL, TCL_LEAVE_ERR_MSG);
+            if ((valuePtr == NULL) || (TclPtrSetVar(interp,
+                    (Tcl_Var)newVarPtr, NULL, ivPtr->namePtr, NULL, valuePtr,
+                    TCL_LEAVE_ERR_MSG) == NULL)) {
+                result = TCL_ERROR;
+            }
+        }
+        if (result != TCL_OK) {
+            break;
+        }
+    }
+
+    if ((result == TCL_OK) && (newIoPtr->accessCmd != NULL)) {
+        Tcl_ResetResult(interp);
+        imPtr = Itcl_LookupMethod(NULL, newIoPtr->iclsPtr, "postclone");
+        if (imPtr != NULL) {
+            result = Itcl_InvokeMethod(interp, newIoPtr, imPtr, 0, NULL);
+        }
+    }
+    if (result != TCL_OK) {
+        istate = Itcl_SaveInterpState(interp, result);
+        if (newIoPtr->accessCmd != NULL) {
+            Tcl_DeleteCommandFromToken(interp, newIoPtr->accessCmd);
+        }
+        result = Itcl_RestoreInterpState(interp, istate);
+    } else {
+        Tcl_ResetResult(interp);
+        *ioPtrPtr = newIoPtr;
+    }
+    Itcl_ReleaseData(newIoPtr);
+    return result;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  CreateObject()
+ *
+ *  Does the work of ItclCreateObject() and
+ *  ItclCreateUnconstructedObject().  Constructors are invoked only if
+ *  construct is non-zero.
+ * ------------------------------------------------------------------------
+ */
+static int
+CreateObject(
+    Tcl_Interp *interp,      /* interpreter mananging new object */
+    const char* name,        /* name of new object */
+    ItclClass *iclsPtr,        /* class for new object */
+    size_t objc,                /* number of arguments */
+    Tcl_Obj *const objv[],   /* argument objects */
+    int construct)           /* non-zero to invoke the constructors */
 {
     int result = TCL_OK;
 
@@ -220,6 +574,9 @@ ItclCreateObject(
     char unique[256];    /* buffer used for unique part of object names */
     int newEntry;
     ItclResolveInfo *resolveInfoPtr;
+    Tcl_WideInt traceStart = 0;
+    Tcl_WideInt phaseMark = 0;
+    int phase = ITCL_CONSTRUCT_INSTANTIATE;
     /* objv[1]: class name */
     /* objv[2]: class full name */
     /* objv[3]: object name */
@@ -243,6 +600,18 @@ ItclCreateObject(
 
     if (infoPtr != NULL) {
       infoPtr->lastIoPtr = NULL;
+      if (infoPtr->instrumentFlags & ITCL_INSTRUMENT_TRACE) {
+          traceStart = ItclGetMonotonicTime();
+      }
+      if (infoPtr->instrumentFlags & ITCL_INSTRUMENT_CONSTRUCT) {
+          if (iclsPtr->constructStatsPtr == NULL) {
+              iclsPtr->constructStatsPtr = (ItclConstructStats *)ckalloc(
+                      sizeof(ItclConstructStats));
+              memset(iclsPtr->constructStatsPtr, 0,
+                      sizeof(ItclConstructStats));
+          }
+          phaseMark = ItclGetMonotonicTime();
+      }
     }
     /*
      *  Create a new object and initialize it.
@@ -261,8 +630,12 @@ ItclCreateObject(
             /* nsName */ NULL, /* objc */ -1, /* objv */ NULL, /* skip */ 0);
     if (ioPtr->oPtr == NULL) {
 	Itcl_Free(ioPtr);
+        ConstructDone(iclsPtr, phase, phaseMark, TCL_ERROR);
         return TCL_ERROR;
     }
+    if (++iclsPtr->numInstances > iclsPtr->maxInstances) {
+        iclsPtr->maxInstances = iclsPtr->numInstances;
+    }
 
     /*
      *  Add a command to the current namespace with the object name.
@@ -311,17 +684,20 @@ ItclCreateObject(
      * and set all the init values for variables
      */
 
+    ConstructPhase(iclsPtr, &phase, &phaseMark, ITCL_CONSTRUCT_VARIABLES);
     if (ItclInitObjectVariables(interp, ioPtr, iclsPtr) != TCL_OK) {
 	ioPtr->hadConstructorError = 11;
 	result = TCL_ERROR;
         goto errorReturn;
     }
+    ConstructPhase(iclsPtr, &phase, &phaseMark, ITCL_CONSTRUCT_COMMANDS);
     if (ItclInitObjectCommands(interp, ioPtr, iclsPtr, name) != TCL_OK) {
 	Tcl_AppendResult(interp, "error in ItclInitObjectCommands", NULL);
 	ioPtr->hadConstructorError = 12;
 	result = TCL_ERROR;
         goto errorReturn;
     }
+    ConstructPhase(iclsPtr, &phase, &phaseMark, ITCL_CONSTRUCT_OPTIONS);
     if (iclsPtr->flags & (ITCL_ECLASS|ITCL_NWIDGET|ITCL_WIDGET|
             ITCL_TYPE|ITCL_WIDGETADAPTOR)) {
 	if (iclsPtr->flags & (ITCL_ECLASS|ITCL_TYPE|ITCL_WIDGET|
@@ -355,6 +731,7 @@ ItclCreateObject(
 	}
 
     }
+    ConstructPhase(iclsPtr, &phase, &phaseMark, ITCL_CONSTRUCT_INSTANTIATE);
 
     saveCurrIoPtr = infoPtr->currIoPtr;
     infoPtr->currIoPtr = ioPtr;
@@ -478,8 +855,11 @@ ItclCreateObject(
      */
     ItclShowArgs(1, "OBJECTCONSTRUCTOR", objc, objv);
     ioPtr->hadConstructorError = 0;
-    result = Itcl_InvokeMethodIfExists(interp, "constructor",
-        iclsPtr, ioPtr, objc, objv);
+    ConstructPhase(iclsPtr, &phase, &phaseMark, ITCL_CONSTRUCT_CONSTRUCTORS);
+    if (construct) {
+        result = Itcl_InvokeMethodIfExists(interp, "constructor",
+            iclsPtr, ioPtr, objc, objv);
+    }
     if (ioPtr->hadConstructorError) {
         result = TCL_ERROR;
     }
@@ -508,11 +888,13 @@ ItclCreateObject(
      *  same chain reaction.
      */
     objPtr = Tcl_NewStringObj("constructor", TCL_INDEX_NONE);
-    if (Tcl_FindHashEntry(&iclsPtr->functions, (char *)objPtr) == NULL) {
+    if (construct
+	    && (Tcl_FindHashEntry(&iclsPtr->functions, (char *)objPtr) == NULL)) {
         result = Itcl_ConstructBase(interp, ioPtr, iclsPtr);
     }
     Tcl_DecrRefCount(objPtr);
 
+    ConstructPhase(iclsPtr, &phase, &phaseMark, ITCL_CONSTRUCT_OPTIONS);
     if (iclsPtr->flags & ITCL_ECLASS) {
         ItclInitExtendedClassOptions(interp, ioPtr);
         if (ItclInitObjectOptions(interp, ioPtr, iclsPtr) != TCL_OK) {
@@ -583,6 +965,7 @@ ItclCreateObject(
             goto errorReturn;
 	}
     }
+    ConstructPhase(iclsPtr, &phase, &phaseMark, ITCL_CONSTRUCT_DELEGATION);
     if (iclsPtr->flags & (ITCL_ECLASS|ITCL_TYPE|ITCL_WIDGETADAPTOR)) {
 	/* FIXME have to check for hierarchy if ITCL_ECLASS !! */
 	result = ItclCheckForInitializedComponents(interp, ioPtr->iclsPtr,
@@ -617,6 +1000,8 @@ ItclCreateObject(
 		goto errorReturn;
 	    }
 	}
+        ConstructPhase(iclsPtr, &phase, &phaseMark,
+                ITCL_CONSTRUCT_INSTANTIATE);
         hPtr = Tcl_CreateHashEntry(&iclsPtr->infoPtr->objectCmds,
                 (char*)ioPtr->accessCmd, &newEntry);
         Tcl_SetHashValue(hPtr, ioPtr);
@@ -686,7 +1071,18 @@ ItclCreateObject(
     Tcl_DeleteHashTable(ioPtr->constructed);
     ckfree((char*)ioPtr->constructed);
     ioPtr->constructed = NULL;
+    ConstructPhase(iclsPtr, &phase, &phaseMark, ITCL_CONSTRUCT_DICTINFO);
     ItclAddObjectsDictInfo(interp, ioPtr);
+    ConstructDone(iclsPtr, phase, phaseMark, result);
+    if ((traceStart != 0)
+	    && (infoPtr->instrumentFlags & ITCL_INSTRUMENT_TRACE)) {
+        ItclTraceObject(infoPtr, ITCL_TRACE_CREATE, ioPtr, traceStart,
+		result);
+    }
+    if (infoPtr->eventMask & ITCL_EVENT_OBJECT_CREATE) {
+        ItclFireEvent(infoPtr, ITCL_EVENT_OBJECT_CREATE, iclsPtr, ioPtr,
+		NULL, result);
+    }
     Itcl_ReleaseData(ioPtr);
     return result;
 
@@ -712,6 +1108,11 @@ errorReturn:
         ioPtr->constructed = NULL;
     }
     ItclDeleteObjectVariablesNamespace(interp, ioPtr);
+    ConstructDone(iclsPtr, phase, phaseMark, result);
+    if ((infoPtr != NULL) && (infoPtr->eventMask & ITCL_EVENT_OBJECT_CREATE)) {
+        ItclFireEvent(infoPtr, ITCL_EVENT_OBJECT_CREATE, iclsPtr, ioPtr,
+		NULL, result);
+    }
     Itcl_ReleaseData(ioPtr);
     Itcl_ReleaseData(ioPtr);
     return result;
@@ -1030,6 +1431,12 @@ ItclInitObjectVariables(
     }
     Tcl_DStringFree(&buffer);
     Itcl_DeleteHierIter(&hier);
+    if (ItclInitTypedVars(interp, ioPtr) != TCL_OK) {
+	goto errorCleanup2;
+    }
+    if (ItclIndexObject(interp, ioPtr) != TCL_OK) {
+	goto errorCleanup2;
+    }
     return TCL_OK;
 errorCleanup:
     Itcl_PopCallFrame(interp);
@@ -1042,6 +1449,142 @@ errorCleanup2:
     return TCL_ERROR;
 }
 
+/*
+ * ------------------------------------------------------------------------
+ *  ItclInitTypedVars()
+ *
+ *  Allocates the buffer of C values of the typed instance variables of
+ *  an object, fills it with their initial values, and puts a trace on
+ *  each of them which keeps the buffer up to date.
+ * ------------------------------------------------------------------------
+ */
+static int
+ItclInitTypedVars(
+    Tcl_Interp *interp,
+    ItclObject *ioPtr)
+{
+    ItclClass *iclsPtr = ioPtr->iclsPtr;
+    ItclTypedVarSlot *slotPtr;
+    ItclVariable *ivPtr;
+    Tcl_HashEntry *hPtr2;
+    Tcl_Obj *namePtr;
+    Tcl_Obj *valuePtr;
+    void *offset;
+    FOREACH_HASH_DECLS;
+    int result = TCL_OK;
+
+    if (iclsPtr->numTypedVars == 0) {
+	return TCL_OK;
+    }
+    ioPtr->typedData = (char *)ckalloc(iclsPtr->typedSize
+	    + iclsPtr->numTypedVars * sizeof(ItclTypedVarSlot));
+    memset(ioPtr->typedData, 0, iclsPtr->typedSize);
+    slotPtr = (ItclTypedVarSlot *)(ioPtr->typedData + iclsPtr->typedSize);
+    FOREACH_HASH(ivPtr, offset, iclsPtr->typedVars) {
+	slotPtr->ioPtr = ioPtr;
+	slotPtr->ivPtr = ivPtr;
+	slotPtr->varPtr = NULL;
+	slotPtr->valuePtr = ioPtr->typedData + PTR2INT(offset);
+	hPtr2 = Tcl_FindHashEntry(&ioPtr->objectVariables, (char *)ivPtr);
+	if (hPtr2 == NULL) {
+	    slotPtr++;
+	    continue;
+	}
+
+	/*
+	 *  Object variables are preserved as long as the object exists,
+	 *  so the trace can use the variable directly.
+	 */
+	slotPtr->varPtr = (Tcl_Var)Tcl_GetHashValue(hPtr2);
+	namePtr = Tcl_NewObj();
+	Tcl_IncrRefCount(namePtr);
+	Tcl_GetVariableFullName(interp, slotPtr->varPtr, namePtr);
+	valuePtr = Tcl_ObjGetVar2(interp, namePtr, NULL, 0);
+	if (valuePtr != NULL) {
+	    result = ItclGetTypedValue(interp, slotPtr->ivPtr->type,
+		    valuePtr, slotPtr->valuePtr);
+	    if ((result == TCL_OK)
+		    && (slotPtr->ivPtr->type == ITCL_VARTYPE_DOUBLE)) {
+		Tcl_ObjSetVar2(interp, namePtr, NULL,
+			NewTypedValueObj(slotPtr), 0);
+	    }
+	}
+	if (result == TCL_OK) {
+	    result = Tcl_TraceVar2(interp, Tcl_GetString(namePtr), NULL,
+		    TCL_TRACE_WRITES|TCL_TRACE_UNSETS|TCL_TRACE_RESULT_OBJECT,
+		    ItclTraceTypedVar, slotPtr);
+	}
+	Tcl_DecrRefCount(namePtr);
+	slotPtr++;
+	if (result != TCL_OK) {
+	    return TCL_ERROR;
+	}
+    }
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclGetTypedValue()
+ *
+ *  Converts a value to the C type of a typed variable, and stores it
+ *  at valuePtr.
+ *
+ *  Returns TCL_OK on success, or TCL_ERROR (along with an error message
+ *  in the interpreter) if the value is not valid for the type.
+ * ------------------------------------------------------------------------
+ */
+int
+ItclGetTypedValue(
+    Tcl_Interp *interp,          /* interpreter for error messages */
+    int type,                    /* ITCL_VARTYPE_* */
+    Tcl_Obj *objPtr,             /* value to convert */
+    void *valuePtr)              /* where to store the C value */
+{
+    switch (type) {
+    case ITCL_VARTYPE_DOUBLE:
+	return Tcl_GetDoubleFromObj(interp, objPtr, (double *)valuePtr);
+    case ITCL_VARTYPE_WIDEINT:
+	return Tcl_GetWideIntFromObj(interp, objPtr,
+		(Tcl_WideInt *)valuePtr);
+    case ITCL_VARTYPE_INT:
+	return Tcl_GetIntFromObj(interp, objPtr, (int *)valuePtr);
+    case ITCL_VARTYPE_BOOLEAN:
+	return Tcl_GetBooleanFromObj(interp, objPtr, (int *)valuePtr);
+    }
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_GetTypedVarPtr()
+ *
+ *  Returns the address of the C value of a typed instance variable of
+ *  an object, as resolved by Itcl_LookupMemberVar().  The address stays
+ *  valid as long as the object exists, and the value is updated each
+ *  time the variable is set.  It must not be written directly; use
+ *  Itcl_SetVarByHandle() instead.
+ *
+ *  Returns NULL if the variable is not a typed variable of the object.
+ * ------------------------------------------------------------------------
+ */
+void *
+Itcl_GetTypedVarPtr(
+    ItclObject *ioPtr,         /* object */
+    ItclVariable *ivPtr)       /* handle of the typed variable */
+{
+    Tcl_HashEntry *hPtr;
+
+    if (ioPtr->typedData == NULL) {
+	return NULL;
+    }
+    hPtr = Tcl_FindHashEntry(ioPtr->iclsPtr->typedVars, (char *)ivPtr);
+    if (hPtr == NULL) {
+	return NULL;
+    }
+    return ioPtr->typedData + PTR2INT(Tcl_GetHashValue(hPtr));
+}
+
 /*
  * ------------------------------------------------------------------------
  *  ItclInitObjectOptions()
@@ -1201,17 +1744,27 @@ Itcl_DeleteObject(
 {
     Tcl_CmdInfo cmdInfo;
     Tcl_HashEntry *hPtr;
+    ItclObjectInfo *infoPtr = contextIoPtr->infoPtr;
+    Tcl_WideInt traceStart = 0;
 
 
     Tcl_GetCommandInfoFromToken(contextIoPtr->accessCmd, &cmdInfo);
 
     contextIoPtr->flags |= ITCL_OBJECT_IS_DELETED;
     Itcl_PreserveData(contextIoPtr);
+    if (infoPtr->instrumentFlags & ITCL_INSTRUMENT_TRACE) {
+        traceStart = ItclGetMonotonicTime();
+    }
 
     /*
      *  Invoke the object's destructors.
      */
     if (Itcl_DestructObject(interp, contextIoPtr, 0) != TCL_OK) {
+        if ((traceStart != 0)
+		&& (infoPtr->instrumentFlags & ITCL_INSTRUMENT_TRACE)) {
+            ItclTraceObject(infoPtr, ITCL_TRACE_DESTROY, contextIoPtr,
+		    traceStart, TCL_ERROR);
+        }
 	Itcl_ReleaseData(contextIoPtr);
 	contextIoPtr->flags |=
 	        ITCL_TCLOO_OBJECT_IS_DELETED|ITCL_OBJECT_DESTRUCT_ERROR;
@@ -1244,6 +1797,15 @@ Itcl_DeleteObject(
     }
     contextIoPtr->oPtr = NULL;
     contextIoPtr->accessCmd = NULL;
+    if ((traceStart != 0)
+	    && (infoPtr->instrumentFlags & ITCL_INSTRUMENT_TRACE)) {
+        ItclTraceObject(infoPtr, ITCL_TRACE_DESTROY, contextIoPtr,
+		traceStart, TCL_OK);
+    }
+    if (infoPtr->eventMask & ITCL_EVENT_OBJECT_DELETE) {
+        ItclFireEvent(infoPtr, ITCL_EVENT_OBJECT_DELETE, NULL, contextIoPtr,
+		NULL, TCL_OK);
+    }
 
     Itcl_ReleaseData(contextIoPtr);
 
@@ -1908,6 +2470,139 @@ ItclSetInstanceVar(
 
     return val;
 }
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_LookupMemberVar()
+ *
+ *  Resolves the name of a data member, instance variable or common, in
+ *  the scope of the given class once, so that it can be accessed with
+ *  Itcl_GetVarByHandle() and Itcl_SetVarByHandle() without looking up
+ *  its name again.  The name may be qualified by a base class name.
+ *  The handle stays valid as long as the class which defines the
+ *  member exists.
+ *
+ *  Returns the handle or NULL (along with an error message in the
+ *  interpreter, if interp is not NULL) if there is no such member.
+ * ------------------------------------------------------------------------
+ */
+ItclVariable *
+Itcl_LookupMemberVar(
+    Tcl_Interp *interp,        /* for error messages or NULL */
+    ItclClass *iclsPtr,        /* name is interpreted in this scope */
+    const char *name)          /* name of the data member */
+{
+    Tcl_HashEntry *hPtr;
+    ItclVarLookup *vlookup;
+
+    hPtr = ItclResolveVarEntry(iclsPtr, name);
+    if (hPtr == NULL) {
+	if (interp != NULL) {
+	    Tcl_AppendResult(interp, "variable \"", name,
+		    "\" not found in class \"",
+		    Tcl_GetString(iclsPtr->fullNamePtr), "\"", NULL);
+	}
+	return NULL;
+    }
+    vlookup = (ItclVarLookup *)Tcl_GetHashValue(hPtr);
+    return vlookup->ivPtr;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  HandleVar()
+ *
+ *  Returns the variable of a data member resolved by
+ *  Itcl_LookupMemberVar(): the variable of the class for a common or
+ *  the variable of the object for an instance variable.  Returns NULL
+ *  (along with an error message) if the object has no such variable.
+ * ------------------------------------------------------------------------
+ */
+static Tcl_Var
+HandleVar(
+    Tcl_Interp *interp,        /* current interpreter */
+    ItclObject *ioPtr,         /* object or NULL for a common */
+    ItclVariable *ivPtr)       /* handle of the data member */
+{
+    Tcl_HashEntry *hPtr;
+
+    if (ivPtr->flags & ITCL_COMMON) {
+	hPtr = Tcl_FindHashEntry(&ivPtr->iclsPtr->classCommons,
+		(char *)ivPtr);
+    } else if (ioPtr == NULL) {
+	Tcl_AppendResult(interp, "cannot access object-specific info ",
+		"without an object context", NULL);
+	return NULL;
+    } else {
+	hPtr = Tcl_FindHashEntry(&ioPtr->objectVariables, (char *)ivPtr);
+    }
+    if (hPtr == NULL) {
+	Tcl_AppendResult(interp, "variable \"",
+		Tcl_GetString(ivPtr->fullNamePtr), "\" is not a member of ",
+		(ioPtr != NULL) ? "object \"" : "class \"",
+		Tcl_GetString((ioPtr != NULL) ? ioPtr->namePtr
+		: ivPtr->iclsPtr->fullNamePtr), "\"", NULL);
+	return NULL;
+    }
+    return (Tcl_Var)Tcl_GetHashValue(hPtr);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_GetVarByHandle()
+ *
+ *  Returns the value of a data member resolved by Itcl_LookupMemberVar()
+ *  for the given object, which may be NULL for a common.  The object
+ *  must belong to the class of the handle or a class derived from it.
+ *  Variable traces fire as usual.
+ *
+ *  Returns the value, owned by the variable, or NULL (along with an
+ *  error message in the interpreter) if anything goes wrong.
+ * ------------------------------------------------------------------------
+ */
+Tcl_Obj *
+Itcl_GetVarByHandle(
+    Tcl_Interp *interp,        /* current interpreter */
+    ItclObject *ioPtr,         /* object or NULL for a common */
+    ItclVariable *ivPtr)       /* handle of the data member */
+{
+    Tcl_Var varPtr = HandleVar(interp, ioPtr, ivPtr);
+
+    if (varPtr == NULL) {
+	return NULL;
+    }
+    return TclPtrGetVar(interp, varPtr, NULL, ivPtr->namePtr, NULL,
+	    TCL_LEAVE_ERR_MSG);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_SetVarByHandle()
+ *
+ *  Sets the value of a data member resolved by Itcl_LookupMemberVar()
+ *  for the given object, which may be NULL for a common.  Variable
+ *  traces fire as usual, but the "config" code of a public variable is
+ *  not run, as with a "set" in a method.
+ *
+ *  Returns the new value of the variable or NULL (along with an error
+ *  message in the interpreter) if anything goes wrong.
+ * ------------------------------------------------------------------------
+ */
+Tcl_Obj *
+Itcl_SetVarByHandle(
+    Tcl_Interp *interp,        /* current interpreter */
+    ItclObject *ioPtr,         /* object or NULL for a common */
+    ItclVariable *ivPtr,       /* handle of the data member */
+    Tcl_Obj *valuePtr)         /* new value */
+{
+    Tcl_Var varPtr = HandleVar(interp, ioPtr, ivPtr);
+
+    if (varPtr == NULL) {
+	return NULL;
+    }
+    return TclPtrSetVar(interp, varPtr, NULL, ivPtr->namePtr, NULL,
+	    valuePtr, TCL_LEAVE_ERR_MSG);
+}
 
 /*
  * ------------------------------------------------------------------------
@@ -2565,6 +3260,114 @@ ItclTraceItclHullVar(
     return NULL;
 }
 
+/*
+ * ------------------------------------------------------------------------
+ *  ItclTraceTypedVar()
+ *
+ *  Invoked to handle write/unset traces on typed instance variables.
+ *
+ *  On write, this procedure converts the new value to the C type of the
+ *  variable and stores it in the buffer of the object.  If the value is
+ *  not valid for the type, the old value is restored and an error is
+ *  returned.  When the variable is unset, its C value is reset to 0 and
+ *  the trace is put back, unless the object is being destroyed.
+ * ------------------------------------------------------------------------
+ */
+
+static char*
+ItclTraceTypedVar(
+    void *cdata,            /* ItclTypedVarSlot of the variable */
+    Tcl_Interp *interp,	    /* interpreter managing this variable */
+    TCL_UNUSED(const char *),   /* variable name */
+    TCL_UNUSED(const char *),   /* element name or NULL */
+    int flags)              /* flags indicating write/unset */
+{
+    ItclTypedVarSlot *slotPtr = (ItclTypedVarSlot *)cdata;
+    ItclObject *ioPtr = slotPtr->ioPtr;
+    Tcl_InterpState state;
+    Tcl_Var varPtr = slotPtr->varPtr;
+    Tcl_Obj *valuePtr;
+    Tcl_Obj *errorPtr;
+    Tcl_Obj *namePtr;
+
+    if (flags & TCL_TRACE_UNSETS) {
+	memset(slotPtr->valuePtr, 0,
+		(slotPtr->ivPtr->type == ITCL_VARTYPE_DOUBLE)
+		? sizeof(double) : (slotPtr->ivPtr->type == ITCL_VARTYPE_WIDEINT)
+		? sizeof(Tcl_WideInt) : sizeof(int));
+	if (!(flags & TCL_TRACE_DESTROYED) || (flags & TCL_INTERP_DESTROYED)
+		|| (ioPtr->flags & (ITCL_OBJECT_IS_DELETED|
+		ITCL_OBJECT_IS_DESTRUCTED|ITCL_OBJECT_IS_DESTROYED))) {
+	    return NULL;
+	}
+	namePtr = Tcl_NewObj();
+	Tcl_GetVariableFullName(interp, varPtr, namePtr);
+	Tcl_TraceVar2(interp, Tcl_GetString(namePtr), NULL,
+		TCL_TRACE_WRITES|TCL_TRACE_UNSETS|TCL_TRACE_RESULT_OBJECT,
+		ItclTraceTypedVar, slotPtr);
+	Tcl_DecrRefCount(namePtr);
+	return NULL;
+    }
+
+    /*
+     *  The variable is not necessarily visible under name1 from the
+     *  current frame, e.g. when it is set by Itcl_SetVarByHandle(), so
+     *  access it directly.  The interpreter state is only saved for the
+     *  error message when the value is not valid.
+     */
+    valuePtr = TclPtrGetVar(interp, varPtr, NULL,
+	    slotPtr->ivPtr->namePtr, NULL, 0);
+    if (valuePtr == NULL) {
+	return NULL;
+    }
+    if (ItclGetTypedValue(NULL, slotPtr->ivPtr->type, valuePtr,
+	    slotPtr->valuePtr) == TCL_OK) {
+	/*
+	 *  Keep doubles as such, so that "expr" does not fall back to
+	 *  integer arithmetic on values like "2".
+	 */
+	if ((slotPtr->ivPtr->type == ITCL_VARTYPE_DOUBLE)
+		&& (valuePtr->typePtr != ioPtr->infoPtr->doubleTypePtr)) {
+	    TclPtrSetVar(interp, varPtr, NULL,
+		    slotPtr->ivPtr->namePtr, NULL, NewTypedValueObj(slotPtr), 0);
+	}
+	return NULL;
+    }
+    state = Tcl_SaveInterpState(interp, TCL_OK);
+    ItclGetTypedValue(interp, slotPtr->ivPtr->type, valuePtr,
+	    slotPtr->valuePtr);
+    errorPtr = Tcl_DuplicateObj(Tcl_GetObjResult(interp));
+    Tcl_IncrRefCount(errorPtr);      /* released by Tcl */
+    Tcl_RestoreInterpState(interp, state);
+
+    TclPtrSetVar(interp, varPtr, NULL, slotPtr->ivPtr->namePtr,
+	    NULL, NewTypedValueObj(slotPtr), 0);
+    return (char *)errorPtr;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  NewTypedValueObj()
+ *
+ *  Returns a new Tcl object holding the C value of a typed variable.
+ * ------------------------------------------------------------------------
+ */
+
+static Tcl_Obj *
+NewTypedValueObj(
+    ItclTypedVarSlot *slotPtr)  /* typed variable of an object */
+{
+    switch (slotPtr->ivPtr->type) {
+    case ITCL_VARTYPE_DOUBLE:
+	return Tcl_NewDoubleObj(*(double *)slotPtr->valuePtr);
+    case ITCL_VARTYPE_WIDEINT:
+	return Tcl_NewWideIntObj(*(Tcl_WideInt *)slotPtr->valuePtr);
+    case ITCL_VARTYPE_BOOLEAN:
+	return Tcl_NewBooleanObj(*(int *)slotPtr->valuePtr);
+    }
+    return Tcl_NewIntObj(*(int *)slotPtr->valuePtr);
+}
+
 /*
  * ------------------------------------------------------------------------
  *  ItclDestroyObject()
@@ -2585,13 +3388,18 @@ ItclDestroyObject(
     void *cdata)  /* object instance data */
 {
     ItclObject *contextIoPtr = (ItclObject*)cdata;
+    ItclObjectInfo *infoPtr = contextIoPtr->infoPtr;
     Tcl_HashEntry *hPtr;
     Itcl_InterpState istate;
+    Tcl_WideInt traceStart = 0;
 
     if (contextIoPtr->flags & ITCL_OBJECT_IS_DESTROYED) {
         return;
     }
     contextIoPtr->flags |= ITCL_OBJECT_IS_DESTROYED;
+    if (infoPtr->instrumentFlags & ITCL_INSTRUMENT_TRACE) {
+        traceStart = ItclGetMonotonicTime();
+    }
 
     if (!(contextIoPtr->flags & ITCL_OBJECT_IS_DESTRUCTED)) {
         /*
@@ -2618,6 +3426,17 @@ ItclDestroyObject(
         }
         contextIoPtr->accessCmd = NULL;
     }
+    ItclIndexForgetObject(contextIoPtr);
+    ItclMemoForgetObject(contextIoPtr);
+    if ((traceStart != 0)
+	    && (infoPtr->instrumentFlags & ITCL_INSTRUMENT_TRACE)) {
+        ItclTraceObject(infoPtr, ITCL_TRACE_DESTROY, contextIoPtr,
+		traceStart, TCL_OK);
+    }
+    if (infoPtr->eventMask & ITCL_EVENT_OBJECT_DELETE) {
+        ItclFireEvent(infoPtr, ITCL_EVENT_OBJECT_DELETE, NULL, contextIoPtr,
+		NULL, TCL_OK);
+    }
     Itcl_ReleaseData(contextIoPtr);
 }
 
@@ -2653,6 +3472,9 @@ FreeObject(
      *    from below.
      */
 
+    ioPtr->iclsPtr->numInstances--;
+    ItclIndexForgetObject(ioPtr);
+    ItclMemoFreeObject(ioPtr);
     ItclReleaseClass(ioPtr->iclsPtr);
     if (ioPtr->constructed) {
         Tcl_DeleteHashTable(ioPtr->constructed);
@@ -2699,6 +3521,9 @@ FreeObject(
 	ckfree((char *)ioPtr->resolvePtr->clientData);
         ckfree((char*)ioPtr->resolvePtr);
     }
+    if (ioPtr->typedData != NULL) {
+        ckfree(ioPtr->typedData);
+    }
     Itcl_Free(ioPtr);
 }
 
@@ -2726,6 +3551,28 @@ CallPublicObjectCmd(
     return result;
 }
 
+/*
+ *  Like CallPublicObjectCmd(), but for the static methods, which need
+ *  no mapping of their name by ItclMapMethodNameProc().
+ */
+static int
+CallStaticObjectCmd(
+    void *data[],
+    Tcl_Interp *interp,
+    int result)
+{
+    Tcl_Object *oPtr = (Tcl_Object *)data[0];
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)data[1];
+    Tcl_Obj *const *objv = (Tcl_Obj *const *)data[3];
+    size_t objc = PTR2INT(data[2]);
+
+    ItclShowArgs(1, "CallStaticObjectCmd", objc, objv);
+    infoPtr->mapMethodDirect = 1;
+    result = Itcl_PublicObjectCmd(oPtr, interp, NULL, objc, objv);
+    infoPtr->mapMethodDirect = 0;
+    return result;
+}
+
 int
 ItclObjectCmd(
     void *clientData,
@@ -2887,8 +3734,13 @@ ItclObjectCmd(
         newObjv[1] = methodNamePtr;
         memcpy(newObjv+incr+1, objv+1, (sizeof(Tcl_Obj*)*(objc-1)));
 	ItclShowArgs(1, "run CallPublicObjectCmd1", objc+incr, newObjv);
-	Tcl_NRAddCallback(interp, CallPublicObjectCmd, oPtr, clsPtr,
-	        INT2PTR(objc+incr), newObjv);
+	if (isDirectCall && !found && Itcl_IsStaticMethod(imPtr)) {
+	    Tcl_NRAddCallback(interp, CallStaticObjectCmd, oPtr,
+		    imPtr->infoPtr, INT2PTR(objc+incr), newObjv);
+	} else {
+	    Tcl_NRAddCallback(interp, CallPublicObjectCmd, oPtr, clsPtr,
+		    INT2PTR(objc+incr), newObjv);
+	}
 
     } else {
 	ItclShowArgs(1, "run CallPublicObjectCmd2", objc, objv);
@@ -3008,6 +3860,11 @@ ItclMapMethodNameProc(
     methodName = NULL;
     infoPtr = (ItclObjectInfo *)Tcl_GetAssocData(interp,
             ITCL_INTERP_DATA, NULL);
+    if (infoPtr->mapMethodDirect) {
+	/* called by Itcl_NRInvokeMethod() with a resolved method */
+	infoPtr->mapMethodDirect = 0;
+	return TCL_OK;
+    }
     ioPtr = (ItclObject *)Tcl_ObjectGetMetadata(oPtr,
             infoPtr->object_meta_type);
     hPtr = Tcl_FindHashEntry(&infoPtr->objects, (char *)ioPtr);
@@ -112,6 +112,13 @@ typedef struct ProtectionCmdInfo {
     ItclObjectInfo *infoPtr;  /* info regarding all known objects */
 } ProtectionCmdInfo;
 
+/*
+ *  Types of "variable name -type type", in the order of ITCL_VARTYPE_*:
+ */
+static const char *const varTypeNames[] = {
+    "double", "wideint", "int", "boolean", NULL
+};
+
 /*
  *  FORWARD DECLARATIONS
  */
@@ -119,11 +126,22 @@ static Tcl_CmdDeleteProc ItclFreeParserCommandData;
 static void ItclDelObjectInfo(char* cdata);
 static int ItclInitClassCommon(Tcl_Interp *interp, ItclClass *iclsPtr,
         ItclVariable *ivPtr, const char *initStr);
+static int DefineClass(ItclObjectInfo *infoPtr, Tcl_Interp *interp,
+        int flags, const char *className, Tcl_Obj *definitionPtr,
+        const Itcl_ClassSpec *specPtr, ItclClass **iclsPtrPtr);
+static int DefineClassMembers(ItclObjectInfo *infoPtr, Tcl_Interp *interp,
+        ItclClass *iclsPtr, const Itcl_ClassSpec *specPtr);
+static void AppendWord(Tcl_Obj *cmdPtr, const char *word);
+static int CheckFinalMethods(Tcl_Interp *interp, ItclClass *iclsPtr);
+static int CallParserCmd(ItclObjectInfo *infoPtr, Tcl_Interp *interp,
+        Tcl_ObjCmdProc *cmdProc, int protection, Tcl_Obj *cmdPtr);
 
 static Tcl_ObjCmdProc Itcl_ClassTypeVariableCmd;
 static Tcl_ObjCmdProc Itcl_ClassTypeMethodCmd;
 static Tcl_ObjCmdProc Itcl_ClassFilterCmd;
+static Tcl_ObjCmdProc Itcl_ClassFinalCmd;
 static Tcl_ObjCmdProc Itcl_ClassMixinCmd;
+static Tcl_ObjCmdProc Itcl_ClassSealedCmd;
 static Tcl_ObjCmdProc Itcl_WidgetCmd;
 static Tcl_ObjCmdProc Itcl_WidgetAdaptorCmd;
 static Tcl_ObjCmdProc Itcl_ClassComponentCmd;
@@ -145,6 +163,7 @@ static const struct {
     {"constructor", Itcl_ClassConstructorCmd},
     {"destructor", Itcl_ClassDestructorCmd},
     {"filter", Itcl_ClassFilterCmd},
+    {"final", Itcl_ClassFinalCmd},
     {"forward", Itcl_ClassForwardCmd},
     {"handleClass", Itcl_HandleClass},
     {"hulltype", Itcl_ClassHullTypeCmd},
@@ -154,6 +173,7 @@ static const struct {
     {"mixin", Itcl_ClassMixinCmd},
     {"option", Itcl_ClassOptionCmd},
     {"proc", Itcl_ClassProcCmd},
+    {"sealed", Itcl_ClassSealedCmd},
     {"typecomponent", Itcl_ClassTypeComponentCmd },
     {"typeconstructor", Itcl_ClassTypeConstructorCmd},
     {"typemethod", Itcl_ClassTypeMethodCmd},
@@ -343,6 +363,45 @@ Itcl_ParseInit(
     Tcl_CreateObjCommand(interp, "::itcl::scope", Itcl_ScopeCmd,
         NULL, NULL);
 
+    /*
+     *  Add the "state" commands (get/set) for whole object states.
+     */
+    if (Itcl_CreateEnsemble(interp, "::itcl::state") != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (Itcl_AddEnsemblePart(interp, "::itcl::state",
+            "get", "object ?-public|-all? ?-class className?",
+            Itcl_StateGetCmd, infoPtr, Itcl_ReleaseData) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    Itcl_PreserveData(infoPtr);
+    if (Itcl_AddEnsemblePart(interp, "::itcl::state",
+            "set", "object dict ?-class className? ?-configure?",
+            Itcl_StateSetCmd, infoPtr, Itcl_ReleaseData) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    Itcl_PreserveData(infoPtr);
+
+    /*
+     *  Add the "column" commands (get/set) for a variable of all
+     *  instances of a class.
+     */
+    if (Itcl_CreateEnsemble(interp, "::itcl::column") != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (Itcl_AddEnsemblePart(interp, "::itcl::column",
+            "get", "className varName ?-isa? ?-objects?",
+            Itcl_ColumnGetCmd, infoPtr, Itcl_ReleaseData) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    Itcl_PreserveData(infoPtr);
+    if (Itcl_AddEnsemblePart(interp, "::itcl::column",
+            "set", "className varName values ?-isa? ?-objects?",
+            Itcl_ColumnSetCmd, infoPtr, Itcl_ReleaseData) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    Itcl_PreserveData(infoPtr);
+
     /*
      *  Add the "filter" commands (add/delete)
      */
@@ -432,6 +491,10 @@ Itcl_ParseInit(
         infoPtr, Itcl_ReleaseData);
     Itcl_PreserveData(infoPtr);
 
+    Tcl_CreateObjCommand(interp, "::itcl::record", Itcl_RecordCmd,
+        infoPtr, Itcl_ReleaseData);
+    Itcl_PreserveData(infoPtr);
+
     Tcl_CreateObjCommand(interp, "::itcl::widget", Itcl_WidgetCmd,
         infoPtr, Itcl_ReleaseData);
     Itcl_PreserveData(infoPtr);
@@ -719,6 +782,40 @@ ItclClassBaseCmd(
     int objc,                /* number of arguments */
     Tcl_Obj *const objv[],   /* argument objects */
     ItclClass **iclsPtrPtr)  /* for returning iclsPtr */
+{
+    if (iclsPtrPtr != NULL) {
+        *iclsPtrPtr = NULL;
+    }
+    if (objc != 3) {
+        Tcl_WrongNumArgs(interp, 1, objv, "name { definition }");
+        return TCL_ERROR;
+    }
+    ItclShowArgs(1, "ItclClassBaseCmd", objc, objv);
+    return DefineClass((ItclObjectInfo *)clientData, interp, flags,
+	    Tcl_GetString(objv[1]), objv[2], NULL, iclsPtrPtr);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  DefineClass()
+ *
+ *  Creates a class and defines its members, either by evaluating the
+ *  body of a class definition, or from the descriptors given to
+ *  Itcl_DefineClass().  Then completes the class.
+ * ------------------------------------------------------------------------
+ */
+static int
+DefineClass(
+    ItclObjectInfo *infoPtr, /* info for all known objects */
+    Tcl_Interp *interp,      /* current interpreter */
+    int flags,               /* flags: ITCL_CLASS, ITCL_TYPE,
+                              * ITCL_WIDGET or ITCL_WIDGETADAPTOR */
+    const char *className,   /* name of the class */
+    Tcl_Obj *definitionPtr,  /* body of the class definition, or NULL */
+    const Itcl_ClassSpec *specPtr,
+                             /* members of the class if definitionPtr
+                              * is NULL */
+    ItclClass **iclsPtrPtr)  /* for returning iclsPtr */
 {
     Tcl_Obj *argumentPtr;
     Tcl_Obj *bodyPtr;
@@ -728,24 +825,11 @@ ItclClassBaseCmd(
     Tcl_CallFrame frame;
     ItclClass *iclsPtr;
     ItclVariable *ivPtr;
-    ItclObjectInfo* infoPtr;
-    char *className;
     int isNewEntry;
     int result;
     int noCleanup;
     ItclMemberFunc *imPtr;
 
-    infoPtr = (ItclObjectInfo*)clientData;
-    if (iclsPtrPtr != NULL) {
-        *iclsPtrPtr = NULL;
-    }
-    if (objc != 3) {
-        Tcl_WrongNumArgs(interp, 1, objv, "name { definition }");
-        return TCL_ERROR;
-    }
-    ItclShowArgs(1, "ItclClassBaseCmd", objc, objv);
-    className = Tcl_GetString(objv[1]);
-
     noCleanup = 0;
     /*
      *  Find the namespace to use as a parser for the class definition.
@@ -774,6 +858,9 @@ ItclClassBaseCmd(
     }
     infoPtr->currClassFlags = 0;
     iclsPtr->flags = flags;
+    if (specPtr != NULL) {
+	iclsPtr->flags |= ITCL_CLASS_FROM_SPEC;
+    }
 
     /*
      *  Import the built-in commands from the itcl::builtin namespace.
@@ -806,12 +893,22 @@ ItclClassBaseCmd(
 
     Itcl_SetCallFrameResolver(interp, iclsPtr->resolvePtr);
     if (result == TCL_OK) {
-        result = Tcl_EvalObjEx(interp, objv[2], 0);
+	if (definitionPtr != NULL) {
+	    result = Tcl_EvalObjEx(interp, definitionPtr, 0);
+	} else {
+	    result = DefineClassMembers(infoPtr, interp, iclsPtr, specPtr);
+	}
         Itcl_PopCallFrame(interp);
     }
     Itcl_PopStack(&infoPtr->clsStack);
 
     noCleanup = 0;
+    if ((result != TCL_OK) && (definitionPtr == NULL)) {
+	Tcl_AppendObjToErrorInfo(interp, Tcl_ObjPrintf(
+		"\n    (while defining class \"%s\")", className));
+        result = TCL_ERROR;
+        goto errorReturn;
+    }
     if (result != TCL_OK) {
 	Tcl_Obj *options = Tcl_GetReturnOptions(interp, result);
 	Tcl_Obj *key = Tcl_NewStringObj("-errorline", TCL_INDEX_NONE);
@@ -823,7 +920,7 @@ ItclClassBaseCmd(
 	if (stackTrace == NULL) {
 	    Tcl_AppendObjToErrorInfo(interp, Tcl_ObjPrintf(
 		    "\n    error while parsing class \"%s\" body %s",
-		    className, Tcl_GetString(objv[2])));
+		    className, Tcl_GetString(definitionPtr)));
 	    noCleanup = 1;
 	} else {
 	    Tcl_AppendObjToErrorInfo(interp, Tcl_ObjPrintf(
@@ -870,6 +967,26 @@ ItclClassBaseCmd(
      */
     Itcl_BuildVirtualTables(iclsPtr);
 
+    /*
+     *  Now that all variables are known, check those listed for
+     *  memoized methods.
+     */
+    FOREACH_HASH_VALUE(imPtr, &iclsPtr->functions) {
+        if ((imPtr->memoVarsPtr != NULL)
+		&& (ItclMemoCheckVars(interp, imPtr) != TCL_OK)) {
+            result = TCL_ERROR;
+            goto errorReturn;
+        }
+    }
+
+    /*
+     *  Final methods of the base classes must not be overridden.
+     */
+    if (CheckFinalMethods(interp, iclsPtr) != TCL_OK) {
+        result = TCL_ERROR;
+        goto errorReturn;
+    }
+
     /* make the methods and procs known to TclOO */
     FOREACH_HASH_VALUE(imPtr, &iclsPtr->functions) {
 	    void *pmPtr;
@@ -927,6 +1044,11 @@ if (imPtr->codePtr->flags & ITCL_IMPLEMENT_OBJCMD) {
 		    Tcl_AppendToObj(bodyPtr, "::itcl::builtin::isa", TCL_INDEX_NONE);
 		    isDone = 1;
 		}
+		if (strcmp(Tcl_GetString(imPtr->codePtr->bodyPtr),
+		        "@itcl-builtin-clone") == 0) {
+		    Tcl_AppendToObj(bodyPtr, "::itcl::builtin::clone", TCL_INDEX_NONE);
+		    isDone = 1;
+		}
 		if (strcmp(Tcl_GetString(imPtr->codePtr->bodyPtr),
 		        "@itcl-builtin-createhull") == 0) {
 		    Tcl_AppendToObj(bodyPtr, "::itcl::builtin::createhull", TCL_INDEX_NONE);
@@ -1155,6 +1277,285 @@ errorReturn:
     return result;
 }
 
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_DefineClass()
+ *
+ *  Defines a class from static descriptors, as "itcl::class" or
+ *  "itcl::extendedclass" would from a class definition.  The members
+ *  are added by calling the commands of the class parser directly, so
+ *  no script is parsed or evaluated, and the class is completed once,
+ *  after all members are known.  Methods implemented by an objProc are
+ *  registered with Itcl_RegisterObjC() under the fully qualified name
+ *  of the method, until the class is deleted.
+ *
+ *  Returns TCL_OK on success, or TCL_ERROR (along with an error message
+ *  in the interpreter) if anything goes wrong, in which case the class
+ *  is not created.
+ * ------------------------------------------------------------------------
+ */
+int
+Itcl_DefineClass(
+    Tcl_Interp *interp,                 /* current interpreter */
+    const Itcl_ClassSpec *specPtr)      /* descriptors of the class */
+{
+    ItclObjectInfo *infoPtr;
+
+    infoPtr = (ItclObjectInfo *)Tcl_GetAssocData(interp, ITCL_INTERP_DATA,
+	    NULL);
+    if (infoPtr == NULL) {
+	Tcl_AppendResult(interp, "[incr Tcl] is not loaded", NULL);
+	return TCL_ERROR;
+    }
+    return DefineClass(infoPtr, interp,
+	    (specPtr->flags & ITCL_DEFINE_EXTENDED) ? ITCL_ECLASS : ITCL_CLASS,
+	    specPtr->name, NULL, specPtr, NULL);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  DefineClassMembers()
+ *
+ *  Adds the members described by an Itcl_ClassSpec to the class being
+ *  defined, which is on top of the class definition stack.  Each member
+ *  is passed to the parser command which defines it in a class body,
+ *  with the protection level of the member.
+ * ------------------------------------------------------------------------
+ */
+static int
+DefineClassMembers(
+    ItclObjectInfo *infoPtr,         /* info for all known objects */
+    Tcl_Interp *interp,              /* current interpreter */
+    ItclClass *iclsPtr,              /* class being defined */
+    const Itcl_ClassSpec *specPtr)   /* descriptors of the members */
+{
+    const Itcl_VariableSpec *varSpecPtr;
+    const Itcl_MethodSpec *methodSpecPtr;
+    const Itcl_OptionSpec *optSpecPtr;
+    Tcl_ObjCmdProc *cmdProc;
+    Tcl_Obj *cmdPtr;
+    Tcl_Obj *namePtr;
+    const char *body;
+    int i;
+    int result;
+
+    if ((specPtr->bases != NULL) && (specPtr->bases[0] != NULL)) {
+	cmdPtr = Tcl_NewStringObj("inherit", TCL_INDEX_NONE);
+	for (i = 0; specPtr->bases[i] != NULL; i++) {
+	    AppendWord(cmdPtr, specPtr->bases[i]);
+	}
+	if (CallParserCmd(infoPtr, interp, Itcl_ClassInheritCmd, 0,
+		cmdPtr) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+    }
+
+    for (varSpecPtr = specPtr->variables;
+	    (varSpecPtr != NULL) && (varSpecPtr->name != NULL); varSpecPtr++) {
+	if (varSpecPtr->flags & ITCL_MEMBER_COMMON) {
+	    cmdProc = Itcl_ClassCommonCmd;
+	    cmdPtr = Tcl_NewStringObj("common", TCL_INDEX_NONE);
+	} else {
+	    cmdProc = Itcl_ClassVariableCmd;
+	    cmdPtr = Tcl_NewStringObj("variable", TCL_INDEX_NONE);
+	}
+	AppendWord(cmdPtr, varSpecPtr->name);
+	if (varSpecPtr->init != NULL) {
+	    AppendWord(cmdPtr, varSpecPtr->init);
+	    if (varSpecPtr->config != NULL) {
+		AppendWord(cmdPtr, varSpecPtr->config);
+	    }
+	}
+	if (CallParserCmd(infoPtr, interp, cmdProc, varSpecPtr->protection,
+		cmdPtr) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+    }
+
+    for (methodSpecPtr = specPtr->methods;
+	    (methodSpecPtr != NULL) && (methodSpecPtr->name != NULL);
+	    methodSpecPtr++) {
+	body = methodSpecPtr->body;
+	namePtr = NULL;
+	if ((body == NULL) && (methodSpecPtr->objProc != NULL)) {
+	    namePtr = Tcl_NewStringObj("@", 1);
+	    Tcl_AppendObjToObj(namePtr, iclsPtr->fullNamePtr);
+	    Tcl_AppendStringsToObj(namePtr, "::", methodSpecPtr->name, NULL);
+	    Tcl_IncrRefCount(namePtr);
+	    if (Itcl_RegisterObjC(interp, Tcl_GetString(namePtr) + 1,
+		    methodSpecPtr->objProc, methodSpecPtr->clientData,
+		    NULL) != TCL_OK) {
+		Tcl_DecrRefCount(namePtr);
+		return TCL_ERROR;
+	    }
+	    body = Tcl_GetString(namePtr);
+	}
+	if (strcmp(methodSpecPtr->name, "constructor") == 0) {
+	    cmdProc = Itcl_ClassConstructorCmd;
+	    cmdPtr = Tcl_NewStringObj("constructor", TCL_INDEX_NONE);
+	    AppendWord(cmdPtr, (methodSpecPtr->args != NULL)
+		    ? methodSpecPtr->args : (namePtr != NULL) ? "args" : "");
+	} else if (strcmp(methodSpecPtr->name, "destructor") == 0) {
+	    cmdProc = Itcl_ClassDestructorCmd;
+	    cmdPtr = Tcl_NewStringObj("destructor", TCL_INDEX_NONE);
+	} else {
+	    if (methodSpecPtr->flags & ITCL_MEMBER_COMMON) {
+		cmdProc = Itcl_ClassProcCmd;
+		cmdPtr = Tcl_NewStringObj("proc", TCL_INDEX_NONE);
+	    } else {
+		cmdProc = Itcl_ClassMethodCmd;
+		cmdPtr = Tcl_NewStringObj("method", TCL_INDEX_NONE);
+	    }
+	    AppendWord(cmdPtr, methodSpecPtr->name);
+	    if ((methodSpecPtr->args != NULL) || (body != NULL)) {
+		AppendWord(cmdPtr, (methodSpecPtr->args != NULL)
+			? methodSpecPtr->args : (namePtr != NULL) ? "args" : "");
+	    }
+	}
+	if (body != NULL) {
+	    AppendWord(cmdPtr, body);
+	}
+	result = CallParserCmd(infoPtr, interp, cmdProc,
+		methodSpecPtr->protection, cmdPtr);
+	if (namePtr != NULL) {
+	    if (result != TCL_OK) {
+		ItclUnregisterC(interp, Tcl_GetString(namePtr) + 1);
+	    }
+	    Tcl_DecrRefCount(namePtr);
+	}
+	if (result != TCL_OK) {
+	    return TCL_ERROR;
+	}
+    }
+
+    for (optSpecPtr = specPtr->options;
+	    (optSpecPtr != NULL) && (optSpecPtr->name != NULL); optSpecPtr++) {
+	cmdPtr = Tcl_NewStringObj("option", TCL_INDEX_NONE);
+	namePtr = Tcl_NewStringObj(optSpecPtr->name, TCL_INDEX_NONE);
+	if ((optSpecPtr->resourceName != NULL)
+		|| (optSpecPtr->className != NULL)) {
+	    namePtr = Tcl_NewListObj(1, &namePtr);
+	    Tcl_ListObjAppendElement(NULL, namePtr, Tcl_NewStringObj(
+		    (optSpecPtr->resourceName != NULL)
+		    ? optSpecPtr->resourceName : "", TCL_INDEX_NONE));
+	    Tcl_ListObjAppendElement(NULL, namePtr, Tcl_NewStringObj(
+		    (optSpecPtr->className != NULL)
+		    ? optSpecPtr->className : "", TCL_INDEX_NONE));
+	}
+	Tcl_ListObjAppendElement(NULL, cmdPtr, namePtr);
+	if (optSpecPtr->defaultValue != NULL) {
+	    AppendWord(cmdPtr, optSpecPtr->defaultValue);
+	}
+	if (CallParserCmd(infoPtr, interp, Itcl_ClassOptionCmd, 0,
+		cmdPtr) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+    }
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  CheckFinalMethods()
+ *
+ *  Makes sure that no member function of a class which is being defined
+ *  has the name of a "final" method of one of its base classes.
+ *
+ *  Returns TCL_OK if there is no such function; otherwise, this
+ *  procedure returns TCL_ERROR along with an error message in the
+ *  interpreter.
+ * ------------------------------------------------------------------------
+ */
+static int
+CheckFinalMethods(
+    Tcl_Interp *interp,      /* current interpreter */
+    ItclClass *iclsPtr)      /* class being defined */
+{
+    FOREACH_HASH_DECLS;
+    Tcl_HashEntry *hPtr2;
+    ItclHierIter hier;
+    ItclClass *superPtr;
+    ItclMemberFunc *imPtr;
+    ItclMemberFunc *baseImPtr;
+
+    if (Itcl_FirstListElem(&iclsPtr->bases) == NULL) {
+        return TCL_OK;
+    }
+    FOREACH_HASH_VALUE(imPtr, &iclsPtr->functions) {
+        if (imPtr->flags & (ITCL_CONSTRUCTOR|ITCL_DESTRUCTOR)) {
+            continue;
+        }
+        Itcl_InitHierIter(&hier, iclsPtr);
+        superPtr = Itcl_AdvanceHierIter(&hier);  /* skip the class itself */
+        while ((superPtr = Itcl_AdvanceHierIter(&hier)) != NULL) {
+            hPtr2 = Tcl_FindHashEntry(&superPtr->functions,
+		    (char *)imPtr->namePtr);
+            if (hPtr2 == NULL) {
+                continue;
+            }
+            baseImPtr = (ItclMemberFunc *)Tcl_GetHashValue(hPtr2);
+            if (baseImPtr->flags & ITCL_FINAL) {
+                Itcl_DeleteHierIter(&hier);
+                Tcl_AppendResult(interp, "cannot override final method \"",
+			Tcl_GetString(baseImPtr->fullNamePtr),
+			"\" in class \"", Tcl_GetString(iclsPtr->fullNamePtr),
+			"\"", NULL);
+                return TCL_ERROR;
+            }
+        }
+        Itcl_DeleteHierIter(&hier);
+    }
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  AppendWord()
+ *
+ *  Appends a word to the list of words of a parser command.
+ * ------------------------------------------------------------------------
+ */
+static void
+AppendWord(
+    Tcl_Obj *cmdPtr,
+    const char *word)
+{
+    Tcl_ListObjAppendElement(NULL, cmdPtr,
+	    Tcl_NewStringObj(word, TCL_INDEX_NONE));
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  CallParserCmd()
+ *
+ *  Calls a command of the class parser with the words of cmdPtr, which
+ *  is freed, at the given protection level, or at the default one if
+ *  it is 0.
+ * ------------------------------------------------------------------------
+ */
+static int
+CallParserCmd(
+    ItclObjectInfo *infoPtr,         /* info for all known objects */
+    Tcl_Interp *interp,              /* current interpreter */
+    Tcl_ObjCmdProc *cmdProc,         /* parser command */
+    int protection,                  /* ITCL_PUBLIC, ... or 0 */
+    Tcl_Obj *cmdPtr)                 /* list of words, with refCount 0 */
+{
+    Tcl_Obj **objv;
+    Tcl_Size objc;
+    int oldLevel;
+    int result;
+
+    Tcl_IncrRefCount(cmdPtr);
+    Tcl_ListObjGetElements(NULL, cmdPtr, &objc, &objv);
+    oldLevel = Itcl_Protection(interp,
+	    (protection != 0) ? protection : ITCL_DEFAULT_PROTECT);
+    result = (*cmdProc)(infoPtr, interp, (int)objc, objv);
+    Itcl_Protection(interp, oldLevel);
+    Tcl_DecrRefCount(cmdPtr);
+    return result;
+}
+
 /*
  * ------------------------------------------------------------------------
  *  ItclCheckForInitializedComponents()
@@ -1390,6 +1791,22 @@ Itcl_ClassInheritCmd(
                 NULL);
             goto inheritError;
         }
+        if (baseClsPtr->flags & ITCL_CLASS_SEALED) {
+            Tcl_AppendStringsToObj(Tcl_GetObjResult(interp),
+                "cannot inherit from sealed class \"",
+		Tcl_GetString(baseClsPtr->fullNamePtr), "\"",
+                NULL);
+            goto inheritError;
+        }
+        if ((baseClsPtr->flags & ITCL_RECORD)
+		&& !(iclsPtr->flags & ITCL_RECORD)) {
+            Tcl_AppendStringsToObj(Tcl_GetObjResult(interp),
+                "class \"", Tcl_GetString(iclsPtr->fullNamePtr),
+		"\" cannot inherit from record \"",
+		Tcl_GetString(baseClsPtr->fullNamePtr), "\"",
+                NULL);
+            goto inheritError;
+        }
 
         Itcl_AppendList(&iclsPtr->bases, baseClsPtr);
 	ItclPreserveClass(baseClsPtr);
@@ -1522,7 +1939,14 @@ Itcl_ClassInheritCmd(
     }
     Tcl_DStringFree(&buffer);
 
-    Itcl_BuildVirtualTables(iclsPtr);
+    /*
+     *  A class body may use inherited members in the commands after
+     *  "inherit".  Itcl_DefineClass() adds no such commands, so the
+     *  tables are only built once, when the class is complete.
+     */
+    if (!(iclsPtr->flags & ITCL_CLASS_FROM_SPEC)) {
+        Itcl_BuildVirtualTables(iclsPtr);
+    }
 
     return result;
 
@@ -1542,6 +1966,44 @@ inheritError:
     return TCL_ERROR;
 }
 
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_ClassSealedCmd()
+ *
+ *  Invoked by Tcl during the parsing of a class definition whenever
+ *  the "sealed" command is invoked to forbid deriving other classes
+ *  from this one.  Calls of the methods defined in a sealed class are
+ *  bound without virtual lookup.  Handles the following syntax:
+ *
+ *      sealed
+ *
+ * ------------------------------------------------------------------------
+ */
+static int
+Itcl_ClassSealedCmd(
+    void *clientData,        /* info for all known objects */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    ItclObjectInfo *infoPtr = (ItclObjectInfo*)clientData;
+    ItclClass *iclsPtr = (ItclClass*)Itcl_PeekStack(&infoPtr->clsStack);
+
+    ItclShowArgs(2, "Itcl_ClassSealedCmd", objc, objv);
+
+    if (objc != 1) {
+        Tcl_WrongNumArgs(interp, 1, objv, NULL);
+        return TCL_ERROR;
+    }
+    if (iclsPtr == NULL) {
+        Tcl_AppendResult(interp, "Error: ::itcl::parser::sealed called from",
+	        " not within a class", NULL);
+        return TCL_ERROR;
+    }
+    iclsPtr->flags |= ITCL_CLASS_SEALED;
+    return TCL_OK;
+}
+
 
 /*
  * ------------------------------------------------------------------------
@@ -1756,7 +2218,7 @@ Itcl_ClassDestructorCmd(
  *  the "method" command is invoked to define an object method.
  *  Handles the following syntax:
  *
- *      method <name> ?<arglist>? ?<body>?
+ *      method <name> ?<arglist>? ?-memoize <varList>? ?<body>?
  *
  * ------------------------------------------------------------------------
  */
@@ -1771,13 +2233,25 @@ Itcl_ClassMethodCmd(
     Tcl_HashEntry *hPtr;
     ItclObjectInfo *infoPtr = (ItclObjectInfo*)clientData;
     ItclClass *iclsPtr = (ItclClass*)Itcl_PeekStack(&infoPtr->clsStack);
+    ItclMemberFunc *imPtr;
+    Tcl_Obj *memoVarsPtr;
+    Tcl_Size numVars;
     char *arglist;
     char *body;
 
     ItclShowArgs(2, "Itcl_ClassMethodCmd", objc, objv);
 
-    if (objc < 2 || objc > 4) {
-        Tcl_WrongNumArgs(interp, 1, objv, "name ?args? ?body?");
+    memoVarsPtr = NULL;
+    if ((objc >= 5)
+	    && (strcmp(Tcl_GetString(objv[3]), "-memoize") == 0)) {
+        memoVarsPtr = objv[4];
+        if (Tcl_ListObjLength(interp, memoVarsPtr, &numVars) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    if (objc < 2 || objc > ((memoVarsPtr != NULL) ? 6 : 4)) {
+        Tcl_WrongNumArgs(interp, 1, objv,
+		"name ?args? ?-memoize varList? ?body?");
         return TCL_ERROR;
     }
 
@@ -1799,13 +2273,69 @@ Itcl_ClassMethodCmd(
     if (objc >= 3) {
         arglist = Tcl_GetString(objv[2]);
     }
-    if (objc >= 4) {
+    if (memoVarsPtr != NULL) {
+        if (objc == 6) {
+            body = Tcl_GetString(objv[5]);
+        }
+    } else if (objc >= 4) {
         body = Tcl_GetString(objv[3]);
     }
 
-    if (Itcl_CreateMethod(interp, iclsPtr, namePtr, arglist, body) != TCL_OK) {
+    if (ItclCreateMethod(interp, iclsPtr, namePtr, arglist, body,
+	    &imPtr) != TCL_OK) {
         return TCL_ERROR;
     }
+    if (memoVarsPtr != NULL) {
+        imPtr->memoVarsPtr = memoVarsPtr;
+        Tcl_IncrRefCount(imPtr->memoVarsPtr);
+    }
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_ClassFinalCmd()
+ *
+ *  Invoked by Tcl during the parsing of a class definition whenever
+ *  the "final" command is invoked to define a method which cannot be
+ *  overridden in derived classes.  Handles the following syntax:
+ *
+ *      final method <name> ?<arglist>? ?-memoize <varList>? ?<body>?
+ *
+ * ------------------------------------------------------------------------
+ */
+static int
+Itcl_ClassFinalCmd(
+    void *clientData,        /* info for all known objects */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    Tcl_HashEntry *hPtr;
+    ItclObjectInfo *infoPtr = (ItclObjectInfo*)clientData;
+    ItclClass *iclsPtr = (ItclClass*)Itcl_PeekStack(&infoPtr->clsStack);
+    ItclMemberFunc *imPtr;
+
+    ItclShowArgs(2, "Itcl_ClassFinalCmd", objc, objv);
+
+    if ((objc < 3) || (strcmp(Tcl_GetString(objv[1]), "method") != 0)) {
+        Tcl_WrongNumArgs(interp, 1, objv,
+		"method name ?args? ?-memoize varList? ?body?");
+        return TCL_ERROR;
+    }
+    if (iclsPtr == NULL) {
+        Tcl_AppendResult(interp, "Error: ::itcl::parser::final called from",
+	        " not within a class", NULL);
+        return TCL_ERROR;
+    }
+    if (Itcl_ClassMethodCmd(clientData, interp, objc-1, objv+1) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    hPtr = Tcl_FindHashEntry(&iclsPtr->functions, (char *)objv[2]);
+    if (hPtr != NULL) {
+        imPtr = (ItclMemberFunc *)Tcl_GetHashValue(hPtr);
+        imPtr->flags |= ITCL_FINAL;
+    }
     return TCL_OK;
 }
 
@@ -1966,8 +2496,10 @@ Itcl_ClassTypeMethodCmd(
  *  the "variable" command is invoked to define an instance variable.
  *  Handles the following syntax:
  *
- *      variable <varname> ?<init>? ?<config>?
+ *      variable <varname> ?-type <type>? ?<init>? ?<config>?
  *
+ *  A variable declared with a type is checked on each write, and its
+ *  value is mirrored as a C value in each object.
  * ------------------------------------------------------------------------
  */
 int
@@ -1989,12 +2521,17 @@ Itcl_ClassVariableCmd(
     int haveError;
     int haveArrayInit;
     int result;
+    int type;
+    int i;
+    Tcl_Obj *typedObjv[4];
+    Tcl_WideInt typedValue;
 
     result = TCL_OK;
     haveError = 0;
     haveArrayInit = 0;
     usageStr = NULL;
     arrayInitStr = NULL;
+    type = ITCL_VARTYPE_NONE;
     ItclShowArgs(1, "Itcl_ClassVariableCmd", objc, objv);
     if (iclsPtr == NULL) {
         Tcl_AppendResult(interp, "Error: ::itcl::parser::variable called from",
@@ -2002,6 +2539,34 @@ Itcl_ClassVariableCmd(
         return TCL_ERROR;
     }
     pLevel = Itcl_Protection(interp, 0);
+
+    /*
+     *  Strip "-type <type>" from the arguments of a typed variable.
+     */
+    if ((objc >= 4) && (strcmp(Tcl_GetString(objv[2]), "-type") == 0)) {
+        if ((objc > 6) || ((objc == 6) && (pLevel != ITCL_PUBLIC))) {
+            Tcl_WrongNumArgs(interp, 1, objv, (pLevel == ITCL_PUBLIC)
+                    ? "name -type type ?init? ?config?"
+                    : "name -type type ?init?");
+            return TCL_ERROR;
+        }
+        if (Tcl_GetIndexFromObj(interp, objv[3], varTypeNames, "type", 0,
+                &type) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        type++;
+        typedObjv[0] = objv[0];
+        typedObjv[1] = objv[1];
+        for (i = 4; i < objc; i++) {
+            typedObjv[i - 2] = objv[i];
+        }
+        objc -= 2;
+        objv = typedObjv;
+        if ((objc >= 3) && (ItclGetTypedValue(interp, type, objv[2],
+                &typedValue) != TCL_OK)) {
+            return TCL_ERROR;
+        }
+    }
     if (iclsPtr->flags & (ITCL_TYPE|ITCL_WIDGET|ITCL_WIDGETADAPTOR)) {
         if (objc > 2) {
 	    if (strcmp(Tcl_GetString(objv[2]), "-array") == 0) {
@@ -2056,10 +2621,14 @@ Itcl_ClassVariableCmd(
         }
     }
 
+    if ((type != ITCL_VARTYPE_NONE) && (init == NULL)) {
+        init = (char *)"0";
+    }
     if (Itcl_CreateVariable(interp, iclsPtr, namePtr, init, config,
             &ivPtr) != TCL_OK) {
         return TCL_ERROR;
     }
+    ivPtr->type = type;
     if (iclsPtr->flags & (ITCL_TYPE|ITCL_WIDGET|ITCL_WIDGETADAPTOR)) {
         ivPtr->flags |= ITCL_VARIABLE;
     }
@@ -2412,7 +2981,8 @@ ItclDelObjectInfo(
  * ------------------------------------------------------------------------
  *  Itcl_ClassFilterCmd()
  *
- *
+ *  Adds filter methods to the class being defined.  They are called
+ *  just before any method of the class is executed.
  * ------------------------------------------------------------------------
  */
 static int
@@ -2422,10 +2992,8 @@ Itcl_ClassFilterCmd(
     int objc,                /* number of arguments */
     Tcl_Obj *const objv[])   /* argument objects */
 {
-    Tcl_Obj **newObjv;
     ItclObjectInfo *infoPtr;
     ItclClass *iclsPtr;
-    int result;
 
     ItclShowArgs(1, "Itcl_ClassFilterCmd", objc, objv);
     infoPtr = (ItclObjectInfo*)clientData;
@@ -2445,39 +3013,48 @@ Itcl_ClassFilterCmd(
         Tcl_WrongNumArgs(interp, 1, objv, "<filterName> ?<filterName> ...?");
         return TCL_ERROR;
     }
-    newObjv = (Tcl_Obj **)ckalloc(sizeof(Tcl_Obj *)*(objc+2));
-    newObjv[0] = Tcl_NewStringObj("::oo::define", TCL_INDEX_NONE);
-    Tcl_IncrRefCount(newObjv[0]);
-    newObjv[1] = Tcl_NewStringObj(Tcl_GetString(iclsPtr->fullNamePtr), TCL_INDEX_NONE);
-    Tcl_IncrRefCount(newObjv[1]);
-    newObjv[2] = Tcl_NewStringObj("filter", TCL_INDEX_NONE);
-    Tcl_IncrRefCount(newObjv[2]);
-    memcpy(newObjv+3, objv+1, sizeof(Tcl_Obj *)*(objc-1));
-ItclShowArgs(1, "Itcl_ClassFilterCmd2", objc+2, newObjv);
-    result = Tcl_EvalObjv(interp, objc+2, newObjv, 0);
-    Tcl_DecrRefCount(newObjv[0]);
-    Tcl_DecrRefCount(newObjv[1]);
-    Tcl_DecrRefCount(newObjv[2]);
-    ckfree((char *)newObjv);
-    return result;
+    return ItclChangeClassChain(interp, iclsPtr, ITCL_CHAIN_FILTER, 1,
+	    objc-1, objv+1);
 }
 
 /*
  * ------------------------------------------------------------------------
  *  Itcl_ClassMixinCmd()
  *
- *
+ *  Adds the methods of other classes to the class being defined,
+ *  without inheritance.
  * ------------------------------------------------------------------------
  */
 static int
 Itcl_ClassMixinCmd(
-    TCL_UNUSED(void *),      /* info for all known objects */
-    TCL_UNUSED(Tcl_Interp *),/* current interpreter */
+    void *clientData,        /* info for all known objects */
+    Tcl_Interp *interp,      /* current interpreter */
     int objc,                /* number of arguments */
     Tcl_Obj *const *objv)    /* argument objects */
 {
+    ItclObjectInfo *infoPtr;
+    ItclClass *iclsPtr;
+
     ItclShowArgs(0, "Itcl_ClassMixinCmd", objc, objv);
-    return TCL_OK;
+    infoPtr = (ItclObjectInfo*)clientData;
+    iclsPtr = (ItclClass*)Itcl_PeekStack(&infoPtr->clsStack);
+    if (iclsPtr == NULL) {
+        Tcl_AppendResult(interp, "Error: ::itcl::parser::mixin called from",
+	        " not within a class", NULL);
+        return TCL_ERROR;
+    }
+    if (iclsPtr->flags & ITCL_CLASS) {
+	/*
+	 *  Plain classes have always ignored their mixins.
+	 */
+	return TCL_OK;
+    }
+    if (objc < 2) {
+        Tcl_WrongNumArgs(interp, 1, objv, "<mixinName> ?<mixinName> ...?");
+        return TCL_ERROR;
+    }
+    return ItclChangeClassChain(interp, iclsPtr, ITCL_CHAIN_MIXIN, 1,
+	    objc-1, objv+1);
 }
 
 /*
@@ -4085,8 +4662,6 @@ Itcl_ClassForwardCmd(
     int objc,                /* number of arguments */
     Tcl_Obj *const objv[])   /* argument objects */
 {
-    Tcl_Obj *prefixObj;
-    Tcl_Method mPtr;
     ItclObjectInfo *infoPtr;
     ItclClass *iclsPtr;
 
@@ -4109,13 +4684,8 @@ Itcl_ClassForwardCmd(
         Tcl_WrongNumArgs(interp, 1, objv, "<forwardName> <targetName> ?<arg> ...?");
         return TCL_ERROR;
     }
-    prefixObj = Tcl_NewListObj(objc-2, objv+2);
-    mPtr = Itcl_NewForwardClassMethod(interp, iclsPtr->clsPtr, 1,
-            objv[1], prefixObj);
-    if (mPtr == NULL) {
-        return TCL_ERROR;
-    }
-    return TCL_OK;
+    return ItclAddForward(interp, iclsPtr, objv[1],
+	    Tcl_NewListObj(objc-2, objv+2));
 }
 /*
  * ------------------------------------------------------------------------
@@ -0,0 +1,1113 @@
+/*
+ * itclProfile.c --
+ *
+ *	This file contains the method call profiler of [incr Tcl], which is
+ *	accessible through the "itcl::profile" command.  While the profiler is
+ *	running, every call of a method, proc or constructor/destructor passing
+ *	ItclCheckCallMethod()/ItclAfterCallMethod() is counted and timed using
+ *	a monotonic clock.
+ *
+ *	It also contains the sampling profiler ("itcl::profile sample"), which
+ *	periodically records the stack of active [incr Tcl] functions and
+ *	writes the samples as folded stacks, the input format of the usual
+ *	flame graph tools.
+ *
+ * See the file "license.terms" for information on usage and redistribution of
+ * this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ */
+
+#ifdef _WIN32
+#   include <windows.h>
+#else
+#   include <time.h>
+#   include <signal.h>
+#   include <sys/time.h>
+#endif
+#include <stdlib.h>
+#include "tclInt.h"
+#include "itclInt.h"
+
+/*
+ * Samples are triggered by the CPU time interval timer (SIGPROF) where that
+ * is available, otherwise only by the event loop.
+ */
+
+#if !defined(_WIN32) && defined(ITIMER_PROF) && defined(SIGPROF)
+#   define ITCL_SAMPLE_SIGNAL 1
+#endif
+
+/*
+ * Accumulated data for one member function.  The entries are kept in a
+ * table keyed by the ItclMemberFunc.  If the function is deleted while the
+ * profiler holds data for it, the entry is moved to the list of retired
+ * entries so it still shows up in the report.
+ */
+
+typedef struct ItclProfileEntry {
+    ItclMemberFunc *imPtr;        /* function or NULL if it was deleted */
+    Tcl_Obj *namePtr;             /* fully qualified name of the function */
+    Tcl_WideInt calls;            /* number of calls */
+    Tcl_WideInt errors;           /* number of calls returning TCL_ERROR */
+    Tcl_WideInt inclusive;        /* time in ns spent in the function
+                                   * including called functions, counted for
+                                   * the outermost of recursive calls only */
+    Tcl_WideInt exclusive;        /* time in ns spent in the function itself */
+    Tcl_Size depth;               /* number of currently active calls */
+    struct ItclProfileEntry *nextPtr;
+                                  /* next retired entry */
+} ItclProfileEntry;
+
+/*
+ * One active call on the profiler's shadow stack.
+ */
+
+typedef struct ItclProfileFrame {
+    ItclMemberFunc *imPtr;        /* function called */
+    ItclProfileEntry *entryPtr;   /* where to account the call */
+    Tcl_WideInt start;            /* time of the call */
+    Tcl_WideInt childTime;        /* time spent in profiled callees */
+} ItclProfileFrame;
+
+/*
+ * Sources of the samples of the sampling profiler.
+ */
+
+#define ITCL_SAMPLE_CPU     1     /* interval timer and Tcl_AsyncMark() */
+#define ITCL_SAMPLE_EVENT   2     /* Tcl timer handler in the event loop */
+
+typedef struct ItclProfileInfo {
+    Tcl_HashTable functions;      /* maps ItclMemberFunc to ItclProfileEntry */
+    ItclProfileEntry *retiredPtr; /* entries of deleted functions */
+    ItclProfileFrame *frames;     /* shadow stack of active calls */
+    Tcl_Size numFrames;           /* number of used frames */
+    Tcl_Size maxFrames;           /* number of allocated frames */
+
+    int sampleSource;             /* ITCL_SAMPLE_* or 0 if not sampling */
+    int sampleInterval;           /* time between samples in ms */
+    Tcl_Obj *sampleFilePtr;       /* file receiving the folded stacks */
+    Tcl_HashTable samples;        /* maps folded stacks to sample counts */
+    Tcl_WideInt numSamples;       /* number of samples taken */
+    Tcl_TimerToken sampleTimer;   /* timer for ITCL_SAMPLE_EVENT */
+    Tcl_AsyncHandler sampleAsync; /* async handler for ITCL_SAMPLE_CPU */
+} ItclProfileInfo;
+
+#ifdef ITCL_SAMPLE_SIGNAL
+/*
+ * The interval timer and its signal are process wide resources, so only one
+ * interpreter at a time can use them.
+ */
+
+TCL_DECLARE_MUTEX(sampleMutex)
+static Tcl_AsyncHandler sampleAsyncHandler = NULL;
+static struct sigaction sampleOldAction;
+#endif
+
+/*
+ * The columns of the report, also used as values for its -sort option.
+ */
+
+static const char *const profileColumns[] = {
+    "name", "calls", "errors", "inclusive", "exclusive", NULL
+};
+enum ProfileColumn {
+    PROF_NAME, PROF_CALLS, PROF_ERRORS, PROF_INCLUSIVE, PROF_EXCLUSIVE
+};
+
+typedef struct ItclProfileRow {
+    const char *name;
+    Tcl_WideInt values[5];        /* indexed by ProfileColumn, name unused */
+    Tcl_WideInt key;              /* sort key, negated for decreasing order */
+    int reverseNames;             /* sort names in decreasing order */
+} ItclProfileRow;
+
+typedef struct ItclProfileReport {
+    Tcl_HashTable byName;         /* maps names to indices into rows */
+    ItclProfileRow *rows;
+    Tcl_Size numRows;
+    Tcl_Size maxRows;
+} ItclProfileReport;
+
+static Tcl_ObjCmdProc Itcl_ProfileStartCmd;
+static Tcl_ObjCmdProc Itcl_ProfileStopCmd;
+static Tcl_ObjCmdProc Itcl_ProfileReportCmd;
+static Tcl_ObjCmdProc Itcl_ProfileResetCmd;
+static void AddProfileRow(ItclProfileReport *reportPtr,
+	ItclProfileEntry *entryPtr);
+static int CompareProfileRows(const void *first, const void *second);
+static void FreeProfileEntry(ItclProfileEntry *entryPtr);
+static ItclProfileInfo *GetProfileInfo(ItclObjectInfo *infoPtr);
+static Tcl_ObjCmdProc Itcl_ProfileSampleCmd;
+static int ProfileSampleStart(ItclObjectInfo *infoPtr, Tcl_Interp *interp,
+	int objc, Tcl_Obj *const objv[]);
+static int ProfileSampleStop(ItclObjectInfo *infoPtr, Tcl_Interp *interp);
+static void RecordSample(ItclObjectInfo *infoPtr);
+static void StopSampling(ItclProfileInfo *profPtr);
+static Tcl_TimerProc SampleTimerProc;
+static Tcl_AsyncProc SampleAsyncProc;
+#ifdef ITCL_SAMPLE_SIGNAL
+static void SampleSignalHandler(int sig);
+#endif
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclGetMonotonicTime()
+ *
+ *  Returns the value of a monotonic clock in nanoseconds.  Only
+ *  differences of two values are meaningful.
+ * ------------------------------------------------------------------------
+ */
+Tcl_WideInt
+ItclGetMonotonicTime(void)
+{
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0) {
+	QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (Tcl_WideInt)(counter.QuadPart / frequency.QuadPart) * 1000000000
+	    + (Tcl_WideInt)(counter.QuadPart % frequency.QuadPart)
+	    * 1000000000 / frequency.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Tcl_WideInt)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+    Tcl_Time now;
+
+    Tcl_GetTime(&now);
+    return (Tcl_WideInt)now.sec * 1000000000 + now.usec * 1000;
+#endif
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclProfileInit()
+ *
+ *  Invoked by Itcl_Init() to install the "itcl::profile" ensemble.
+ * ------------------------------------------------------------------------
+ */
+int
+ItclProfileInit(
+    Tcl_Interp *interp,          /* interpreter to be updated */
+    ItclObjectInfo *infoPtr)     /* info regarding all known objects */
+{
+    if (Itcl_CreateEnsemble(interp, "::itcl::profile") != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (Itcl_AddEnsemblePart(interp, "::itcl::profile",
+            "start", "", Itcl_ProfileStartCmd,
+            infoPtr, Itcl_ReleaseData) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    Itcl_PreserveData(infoPtr);
+
+    if (Itcl_AddEnsemblePart(interp, "::itcl::profile",
+            "stop", "", Itcl_ProfileStopCmd,
+            infoPtr, Itcl_ReleaseData) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    Itcl_PreserveData(infoPtr);
+
+    if (Itcl_AddEnsemblePart(interp, "::itcl::profile",
+            "report", "?-sort column? ?-increasing? ?-decreasing?",
+	    Itcl_ProfileReportCmd,
+            infoPtr, Itcl_ReleaseData) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    Itcl_PreserveData(infoPtr);
+
+    if (Itcl_AddEnsemblePart(interp, "::itcl::profile",
+            "reset", "", Itcl_ProfileResetCmd,
+            infoPtr, Itcl_ReleaseData) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    Itcl_PreserveData(infoPtr);
+
+    if (Itcl_AddEnsemblePart(interp, "::itcl::profile",
+            "sample", "start|stop ?arg ...?", Itcl_ProfileSampleCmd,
+            infoPtr, Itcl_ReleaseData) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    Itcl_PreserveData(infoPtr);
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  GetProfileInfo()
+ *
+ *  Returns the profiler data of an interpreter, creating it if needed.
+ * ------------------------------------------------------------------------
+ */
+static ItclProfileInfo *
+GetProfileInfo(
+    ItclObjectInfo *infoPtr)
+{
+    ItclProfileInfo *profPtr = infoPtr->profileInfoPtr;
+
+    if (profPtr == NULL) {
+	profPtr = (ItclProfileInfo *)ckalloc(sizeof(ItclProfileInfo));
+	memset(profPtr, 0, sizeof(ItclProfileInfo));
+	Tcl_InitHashTable(&profPtr->functions, TCL_ONE_WORD_KEYS);
+	Tcl_InitHashTable(&profPtr->samples, TCL_STRING_KEYS);
+	infoPtr->profileInfoPtr = profPtr;
+    }
+    return profPtr;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclProfileFinish()
+ *
+ *  Frees all profiler data of an interpreter.  Called when the
+ *  interpreter is deleted.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclProfileFinish(
+    ItclObjectInfo *infoPtr)
+{
+    FOREACH_HASH_DECLS;
+    ItclProfileInfo *profPtr = infoPtr->profileInfoPtr;
+    ItclProfileEntry *entryPtr;
+
+    if (profPtr == NULL) {
+        return;
+    }
+    infoPtr->instrumentFlags &= ~ITCL_INSTRUMENT_PROFILE;
+    StopSampling(profPtr);
+    Tcl_DeleteHashTable(&profPtr->samples);
+    FOREACH_HASH_VALUE(entryPtr, &profPtr->functions) {
+	FreeProfileEntry(entryPtr);
+    }
+    Tcl_DeleteHashTable(&profPtr->functions);
+    while (profPtr->retiredPtr != NULL) {
+	entryPtr = profPtr->retiredPtr;
+	profPtr->retiredPtr = entryPtr->nextPtr;
+	FreeProfileEntry(entryPtr);
+    }
+    if (profPtr->frames != NULL) {
+	ckfree((char *)profPtr->frames);
+    }
+    ckfree((char *)profPtr);
+    infoPtr->profileInfoPtr = NULL;
+}
+
+static void
+FreeProfileEntry(
+    ItclProfileEntry *entryPtr)
+{
+    Tcl_DecrRefCount(entryPtr->namePtr);
+    ckfree((char *)entryPtr);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclProfileEnter()
+ *
+ *  Called by ItclCheckCallMethod() when a member function is entered
+ *  while the profiler is running.  Pushes a frame onto the shadow stack.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclProfileEnter(
+    ItclObjectInfo *infoPtr,
+    ItclMemberFunc *imPtr)
+{
+    ItclProfileInfo *profPtr = infoPtr->profileInfoPtr;
+    ItclProfileEntry *entryPtr;
+    ItclProfileFrame *framePtr;
+    Tcl_HashEntry *hPtr;
+    int isNew;
+
+    hPtr = Tcl_CreateHashEntry(&profPtr->functions, (char *)imPtr, &isNew);
+    if (isNew) {
+	entryPtr = (ItclProfileEntry *)ckalloc(sizeof(ItclProfileEntry));
+	memset(entryPtr, 0, sizeof(ItclProfileEntry));
+	entryPtr->imPtr = imPtr;
+	entryPtr->namePtr = imPtr->fullNamePtr;
+	Tcl_IncrRefCount(entryPtr->namePtr);
+	Tcl_SetHashValue(hPtr, entryPtr);
+    } else {
+	entryPtr = (ItclProfileEntry *)Tcl_GetHashValue(hPtr);
+    }
+    entryPtr->calls++;
+    entryPtr->depth++;
+
+    if (profPtr->numFrames >= profPtr->maxFrames) {
+	profPtr->maxFrames = profPtr->maxFrames ? 2 * profPtr->maxFrames : 32;
+	profPtr->frames = (ItclProfileFrame *)ckrealloc(
+		(char *)profPtr->frames,
+		profPtr->maxFrames * sizeof(ItclProfileFrame));
+    }
+    framePtr = &profPtr->frames[profPtr->numFrames++];
+    framePtr->imPtr = imPtr;
+    framePtr->entryPtr = entryPtr;
+    framePtr->childTime = 0;
+    framePtr->start = ItclGetMonotonicTime();
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclProfileLeave()
+ *
+ *  Called by ItclAfterCallMethod() when a member function returns while
+ *  the profiler is running.  Pops the matching frame and accounts the
+ *  elapsed time.  Calls which were entered before the profiler was
+ *  started (or reset) have no frame and are ignored.  Frames left over
+ *  above the matching one (e.g. by coroutines switching away) are
+ *  discarded.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclProfileLeave(
+    ItclObjectInfo *infoPtr,
+    ItclMemberFunc *imPtr,
+    int result)
+{
+    ItclProfileInfo *profPtr = infoPtr->profileInfoPtr;
+    ItclProfileFrame *framePtr;
+    ItclProfileEntry *entryPtr;
+    Tcl_WideInt elapsed;
+    Tcl_Size i;
+
+    for (i = profPtr->numFrames - 1; i >= 0; i--) {
+	if (profPtr->frames[i].imPtr == imPtr) {
+	    break;
+	}
+    }
+    if (i < 0) {
+	return;
+    }
+    while (profPtr->numFrames > i + 1) {
+	profPtr->frames[--profPtr->numFrames].entryPtr->depth--;
+    }
+    framePtr = &profPtr->frames[i];
+    entryPtr = framePtr->entryPtr;
+    elapsed = ItclGetMonotonicTime() - framePtr->start;
+
+    entryPtr->exclusive += elapsed - framePtr->childTime;
+    if (--entryPtr->depth == 0) {
+	entryPtr->inclusive += elapsed;
+    }
+    if (result == TCL_ERROR) {
+	entryPtr->errors++;
+    }
+    profPtr->numFrames--;
+    if (profPtr->numFrames > 0) {
+	profPtr->frames[profPtr->numFrames - 1].childTime += elapsed;
+    }
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclProfileForget()
+ *
+ *  Called when a member function is deleted.  Keeps the data collected
+ *  for it, but detaches it from the (now invalid) function pointer.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclProfileForget(
+    ItclObjectInfo *infoPtr,
+    ItclMemberFunc *imPtr)
+{
+    ItclProfileInfo *profPtr = infoPtr->profileInfoPtr;
+    ItclProfileEntry *entryPtr;
+    Tcl_HashEntry *hPtr;
+
+    if (profPtr == NULL) {
+	return;
+    }
+    hPtr = Tcl_FindHashEntry(&profPtr->functions, (char *)imPtr);
+    if (hPtr == NULL) {
+	return;
+    }
+    entryPtr = (ItclProfileEntry *)Tcl_GetHashValue(hPtr);
+    Tcl_DeleteHashEntry(hPtr);
+    entryPtr->imPtr = NULL;
+    entryPtr->nextPtr = profPtr->retiredPtr;
+    profPtr->retiredPtr = entryPtr;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_ProfileStartCmd()
+ *
+ *  Starts (or resumes) recording of method calls.
+ *  Handles the following syntax:
+ *
+ *      itcl::profile start
+ *
+ * ------------------------------------------------------------------------
+ */
+static int
+Itcl_ProfileStartCmd(
+    void *clientData,        /* info for all known objects */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)clientData;
+
+    if (objc != 1) {
+        Tcl_WrongNumArgs(interp, 1, objv, "");
+        return TCL_ERROR;
+    }
+    GetProfileInfo(infoPtr);
+    infoPtr->instrumentFlags |= ITCL_INSTRUMENT_PROFILE;
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_ProfileStopCmd()
+ *
+ *  Stops recording of method calls.  The data collected so far is kept.
+ *  Calls active at that time are not accounted.
+ *  Handles the following syntax:
+ *
+ *      itcl::profile stop
+ *
+ * ------------------------------------------------------------------------
+ */
+static int
+Itcl_ProfileStopCmd(
+    void *clientData,        /* info for all known objects */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)clientData;
+    ItclProfileInfo *profPtr = infoPtr->profileInfoPtr;
+
+    if (objc != 1) {
+        Tcl_WrongNumArgs(interp, 1, objv, "");
+        return TCL_ERROR;
+    }
+    infoPtr->instrumentFlags &= ~ITCL_INSTRUMENT_PROFILE;
+    if (profPtr != NULL) {
+	while (profPtr->numFrames > 0) {
+	    profPtr->frames[--profPtr->numFrames].entryPtr->depth--;
+	}
+    }
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_ProfileResetCmd()
+ *
+ *  Discards the data collected so far.  Does not change whether the
+ *  profiler is running.
+ *  Handles the following syntax:
+ *
+ *      itcl::profile reset
+ *
+ * ------------------------------------------------------------------------
+ */
+static int
+Itcl_ProfileResetCmd(
+    void *clientData,        /* info for all known objects */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    FOREACH_HASH_DECLS;
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)clientData;
+    ItclProfileInfo *profPtr = infoPtr->profileInfoPtr;
+    ItclProfileEntry *entryPtr;
+
+    if (objc != 1) {
+        Tcl_WrongNumArgs(interp, 1, objv, "");
+        return TCL_ERROR;
+    }
+    if (profPtr == NULL) {
+	return TCL_OK;
+    }
+
+    /*
+     *  Entries of active calls must survive, so only the counters are
+     *  cleared.  The calls themselves are not accounted any more.
+     */
+    while (profPtr->numFrames > 0) {
+	profPtr->frames[--profPtr->numFrames].entryPtr->depth--;
+    }
+    FOREACH_HASH_VALUE(entryPtr, &profPtr->functions) {
+	entryPtr->calls = 0;
+	entryPtr->errors = 0;
+	entryPtr->inclusive = 0;
+	entryPtr->exclusive = 0;
+    }
+    while (profPtr->retiredPtr != NULL) {
+	entryPtr = profPtr->retiredPtr;
+	profPtr->retiredPtr = entryPtr->nextPtr;
+	FreeProfileEntry(entryPtr);
+    }
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_ProfileReportCmd()
+ *
+ *  Returns the data collected as a dictionary mapping the fully qualified
+ *  function names to dictionaries with the keys "calls", "errors",
+ *  "inclusive" and "exclusive" (times in nanoseconds).  The dictionary is
+ *  ordered by the column given with -sort, by default the inclusive time
+ *  in decreasing order.
+ *  Handles the following syntax:
+ *
+ *      itcl::profile report ?-sort column? ?-increasing? ?-decreasing?
+ *
+ * ------------------------------------------------------------------------
+ */
+static int
+Itcl_ProfileReportCmd(
+    void *clientData,        /* info for all known objects */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    static const char *const options[] = {
+	"-decreasing", "-increasing", "-sort", NULL
+    };
+    enum ReportOption {
+	REPORT_DECREASING, REPORT_INCREASING, REPORT_SORT
+    };
+    FOREACH_HASH_DECLS;
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)clientData;
+    ItclProfileInfo *profPtr = infoPtr->profileInfoPtr;
+    ItclProfileEntry *entryPtr;
+    ItclProfileReport report;
+    ItclProfileRow *rowPtr;
+    Tcl_Obj *resultPtr;
+    Tcl_Obj *rowObjPtr;
+    Tcl_Size i;
+    int column = PROF_INCLUSIVE;
+    int decreasing = -1;
+    int index;
+    int pos;
+
+    for (pos = 1; pos < objc; pos++) {
+	if (Tcl_GetIndexFromObj(interp, objv[pos], options, "option", 0,
+		&index) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	switch (index) {
+	case REPORT_DECREASING:
+	    decreasing = 1;
+	    break;
+	case REPORT_INCREASING:
+	    decreasing = 0;
+	    break;
+	case REPORT_SORT:
+	    if (++pos >= objc) {
+		Tcl_AppendResult(interp, "missing value for \"-sort\"", NULL);
+		return TCL_ERROR;
+	    }
+	    if (Tcl_GetIndexFromObj(interp, objv[pos], profileColumns,
+		    "column", 0, &column) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    break;
+	}
+    }
+    if (decreasing < 0) {
+	/* names are listed alphabetically, numbers largest first */
+	decreasing = (column != PROF_NAME);
+    }
+
+    resultPtr = Tcl_NewObj();
+    if (profPtr == NULL) {
+	Tcl_SetObjResult(interp, resultPtr);
+	return TCL_OK;
+    }
+
+    /*
+     *  Merge all entries by name, since a function may have been
+     *  redefined or its class deleted and recreated.
+     */
+    Tcl_InitHashTable(&report.byName, TCL_STRING_KEYS);
+    report.rows = NULL;
+    report.numRows = 0;
+    report.maxRows = 0;
+    FOREACH_HASH_VALUE(entryPtr, &profPtr->functions) {
+	AddProfileRow(&report, entryPtr);
+    }
+    for (entryPtr = profPtr->retiredPtr; entryPtr != NULL;
+	    entryPtr = entryPtr->nextPtr) {
+	AddProfileRow(&report, entryPtr);
+    }
+
+    for (i = 0; i < report.numRows; i++) {
+	rowPtr = &report.rows[i];
+	rowPtr->reverseNames = (decreasing && (column == PROF_NAME));
+	if (column != PROF_NAME) {
+	    rowPtr->key = decreasing ?
+		    -rowPtr->values[column] : rowPtr->values[column];
+	}
+    }
+    if (report.numRows > 1) {
+	qsort(report.rows, report.numRows, sizeof(ItclProfileRow),
+		CompareProfileRows);
+    }
+
+    for (i = 0; i < report.numRows; i++) {
+	rowPtr = &report.rows[i];
+	rowObjPtr = Tcl_NewObj();
+	for (index = PROF_CALLS; index <= PROF_EXCLUSIVE; index++) {
+	    Tcl_DictObjPut(NULL, rowObjPtr,
+		    Tcl_NewStringObj(profileColumns[index], TCL_INDEX_NONE),
+		    Tcl_NewWideIntObj(rowPtr->values[index]));
+	}
+	Tcl_DictObjPut(NULL, resultPtr,
+		Tcl_NewStringObj(rowPtr->name, TCL_INDEX_NONE), rowObjPtr);
+    }
+    if (report.rows != NULL) {
+	ckfree((char *)report.rows);
+    }
+    Tcl_DeleteHashTable(&report.byName);
+    Tcl_SetObjResult(interp, resultPtr);
+    return TCL_OK;
+}
+
+static void
+AddProfileRow(
+    ItclProfileReport *reportPtr,
+    ItclProfileEntry *entryPtr)
+{
+    ItclProfileRow *rowPtr;
+    Tcl_HashEntry *hPtr;
+    int isNew;
+
+    if (entryPtr->calls == 0) {
+	return;
+    }
+    hPtr = Tcl_CreateHashEntry(&reportPtr->byName,
+	    Tcl_GetString(entryPtr->namePtr), &isNew);
+    if (isNew) {
+	if (reportPtr->numRows >= reportPtr->maxRows) {
+	    reportPtr->maxRows = reportPtr->maxRows ?
+		    2 * reportPtr->maxRows : 32;
+	    reportPtr->rows = (ItclProfileRow *)ckrealloc(
+		    (char *)reportPtr->rows,
+		    reportPtr->maxRows * sizeof(ItclProfileRow));
+	}
+	rowPtr = &reportPtr->rows[reportPtr->numRows];
+	memset(rowPtr, 0, sizeof(ItclProfileRow));
+	rowPtr->name = (const char *)Tcl_GetHashKey(&reportPtr->byName, hPtr);
+	Tcl_SetHashValue(hPtr, INT2PTR(reportPtr->numRows));
+	reportPtr->numRows++;
+    } else {
+	rowPtr = &reportPtr->rows[PTR2INT(Tcl_GetHashValue(hPtr))];
+    }
+    rowPtr->values[PROF_CALLS] += entryPtr->calls;
+    rowPtr->values[PROF_ERRORS] += entryPtr->errors;
+    rowPtr->values[PROF_INCLUSIVE] += entryPtr->inclusive;
+    rowPtr->values[PROF_EXCLUSIVE] += entryPtr->exclusive;
+}
+
+static int
+CompareProfileRows(
+    const void *first,
+    const void *second)
+{
+    const ItclProfileRow *row1 = (const ItclProfileRow *)first;
+    const ItclProfileRow *row2 = (const ItclProfileRow *)second;
+    int cmp;
+
+    cmp = (row1->key > row2->key) - (row1->key < row2->key);
+    if (cmp == 0) {
+	cmp = strcmp(row1->name, row2->name);
+	if (row1->reverseNames) {
+	    cmp = -cmp;
+	}
+    }
+    return cmp;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_ProfileSampleCmd()
+ *
+ *  Starts or stops the sampling profiler.
+ *  Handles the following syntax:
+ *
+ *      itcl::profile sample start ?-interval ms? ?-timer cpu|event? fileName
+ *      itcl::profile sample stop
+ *
+ * ------------------------------------------------------------------------
+ */
+static int
+Itcl_ProfileSampleCmd(
+    void *clientData,        /* info for all known objects */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    static const char *const actions[] = {
+	"start", "stop", NULL
+    };
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)clientData;
+    int index;
+
+    if (objc < 2) {
+        Tcl_WrongNumArgs(interp, 1, objv, "start|stop ?arg ...?");
+        return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[1], actions, "action", 0,
+	    &index) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (index == 0) {
+	return ProfileSampleStart(infoPtr, interp, objc, objv);
+    }
+    if (objc != 2) {
+        Tcl_WrongNumArgs(interp, 2, objv, "");
+        return TCL_ERROR;
+    }
+    return ProfileSampleStop(infoPtr, interp);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ProfileSampleStart()
+ *
+ *  Starts the sampling profiler.  Every "interval" milliseconds the stack
+ *  of active [incr Tcl] functions is recorded.  The "cpu" timer counts
+ *  CPU time of the process and takes samples while Tcl code is executed,
+ *  the "event" timer takes samples only when the event loop is entered.
+ * ------------------------------------------------------------------------
+ */
+static int
+ProfileSampleStart(
+    ItclObjectInfo *infoPtr, /* info for all known objects */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    static const char *const options[] = {
+	"-interval", "-timer", NULL
+    };
+    enum SampleOption {
+	SAMPLE_INTERVAL, SAMPLE_TIMER
+    };
+    static const char *const timers[] = {
+	"cpu", "event", NULL
+    };
+    ItclProfileInfo *profPtr;
+    int interval = 10;
+    int source;
+    int index;
+    int pos;
+
+#ifdef ITCL_SAMPLE_SIGNAL
+    source = ITCL_SAMPLE_CPU;
+#else
+    source = ITCL_SAMPLE_EVENT;
+#endif
+    for (pos = 2; pos < objc - 1; pos += 2) {
+	if (Tcl_GetIndexFromObj(interp, objv[pos], options, "option", 0,
+		&index) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	if (pos + 1 >= objc - 1) {
+	    Tcl_AppendResult(interp, "missing value for \"",
+		    Tcl_GetString(objv[pos]), "\"", NULL);
+	    return TCL_ERROR;
+	}
+	switch (index) {
+	case SAMPLE_INTERVAL:
+	    if (Tcl_GetIntFromObj(interp, objv[pos+1], &interval) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    if (interval <= 0) {
+		Tcl_AppendResult(interp, "bad interval \"",
+			Tcl_GetString(objv[pos+1]),
+			"\": must be a positive integer", NULL);
+		return TCL_ERROR;
+	    }
+	    break;
+	case SAMPLE_TIMER:
+	    if (Tcl_GetIndexFromObj(interp, objv[pos+1], timers, "timer", 0,
+		    &index) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    source = (index == 0) ? ITCL_SAMPLE_CPU : ITCL_SAMPLE_EVENT;
+	    break;
+	}
+    }
+    if (pos != objc - 1) {
+        Tcl_WrongNumArgs(interp, 2, objv,
+		"?-interval milliseconds? ?-timer cpu|event? fileName");
+        return TCL_ERROR;
+    }
+#ifndef ITCL_SAMPLE_SIGNAL
+    if (source == ITCL_SAMPLE_CPU) {
+	Tcl_AppendResult(interp, "the cpu timer is not supported ",
+		"on this platform", NULL);
+	return TCL_ERROR;
+    }
+#endif
+
+    profPtr = GetProfileInfo(infoPtr);
+    if (profPtr->sampleSource != 0) {
+	Tcl_AppendResult(interp, "sampling is already active", NULL);
+	return TCL_ERROR;
+    }
+
+#ifdef ITCL_SAMPLE_SIGNAL
+    if (source == ITCL_SAMPLE_CPU) {
+	struct sigaction action;
+	struct itimerval timer;
+
+	Tcl_MutexLock(&sampleMutex);
+	if (sampleAsyncHandler != NULL) {
+	    Tcl_MutexUnlock(&sampleMutex);
+	    Tcl_AppendResult(interp, "the cpu timer is already used ",
+		    "by another interpreter", NULL);
+	    return TCL_ERROR;
+	}
+	profPtr->sampleAsync = Tcl_AsyncCreate(SampleAsyncProc, infoPtr);
+	sampleAsyncHandler = profPtr->sampleAsync;
+
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = SampleSignalHandler;
+	action.sa_flags = SA_RESTART;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGPROF, &action, &sampleOldAction);
+
+	timer.it_interval.tv_sec = interval / 1000;
+	timer.it_interval.tv_usec = (interval % 1000) * 1000;
+	timer.it_value = timer.it_interval;
+	setitimer(ITIMER_PROF, &timer, NULL);
+	Tcl_MutexUnlock(&sampleMutex);
+    }
+#endif
+    if (source == ITCL_SAMPLE_EVENT) {
+	profPtr->sampleTimer = Tcl_CreateTimerHandler(interval,
+		SampleTimerProc, infoPtr);
+    }
+    profPtr->sampleSource = source;
+    profPtr->sampleInterval = interval;
+    profPtr->sampleFilePtr = objv[objc-1];
+    Tcl_IncrRefCount(profPtr->sampleFilePtr);
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ProfileSampleStop()
+ *
+ *  Stops the sampling profiler and writes the samples to the file given
+ *  on start, one line "frame;frame;... count" per distinct stack with the
+ *  outermost frame first.  Returns the number of samples written.
+ * ------------------------------------------------------------------------
+ */
+static int
+ProfileSampleStop(
+    ItclObjectInfo *infoPtr, /* info for all known objects */
+    Tcl_Interp *interp)      /* current interpreter */
+{
+    FOREACH_HASH_DECLS;
+    ItclProfileInfo *profPtr = infoPtr->profileInfoPtr;
+    Tcl_Channel channel;
+    Tcl_Obj *linePtr;
+    Tcl_Obj *fileNamePtr;
+    Tcl_WideInt numSamples;
+    const char *stack;
+    void *count;
+    int result;
+
+    if ((profPtr == NULL) || (profPtr->sampleSource == 0)) {
+	Tcl_AppendResult(interp, "sampling is not active", NULL);
+	return TCL_ERROR;
+    }
+    fileNamePtr = profPtr->sampleFilePtr;
+    profPtr->sampleFilePtr = NULL;
+    StopSampling(profPtr);
+    numSamples = profPtr->numSamples;
+
+    result = TCL_ERROR;
+    channel = Tcl_FSOpenFileChannel(interp, fileNamePtr, "w", 0666);
+    if (channel != NULL) {
+	linePtr = Tcl_NewObj();
+	Tcl_IncrRefCount(linePtr);
+	FOREACH_HASH(stack, count, &profPtr->samples) {
+	    Tcl_SetObjLength(linePtr, 0);
+	    Tcl_AppendPrintfToObj(linePtr, "%s %" TCL_LL_MODIFIER "d\n",
+		    stack, (Tcl_WideInt)PTR2INT(count));
+	    if (Tcl_WriteObj(channel, linePtr) < 0) {
+		break;
+	    }
+	}
+	Tcl_DecrRefCount(linePtr);
+	if (hPtr != NULL) {
+	    Tcl_AppendResult(interp, "error writing \"",
+		    Tcl_GetString(fileNamePtr), "\": ",
+		    Tcl_PosixError(interp), NULL);
+	    Tcl_Close(NULL, channel);
+	} else {
+	    result = Tcl_Close(interp, channel);
+	}
+    }
+    Tcl_DecrRefCount(fileNamePtr);
+
+    Tcl_DeleteHashTable(&profPtr->samples);
+    Tcl_InitHashTable(&profPtr->samples, TCL_STRING_KEYS);
+    profPtr->numSamples = 0;
+    if (result == TCL_OK) {
+	Tcl_SetObjResult(interp, Tcl_NewWideIntObj(numSamples));
+    }
+    return result;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  StopSampling()
+ *
+ *  Releases the timer used by the sampling profiler.  The samples taken
+ *  so far are kept.
+ * ------------------------------------------------------------------------
+ */
+static void
+StopSampling(
+    ItclProfileInfo *profPtr)
+{
+#ifdef ITCL_SAMPLE_SIGNAL
+    if (profPtr->sampleSource == ITCL_SAMPLE_CPU) {
+	struct itimerval timer;
+
+	Tcl_MutexLock(&sampleMutex);
+	memset(&timer, 0, sizeof(timer));
+	setitimer(ITIMER_PROF, &timer, NULL);
+	sigaction(SIGPROF, &sampleOldAction, NULL);
+	sampleAsyncHandler = NULL;
+	Tcl_MutexUnlock(&sampleMutex);
+	Tcl_AsyncDelete(profPtr->sampleAsync);
+	profPtr->sampleAsync = NULL;
+    }
+#endif
+    if (profPtr->sampleTimer != NULL) {
+	Tcl_DeleteTimerHandler(profPtr->sampleTimer);
+	profPtr->sampleTimer = NULL;
+    }
+    if (profPtr->sampleFilePtr != NULL) {
+	Tcl_DecrRefCount(profPtr->sampleFilePtr);
+	profPtr->sampleFilePtr = NULL;
+    }
+    profPtr->sampleSource = 0;
+}
+
+#ifdef ITCL_SAMPLE_SIGNAL
+static void
+SampleSignalHandler(
+    TCL_UNUSED(int))
+{
+    Tcl_AsyncHandler async = sampleAsyncHandler;
+
+    if (async != NULL) {
+	Tcl_AsyncMark(async);
+    }
+}
+#endif
+
+static int
+SampleAsyncProc(
+    void *clientData,
+    TCL_UNUSED(Tcl_Interp *),
+    int code)
+{
+    RecordSample((ItclObjectInfo *)clientData);
+    return code;
+}
+
+static void
+SampleTimerProc(
+    void *clientData)
+{
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)clientData;
+    ItclProfileInfo *profPtr = infoPtr->profileInfoPtr;
+
+    RecordSample(infoPtr);
+    profPtr->sampleTimer = Tcl_CreateTimerHandler(profPtr->sampleInterval,
+	    SampleTimerProc, infoPtr);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  RecordSample()
+ *
+ *  Records the stack of active [incr Tcl] functions.  The stack is found
+ *  by walking the Tcl call frames and mapping each of them through the
+ *  frameContext table to the call contexts pushed by ItclCheckCallMethod().
+ *  Samples without any active function are not recorded.
+ * ------------------------------------------------------------------------
+ */
+static void
+RecordSample(
+    ItclObjectInfo *infoPtr)
+{
+    ItclProfileInfo *profPtr = infoPtr->profileInfoPtr;
+    Interp *iPtr = (Interp *)infoPtr->interp;
+    CallFrame *framePtr;
+    ItclCallContext *callContextPtr;
+    ItclMemberFunc *imPtr;
+    Itcl_Stack *stackPtr;
+    Itcl_Stack functions;
+    Tcl_HashEntry *hPtr;
+    Tcl_DString buffer;
+    Tcl_Size i;
+    char *p;
+    int isNew;
+
+    if ((profPtr == NULL) || (profPtr->sampleSource == 0)) {
+	return;
+    }
+    Itcl_InitStack(&functions);
+    for (framePtr = iPtr->framePtr; framePtr != NULL;
+	    framePtr = framePtr->callerPtr) {
+	hPtr = Tcl_FindHashEntry(&infoPtr->frameContext, (char *)framePtr);
+	if (hPtr == NULL) {
+	    continue;
+	}
+	stackPtr = (Itcl_Stack *)Tcl_GetHashValue(hPtr);
+	for (i = Itcl_GetStackSize(stackPtr) - 1; i >= 0; i--) {
+	    callContextPtr = (ItclCallContext *)Itcl_GetStackValue(stackPtr, i);
+	    Itcl_PushStack(callContextPtr->imPtr, &functions);
+	}
+    }
+    if (Itcl_GetStackSize(&functions) == 0) {
+	Itcl_DeleteStack(&functions);
+	return;
+    }
+
+    Tcl_DStringInit(&buffer);
+    while (Itcl_GetStackSize(&functions) > 0) {
+	imPtr = (ItclMemberFunc *)Itcl_PopStack(&functions);
+	if (Tcl_DStringLength(&buffer) > 0) {
+	    Tcl_DStringAppend(&buffer, ";", 1);
+	}
+	i = Tcl_DStringLength(&buffer);
+	Tcl_DStringAppend(&buffer, Tcl_GetString(imPtr->fullNamePtr),
+		TCL_INDEX_NONE);
+	/* the separator must not show up within a frame */
+	for (p = Tcl_DStringValue(&buffer) + i; *p != '\0'; p++) {
+	    if (*p == ';') {
+		*p = ':';
+	    }
+	}
+    }
+    Itcl_DeleteStack(&functions);
+
+    hPtr = Tcl_CreateHashEntry(&profPtr->samples, Tcl_DStringValue(&buffer),
+	    &isNew);
+    Tcl_SetHashValue(hPtr, INT2PTR(PTR2INT(Tcl_GetHashValue(hPtr)) + 1));
+    profPtr->numSamples++;
+    Tcl_DStringFree(&buffer);
+}
@@ -0,0 +1,1041 @@
+/*
+ * itclRecord.c --
+ *
+ *	This file implements "itcl::record", a class flavor for large sets
+ *	of small homogeneous objects.  A record class is defined like any
+ *	other class, but its instances are rows in per-class columns, one
+ *	column per instance variable, instead of objects with their own
+ *	command, TclOO object and variable namespace.  Columns of typed
+ *	variables hold packed C values; the others hold Tcl objects.
+ *
+ *	Rows are addressed by their index.  Methods are run by loading the
+ *	row into the variables of a single hidden object of the class, the
+ *	cursor, and storing them back into the row afterwards.
+ *
+ * See the file "license.terms" for information on usage and redistribution of
+ * this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ */
+
+#include <tclInt.h>
+#include "itclInt.h"
+
+/*
+ * One column of a record class, holding the values of an instance
+ * variable for all rows.
+ */
+
+typedef struct ItclRecordColumn {
+    ItclVariable *ivPtr;          /* instance variable of the column */
+    int type;                     /* its ITCL_VARTYPE_*, kept for
+                                   * ItclDeleteRecord() */
+    char *cells;                  /* one value per row: a Tcl_Obj * (NULL
+                                   * if unset) for untyped variables, else
+                                   * a C value as in ItclGetTypedValue() */
+} ItclRecordColumn;
+
+/*
+ * The rows of a record class, attached to its ItclClass.
+ */
+
+typedef struct ItclRecord {
+    ItclClass *iclsPtr;           /* record class */
+    Tcl_Size numColumns;          /* number of entries in columns */
+    ItclRecordColumn *columns;    /* columns, in the order of the variables
+                                   * of the class and its bases */
+    Tcl_Size numRows;             /* rows ever used, live or deleted */
+    Tcl_Size maxRows;             /* rows allocated in each column */
+    Tcl_Size numLive;             /* rows in use */
+    char *live;                   /* 1 for each row in use */
+    unsigned int *generations;    /* for each row, the number of times it
+                                   * was deleted, so that a call can tell
+                                   * whether its row was reused */
+    Tcl_Size *freeRows;           /* deleted rows, for reuse */
+    Tcl_Size numFree;             /* number of entries in freeRows */
+    ItclObject *cursorPtr;        /* object running methods, or NULL */
+    Tcl_Size boundRow;            /* row loaded in the cursor, or -1 */
+} ItclRecord;
+
+static const char *const recordOptions[] = {
+    "call", "column", "count", "delete", "exists", "get", "new", "rows",
+    "set", NULL
+};
+enum RecordOption {
+    REC_CALL, REC_COLUMN, REC_COUNT, REC_DELETE, REC_EXISTS, REC_GET,
+    REC_NEW, REC_ROWS, REC_SET
+};
+
+static size_t CellSize(int type);
+static Tcl_Obj *GetCell(ItclRecordColumn *colPtr, Tcl_Size row);
+static void SetCell(ItclRecordColumn *colPtr, Tcl_Size row,
+	Tcl_Obj *objPtr, const void *valuePtr);
+static int ConvertCell(Tcl_Interp *interp, ItclRecordColumn *colPtr,
+	Tcl_Obj *objPtr, void *valuePtr);
+static ItclRecordColumn *FindColumn(Tcl_Interp *interp,
+	ItclRecord *recPtr, Tcl_Obj *namePtr);
+static int GetRow(Tcl_Interp *interp, ItclRecord *recPtr,
+	Tcl_Obj *objPtr, Tcl_Size *rowPtr);
+static Tcl_Size NewRow(ItclRecord *recPtr);
+static void DeleteRow(ItclRecord *recPtr, Tcl_Size row);
+static ItclObject *GetCursor(Tcl_Interp *interp, ItclRecord *recPtr);
+static int LoadRow(Tcl_Interp *interp, ItclRecord *recPtr, Tcl_Size row);
+static void StoreRow(Tcl_Interp *interp, ItclRecord *recPtr, Tcl_Size row);
+static int RecordColumnCmd(Tcl_Interp *interp, ItclRecord *recPtr,
+	int objc, Tcl_Obj *const objv[]);
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_RecordCmd()
+ *
+ *  Invoked by Tcl to define a record class.  Handles the following
+ *  syntax:
+ *
+ *    itcl::record <className> { <definition> }
+ *
+ *  The definition is that of an "itcl::class", except that records can
+ *  only inherit from records and have no constructor or destructor.
+ *
+ *  Returns TCL_OK/TCL_ERROR to indicate success/failure.
+ * ------------------------------------------------------------------------
+ */
+int
+Itcl_RecordCmd(
+    void *clientData,        /* infoPtr */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    ItclClass *iclsPtr;
+    ItclClass *baseClsPtr;
+    ItclMemberFunc *imPtr;
+    ItclRecord *recPtr;
+    ItclHierIter hier;
+    ItclClass *iclsPtr2;
+    ItclVariable *ivPtr;
+    Itcl_ListElem *elem;
+    FOREACH_HASH_DECLS;
+    Tcl_Size i;
+
+    ItclShowArgs(1, "Itcl_RecordCmd", objc, objv);
+
+    /*
+     *  The class is flagged as a record while its body is evaluated, so
+     *  that "inherit" knows it may inherit from records.
+     */
+    if (ItclClassBaseCmd(clientData, interp, ITCL_CLASS|ITCL_RECORD, objc,
+	    objv, &iclsPtr) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (iclsPtr == NULL) {
+	return TCL_ERROR;
+    }
+
+    /*
+     *  Check what records cannot have.
+     */
+    for (elem = Itcl_FirstListElem(&iclsPtr->bases); elem != NULL;
+	    elem = Itcl_NextListElem(elem)) {
+	baseClsPtr = (ItclClass *)Itcl_GetListValue(elem);
+	if (!(baseClsPtr->flags & ITCL_RECORD)) {
+	    Tcl_AppendResult(interp, "record \"",
+		    Tcl_GetString(iclsPtr->fullNamePtr),
+		    "\" cannot inherit from class \"",
+		    Tcl_GetString(baseClsPtr->fullNamePtr),
+		    "\" which is not a record", NULL);
+	    goto errorReturn;
+	}
+    }
+    FOREACH_HASH_VALUE(imPtr, &iclsPtr->functions) {
+	if ((imPtr->flags & (ITCL_CONSTRUCTOR|ITCL_DESTRUCTOR))
+		&& (imPtr->iclsPtr == iclsPtr)) {
+	    Tcl_AppendResult(interp, "record \"",
+		    Tcl_GetString(iclsPtr->fullNamePtr), "\" cannot have a ",
+		    Tcl_GetString(imPtr->namePtr), NULL);
+	    goto errorReturn;
+	}
+    }
+
+    /*
+     *  One column for each instance variable of the class and its bases.
+     */
+    recPtr = (ItclRecord *)ckalloc(sizeof(ItclRecord));
+    memset(recPtr, 0, sizeof(ItclRecord));
+    recPtr->iclsPtr = iclsPtr;
+    recPtr->boundRow = -1;
+    for (i = 0; i < 2; i++) {
+	recPtr->numColumns = 0;
+	Itcl_InitHierIter(&hier, iclsPtr);
+	while ((iclsPtr2 = Itcl_AdvanceHierIter(&hier)) != NULL) {
+	    FOREACH_HASH_VALUE(ivPtr, &iclsPtr2->variables) {
+		if ((ivPtr->flags & (ITCL_COMMON|ITCL_THIS_VAR|
+			ITCL_OPTIONS_VAR|ITCL_TYPE_VAR|ITCL_SELF_VAR|
+			ITCL_SELFNS_VAR|ITCL_WIN_VAR|ITCL_COMPONENT_VAR|
+			ITCL_HULL_VAR)) || (ivPtr->arrayInitPtr != NULL)) {
+		    continue;
+		}
+		if (recPtr->columns != NULL) {
+		    recPtr->columns[recPtr->numColumns].ivPtr = ivPtr;
+		    recPtr->columns[recPtr->numColumns].type = ivPtr->type;
+		}
+		recPtr->numColumns++;
+	    }
+	}
+	Itcl_DeleteHierIter(&hier);
+	if ((i == 0) && (recPtr->numColumns > 0)) {
+	    recPtr->columns = (ItclRecordColumn *)ckalloc(
+		    recPtr->numColumns * sizeof(ItclRecordColumn));
+	    memset(recPtr->columns, 0,
+		    recPtr->numColumns * sizeof(ItclRecordColumn));
+	} else {
+	    break;
+	}
+    }
+    iclsPtr->recordPtr = recPtr;
+    Tcl_SetObjResult(interp, iclsPtr->fullNamePtr);
+    return TCL_OK;
+
+errorReturn:
+    Tcl_DeleteNamespace(iclsPtr->nsPtr);
+    return TCL_ERROR;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclDestroyRecord()
+ *
+ *  Releases the cursor of a record class.  Invoked when the class is
+ *  destroyed, after its objects, the cursor among them, are deleted.
+ *  The cursor keeps the class alive, so it cannot wait until the class
+ *  is freed.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclDestroyRecord(
+    ItclClass *iclsPtr)      /* record class */
+{
+    ItclRecord *recPtr = iclsPtr->recordPtr;
+
+    if ((recPtr != NULL) && (recPtr->cursorPtr != NULL)) {
+	Itcl_ReleaseData(recPtr->cursorPtr);
+	recPtr->cursorPtr = NULL;
+    }
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclDeleteRecord()
+ *
+ *  Frees the rows of a record class.  Invoked when the class is freed.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclDeleteRecord(
+    ItclClass *iclsPtr)      /* record class */
+{
+    ItclRecord *recPtr = iclsPtr->recordPtr;
+    ItclRecordColumn *colPtr;
+    Tcl_Obj *objPtr;
+    Tcl_Size i;
+    Tcl_Size row;
+
+    for (i = 0; i < recPtr->numColumns; i++) {
+	colPtr = &recPtr->columns[i];
+	if (colPtr->type == ITCL_VARTYPE_NONE) {
+	    for (row = 0; row < recPtr->numRows; row++) {
+		objPtr = ((Tcl_Obj **)colPtr->cells)[row];
+		if (objPtr != NULL) {
+		    Tcl_DecrRefCount(objPtr);
+		}
+	    }
+	}
+	if (colPtr->cells != NULL) {
+	    ckfree(colPtr->cells);
+	}
+    }
+    if (recPtr->columns != NULL) {
+	ckfree((char *)recPtr->columns);
+    }
+    if (recPtr->live != NULL) {
+	ckfree(recPtr->live);
+	ckfree((char *)recPtr->generations);
+	ckfree((char *)recPtr->freeRows);
+    }
+    if (recPtr->cursorPtr != NULL) {
+	Itcl_ReleaseData(recPtr->cursorPtr);
+    }
+    ckfree((char *)recPtr);
+    iclsPtr->recordPtr = NULL;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclRecordCmd()
+ *
+ *  Invoked by Itcl_HandleClass() for the command of a record class.
+ *  Handles the following syntax:
+ *
+ *    <className> new ?-<var> <value>...?
+ *    <className> delete ?<row>...?
+ *    <className> exists <row>
+ *    <className> get <row> ?<var>?
+ *    <className> set <row> <var> <value> ?<var> <value>...?
+ *    <className> call <row> <method> ?<arg>...?
+ *    <className> column get <var> ?<rows>?
+ *    <className> column set <var> <values> ?<rows>?
+ *    <className> rows
+ *    <className> count
+ *
+ *  objv[0] is the name of the class.
+ * ------------------------------------------------------------------------
+ */
+int
+ItclRecordCmd(
+    ItclClass *iclsPtr,      /* record class */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    ItclRecord *recPtr = iclsPtr->recordPtr;
+    ItclRecordColumn *colPtr;
+    ItclMemberFunc *imPtr;
+    ItclObject *cursorPtr;
+    Tcl_Obj *resultPtr;
+    Tcl_Obj *objPtr;
+    Tcl_Size row;
+    Tcl_Size prevRow;
+    unsigned int generation;
+    unsigned int prevGeneration;
+    Tcl_WideInt value;
+    int index;
+    int result;
+    int i;
+
+    if (objc < 2) {
+	Tcl_WrongNumArgs(interp, 1, objv, "option ?arg ...?");
+	return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[1], recordOptions, "option", 0,
+	    &index) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    /*
+     *  Make the row bound to the cursor by a running method up to date.
+     */
+    if ((recPtr->boundRow >= 0) && (index != REC_CALL)) {
+	StoreRow(interp, recPtr, recPtr->boundRow);
+    }
+
+    switch ((enum RecordOption)index) {
+    case REC_NEW:
+	if ((objc % 2) != 0) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "?-var value ...?");
+	    return TCL_ERROR;
+	}
+	row = NewRow(recPtr);
+	for (i = 2; i < objc; i += 2) {
+	    objPtr = objv[i];
+	    if (*Tcl_GetString(objPtr) == '-') {
+		objPtr = Tcl_NewStringObj(Tcl_GetString(objPtr) + 1,
+			TCL_INDEX_NONE);
+	    }
+	    Tcl_IncrRefCount(objPtr);
+	    colPtr = FindColumn(interp, recPtr, objPtr);
+	    Tcl_DecrRefCount(objPtr);
+	    if ((colPtr == NULL)
+		    || (ConvertCell(interp, colPtr, objv[i+1], &value) != TCL_OK)) {
+		DeleteRow(recPtr, row);
+		return TCL_ERROR;
+	    }
+	    SetCell(colPtr, row, objv[i+1], &value);
+	}
+	Tcl_SetObjResult(interp, Tcl_NewWideIntObj(row));
+	return TCL_OK;
+
+    case REC_DELETE:
+	for (i = 2; i < objc; i++) {
+	    if (GetRow(interp, recPtr, objv[i], &row) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    DeleteRow(recPtr, row);
+	}
+	return TCL_OK;
+
+    case REC_EXISTS:
+	if (objc != 3) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "row");
+	    return TCL_ERROR;
+	}
+	Tcl_SetObjResult(interp, Tcl_NewBooleanObj(
+		GetRow(NULL, recPtr, objv[2], &row) == TCL_OK));
+	return TCL_OK;
+
+    case REC_GET:
+	if ((objc != 3) && (objc != 4)) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "row ?var?");
+	    return TCL_ERROR;
+	}
+	if (GetRow(interp, recPtr, objv[2], &row) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	if (objc == 4) {
+	    colPtr = FindColumn(interp, recPtr, objv[3]);
+	    if (colPtr == NULL) {
+		return TCL_ERROR;
+	    }
+	    objPtr = GetCell(colPtr, row);
+	    if (objPtr == NULL) {
+		Tcl_AppendResult(interp, "can't read \"",
+			Tcl_GetString(objv[3]), "\": no value", NULL);
+		return TCL_ERROR;
+	    }
+	    Tcl_SetObjResult(interp, objPtr);
+	    return TCL_OK;
+	}
+	resultPtr = Tcl_NewDictObj();
+	for (i = 0; i < recPtr->numColumns; i++) {
+	    colPtr = &recPtr->columns[i];
+	    objPtr = GetCell(colPtr, row);
+	    if (objPtr != NULL) {
+		Tcl_DictObjPut(NULL, resultPtr, colPtr->ivPtr->namePtr,
+			objPtr);
+	    }
+	}
+	Tcl_SetObjResult(interp, resultPtr);
+	return TCL_OK;
+
+    case REC_SET:
+	if ((objc < 5) || ((objc % 2) == 0)) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "row var value ?var value ...?");
+	    return TCL_ERROR;
+	}
+	if (GetRow(interp, recPtr, objv[2], &row) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	result = TCL_OK;
+	for (i = 3; i < objc; i += 2) {
+	    colPtr = FindColumn(interp, recPtr, objv[i]);
+	    if ((colPtr == NULL)
+		    || (ConvertCell(interp, colPtr, objv[i+1], &value) != TCL_OK)) {
+		result = TCL_ERROR;
+		break;
+	    }
+	    SetCell(colPtr, row, objv[i+1], &value);
+	}
+	if (recPtr->boundRow == row) {
+	    LoadRow(interp, recPtr, row);
+	}
+	if (result == TCL_OK) {
+	    Tcl_SetObjResult(interp, objv[objc-1]);
+	}
+	return result;
+
+    case REC_CALL:
+	if (objc < 4) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "row method ?arg ...?");
+	    return TCL_ERROR;
+	}
+	if (GetRow(interp, recPtr, objv[2], &row) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	imPtr = Itcl_LookupMethod(interp, iclsPtr, Tcl_GetString(objv[3]));
+	if (imPtr == NULL) {
+	    return TCL_ERROR;
+	}
+	if (imPtr->flags & ITCL_COMMON) {
+	    Tcl_AppendResult(interp, "\"", Tcl_GetString(objv[3]),
+		    "\" is a proc, not a method", NULL);
+	    return TCL_ERROR;
+	}
+	cursorPtr = GetCursor(interp, recPtr);
+	if (cursorPtr == NULL) {
+	    return TCL_ERROR;
+	}
+
+	/*
+	 *  Calls may be nested: keep the row of the outer call up to date
+	 *  and load it back afterwards, unless it was deleted meanwhile.
+	 *  The rows are tracked by generation, since a deleted row may be
+	 *  reused by "new" before the call returns.
+	 */
+	prevRow = recPtr->boundRow;
+	prevGeneration = 0;
+	if (prevRow >= 0) {
+	    prevGeneration = recPtr->generations[prevRow];
+	    if (prevRow != row) {
+		StoreRow(interp, recPtr, prevRow);
+	    }
+	}
+	if (LoadRow(interp, recPtr, row) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	recPtr->boundRow = row;
+	generation = recPtr->generations[row];
+	Itcl_PreserveData(cursorPtr);
+	result = Itcl_InvokeMethod(interp, cursorPtr, imPtr, objc - 4,
+		objv + 4);
+	if ((recPtr->boundRow == row) && (recPtr->cursorPtr == cursorPtr)
+		&& (recPtr->generations[row] == generation)) {
+	    StoreRow(interp, recPtr, row);
+	}
+	recPtr->boundRow = -1;
+	if ((prevRow >= 0) && recPtr->live[prevRow]
+		&& (recPtr->generations[prevRow] == prevGeneration)
+		&& (recPtr->cursorPtr == cursorPtr)) {
+	    recPtr->boundRow = prevRow;
+	    if (prevRow != row) {
+		LoadRow(interp, recPtr, prevRow);
+	    }
+	}
+	Itcl_ReleaseData(cursorPtr);
+	return result;
+
+    case REC_COLUMN:
+	return RecordColumnCmd(interp, recPtr, objc, objv);
+
+    case REC_ROWS:
+	if (objc != 2) {
+	    Tcl_WrongNumArgs(interp, 2, objv, NULL);
+	    return TCL_ERROR;
+	}
+	resultPtr = Tcl_NewListObj(0, NULL);
+	for (row = 0; row < recPtr->numRows; row++) {
+	    if (recPtr->live[row]) {
+		Tcl_ListObjAppendElement(NULL, resultPtr,
+			Tcl_NewWideIntObj(row));
+	    }
+	}
+	Tcl_SetObjResult(interp, resultPtr);
+	return TCL_OK;
+
+    case REC_COUNT:
+	if (objc != 2) {
+	    Tcl_WrongNumArgs(interp, 2, objv, NULL);
+	    return TCL_ERROR;
+	}
+	Tcl_SetObjResult(interp, Tcl_NewWideIntObj(recPtr->numLive));
+	return TCL_OK;
+    }
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  RecordColumnCmd()
+ *
+ *  Handles "<className> column get|set ...", which read or write one
+ *  variable of many rows at once: the given rows, or all rows in use
+ *  in increasing order.  All values are checked before any is set.
+ * ------------------------------------------------------------------------
+ */
+static int
+RecordColumnCmd(
+    Tcl_Interp *interp,      /* current interpreter */
+    ItclRecord *recPtr,      /* rows of the record class */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    static const char *const columnOptions[] = {"get", "set", NULL};
+    ItclRecordColumn *colPtr;
+    Tcl_Obj *resultPtr;
+    Tcl_Obj *objPtr;
+    Tcl_Obj **valueObjv;
+    Tcl_Obj **rowObjv;
+    Tcl_Size *rows;
+    Tcl_Size numValues;
+    Tcl_Size numRows;
+    Tcl_Size row;
+    Tcl_Size i;
+    size_t cellSize;
+    char *values;
+    int isSet;
+    int result;
+
+    if (objc < 4) {
+	Tcl_WrongNumArgs(interp, 2, objv, "get|set var ?arg ...?");
+	return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[2], columnOptions, "option", 0,
+	    &isSet) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if ((isSet && (objc != 5) && (objc != 6))
+	    || (!isSet && (objc != 4) && (objc != 5))) {
+	Tcl_WrongNumArgs(interp, 3, objv,
+		isSet ? "var values ?rows?" : "var ?rows?");
+	return TCL_ERROR;
+    }
+    colPtr = FindColumn(interp, recPtr, objv[3]);
+    if (colPtr == NULL) {
+	return TCL_ERROR;
+    }
+
+    /*
+     *  Collect the rows.
+     */
+    if (objc == 5 + isSet) {
+	if (Tcl_ListObjGetElements(interp, objv[4 + isSet], &numRows,
+		&rowObjv) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	rows = (Tcl_Size *)ckalloc((numRows + 1) * sizeof(Tcl_Size));
+	for (i = 0; i < numRows; i++) {
+	    if (GetRow(interp, recPtr, rowObjv[i], &rows[i]) != TCL_OK) {
+		ckfree((char *)rows);
+		return TCL_ERROR;
+	    }
+	}
+    } else {
+	numRows = 0;
+	rows = (Tcl_Size *)ckalloc((recPtr->numLive + 1) * sizeof(Tcl_Size));
+	for (row = 0; row < recPtr->numRows; row++) {
+	    if (recPtr->live[row]) {
+		rows[numRows++] = row;
+	    }
+	}
+    }
+
+    if (!isSet) {
+	resultPtr = Tcl_NewListObj(numRows, NULL);
+	for (i = 0; i < numRows; i++) {
+	    objPtr = GetCell(colPtr, rows[i]);
+	    Tcl_ListObjAppendElement(NULL, resultPtr,
+		    (objPtr != NULL) ? objPtr : Tcl_NewObj());
+	}
+	ckfree((char *)rows);
+	Tcl_SetObjResult(interp, resultPtr);
+	return TCL_OK;
+    }
+
+    result = Tcl_ListObjGetElements(interp, objv[4], &numValues, &valueObjv);
+    if ((result == TCL_OK) && (numValues != numRows)) {
+	Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		"expected %" TCL_LL_MODIFIER "d values but got %"
+		TCL_LL_MODIFIER "d", (Tcl_WideInt)numRows,
+		(Tcl_WideInt)numValues));
+	result = TCL_ERROR;
+    }
+    values = NULL;
+    if (result == TCL_OK) {
+	cellSize = CellSize(colPtr->ivPtr->type);
+	values = (char *)ckalloc((numValues + 1) * cellSize);
+	for (i = 0; i < numValues; i++) {
+	    if (ConvertCell(interp, colPtr, valueObjv[i],
+		    values + i * cellSize) != TCL_OK) {
+		result = TCL_ERROR;
+		break;
+	    }
+	}
+    }
+    if (result == TCL_OK) {
+	for (i = 0; i < numValues; i++) {
+	    SetCell(colPtr, rows[i], valueObjv[i], values + i * cellSize);
+	}
+	if (recPtr->boundRow >= 0) {
+	    LoadRow(interp, recPtr, recPtr->boundRow);
+	}
+    }
+    if (values != NULL) {
+	ckfree(values);
+    }
+    ckfree((char *)rows);
+    return result;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  CellSize()
+ *
+ *  Returns the size of a value of a column with the given ITCL_VARTYPE_*.
+ * ------------------------------------------------------------------------
+ */
+static size_t
+CellSize(
+    int type)
+{
+    switch (type) {
+    case ITCL_VARTYPE_DOUBLE:
+	return sizeof(double);
+    case ITCL_VARTYPE_WIDEINT:
+	return sizeof(Tcl_WideInt);
+    case ITCL_VARTYPE_INT:
+    case ITCL_VARTYPE_BOOLEAN:
+	return sizeof(int);
+    }
+    return sizeof(Tcl_Obj *);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  GetCell()
+ *
+ *  Returns the value of a row in a column, or NULL if it is unset.  For
+ *  typed columns, a new object is returned.
+ * ------------------------------------------------------------------------
+ */
+static Tcl_Obj *
+GetCell(
+    ItclRecordColumn *colPtr,
+    Tcl_Size row)
+{
+    switch (colPtr->ivPtr->type) {
+    case ITCL_VARTYPE_DOUBLE:
+	return Tcl_NewDoubleObj(((double *)colPtr->cells)[row]);
+    case ITCL_VARTYPE_WIDEINT:
+	return Tcl_NewWideIntObj(((Tcl_WideInt *)colPtr->cells)[row]);
+    case ITCL_VARTYPE_INT:
+	return Tcl_NewIntObj(((int *)colPtr->cells)[row]);
+    case ITCL_VARTYPE_BOOLEAN:
+	return Tcl_NewBooleanObj(((int *)colPtr->cells)[row]);
+    }
+    return ((Tcl_Obj **)colPtr->cells)[row];
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ConvertCell()
+ *
+ *  Checks that a value is valid for a column and, for typed columns,
+ *  converts it to a C value at valuePtr.
+ *
+ *  Returns TCL_OK, or TCL_ERROR (along with an error message in the
+ *  interpreter) if the value is not valid.
+ * ------------------------------------------------------------------------
+ */
+static int
+ConvertCell(
+    Tcl_Interp *interp,
+    ItclRecordColumn *colPtr,
+    Tcl_Obj *objPtr,
+    void *valuePtr)
+{
+    if (colPtr->ivPtr->type == ITCL_VARTYPE_NONE) {
+	return TCL_OK;
+    }
+    if (ItclGetTypedValue(interp, colPtr->ivPtr->type, objPtr,
+	    valuePtr) != TCL_OK) {
+	Tcl_AppendObjToErrorInfo(interp, Tcl_ObjPrintf(
+		"\n    (setting variable \"%s\")",
+		Tcl_GetString(colPtr->ivPtr->namePtr)));
+	return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  SetCell()
+ *
+ *  Sets the value of a row in a column: objPtr for untyped columns, in
+ *  which NULL unsets it, or the C value at valuePtr for typed columns.
+ * ------------------------------------------------------------------------
+ */
+static void
+SetCell(
+    ItclRecordColumn *colPtr,
+    Tcl_Size row,
+    Tcl_Obj *objPtr,
+    const void *valuePtr)
+{
+    Tcl_Obj **cellPtr;
+    size_t cellSize;
+
+    if (colPtr->ivPtr->type == ITCL_VARTYPE_NONE) {
+	cellPtr = &((Tcl_Obj **)colPtr->cells)[row];
+	if (objPtr != NULL) {
+	    Tcl_IncrRefCount(objPtr);
+	}
+	if (*cellPtr != NULL) {
+	    Tcl_DecrRefCount(*cellPtr);
+	}
+	*cellPtr = objPtr;
+    } else {
+	cellSize = CellSize(colPtr->ivPtr->type);
+	memcpy(colPtr->cells + row * cellSize, valuePtr, cellSize);
+    }
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  FindColumn()
+ *
+ *  Returns the column of a variable of a record class, which may be
+ *  qualified by the name of a base class, or NULL (along with an error
+ *  message in the interpreter) if there is no such column.
+ * ------------------------------------------------------------------------
+ */
+static ItclRecordColumn *
+FindColumn(
+    Tcl_Interp *interp,
+    ItclRecord *recPtr,
+    Tcl_Obj *namePtr)
+{
+    ItclVariable *ivPtr;
+    Tcl_Size i;
+
+    ivPtr = Itcl_LookupMemberVar(NULL, recPtr->iclsPtr,
+	    Tcl_GetString(namePtr));
+    for (i = 0; (ivPtr != NULL) && (i < recPtr->numColumns); i++) {
+	if (recPtr->columns[i].ivPtr == ivPtr) {
+	    return &recPtr->columns[i];
+	}
+    }
+    Tcl_AppendResult(interp, "\"", Tcl_GetString(namePtr),
+	    "\" is not a variable of record \"",
+	    Tcl_GetString(recPtr->iclsPtr->fullNamePtr), "\"", NULL);
+    return NULL;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  GetRow()
+ *
+ *  Gets the index of a row in use from objPtr.
+ *
+ *  Returns TCL_OK, or TCL_ERROR (along with an error message in the
+ *  interpreter, if not NULL) if objPtr is not such a row.
+ * ------------------------------------------------------------------------
+ */
+static int
+GetRow(
+    Tcl_Interp *interp,
+    ItclRecord *recPtr,
+    Tcl_Obj *objPtr,
+    Tcl_Size *rowPtr)
+{
+    Tcl_WideInt row;
+
+    if ((Tcl_GetWideIntFromObj(NULL, objPtr, &row) != TCL_OK)
+	    || (row < 0) || (row >= recPtr->numRows) || !recPtr->live[row]) {
+	if (interp != NULL) {
+	    Tcl_AppendResult(interp, "row \"", Tcl_GetString(objPtr),
+		    "\" does not exist in record \"",
+		    Tcl_GetString(recPtr->iclsPtr->fullNamePtr), "\"", NULL);
+	}
+	return TCL_ERROR;
+    }
+    *rowPtr = (Tcl_Size)row;
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  NewRow()
+ *
+ *  Allocates a row, reusing a deleted one if possible, and sets its
+ *  variables to their initial values.  Returns the index of the row.
+ * ------------------------------------------------------------------------
+ */
+static Tcl_Size
+NewRow(
+    ItclRecord *recPtr)
+{
+    ItclRecordColumn *colPtr;
+    Tcl_WideInt value;
+    Tcl_Size row;
+    Tcl_Size i;
+
+    if (recPtr->numFree > 0) {
+	row = recPtr->freeRows[--recPtr->numFree];
+    } else {
+	if (recPtr->numRows == recPtr->maxRows) {
+	    recPtr->maxRows = (recPtr->maxRows == 0) ? 16 : 2 * recPtr->maxRows;
+	    recPtr->live = (char *)ckrealloc(recPtr->live, recPtr->maxRows);
+	    recPtr->generations = (unsigned int *)ckrealloc(
+		    (char *)recPtr->generations,
+		    recPtr->maxRows * sizeof(unsigned int));
+	    recPtr->freeRows = (Tcl_Size *)ckrealloc(
+		    (char *)recPtr->freeRows,
+		    recPtr->maxRows * sizeof(Tcl_Size));
+	    for (i = 0; i < recPtr->numColumns; i++) {
+		colPtr = &recPtr->columns[i];
+		colPtr->cells = (char *)ckrealloc(colPtr->cells,
+			recPtr->maxRows * CellSize(colPtr->ivPtr->type));
+	    }
+	}
+	row = recPtr->numRows++;
+	recPtr->generations[row] = 0;
+	for (i = 0; i < recPtr->numColumns; i++) {
+	    colPtr = &recPtr->columns[i];
+	    if (colPtr->ivPtr->type == ITCL_VARTYPE_NONE) {
+		((Tcl_Obj **)colPtr->cells)[row] = NULL;
+	    }
+	}
+    }
+    recPtr->live[row] = 1;
+    recPtr->numLive++;
+
+    for (i = 0; i < recPtr->numColumns; i++) {
+	colPtr = &recPtr->columns[i];
+	value = 0;
+	if ((colPtr->ivPtr->init != NULL)
+		&& (colPtr->ivPtr->type != ITCL_VARTYPE_NONE)) {
+	    ItclGetTypedValue(NULL, colPtr->ivPtr->type, colPtr->ivPtr->init,
+		    &value);
+	}
+	SetCell(colPtr, row, colPtr->ivPtr->init, &value);
+    }
+    return row;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  DeleteRow()
+ *
+ *  Releases the values of a row and makes it available for reuse.  If
+ *  a running method is bound to the row, the cursor is unbound from it,
+ *  so that its variables are not stored into the row once reused.
+ * ------------------------------------------------------------------------
+ */
+static void
+DeleteRow(
+    ItclRecord *recPtr,
+    Tcl_Size row)
+{
+    ItclRecordColumn *colPtr;
+    Tcl_Size i;
+
+    for (i = 0; i < recPtr->numColumns; i++) {
+	colPtr = &recPtr->columns[i];
+	if (colPtr->ivPtr->type == ITCL_VARTYPE_NONE) {
+	    SetCell(colPtr, row, NULL, NULL);
+	}
+    }
+    recPtr->live[row] = 0;
+    recPtr->generations[row]++;
+    recPtr->numLive--;
+    if (recPtr->boundRow == row) {
+	recPtr->boundRow = -1;
+    }
+    recPtr->freeRows[recPtr->numFree++] = row;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  GetCursor()
+ *
+ *  Returns the object of a record class in which its methods run,
+ *  creating it in the class namespace if needed, or NULL (along with an
+ *  error message in the interpreter) if it cannot be created.  The
+ *  object is hidden from "itcl::find objects" and "info instances".
+ * ------------------------------------------------------------------------
+ */
+static ItclObject *
+GetCursor(
+    Tcl_Interp *interp,
+    ItclRecord *recPtr)
+{
+    ItclObject *ioPtr = recPtr->cursorPtr;
+    Tcl_InterpState state;
+    Tcl_Obj *namePtr;
+    int result;
+
+    if (ioPtr != NULL) {
+	if (!(ioPtr->flags & (ITCL_OBJECT_IS_DELETED|
+		ITCL_OBJECT_IS_DESTRUCTED|ITCL_OBJECT_IS_DESTROYED))) {
+	    return ioPtr;
+	}
+	Itcl_ReleaseData(ioPtr);
+	recPtr->cursorPtr = NULL;
+    }
+    namePtr = Tcl_NewStringObj(recPtr->iclsPtr->nsPtr->fullName,
+	    TCL_INDEX_NONE);
+    Tcl_AppendToObj(namePtr, "::#record", TCL_INDEX_NONE);
+    Tcl_IncrRefCount(namePtr);
+    state = Tcl_SaveInterpState(interp, TCL_OK);
+    result = Itcl_CreateObject(interp, Tcl_GetString(namePtr),
+	    recPtr->iclsPtr, 0, NULL, &ioPtr);
+    Tcl_DecrRefCount(namePtr);
+    if (result != TCL_OK) {
+	Tcl_DiscardInterpState(state);
+	return NULL;
+    }
+    Tcl_RestoreInterpState(interp, state);
+    ioPtr->flags |= ITCL_OBJECT_HIDDEN;
+    Itcl_PreserveData(ioPtr);
+    recPtr->cursorPtr = ioPtr;
+    return ioPtr;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  LoadRow()
+ *
+ *  Sets the variables of the cursor to the values of a row.
+ * ------------------------------------------------------------------------
+ */
+static int
+LoadRow(
+    Tcl_Interp *interp,
+    ItclRecord *recPtr,
+    Tcl_Size row)
+{
+    ItclRecordColumn *colPtr;
+    Tcl_HashEntry *hPtr;
+    Tcl_Obj *objPtr;
+    Tcl_Size i;
+
+    for (i = 0; i < recPtr->numColumns; i++) {
+	colPtr = &recPtr->columns[i];
+	objPtr = GetCell(colPtr, row);
+	if (objPtr != NULL) {
+	    if (Itcl_SetVarByHandle(interp, recPtr->cursorPtr, colPtr->ivPtr,
+		    objPtr) == NULL) {
+		return TCL_ERROR;
+	    }
+	    continue;
+	}
+	hPtr = Tcl_FindHashEntry(&recPtr->cursorPtr->objectVariables,
+		(char *)colPtr->ivPtr);
+	if (hPtr != NULL) {
+	    objPtr = Tcl_NewObj();
+	    Tcl_IncrRefCount(objPtr);
+	    Tcl_GetVariableFullName(interp, (Tcl_Var)Tcl_GetHashValue(hPtr),
+		    objPtr);
+	    Tcl_UnsetVar2(interp, Tcl_GetString(objPtr), NULL, 0);
+	    Tcl_DecrRefCount(objPtr);
+	}
+    }
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  StoreRow()
+ *
+ *  Sets the values of a row to the variables of the cursor.  Typed
+ *  values are copied from the buffer of C values of the cursor.
+ * ------------------------------------------------------------------------
+ */
+static void
+StoreRow(
+    Tcl_Interp *interp,
+    ItclRecord *recPtr,
+    Tcl_Size row)
+{
+    ItclRecordColumn *colPtr;
+    Tcl_InterpState state;
+    Tcl_Obj *objPtr;
+    void *valuePtr;
+    Tcl_Size i;
+
+    if ((recPtr->cursorPtr == NULL) || (recPtr->cursorPtr->flags
+	    & (ITCL_OBJECT_IS_DELETED|ITCL_OBJECT_IS_DESTRUCTED|
+	    ITCL_OBJECT_IS_DESTROYED))) {
+	return;
+    }
+    state = Tcl_SaveInterpState(interp, TCL_OK);
+    for (i = 0; i < recPtr->numColumns; i++) {
+	colPtr = &recPtr->columns[i];
+	if (colPtr->ivPtr->type != ITCL_VARTYPE_NONE) {
+	    valuePtr = Itcl_GetTypedVarPtr(recPtr->cursorPtr, colPtr->ivPtr);
+	    if (valuePtr != NULL) {
+		SetCell(colPtr, row, NULL, valuePtr);
+	    }
+	} else {
+	    objPtr = Itcl_GetVarByHandle(interp, recPtr->cursorPtr,
+		    colPtr->ivPtr);
+	    SetCell(colPtr, row, objPtr, NULL);
+	}
+    }
+    Tcl_RestoreInterpState(interp, state);
+}
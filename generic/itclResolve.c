@@ -72,6 +72,10 @@ Itcl_ClassCmdResolver(
     int inOptionHandling;
     int isCmdDeleted;
 
+    /*
+     *  "this" is never a member, so it is passed on before even the
+     *  interpreter data is looked up, and not counted.
+     */
     if ((name[0] == 't') && (strcmp(name, "this") == 0)) {
         return TCL_CONTINUE;
     }
@@ -79,6 +83,7 @@ Itcl_ClassCmdResolver(
                 ITCL_INTERP_DATA, NULL);
     hPtr = Tcl_FindHashEntry(&infoPtr->namespaceClasses, (char *)nsPtr);
     if (hPtr == NULL) {
+        ITCL_STATS_INCR(infoPtr, cmdResolverFallthroughs);
         return TCL_CONTINUE;
     }
     iclsPtr = (ItclClass *)Tcl_GetHashValue(hPtr);
@@ -103,6 +108,7 @@ Itcl_ClassCmdResolver(
 	    Tcl_DecrRefCount(namePtr);
 	}
         if (hPtr == NULL) {
+            ITCL_STATS_INCR(infoPtr, cmdResolverFallthroughs);
             return TCL_CONTINUE;
         }
         clookup = (ItclCmdLookup *)Tcl_GetHashValue(hPtr);
@@ -208,6 +214,7 @@ isCmdDeleted = 0;
 	}
 	return TCL_ERROR;   /* disallow access! */
     }
+    ITCL_STATS_INCR(infoPtr, cmdResolverHits);
     *rPtr = imPtr->accessCmd;
     return TCL_OK;
 }
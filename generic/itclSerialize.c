@@ -0,0 +1,938 @@
+/*
+ * itclSerialize.c --
+ *
+ *	This file implements "itcl::serialize" and "itcl::deserialize",
+ *	which save a set of objects with the values of all their instance
+ *	variables into a byte array, and recreate them from it without
+ *	running their constructors.  Values naming objects of the set are
+ *	saved as references to these objects, so that links between the
+ *	objects survive when they are restored under other names.
+ *
+ *	The data starts with the 4 bytes "ITS1" and a count of objects,
+ *	followed for each object by the name of its class, its name, a
+ *	count of variables and the variables.  Each variable is its full
+ *	name followed by a tag byte:
+ *
+ *	    'U'	    the variable is unset
+ *	    'S'	    a string
+ *	    'R'	    a reference to an object of the set
+ *	    'L'	    the list as a string, then a count and that many
+ *		    references, for a list of objects
+ *	    'A'	    a count and that many array elements, each a key
+ *		    followed by a value tagged 'S', 'R' or 'L'
+ *
+ *	A reference is twice the index of the object in the set, plus one if
+ *	it was written as the name of an object of the global namespace
+ *	without the leading "::".  Counts and references are 4 byte unsigned
+ *	integers, most significant byte first, and strings are a count of
+ *	bytes followed by the bytes.  A list of objects is restored as its
+ *	string if the objects keep their names, so that its spacing is
+ *	kept, and else rebuilt from the new names.
+ *
+ * See the file "license.terms" for information on usage and redistribution of
+ * this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ */
+
+#include <tclInt.h>
+#include "itclInt.h"
+
+/*
+ *  Flags of the variables which are not saved: commons and the
+ *  built-in variables, which are set up again when objects are created.
+ */
+#define ITCL_SERIALIZE_IGNORED_VARS (ITCL_COMMON|ITCL_THIS_VAR| \
+	ITCL_OPTIONS_VAR|ITCL_TYPE_VAR|ITCL_SELF_VAR|ITCL_SELFNS_VAR| \
+	ITCL_WIN_VAR|ITCL_HULL_VAR|ITCL_OPTION_COMP_VAR)
+
+#define ITCL_SERIALIZE_MAGIC "ITS1"
+
+/*
+ * State of the decoding of serialized data.
+ */
+
+typedef struct SerialReader {
+    const unsigned char *pos;     /* next byte to read */
+    const unsigned char *end;     /* end of the data */
+    Tcl_Size numObjects;          /* number of objects in the data */
+    Tcl_Obj **namePtrs;           /* names of the restored objects by
+                                   * reference, or NULL while the data is
+                                   * checked */
+} SerialReader;
+
+/*
+ * An object of serialized data while it is restored.
+ */
+
+typedef struct SerialObject {
+    Tcl_Obj *classNamePtr;        /* name of its class */
+    Tcl_Obj *namePtr;             /* name it was saved with */
+    const unsigned char *varsPos; /* count of its variables in the data */
+    ItclObject *ioPtr;            /* restored object, or NULL */
+} SerialObject;
+
+static Tcl_ObjCmdProc Itcl_SerializeCmd;
+static Tcl_ObjCmdProc Itcl_DeserializeCmd;
+static int CheckSerializable(Tcl_Interp *interp, ItclClass *iclsPtr);
+static int IsSerializedVar(ItclVariable *ivPtr, Var *varPtr);
+static void WriteCount(Tcl_DString *dsPtr, Tcl_Size count);
+static void WriteString(Tcl_DString *dsPtr, Tcl_Obj *objPtr);
+static void WriteValue(Tcl_DString *dsPtr, Tcl_Obj *valuePtr,
+	Tcl_HashTable *refsPtr);
+static int ReadCount(SerialReader *rPtr, Tcl_Size *countPtr);
+static int ReadString(SerialReader *rPtr, Tcl_Obj **objPtrPtr);
+static int ReadValue(SerialReader *rPtr, Tcl_Obj **valuePtrPtr);
+static int ReadVariable(SerialReader *rPtr, Tcl_Obj **namePtrPtr,
+	int *tagPtr, Tcl_Obj **valuePtrPtr);
+static int RestoreVariables(Tcl_Interp *interp, SerialReader *rPtr,
+	ItclObject *ioPtr);
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclSerializeInit()
+ *
+ *  Invoked by Itcl_Init() to install the "itcl::serialize" and
+ *  "itcl::deserialize" commands.
+ * ------------------------------------------------------------------------
+ */
+int
+ItclSerializeInit(
+    Tcl_Interp *interp,          /* interpreter to be updated */
+    ItclObjectInfo *infoPtr)     /* info regarding all known objects */
+{
+    Tcl_CreateObjCommand(interp, "::itcl::serialize", Itcl_SerializeCmd,
+        infoPtr, Itcl_ReleaseData);
+    Itcl_PreserveData(infoPtr);
+    Tcl_CreateObjCommand(interp, "::itcl::deserialize", Itcl_DeserializeCmd,
+        infoPtr, Itcl_ReleaseData);
+    Itcl_PreserveData(infoPtr);
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_SerializeCmd()
+ *
+ *  Saves a set of objects into a byte array.  Handles the following
+ *  syntax:
+ *
+ *    itcl::serialize <objectList>
+ *
+ *  Returns TCL_OK/TCL_ERROR to indicate success/failure.
+ * ------------------------------------------------------------------------
+ */
+static int
+Itcl_SerializeCmd(
+    TCL_UNUSED(void *),      /* infoPtr */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    Tcl_HashTable refs;
+    Tcl_HashEntry *entryPtr;
+    Tcl_DString buffer;
+    ItclObject **ioPtrs;
+    ItclObject *ioPtr;
+    ItclVariable *ivPtr;
+    Tcl_Obj **namev;
+    Tcl_Obj *fullNamePtr;
+    Tcl_Obj *valuePtr;
+    Tcl_Obj **elemv;
+    Tcl_Size namec;
+    Tcl_Size elemc;
+    Tcl_Size numVars;
+    Tcl_Size i;
+    Tcl_Size j;
+    Var *varPtr;
+    int result = TCL_OK;
+    int isNew;
+    FOREACH_HASH_DECLS;
+
+    if (objc != 2) {
+	Tcl_WrongNumArgs(interp, 1, objv, "objectList");
+	return TCL_ERROR;
+    }
+    if (Tcl_ListObjGetElements(interp, objv[1], &namec, &namev) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    /*
+     *  Number the objects.  References to them are recognized by their
+     *  fully qualified names, or by their simple names for the objects
+     *  of the global namespace.
+     */
+    ioPtrs = (ItclObject **)ckalloc(sizeof(ItclObject *) * (namec + 1));
+    Tcl_InitHashTable(&refs, TCL_STRING_KEYS);
+    for (i = 0; i < namec; i++) {
+	ioPtr = NULL;
+	if (Itcl_FindObject(interp, Tcl_GetString(namev[i]), &ioPtr)
+		!= TCL_OK) {
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if (ioPtr == NULL) {
+	    Tcl_AppendResult(interp, "object \"", Tcl_GetString(namev[i]),
+		    "\" not found", NULL);
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if (CheckSerializable(interp, ioPtr->iclsPtr) != TCL_OK) {
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	ioPtrs[i] = ioPtr;
+	fullNamePtr = Tcl_NewObj();
+	Tcl_IncrRefCount(fullNamePtr);
+	Tcl_GetCommandFullName(interp, ioPtr->accessCmd, fullNamePtr);
+	entryPtr = Tcl_CreateHashEntry(&refs, Tcl_GetString(fullNamePtr),
+		&isNew);
+	if (!isNew) {
+	    Tcl_AppendResult(interp, "object \"", Tcl_GetString(fullNamePtr),
+		    "\" is listed twice", NULL);
+	    Tcl_DecrRefCount(fullNamePtr);
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	Tcl_SetHashValue(entryPtr, INT2PTR(2 * i));
+	if (strstr(Tcl_GetString(fullNamePtr) + 2, "::") == NULL) {
+	    entryPtr = Tcl_CreateHashEntry(&refs,
+		    Tcl_GetString(fullNamePtr) + 2, &isNew);
+	    Tcl_SetHashValue(entryPtr, INT2PTR(2 * i + 1));
+	}
+	Tcl_DecrRefCount(fullNamePtr);
+    }
+
+    Tcl_DStringInit(&buffer);
+    Tcl_DStringAppend(&buffer, ITCL_SERIALIZE_MAGIC, 4);
+    WriteCount(&buffer, namec);
+    for (i = 0; (i < namec) && (result == TCL_OK); i++) {
+	ioPtr = ioPtrs[i];
+	WriteString(&buffer, ioPtr->iclsPtr->fullNamePtr);
+	fullNamePtr = Tcl_NewObj();
+	Tcl_IncrRefCount(fullNamePtr);
+	Tcl_GetCommandFullName(interp, ioPtr->accessCmd, fullNamePtr);
+	WriteString(&buffer, fullNamePtr);
+	Tcl_DecrRefCount(fullNamePtr);
+
+	numVars = 0;
+	FOREACH_HASH(ivPtr, varPtr, &ioPtr->objectVariables) {
+	    if (IsSerializedVar(ivPtr, varPtr)) {
+		numVars++;
+	    }
+	}
+	WriteCount(&buffer, numVars);
+	FOREACH_HASH(ivPtr, varPtr, &ioPtr->objectVariables) {
+	    if (!IsSerializedVar(ivPtr, varPtr)) {
+		continue;
+	    }
+	    WriteString(&buffer, ivPtr->fullNamePtr);
+	    if (TclIsVarUndefined(varPtr)) {
+		Tcl_DStringAppend(&buffer, "U", 1);
+	    } else if (TclIsVarArray(varPtr)) {
+		valuePtr = ItclGetArrayElements(interp, (Tcl_Var)varPtr);
+		if (valuePtr == NULL) {
+		    result = TCL_ERROR;
+		    break;
+		}
+		Tcl_IncrRefCount(valuePtr);
+		Tcl_ListObjGetElements(NULL, valuePtr, &elemc, &elemv);
+		Tcl_DStringAppend(&buffer, "A", 1);
+		WriteCount(&buffer, elemc / 2);
+		for (j = 0; j + 1 < elemc; j += 2) {
+		    WriteString(&buffer, elemv[j]);
+		    WriteValue(&buffer, elemv[j + 1], &refs);
+		}
+		Tcl_DecrRefCount(valuePtr);
+	    } else {
+		valuePtr = TclPtrGetVar(interp, (Tcl_Var)varPtr, NULL,
+			ivPtr->namePtr, NULL, TCL_LEAVE_ERR_MSG);
+		if (valuePtr == NULL) {
+		    result = TCL_ERROR;
+		    break;
+		}
+		WriteValue(&buffer, valuePtr, &refs);
+	    }
+	}
+    }
+    if (result == TCL_OK) {
+	Tcl_SetObjResult(interp, Tcl_NewByteArrayObj(
+		(unsigned char *)Tcl_DStringValue(&buffer),
+		Tcl_DStringLength(&buffer)));
+    }
+    Tcl_DStringFree(&buffer);
+
+done:
+    Tcl_DeleteHashTable(&refs);
+    ckfree(ioPtrs);
+    return result;
+}
+
+static const char *const deserializeOptions[] = {
+    "-autoname", "-hook", NULL
+};
+enum DeserializeOption {
+    DESERIALIZE_AUTONAME, DESERIALIZE_HOOK
+};
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_DeserializeCmd()
+ *
+ *  Recreates the objects saved by "itcl::serialize".  Handles the
+ *  following syntax:
+ *
+ *    itcl::deserialize <data> ?-autoname? ?-hook <methodName>?
+ *
+ *  The objects are created in the order they were saved, with their
+ *  original names, or with names built from their class names with
+ *  -autoname, and without running their constructors.  Then all their
+ *  variables are set, and with -hook, the given method is invoked on
+ *  each object having it.  If anything fails, the objects created are
+ *  deleted again.  Returns the list of the names of the new objects.
+ *
+ *  Returns TCL_OK/TCL_ERROR to indicate success/failure.
+ * ------------------------------------------------------------------------
+ */
+static int
+Itcl_DeserializeCmd(
+    TCL_UNUSED(void *),      /* infoPtr */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    SerialReader reader;
+    SerialObject *objects = NULL;
+    ItclClass *iclsPtr;
+    ItclMemberFunc *imPtr;
+    Itcl_InterpState istate;
+    Tcl_DString buffer;
+    Tcl_Obj *resultPtr;
+    Tcl_Obj *namePtr;
+    const unsigned char *bytes;
+    const char *name;
+    const char *hookName = NULL;
+    Tcl_Size length;
+    Tcl_Size numVars;
+    Tcl_Size i;
+    Tcl_Size j;
+    int autoname = 0;
+    int result = TCL_OK;
+    int index;
+
+    if (objc < 2) {
+	Tcl_WrongNumArgs(interp, 1, objv,
+		"data ?-autoname? ?-hook methodName?");
+	return TCL_ERROR;
+    }
+    for (i = 2; i < objc; i++) {
+	if (Tcl_GetIndexFromObj(interp, objv[i], deserializeOptions,
+		"option", 0, &index) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	switch ((enum DeserializeOption)index) {
+	case DESERIALIZE_AUTONAME:
+	    autoname = 1;
+	    break;
+	case DESERIALIZE_HOOK:
+	    if (++i >= objc) {
+		Tcl_AppendResult(interp, "missing value for option \"-hook\"",
+			NULL);
+		return TCL_ERROR;
+	    }
+	    hookName = Tcl_GetString(objv[i]);
+	    break;
+	}
+    }
+
+    /*
+     *  Check the whole data before creating anything.
+     */
+    bytes = Tcl_GetByteArrayFromObj(objv[1], &length);
+    reader.pos = bytes + 4;
+    reader.end = bytes + length;
+    reader.numObjects = 0;
+    reader.namePtrs = NULL;
+    if ((length < 4) || (memcmp(bytes, ITCL_SERIALIZE_MAGIC, 4) != 0)
+	    || !ReadCount(&reader, &reader.numObjects)
+	    || (reader.numObjects > (reader.end - reader.pos) / 12)) {
+	goto badData;
+    }
+    objects = (SerialObject *)ckalloc(sizeof(SerialObject)
+	    * (reader.numObjects + 1));
+    memset(objects, 0, sizeof(SerialObject) * (reader.numObjects + 1));
+    for (i = 0; i < reader.numObjects; i++) {
+	if (!ReadString(&reader, &objects[i].classNamePtr)
+		|| !ReadString(&reader, &objects[i].namePtr)) {
+	    goto badData;
+	}
+	objects[i].varsPos = reader.pos;
+	if (!ReadCount(&reader, &numVars)) {
+	    goto badData;
+	}
+	for (j = 0; j < numVars; j++) {
+	    if (!ReadVariable(&reader, NULL, NULL, NULL)) {
+		goto badData;
+	    }
+	}
+    }
+    if (reader.pos != reader.end) {
+	goto badData;
+    }
+    for (i = 0; i < reader.numObjects; i++) {
+	iclsPtr = Itcl_FindClass(interp,
+		Tcl_GetString(objects[i].classNamePtr), /* autoload */ 1);
+	if ((iclsPtr == NULL) || (CheckSerializable(interp, iclsPtr)
+		!= TCL_OK)) {
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if (!autoname && (Tcl_FindCommand(interp,
+		Tcl_GetString(objects[i].namePtr), NULL, 0) != NULL)) {
+	    Tcl_AppendResult(interp, "command \"",
+		    Tcl_GetString(objects[i].namePtr), "\" already exists",
+		    NULL);
+	    result = TCL_ERROR;
+	    goto done;
+	}
+    }
+
+    /*
+     *  Create the objects, then set their variables, now that the
+     *  names of all objects are known.
+     */
+    reader.namePtrs = (Tcl_Obj **)ckalloc(sizeof(Tcl_Obj *)
+	    * (2 * reader.numObjects + 1));
+    resultPtr = Tcl_NewListObj(0, NULL);
+    Tcl_IncrRefCount(resultPtr);
+    Tcl_DStringInit(&buffer);
+    for (i = 0; i < reader.numObjects; i++) {
+	iclsPtr = Itcl_FindClass(interp,
+		Tcl_GetString(objects[i].classNamePtr), /* autoload */ 0);
+	name = autoname ? ItclAutoObjectName(interp, iclsPtr, &buffer)
+		: Tcl_GetString(objects[i].namePtr);
+	result = ItclCreateUnconstructedObject(interp, name, iclsPtr,
+		&objects[i].ioPtr);
+	if (result != TCL_OK) {
+	    objects[i].ioPtr = NULL;
+	    break;
+	}
+	Itcl_PreserveData(objects[i].ioPtr);
+	namePtr = Tcl_NewObj();
+	Tcl_GetCommandFullName(interp, objects[i].ioPtr->accessCmd, namePtr);
+	Tcl_ListObjAppendElement(NULL, resultPtr, namePtr);
+	reader.namePtrs[2 * i] = namePtr;
+	if (strstr(Tcl_GetString(namePtr) + 2, "::") == NULL) {
+	    namePtr = Tcl_NewStringObj(Tcl_GetString(namePtr) + 2,
+		    TCL_INDEX_NONE);
+	}
+	reader.namePtrs[2 * i + 1] = namePtr;
+	Tcl_IncrRefCount(reader.namePtrs[2 * i]);
+	Tcl_IncrRefCount(reader.namePtrs[2 * i + 1]);
+    }
+    Tcl_DStringFree(&buffer);
+    for (i = 0; (i < reader.numObjects) && (result == TCL_OK); i++) {
+	reader.pos = objects[i].varsPos;
+	result = RestoreVariables(interp, &reader, objects[i].ioPtr);
+    }
+    for (i = 0; (i < reader.numObjects) && (result == TCL_OK)
+	    && (hookName != NULL); i++) {
+	if (objects[i].ioPtr->accessCmd == NULL) {
+	    continue;
+	}
+	imPtr = Itcl_LookupMethod(NULL, objects[i].ioPtr->iclsPtr, hookName);
+	if (imPtr != NULL) {
+	    result = Itcl_InvokeMethod(interp, objects[i].ioPtr, imPtr, 0,
+		    NULL);
+	}
+    }
+
+    if (result == TCL_OK) {
+	Tcl_SetObjResult(interp, resultPtr);
+    } else {
+	istate = Itcl_SaveInterpState(interp, result);
+	for (i = 0; i < reader.numObjects; i++) {
+	    if ((objects[i].ioPtr != NULL)
+		    && (objects[i].ioPtr->accessCmd != NULL)) {
+		Tcl_DeleteCommandFromToken(interp,
+			objects[i].ioPtr->accessCmd);
+	    }
+	}
+	result = Itcl_RestoreInterpState(interp, istate);
+    }
+    for (i = 0; i < reader.numObjects; i++) {
+	if (objects[i].ioPtr != NULL) {
+	    Itcl_ReleaseData(objects[i].ioPtr);
+	    Tcl_DecrRefCount(reader.namePtrs[2 * i]);
+	    Tcl_DecrRefCount(reader.namePtrs[2 * i + 1]);
+	}
+    }
+    Tcl_DecrRefCount(resultPtr);
+    ckfree(reader.namePtrs);
+    goto done;
+
+badData:
+    Tcl_AppendResult(interp, "invalid serialized data", NULL);
+    result = TCL_ERROR;
+
+done:
+    if (objects != NULL) {
+	for (i = 0; i < reader.numObjects; i++) {
+	    if (objects[i].classNamePtr != NULL) {
+		Tcl_DecrRefCount(objects[i].classNamePtr);
+	    }
+	    if (objects[i].namePtr != NULL) {
+		Tcl_DecrRefCount(objects[i].namePtr);
+	    }
+	}
+	ckfree(objects);
+    }
+    return result;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  CheckSerializable()
+ *
+ *  Returns TCL_OK if the objects of a class can be serialized, or
+ *  TCL_ERROR (along with an error message in the interpreter).  Only
+ *  the objects of plain "itcl::class" classes can be recreated without
+ *  their constructors.
+ * ------------------------------------------------------------------------
+ */
+static int
+CheckSerializable(
+    Tcl_Interp *interp,      /* current interpreter */
+    ItclClass *iclsPtr)      /* class */
+{
+    if (!(iclsPtr->flags & ITCL_CLASS) || (iclsPtr->flags & ITCL_RECORD)) {
+	Tcl_AppendResult(interp, "objects of \"",
+		Tcl_GetString(iclsPtr->fullNamePtr),
+		"\" cannot be serialized", NULL);
+	return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  IsSerializedVar()
+ *
+ *  Returns non-zero if a variable of an object is saved.
+ * ------------------------------------------------------------------------
+ */
+static int
+IsSerializedVar(
+    ItclVariable *ivPtr,     /* variable definition */
+    Var *varPtr)             /* variable of the object */
+{
+    return !(ivPtr->flags & ITCL_SERIALIZE_IGNORED_VARS)
+	    && !TclIsVarDeadHash(varPtr);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  WriteCount()
+ *
+ *  Appends a count or an index to serialized data.
+ * ------------------------------------------------------------------------
+ */
+static void
+WriteCount(
+    Tcl_DString *dsPtr,      /* data */
+    Tcl_Size count)          /* count to append */
+{
+    char bytes[4];
+
+    bytes[0] = (char)((count >> 24) & 0xff);
+    bytes[1] = (char)((count >> 16) & 0xff);
+    bytes[2] = (char)((count >> 8) & 0xff);
+    bytes[3] = (char)(count & 0xff);
+    Tcl_DStringAppend(dsPtr, bytes, 4);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  WriteString()
+ *
+ *  Appends a string to serialized data.
+ * ------------------------------------------------------------------------
+ */
+static void
+WriteString(
+    Tcl_DString *dsPtr,      /* data */
+    Tcl_Obj *objPtr)         /* string to append */
+{
+    const char *str;
+    Tcl_Size length;
+
+    str = Tcl_GetStringFromObj(objPtr, &length);
+    WriteCount(dsPtr, length);
+    Tcl_DStringAppend(dsPtr, str, length);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  WriteValue()
+ *
+ *  Appends the value of a variable to serialized data, as a reference
+ *  if it names a serialized object, as a list of references along with
+ *  its string if it is a list of several such names, and else as a
+ *  string.
+ * ------------------------------------------------------------------------
+ */
+static void
+WriteValue(
+    Tcl_DString *dsPtr,      /* data */
+    Tcl_Obj *valuePtr,       /* value to append */
+    Tcl_HashTable *refsPtr)  /* indexes of the objects by name */
+{
+    Tcl_HashEntry *hPtr;
+    Tcl_Obj **elemv;
+    Tcl_Size elemc;
+    Tcl_Size i;
+    const char *str;
+
+    str = Tcl_GetString(valuePtr);
+    hPtr = Tcl_FindHashEntry(refsPtr, str);
+    if (hPtr != NULL) {
+	Tcl_DStringAppend(dsPtr, "R", 1);
+	WriteCount(dsPtr, PTR2INT(Tcl_GetHashValue(hPtr)));
+	return;
+    }
+
+    /*
+     *  Only strings with separators can be lists of several objects,
+     *  which saves converting the other values to lists.
+     */
+    if ((strpbrk(str, " \t\n") != NULL)
+	    && (Tcl_ListObjGetElements(NULL, valuePtr, &elemc, &elemv)
+	    == TCL_OK) && (elemc > 1)) {
+	for (i = 0; i < elemc; i++) {
+	    if (Tcl_FindHashEntry(refsPtr, Tcl_GetString(elemv[i])) == NULL) {
+		break;
+	    }
+	}
+	if (i == elemc) {
+	    Tcl_DStringAppend(dsPtr, "L", 1);
+	    WriteString(dsPtr, valuePtr);
+	    WriteCount(dsPtr, elemc);
+	    for (i = 0; i < elemc; i++) {
+		hPtr = Tcl_FindHashEntry(refsPtr, Tcl_GetString(elemv[i]));
+		WriteCount(dsPtr, PTR2INT(Tcl_GetHashValue(hPtr)));
+	    }
+	    return;
+	}
+    }
+    Tcl_DStringAppend(dsPtr, "S", 1);
+    WriteString(dsPtr, valuePtr);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ReadCount()
+ *
+ *  Reads a count or an index from serialized data.  Returns zero if the
+ *  data is too short or the value does not fit in a Tcl_Size, so that
+ *  callers only have to check it against the remaining data.
+ * ------------------------------------------------------------------------
+ */
+static int
+ReadCount(
+    SerialReader *rPtr,      /* data */
+    Tcl_Size *countPtr)      /* returns the count */
+{
+    const unsigned char *p = rPtr->pos;
+    unsigned long count;
+
+    if (rPtr->end - p < 4) {
+	return 0;
+    }
+    count = ((unsigned long)p[0] << 24) | ((unsigned long)p[1] << 16)
+	    | ((unsigned long)p[2] << 8) | (unsigned long)p[3];
+    if (count > (unsigned long)TCL_SIZE_MAX) {
+	return 0;
+    }
+    *countPtr = (Tcl_Size)count;
+    rPtr->pos += 4;
+    return 1;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ReadString()
+ *
+ *  Reads a string from serialized data, into a new object with a
+ *  reference count of 1, or skips it if objPtrPtr is NULL.  Returns
+ *  zero if the data is too short.
+ * ------------------------------------------------------------------------
+ */
+static int
+ReadString(
+    SerialReader *rPtr,      /* data */
+    Tcl_Obj **objPtrPtr)     /* returns the string, or NULL */
+{
+    Tcl_Size length;
+
+    if (!ReadCount(rPtr, &length) || (rPtr->end - rPtr->pos < length)) {
+	return 0;
+    }
+    if (objPtrPtr != NULL) {
+	*objPtrPtr = Tcl_NewStringObj((const char *)rPtr->pos, length);
+	Tcl_IncrRefCount(*objPtrPtr);
+    }
+    rPtr->pos += length;
+    return 1;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ReadValue()
+ *
+ *  Reads a value tagged 'S', 'R' or 'L' from serialized data, into a
+ *  new object with a reference count of 1 in which references are
+ *  replaced by the names of the restored objects, or checks it if
+ *  valuePtrPtr is NULL.  Returns zero if the data is invalid.
+ * ------------------------------------------------------------------------
+ */
+static int
+ReadValue(
+    SerialReader *rPtr,      /* data */
+    Tcl_Obj **valuePtrPtr)   /* returns the value, or NULL */
+{
+    Tcl_Obj *stringPtr = NULL;
+    Tcl_Obj *listPtr = NULL;
+    Tcl_Obj **elemv = NULL;
+    Tcl_Size elemc = 0;
+    Tcl_Size count;
+    Tcl_Size index;
+    Tcl_Size i;
+    int renamed;
+    int tag;
+
+    if (rPtr->pos >= rPtr->end) {
+	return 0;
+    }
+    tag = *rPtr->pos++;
+    switch (tag) {
+    case 'S':
+	return ReadString(rPtr, valuePtrPtr);
+    case 'R':
+	if (!ReadCount(rPtr, &index) || (index >= 2 * rPtr->numObjects)) {
+	    return 0;
+	}
+	if (valuePtrPtr != NULL) {
+	    *valuePtrPtr = rPtr->namePtrs[index];
+	    Tcl_IncrRefCount(*valuePtrPtr);
+	}
+	return 1;
+    case 'L':
+	if (!ReadString(rPtr, (valuePtrPtr != NULL) ? &stringPtr : NULL)) {
+	    return 0;
+	}
+	if (!ReadCount(rPtr, &count) || (count > (rPtr->end - rPtr->pos) / 4)) {
+	    goto badList;
+	}
+	if (valuePtrPtr != NULL) {
+	    listPtr = Tcl_NewListObj(0, NULL);
+	    Tcl_IncrRefCount(listPtr);
+	    if (Tcl_ListObjGetElements(NULL, stringPtr, &elemc, &elemv)
+		    != TCL_OK) {
+		elemc = -1;
+	    }
+	}
+	renamed = 0;
+	for (i = 0; i < count; i++) {
+	    if (!ReadCount(rPtr, &index) || (index >= 2 * rPtr->numObjects)) {
+		goto badList;
+	    }
+	    if (valuePtrPtr != NULL) {
+		Tcl_ListObjAppendElement(NULL, listPtr, rPtr->namePtrs[index]);
+		if ((elemc != count) || (strcmp(Tcl_GetString(elemv[i]),
+			Tcl_GetString(rPtr->namePtrs[index])) != 0)) {
+		    renamed = 1;
+		}
+	    }
+	}
+	if (valuePtrPtr != NULL) {
+	    if (renamed) {
+		*valuePtrPtr = listPtr;
+		Tcl_DecrRefCount(stringPtr);
+	    } else {
+		*valuePtrPtr = stringPtr;
+		Tcl_DecrRefCount(listPtr);
+	    }
+	}
+	return 1;
+
+    badList:
+	if (valuePtrPtr != NULL) {
+	    Tcl_DecrRefCount(stringPtr);
+	    if (listPtr != NULL) {
+		Tcl_DecrRefCount(listPtr);
+	    }
+	}
+	return 0;
+    }
+    return 0;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ReadVariable()
+ *
+ *  Reads a variable from serialized data: its name and tag, and its
+ *  value, which is a list of keys and values for an array, or NULL for
+ *  an unset variable.  The name and the value are new objects with a
+ *  reference count of 1.  If namePtrPtr is NULL, the variable is only
+ *  checked.  Returns zero if the data is invalid.
+ * ------------------------------------------------------------------------
+ */
+static int
+ReadVariable(
+    SerialReader *rPtr,      /* data */
+    Tcl_Obj **namePtrPtr,    /* returns the full variable name, or NULL */
+    int *tagPtr,             /* returns the tag */
+    Tcl_Obj **valuePtrPtr)   /* returns the value */
+{
+    Tcl_Obj *keyPtr;
+    Tcl_Obj *valuePtr;
+    Tcl_Size count;
+    Tcl_Size i;
+    int tag;
+
+    if (!ReadString(rPtr, namePtrPtr)) {
+	return 0;
+    }
+    if (rPtr->pos >= rPtr->end) {
+	goto badData;
+    }
+    tag = *rPtr->pos;
+    if (tagPtr != NULL) {
+	*tagPtr = tag;
+    }
+    if (valuePtrPtr != NULL) {
+	*valuePtrPtr = NULL;
+    }
+    if (tag == 'U') {
+	rPtr->pos++;
+	return 1;
+    }
+    if (tag != 'A') {
+	if (!ReadValue(rPtr, valuePtrPtr)) {
+	    goto badData;
+	}
+	return 1;
+    }
+    rPtr->pos++;
+    if (!ReadCount(rPtr, &count) || (count > (rPtr->end - rPtr->pos) / 9)) {
+	goto badData;
+    }
+    if (valuePtrPtr != NULL) {
+	*valuePtrPtr = Tcl_NewListObj(0, NULL);
+	Tcl_IncrRefCount(*valuePtrPtr);
+    }
+    for (i = 0; i < count; i++) {
+	if (valuePtrPtr == NULL) {
+	    if (!ReadString(rPtr, NULL) || !ReadValue(rPtr, NULL)) {
+		goto badData;
+	    }
+	    continue;
+	}
+	if (!ReadString(rPtr, &keyPtr)) {
+	    goto badData;
+	}
+	Tcl_ListObjAppendElement(NULL, *valuePtrPtr, keyPtr);
+	Tcl_DecrRefCount(keyPtr);
+	if (!ReadValue(rPtr, &valuePtr)) {
+	    goto badData;
+	}
+	Tcl_ListObjAppendElement(NULL, *valuePtrPtr, valuePtr);
+	Tcl_DecrRefCount(valuePtr);
+    }
+    return 1;
+
+badData:
+    if (namePtrPtr != NULL) {
+	Tcl_DecrRefCount(*namePtrPtr);
+	if ((valuePtrPtr != NULL) && (*valuePtrPtr != NULL)) {
+	    Tcl_DecrRefCount(*valuePtrPtr);
+	}
+    }
+    return 0;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  RestoreVariables()
+ *
+ *  Sets the variables of a restored object from serialized data which
+ *  was already checked.  Returns TCL_OK, or TCL_ERROR (along with an
+ *  error message in the interpreter) if a variable is not found in the
+ *  class of the object or cannot be set.
+ * ------------------------------------------------------------------------
+ */
+static int
+RestoreVariables(
+    Tcl_Interp *interp,      /* current interpreter */
+    SerialReader *rPtr,      /* data, at the variables of the object */
+    ItclObject *ioPtr)       /* restored object */
+{
+    Tcl_HashTable vars;
+    Tcl_HashEntry *entryPtr;
+    ItclVariable *ivPtr;
+    Tcl_Obj *namePtr;
+    Tcl_Obj *valuePtr;
+    Tcl_Obj *fullNamePtr;
+    Tcl_Var var;
+    Tcl_Size numVars = 0;
+    Tcl_Size i;
+    Var *varPtr;
+    int result = TCL_OK;
+    int isNew;
+    int tag;
+    FOREACH_HASH_DECLS;
+
+    Tcl_InitHashTable(&vars, TCL_STRING_KEYS);
+    FOREACH_HASH(ivPtr, varPtr, &ioPtr->objectVariables) {
+	if (IsSerializedVar(ivPtr, varPtr)) {
+	    entryPtr = Tcl_CreateHashEntry(&vars,
+		    Tcl_GetString(ivPtr->fullNamePtr), &isNew);
+	    Tcl_SetHashValue(entryPtr, varPtr);
+	}
+    }
+
+    ReadCount(rPtr, &numVars);
+    for (i = 0; (i < numVars) && (result == TCL_OK); i++) {
+	ReadVariable(rPtr, &namePtr, &tag, &valuePtr);
+	entryPtr = Tcl_FindHashEntry(&vars, Tcl_GetString(namePtr));
+	if (entryPtr == NULL) {
+	    Tcl_AppendResult(interp, "variable \"", Tcl_GetString(namePtr),
+		    "\" not found in class \"",
+		    Tcl_GetString(ioPtr->iclsPtr->fullNamePtr), "\"", NULL);
+	    result = TCL_ERROR;
+	} else {
+	    var = (Tcl_Var)Tcl_GetHashValue(entryPtr);
+	    fullNamePtr = Tcl_NewObj();
+	    Tcl_IncrRefCount(fullNamePtr);
+	    Tcl_GetVariableFullName(interp, var, fullNamePtr);
+	    if (tag != 'S' && tag != 'R' && tag != 'L') {
+		Tcl_UnsetVar2(interp, Tcl_GetString(fullNamePtr), NULL,
+			TCL_GLOBAL_ONLY);
+	    }
+	    if (tag == 'A') {
+		result = ItclSetArrayElements(interp, var, valuePtr);
+	    } else if (tag != 'U') {
+		if (Tcl_ObjSetVar2(interp, fullNamePtr, NULL, valuePtr,
+			TCL_GLOBAL_ONLY|TCL_LEAVE_ERR_MSG) == NULL) {
+		    result = TCL_ERROR;
+		}
+	    }
+	    Tcl_DecrRefCount(fullNamePtr);
+	}
+	Tcl_DecrRefCount(namePtr);
+	if (valuePtr != NULL) {
+	    Tcl_DecrRefCount(valuePtr);
+	}
+    }
+    Tcl_DeleteHashTable(&vars);
+    return result;
+}
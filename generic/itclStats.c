@@ -0,0 +1,663 @@
+/*
+ * itclStats.c --
+ *
+ *	This file contains the "itcl::stats" command, which reports the
+ *	counters kept for the internal caches and resolvers of [incr Tcl].
+ *	The counters are kept per interpreter in the ItclObjectInfo and are
+ *	incremented with the ITCL_STATS_INCR macro; they can be compiled out
+ *	by defining ITCL_NO_STATS.
+ *
+ *	"itcl::stats construct" reports the time spent in the phases of
+ *	object construction for each class, measured by ItclCreateObject()
+ *	while ITCL_INSTRUMENT_CONSTRUCT is set.
+ *
+ *	It also contains the "itcl::memory" command, which estimates the
+ *	memory used by the classes and their objects.
+ *
+ * See the file "license.terms" for information on usage and redistribution of
+ * this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include "tclInt.h"
+#include "itclInt.h"
+
+/*
+ * The counters in the order they are reported.
+ */
+
+static const struct {
+    const char *name;             /* key in the result of "itcl::stats" */
+    size_t offset;                /* offset of the counter in ItclStats */
+} statsCounters[] = {
+    {"varLookupHits", offsetof(ItclStats, varLookupHits)},
+    {"varLookupMisses", offsetof(ItclStats, varLookupMisses)},
+    {"varLookupsAllocated", offsetof(ItclStats, varLookupsAllocated)},
+    {"contextCacheHits", offsetof(ItclStats, contextCacheHits)},
+    {"contextCacheMisses", offsetof(ItclStats, contextCacheMisses)},
+    {"cmdResolverHits", offsetof(ItclStats, cmdResolverHits)},
+    {"cmdResolverFallthroughs", offsetof(ItclStats, cmdResolverFallthroughs)},
+    {"virtualTableBuilds", offsetof(ItclStats, virtualTableBuilds)},
+    {"memoHits", offsetof(ItclStats, memoHits)},
+    {"memoMisses", offsetof(ItclStats, memoMisses)},
+    {"staticCalls", offsetof(ItclStats, staticCalls)},
+    {"chainChanges", offsetof(ItclStats, chainChanges)},
+    {NULL, 0}
+};
+
+/*
+ * The keys of the phases in the result of "itcl::stats construct", in
+ * the order of the ITCL_CONSTRUCT_* indices.
+ */
+
+static const char *const constructPhases[ITCL_CONSTRUCT_PHASES] = {
+    "instantiate", "variables", "commands", "options", "delegation",
+    "constructors", "dictInfo"
+};
+
+/*
+ * Memory used by one class and its objects, as reported by "itcl::memory".
+ */
+
+typedef struct ItclMemoryUsage {
+    Tcl_WideInt objectBytes;      /* ItclObject structures and their tables */
+    Tcl_WideInt variableBytes;    /* instance variables and their traces */
+    Tcl_WideInt resolverBytes;    /* resolveVars, resolveCmds, contextCache */
+    Tcl_WideInt classBytes;       /* ItclClass and its member definitions */
+} ItclMemoryUsage;
+
+static Tcl_ObjCmdProc Itcl_StatsCmd;
+static Tcl_ObjCmdProc Itcl_MemoryCmd;
+static int ConstructStatsCmd(ItclObjectInfo *infoPtr, Tcl_Interp *interp,
+	int objc, Tcl_Obj *const objv[]);
+static Tcl_Obj *ConstructStatsObj(ItclConstructStats *statsPtr);
+static int CompareClassNames(const void *first, const void *second);
+static Tcl_WideInt HashTableBytes(Tcl_HashTable *tablePtr);
+static Tcl_WideInt ObjBytes(Tcl_Obj *objPtr);
+static Tcl_WideInt VarBytes(Interp *iPtr, Var *varPtr);
+static void AddClassUsage(ItclClass *iclsPtr, ItclMemoryUsage *usagePtr);
+static void AddObjectUsage(ItclObject *ioPtr, ItclMemoryUsage *usagePtr);
+static Tcl_Obj *MemoryUsageObj(ItclClass *iclsPtr, ItclMemoryUsage *usagePtr);
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclStatsInit()
+ *
+ *  Invoked by Itcl_Init() to install the "itcl::stats" and
+ *  "itcl::memory" commands.
+ * ------------------------------------------------------------------------
+ */
+int
+ItclStatsInit(
+    Tcl_Interp *interp,          /* interpreter to be updated */
+    ItclObjectInfo *infoPtr)     /* info regarding all known objects */
+{
+    Tcl_CreateObjCommand(interp, "::itcl::stats", Itcl_StatsCmd,
+        infoPtr, Itcl_ReleaseData);
+    Itcl_PreserveData(infoPtr);
+
+    Tcl_CreateObjCommand(interp, "::itcl::memory", Itcl_MemoryCmd,
+        infoPtr, Itcl_ReleaseData);
+    Itcl_PreserveData(infoPtr);
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_StatsCmd()
+ *
+ *  Returns the counters of the internal caches and resolvers as a
+ *  dictionary.  With -reset, the counters are set to zero after they
+ *  have been reported.
+ *  Handles the following syntax:
+ *
+ *      itcl::stats ?-reset?
+ *      itcl::stats construct ?-enable boolean? ?-reset? ?className?
+ *
+ * ------------------------------------------------------------------------
+ */
+static int
+Itcl_StatsCmd(
+    void *clientData,        /* info for all known objects */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    static const char *const options[] = {
+	"-reset", NULL
+    };
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)clientData;
+    Tcl_Obj *resultPtr;
+    int reset = 0;
+    int index;
+    int i;
+
+    if ((objc > 1) && (strcmp(Tcl_GetString(objv[1]), "construct") == 0)) {
+        return ConstructStatsCmd(infoPtr, interp, objc, objv);
+    }
+    if (objc > 2) {
+        Tcl_WrongNumArgs(interp, 1, objv, "?-reset?");
+        return TCL_ERROR;
+    }
+    if (objc == 2) {
+	if (Tcl_GetIndexFromObj(interp, objv[1], options, "option", 0,
+		&index) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	reset = 1;
+    }
+
+    resultPtr = Tcl_NewDictObj();
+    for (i = 0; statsCounters[i].name != NULL; i++) {
+	Tcl_DictObjPut(NULL, resultPtr,
+		Tcl_NewStringObj(statsCounters[i].name, TCL_INDEX_NONE),
+		Tcl_NewWideIntObj(*(Tcl_WideInt *)((char *)&infoPtr->stats
+		+ statsCounters[i].offset)));
+    }
+    if (reset) {
+	memset(&infoPtr->stats, 0, sizeof(ItclStats));
+    }
+    Tcl_SetObjResult(interp, resultPtr);
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ConstructStatsCmd()
+ *
+ *  Implements "itcl::stats construct".  Returns a dictionary mapping the
+ *  classes whose objects were constructed while the timing was enabled
+ *  to the time spent in each phase, or only the dictionary of the class
+ *  given.  -enable starts or stops the timing; -reset discards the
+ *  times after they have been reported.
+ * ------------------------------------------------------------------------
+ */
+static int
+ConstructStatsCmd(
+    ItclObjectInfo *infoPtr, /* info for all known objects */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    FOREACH_HASH_DECLS;
+    static const char *const options[] = {
+	"-enable", "-reset", NULL
+    };
+    enum ConstructOption {
+	CONSTRUCT_ENABLE, CONSTRUCT_RESET
+    };
+    ItclConstructStats zero;
+    ItclClass *iclsPtr;
+    ItclClass *classIclsPtr = NULL;
+    ItclClass **classes;
+    Tcl_Obj *resultPtr;
+    Tcl_Size numClasses;
+    Tcl_Size i;
+    int reset = 0;
+    int enable;
+    int index;
+    int pos;
+
+    for (pos = 2; pos < objc; pos++) {
+	if (Tcl_GetString(objv[pos])[0] != '-') {
+	    break;
+	}
+	if (Tcl_GetIndexFromObj(interp, objv[pos], options, "option", 0,
+		&index) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	switch (index) {
+	case CONSTRUCT_ENABLE:
+	    if (pos + 1 >= objc) {
+		Tcl_AppendResult(interp, "missing value for \"-enable\"",
+			NULL);
+		return TCL_ERROR;
+	    }
+	    if (Tcl_GetBooleanFromObj(interp, objv[++pos], &enable)
+		    != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    if (enable) {
+		infoPtr->instrumentFlags |= ITCL_INSTRUMENT_CONSTRUCT;
+	    } else {
+		infoPtr->instrumentFlags &= ~ITCL_INSTRUMENT_CONSTRUCT;
+	    }
+	    break;
+	case CONSTRUCT_RESET:
+	    reset = 1;
+	    break;
+	}
+    }
+    if (pos + 1 < objc) {
+        Tcl_WrongNumArgs(interp, 2, objv,
+		"?-enable boolean? ?-reset? ?className?");
+        return TCL_ERROR;
+    }
+    if (pos < objc) {
+	classIclsPtr = Itcl_FindClass(interp, Tcl_GetString(objv[pos]),
+		/* autoload */ 1);
+	if (classIclsPtr == NULL) {
+	    return TCL_ERROR;
+	}
+    }
+
+    if (classIclsPtr != NULL) {
+	numClasses = 1;
+	classes = (ItclClass **)ckalloc(sizeof(ItclClass *));
+	classes[0] = classIclsPtr;
+	if (classIclsPtr->constructStatsPtr != NULL) {
+	    resultPtr = ConstructStatsObj(classIclsPtr->constructStatsPtr);
+	} else {
+	    memset(&zero, 0, sizeof(zero));
+	    resultPtr = ConstructStatsObj(&zero);
+	}
+    } else {
+	numClasses = 0;
+	classes = (ItclClass **)ckalloc(
+		(infoPtr->classes.numEntries + 1) * sizeof(ItclClass *));
+	FOREACH_HASH_VALUE(iclsPtr, &infoPtr->classes) {
+	    if (iclsPtr->constructStatsPtr != NULL) {
+		classes[numClasses++] = iclsPtr;
+	    }
+	}
+	qsort(classes, numClasses, sizeof(ItclClass *), CompareClassNames);
+	resultPtr = Tcl_NewDictObj();
+	for (i = 0; i < numClasses; i++) {
+	    Tcl_DictObjPut(NULL, resultPtr, classes[i]->fullNamePtr,
+		    ConstructStatsObj(classes[i]->constructStatsPtr));
+	}
+    }
+    if (reset) {
+	for (i = 0; i < numClasses; i++) {
+	    if (classes[i]->constructStatsPtr != NULL) {
+		memset(classes[i]->constructStatsPtr, 0,
+			sizeof(ItclConstructStats));
+	    }
+	}
+    }
+    ckfree((char *)classes);
+    Tcl_SetObjResult(interp, resultPtr);
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ConstructStatsObj()
+ *
+ *  Returns the dictionary reported by "itcl::stats construct" for one
+ *  class.  Times are in nanoseconds.
+ * ------------------------------------------------------------------------
+ */
+static Tcl_Obj *
+ConstructStatsObj(
+    ItclConstructStats *statsPtr)
+{
+    Tcl_Obj *dictPtr = Tcl_NewDictObj();
+    Tcl_WideInt total = 0;
+    int i;
+
+    Tcl_DictObjPut(NULL, dictPtr,
+	    Tcl_NewStringObj("objects", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(statsPtr->objects));
+    Tcl_DictObjPut(NULL, dictPtr,
+	    Tcl_NewStringObj("errors", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(statsPtr->errors));
+    for (i = 0; i < ITCL_CONSTRUCT_PHASES; i++) {
+	Tcl_DictObjPut(NULL, dictPtr,
+		Tcl_NewStringObj(constructPhases[i], TCL_INDEX_NONE),
+		Tcl_NewWideIntObj(statsPtr->phaseTime[i]));
+	total += statsPtr->phaseTime[i];
+    }
+    Tcl_DictObjPut(NULL, dictPtr,
+	    Tcl_NewStringObj("total", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(total));
+    return dictPtr;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_MemoryCmd()
+ *
+ *  Reports the number of live objects and an estimate of the memory used
+ *  by each class and its objects.  Objects are counted until their data
+ *  is freed, so objects still referenced after their deletion count as
+ *  live.  With -reset, the high-water marks of live objects are set to
+ *  the current numbers after they have been reported.
+ *  Handles the following syntax:
+ *
+ *      itcl::memory ?-class className? ?-reset?
+ *
+ * ------------------------------------------------------------------------
+ */
+static int
+Itcl_MemoryCmd(
+    void *clientData,        /* info for all known objects */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    FOREACH_HASH_DECLS;
+    static const char *const options[] = {
+	"-class", "-reset", NULL
+    };
+    enum MemoryOption {
+	MEMORY_CLASS, MEMORY_RESET
+    };
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)clientData;
+    ItclClass *iclsPtr;
+    ItclClass *classIclsPtr = NULL;
+    ItclClass **classes;
+    ItclObject *ioPtr;
+    ItclMemoryUsage *usages;
+    Tcl_HashTable indices;
+    Tcl_Obj *resultPtr;
+    Tcl_Size numClasses;
+    Tcl_Size i;
+    int reset = 0;
+    int index;
+    int pos;
+
+    for (pos = 1; pos < objc; pos++) {
+	if (Tcl_GetIndexFromObj(interp, objv[pos], options, "option", 0,
+		&index) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	switch (index) {
+	case MEMORY_CLASS:
+	    if (pos + 1 >= objc) {
+		Tcl_AppendResult(interp, "missing value for \"-class\"", NULL);
+		return TCL_ERROR;
+	    }
+	    classIclsPtr = Itcl_FindClass(interp,
+		    Tcl_GetString(objv[++pos]), /* autoload */ 1);
+	    if (classIclsPtr == NULL) {
+		return TCL_ERROR;
+	    }
+	    break;
+	case MEMORY_RESET:
+	    reset = 1;
+	    break;
+	}
+    }
+
+    /*
+     *  Collect the classes to report, sorted by name.
+     */
+    if (classIclsPtr != NULL) {
+	numClasses = 1;
+	classes = (ItclClass **)ckalloc(sizeof(ItclClass *));
+	classes[0] = classIclsPtr;
+    } else {
+	numClasses = 0;
+	classes = (ItclClass **)ckalloc(
+		(infoPtr->classes.numEntries + 1) * sizeof(ItclClass *));
+	FOREACH_HASH_VALUE(iclsPtr, &infoPtr->classes) {
+	    classes[numClasses++] = iclsPtr;
+	}
+	qsort(classes, numClasses, sizeof(ItclClass *), CompareClassNames);
+    }
+    usages = (ItclMemoryUsage *)ckalloc(
+	    (numClasses + 1) * sizeof(ItclMemoryUsage));
+    memset(usages, 0, (numClasses + 1) * sizeof(ItclMemoryUsage));
+    Tcl_InitHashTable(&indices, TCL_ONE_WORD_KEYS);
+    for (i = 0; i < numClasses; i++) {
+	Tcl_SetHashValue(Tcl_CreateHashEntry(&indices, (char *)classes[i],
+		&index), INT2PTR(i));
+	AddClassUsage(classes[i], &usages[i]);
+    }
+    FOREACH_HASH_VALUE(ioPtr, &infoPtr->objects) {
+	hPtr = Tcl_FindHashEntry(&indices, (char *)ioPtr->iclsPtr);
+	if (hPtr != NULL) {
+	    AddObjectUsage(ioPtr, &usages[PTR2INT(Tcl_GetHashValue(hPtr))]);
+	}
+    }
+    Tcl_DeleteHashTable(&indices);
+
+    if (classIclsPtr != NULL) {
+	resultPtr = MemoryUsageObj(classIclsPtr, &usages[0]);
+    } else {
+	resultPtr = Tcl_NewDictObj();
+	for (i = 0; i < numClasses; i++) {
+	    Tcl_DictObjPut(NULL, resultPtr, classes[i]->fullNamePtr,
+		    MemoryUsageObj(classes[i], &usages[i]));
+	}
+    }
+    if (reset) {
+	for (i = 0; i < numClasses; i++) {
+	    classes[i]->maxInstances = classes[i]->numInstances;
+	}
+    }
+    ckfree((char *)usages);
+    ckfree((char *)classes);
+    Tcl_SetObjResult(interp, resultPtr);
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  MemoryUsageObj()
+ *
+ *  Returns the dictionary reported by "itcl::memory" for one class.
+ * ------------------------------------------------------------------------
+ */
+static Tcl_Obj *
+MemoryUsageObj(
+    ItclClass *iclsPtr,
+    ItclMemoryUsage *usagePtr)
+{
+    Tcl_Obj *dictPtr = Tcl_NewDictObj();
+
+    Tcl_DictObjPut(NULL, dictPtr,
+	    Tcl_NewStringObj("instances", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(iclsPtr->numInstances));
+    Tcl_DictObjPut(NULL, dictPtr,
+	    Tcl_NewStringObj("maxInstances", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(iclsPtr->maxInstances));
+    Tcl_DictObjPut(NULL, dictPtr,
+	    Tcl_NewStringObj("objectBytes", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(usagePtr->objectBytes));
+    Tcl_DictObjPut(NULL, dictPtr,
+	    Tcl_NewStringObj("variableBytes", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(usagePtr->variableBytes));
+    Tcl_DictObjPut(NULL, dictPtr,
+	    Tcl_NewStringObj("resolverBytes", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(usagePtr->resolverBytes));
+    Tcl_DictObjPut(NULL, dictPtr,
+	    Tcl_NewStringObj("classBytes", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(usagePtr->classBytes));
+    return dictPtr;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  AddClassUsage()
+ *
+ *  Adds the memory used by the definition of a class and by its
+ *  resolution tables.
+ * ------------------------------------------------------------------------
+ */
+static void
+AddClassUsage(
+    ItclClass *iclsPtr,
+    ItclMemoryUsage *usagePtr)
+{
+    FOREACH_HASH_DECLS;
+    ItclVarLookup *vlookup;
+
+    usagePtr->classBytes += sizeof(ItclClass)
+	    + ObjBytes(iclsPtr->namePtr) + ObjBytes(iclsPtr->fullNamePtr)
+	    + HashTableBytes(&iclsPtr->heritage)
+	    + HashTableBytes(&iclsPtr->variables)
+	    + iclsPtr->variables.numEntries * sizeof(ItclVariable)
+	    + HashTableBytes(&iclsPtr->options)
+	    + iclsPtr->options.numEntries * sizeof(ItclOption)
+	    + HashTableBytes(&iclsPtr->components)
+	    + iclsPtr->components.numEntries * sizeof(ItclComponent)
+	    + HashTableBytes(&iclsPtr->functions)
+	    + iclsPtr->functions.numEntries
+	    * (sizeof(ItclMemberFunc) + sizeof(ItclMemberCode))
+	    + HashTableBytes(&iclsPtr->delegatedOptions)
+	    + iclsPtr->delegatedOptions.numEntries * sizeof(ItclDelegatedOption)
+	    + HashTableBytes(&iclsPtr->delegatedFunctions)
+	    + iclsPtr->delegatedFunctions.numEntries
+	    * sizeof(ItclDelegatedFunction)
+	    + HashTableBytes(&iclsPtr->methodVariables)
+	    + iclsPtr->methodVariables.numEntries * sizeof(ItclMethodVariable)
+	    + HashTableBytes(&iclsPtr->classCommons);
+
+    usagePtr->resolverBytes += HashTableBytes(&iclsPtr->resolveVars)
+	    + HashTableBytes(&iclsPtr->resolveCmds)
+	    + iclsPtr->resolveCmds.numEntries * sizeof(ItclCmdLookup)
+	    + HashTableBytes(&iclsPtr->contextCache)
+	    + iclsPtr->contextCache.numEntries * sizeof(ItclCallContext);
+    /* lookups are shared by all names of a variable, count them once */
+    FOREACH_HASH_VALUE(vlookup, &iclsPtr->resolveVars) {
+	if (vlookup->leastQualName == (char *)Tcl_GetHashKey(
+		&iclsPtr->resolveVars, hPtr)) {
+	    usagePtr->resolverBytes += sizeof(ItclVarLookup);
+	}
+    }
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  AddObjectUsage()
+ *
+ *  Adds the memory used by an object, its context cache and its
+ *  instance variables.
+ * ------------------------------------------------------------------------
+ */
+static void
+AddObjectUsage(
+    ItclObject *ioPtr,
+    ItclMemoryUsage *usagePtr)
+{
+    FOREACH_HASH_DECLS;
+    Tcl_Var var;
+
+    usagePtr->objectBytes += sizeof(ItclObject)
+	    + ObjBytes(ioPtr->namePtr) + ObjBytes(ioPtr->origNamePtr)
+	    + HashTableBytes(&ioPtr->objectVariables)
+	    + HashTableBytes(&ioPtr->objectOptions)
+	    + HashTableBytes(&ioPtr->objectComponents)
+	    + HashTableBytes(&ioPtr->objectMethodVariables)
+	    + HashTableBytes(&ioPtr->objectDelegatedOptions)
+	    + HashTableBytes(&ioPtr->objectDelegatedFunctions);
+    usagePtr->resolverBytes += HashTableBytes(&ioPtr->contextCache)
+	    + ioPtr->contextCache.numEntries * sizeof(ItclCallContext);
+    FOREACH_HASH_VALUE(var, &ioPtr->objectVariables) {
+	usagePtr->variableBytes += VarBytes((Interp *)ioPtr->interp,
+		(Var *)var);
+    }
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  HashTableBytes()
+ *
+ *  Returns the memory used by the entries and buckets of a hash table,
+ *  without the values.
+ * ------------------------------------------------------------------------
+ */
+static Tcl_WideInt
+HashTableBytes(
+    Tcl_HashTable *tablePtr)
+{
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch place;
+    Tcl_WideInt bytes;
+
+    bytes = (Tcl_WideInt)tablePtr->numEntries * sizeof(Tcl_HashEntry);
+    if (tablePtr->buckets != tablePtr->staticBuckets) {
+	bytes += (Tcl_WideInt)tablePtr->numBuckets * sizeof(Tcl_HashEntry *);
+    }
+    if (tablePtr->keyType == TCL_STRING_KEYS) {
+	for (hPtr = Tcl_FirstHashEntry(tablePtr, &place); hPtr != NULL;
+		hPtr = Tcl_NextHashEntry(&place)) {
+	    bytes += strlen((char *)Tcl_GetHashKey(tablePtr, hPtr)) + 1;
+	}
+    }
+    return bytes;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ObjBytes()
+ *
+ *  Returns the memory used by a Tcl_Obj and its string representation.
+ *  The internal representation is not accounted.
+ * ------------------------------------------------------------------------
+ */
+static Tcl_WideInt
+ObjBytes(
+    Tcl_Obj *objPtr)
+{
+    if (objPtr == NULL) {
+	return 0;
+    }
+    return sizeof(Tcl_Obj) + ((objPtr->bytes != NULL) ? objPtr->length + 1 : 0);
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  VarBytes()
+ *
+ *  Returns the memory used by a variable, its value or elements and its
+ *  traces.
+ * ------------------------------------------------------------------------
+ */
+static Tcl_WideInt
+VarBytes(
+    Interp *iPtr,
+    Var *varPtr)
+{
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch place;
+    VarTrace *tracePtr;
+    Tcl_WideInt bytes;
+
+    bytes = TclIsVarInHash(varPtr) ? sizeof(VarInHash) : sizeof(Var);
+    if (TclIsVarArray(varPtr)) {
+	if (varPtr->value.tablePtr != NULL) {
+	    bytes += sizeof(TclVarHashTable);
+	    for (hPtr = Tcl_FirstHashEntry(&varPtr->value.tablePtr->table,
+		    &place); hPtr != NULL; hPtr = Tcl_NextHashEntry(&place)) {
+		bytes += VarBytes(iPtr, (Var *)((char *)hPtr
+			- offsetof(VarInHash, entry)))
+			+ ObjBytes((Tcl_Obj *)hPtr->key.objPtr);
+	    }
+	}
+    } else if (TclIsVarScalar(varPtr) && !TclIsVarLink(varPtr)) {
+	bytes += ObjBytes(varPtr->value.objPtr);
+    }
+    if (TclIsVarTraced(varPtr)) {
+	hPtr = Tcl_FindHashEntry(&iPtr->varTraces, (char *)varPtr);
+	if (hPtr != NULL) {
+	    for (tracePtr = (VarTrace *)Tcl_GetHashValue(hPtr);
+		    tracePtr != NULL; tracePtr = tracePtr->nextPtr) {
+		bytes += sizeof(VarTrace);
+	    }
+	}
+    }
+    return bytes;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  CompareClassNames()
+ *
+ *  Orders classes by their fully qualified names, for qsort().
+ * ------------------------------------------------------------------------
+ */
+static int
+CompareClassNames(
+    const void *first,
+    const void *second)
+{
+    ItclClass *iclsPtr1 = *(ItclClass **)first;
+    ItclClass *iclsPtr2 = *(ItclClass **)second;
+
+    return strcmp(Tcl_GetString(iclsPtr1->fullNamePtr),
+	    Tcl_GetString(iclsPtr2->fullNamePtr));
+}
@@ -198,6 +198,13 @@ static const ItclIntStubs itclIntStubs = {
     Itcl_SetContext, /* 182 */
     Itcl_UnsetContext, /* 183 */
     ItclGetInstanceVar, /* 184 */
+    Itcl_LookupMemberVar, /* 185 */
+    Itcl_GetVarByHandle, /* 186 */
+    Itcl_SetVarByHandle, /* 187 */
+    Itcl_LookupMethod, /* 188 */
+    Itcl_InvokeMethod, /* 189 */
+    Itcl_NRInvokeMethod, /* 190 */
+    Itcl_GetTypedVarPtr, /* 191 */
 };
 
 static const ItclStubHooks itclStubHooks = {
@@ -237,6 +244,9 @@ const ItclStubs itclStubs = {
     Itcl_DiscardInterpState, /* 25 */
     Itcl_Alloc, /* 26 */
     Itcl_Free, /* 27 */
+    Itcl_AddEventHook, /* 28 */
+    Itcl_RemoveEventHook, /* 29 */
+    Itcl_DefineClass, /* 30 */
 };
 
 /* !END!: Do not edit above this line. */
@@ -0,0 +1,130 @@
+/*
+ * itclTestCxx.cpp --
+ *
+ *	This file contains a small test extension for the C++ binding in
+ *	itclCxx.h.  It registers a few typed C++ functions, which the
+ *	classes of tests/cxx.test use as the implementation of their
+ *	methods and procs:
+ *
+ *	    load libitclcxxtest.so Itclcxxtest
+ *
+ *	    itcl::class Box {
+ *		variable size 2.0
+ *		method area {width height} @cxx_area
+ *	    }
+ *
+ *	It is only built if configure finds a C++11 compiler, and it is
+ *	not installed.
+ *
+ * See the file "license.terms" for information on usage and redistribution of
+ * this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ */
+
+#include "itclCxx.h"
+
+#include <stdexcept>
+
+/*
+ *  Plain conversions of arguments and results.
+ */
+static double
+Area(
+    double width,
+    double height)
+{
+    return width * height;
+}
+
+static std::string
+Greet(
+    const char *name,
+    int times)
+{
+    std::string result;
+
+    while (times-- > 0) {
+	result += "hello ";
+    }
+    return result + name;
+}
+
+static bool
+Negate(
+    bool value)
+{
+    return !value;
+}
+
+/*
+ *  C++ exceptions become Tcl errors.
+ */
+static Tcl_WideInt
+Checked(
+    Tcl_WideInt value)
+{
+    if (value < 0) {
+	throw std::invalid_argument("negative value");
+    }
+    return value;
+}
+
+/*
+ *  Methods get the object and the class of the call as parameters which
+ *  take no argument, and reach data members with itcl::Variable.
+ */
+static double
+Scaled(
+    Tcl_Interp *interp,
+    ItclObject *ioPtr,
+    ItclClass *iclsPtr,
+    double factor)
+{
+    itcl::Variable<double> size;
+    double value;
+
+    if ((size.Lookup(interp, iclsPtr, "size") != TCL_OK)
+	    || (size.Get(interp, ioPtr, value) != TCL_OK)) {
+	throw std::runtime_error(Tcl_GetString(Tcl_GetObjResult(interp)));
+    }
+    return value * factor;
+}
+
+static void
+Grow(
+    Tcl_Interp *interp,
+    ItclObject *ioPtr,
+    ItclClass *iclsPtr,
+    double amount)
+{
+    itcl::Variable<double> size;
+    double value;
+
+    if ((size.Lookup(interp, iclsPtr, "size") != TCL_OK)
+	    || (size.Get(interp, ioPtr, value) != TCL_OK)
+	    || (size.Set(interp, ioPtr, value + amount) != TCL_OK)) {
+	throw std::runtime_error(Tcl_GetString(Tcl_GetObjResult(interp)));
+    }
+}
+
+extern "C" DLLEXPORT int
+Itclcxxtest_Init(
+    Tcl_Interp *interp)
+{
+    if (Tcl_InitStubs(interp, "8.6-", 0) == NULL) {
+	return TCL_ERROR;
+    }
+    if (Itcl_InitStubs(interp, ITCL_PATCH_LEVEL, 1) == NULL) {
+	return TCL_ERROR;
+    }
+    if ((itcl::RegisterFunction(interp, "cxx_area", Area) != TCL_OK)
+	    || (itcl::RegisterFunction(interp, "cxx_greet", Greet,
+		"name times") != TCL_OK)
+	    || (itcl::RegisterFunction(interp, "cxx_negate", Negate) != TCL_OK)
+	    || (itcl::RegisterFunction(interp, "cxx_checked", Checked)
+		!= TCL_OK)
+	    || (itcl::RegisterFunction(interp, "cxx_scaled", Scaled) != TCL_OK)
+	    || (itcl::RegisterFunction(interp, "cxx_grow", Grow) != TCL_OK)) {
+	return TCL_ERROR;
+    }
+    return Tcl_PkgProvide(interp, "itclcxxtest", ITCL_PATCH_LEVEL);
+}
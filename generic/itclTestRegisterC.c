@@ -113,12 +113,421 @@ fprintf(stderr, "IP2:%p %p %p\n",interp, clientData, iclsPtr);
     return TCL_OK;
 }
 
+/*
+ * ------------------------------------------------------------------------
+ *  Test commands for the C interface, in the namespace ::itcl::ctest.
+ *  They exist only if [incr Tcl] is compiled with ITCL_DEBUG_C_INTERFACE
+ *  and are used by the tests of the C interface.
+ * ------------------------------------------------------------------------
+ */
+
+/*
+ *  Hooks are identified by the address of their name, so that the same
+ *  name installs the same hook again.
+ */
+static const char *const hookIds[] = {
+    "h0", "h1", "h2", "h3", NULL
+};
+static const char *const eventNames[] = {
+    "objectCreate", "objectDelete", "methodEnter", "methodLeave",
+    "classCreate", NULL
+};
+
+static void
+RecordEvent(
+    const char *hookId,
+    Tcl_Interp *interp,
+    const Itcl_EventInfo *eventPtr)
+{
+    Tcl_Obj *listPtr;
+    const char *eventName = "";
+    int i;
+
+    for (i = 0; eventNames[i] != NULL; i++) {
+	if (eventPtr->type == (1 << i)) {
+	    eventName = eventNames[i];
+	}
+    }
+    listPtr = Tcl_NewListObj(0, NULL);
+    Tcl_ListObjAppendElement(NULL, listPtr,
+	    Tcl_NewStringObj(hookId, TCL_INDEX_NONE));
+    Tcl_ListObjAppendElement(NULL, listPtr,
+	    Tcl_NewStringObj(eventName, TCL_INDEX_NONE));
+    Tcl_ListObjAppendElement(NULL, listPtr, (eventPtr->classNamePtr != NULL)
+	    ? eventPtr->classNamePtr : Tcl_NewObj());
+    Tcl_ListObjAppendElement(NULL, listPtr, (eventPtr->objectNamePtr != NULL)
+	    ? eventPtr->objectNamePtr : Tcl_NewObj());
+    Tcl_ListObjAppendElement(NULL, listPtr, (eventPtr->methodNamePtr != NULL)
+	    ? eventPtr->methodNamePtr : Tcl_NewObj());
+    Tcl_ListObjAppendElement(NULL, listPtr, Tcl_NewIntObj(eventPtr->result));
+    Tcl_SetVar2Ex(interp, "::itcl::ctest::events", NULL, listPtr,
+	    TCL_GLOBAL_ONLY|TCL_APPEND_VALUE|TCL_LIST_ELEMENT);
+}
+
+static void
+TestHookProc(
+    void *clientData,
+    Tcl_Interp *interp,
+    const Itcl_EventInfo *eventPtr)
+{
+    RecordEvent((const char *)clientData, interp, eventPtr);
+}
+
+static void
+TestSelfRemovingHookProc(
+    void *clientData,
+    Tcl_Interp *interp,
+    const Itcl_EventInfo *eventPtr)
+{
+    RecordEvent((const char *)clientData, interp, eventPtr);
+    Itcl_RemoveEventHook(interp, TestSelfRemovingHookProc, clientData);
+}
+
+/*
+ *  ::itcl::ctest::hook add|once hookId ?eventName ...?
+ *  ::itcl::ctest::hook remove|removeonce hookId
+ *
+ *  Installs or removes a hook, which appends a list of the hook id, the
+ *  event name, the class, object and method name and the result of each
+ *  event to the variable ::itcl::ctest::events.  A hook installed with
+ *  "once" removes itself when it is called.
+ */
+static int
+TestHookCmd(
+    TCL_UNUSED(void *),
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const *objv)
+{
+    static const char *const options[] = {
+	"add", "once", "remove", "removeonce", NULL
+    };
+    enum { HOOK_ADD, HOOK_ONCE, HOOK_REMOVE, HOOK_REMOVEONCE };
+    Itcl_EventHookProc *proc;
+    int option, id, event, mask, i;
+
+    if (objc < 3) {
+	Tcl_WrongNumArgs(interp, 1, objv, "option hookId ?eventName ...?");
+	return TCL_ERROR;
+    }
+    if ((Tcl_GetIndexFromObj(interp, objv[1], options, "option", 0,
+	    &option) != TCL_OK) || (Tcl_GetIndexFromObj(interp, objv[2],
+	    hookIds, "hook", 0, &id) != TCL_OK)) {
+	return TCL_ERROR;
+    }
+    proc = ((option == HOOK_ONCE) || (option == HOOK_REMOVEONCE))
+	    ? TestSelfRemovingHookProc : TestHookProc;
+    if ((option == HOOK_REMOVE) || (option == HOOK_REMOVEONCE)) {
+	Itcl_RemoveEventHook(interp, proc, (void *)hookIds[id]);
+	return TCL_OK;
+    }
+    mask = 0;
+    for (i = 3; i < objc; i++) {
+	if (Tcl_GetIndexFromObj(interp, objv[i], eventNames, "event", 0,
+		&event) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	mask |= 1 << event;
+    }
+    return Itcl_AddEventHook(interp, mask, proc, (void *)hookIds[id]);
+}
+
+/*
+ *  Returns in *ioPtrPtr the object named by objPtr, or NULL if the name
+ *  is empty.  Returns TCL_ERROR (along with an error message) if there
+ *  is no such object.
+ */
+static int
+GetTestObject(
+    Tcl_Interp *interp,
+    Tcl_Obj *objPtr,
+    ItclObject **ioPtrPtr)
+{
+    *ioPtrPtr = NULL;
+    if (Tcl_GetString(objPtr)[0] == '\0') {
+	return TCL_OK;
+    }
+    if (Itcl_FindObject(interp, Tcl_GetString(objPtr), ioPtrPtr) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (*ioPtrPtr == NULL) {
+	Tcl_AppendResult(interp, "object \"", Tcl_GetString(objPtr),
+		"\" not found", NULL);
+	return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+/*
+ *  ::itcl::ctest::var get className varName objectName
+ *  ::itcl::ctest::var set className varName objectName value
+ *
+ *  Looks up a data member with Itcl_LookupMemberVar() in the scope of a
+ *  class and reads or writes it with Itcl_GetVarByHandle() or
+ *  Itcl_SetVarByHandle().  The object name is empty for a common.
+ */
+static int
+TestVarCmd(
+    TCL_UNUSED(void *),
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const *objv)
+{
+    static const char *const options[] = {
+	"get", "set", NULL
+    };
+    enum { VAR_GET, VAR_SET };
+    ItclClass *iclsPtr;
+    ItclObject *ioPtr;
+    ItclVariable *ivPtr;
+    Tcl_Obj *valuePtr;
+    int option;
+
+    if (objc < 5) {
+	Tcl_WrongNumArgs(interp, 1, objv,
+		"option className varName objectName ?value?");
+	return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[1], options, "option", 0,
+	    &option) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (objc != ((option == VAR_SET) ? 6 : 5)) {
+	Tcl_WrongNumArgs(interp, 2, objv, (option == VAR_SET)
+		? "className varName objectName value"
+		: "className varName objectName");
+	return TCL_ERROR;
+    }
+    iclsPtr = Itcl_FindClass(interp, Tcl_GetString(objv[2]), 0);
+    if (iclsPtr == NULL) {
+	return TCL_ERROR;
+    }
+    ivPtr = Itcl_LookupMemberVar(interp, iclsPtr, Tcl_GetString(objv[3]));
+    if ((ivPtr == NULL) || (GetTestObject(interp, objv[4], &ioPtr) != TCL_OK)) {
+	return TCL_ERROR;
+    }
+    if (option == VAR_SET) {
+	valuePtr = Itcl_SetVarByHandle(interp, ioPtr, ivPtr, objv[5]);
+    } else {
+	valuePtr = Itcl_GetVarByHandle(interp, ioPtr, ivPtr);
+    }
+    if (valuePtr == NULL) {
+	return TCL_ERROR;
+    }
+    Tcl_SetObjResult(interp, valuePtr);
+    return TCL_OK;
+}
+
+/*
+ *  ::itcl::ctest::method className methodName objectName ?arg ...?
+ *  ::itcl::ctest::nrmethod className methodName objectName ?arg ...?
+ *
+ *  Looks up a method with Itcl_LookupMethod() in the scope of a class and
+ *  calls it on an object with Itcl_InvokeMethod(), or Itcl_NRInvokeMethod()
+ *  for "nrmethod".
+ */
+static int
+GetTestMethod(
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const *objv,
+    ItclObject **ioPtrPtr,
+    ItclMemberFunc **imPtrPtr)
+{
+    ItclClass *iclsPtr;
+
+    if (objc < 4) {
+	Tcl_WrongNumArgs(interp, 1, objv,
+		"className methodName objectName ?arg ...?");
+	return TCL_ERROR;
+    }
+    iclsPtr = Itcl_FindClass(interp, Tcl_GetString(objv[1]), 0);
+    if (iclsPtr == NULL) {
+	return TCL_ERROR;
+    }
+    *imPtrPtr = Itcl_LookupMethod(interp, iclsPtr, Tcl_GetString(objv[2]));
+    if (*imPtrPtr == NULL) {
+	return TCL_ERROR;
+    }
+    return GetTestObject(interp, objv[3], ioPtrPtr);
+}
+
+static int
+TestMethodCmd(
+    TCL_UNUSED(void *),
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const *objv)
+{
+    ItclObject *ioPtr;
+    ItclMemberFunc *imPtr;
+
+    if (GetTestMethod(interp, objc, objv, &ioPtr, &imPtr) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    return Itcl_InvokeMethod(interp, ioPtr, imPtr, objc - 4, objv + 4);
+}
+
+static int
+TestNRMethodCmd(
+    TCL_UNUSED(void *),
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const *objv)
+{
+    ItclObject *ioPtr;
+    ItclMemberFunc *imPtr;
+
+    if (GetTestMethod(interp, objc, objv, &ioPtr, &imPtr) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    return Itcl_NRInvokeMethod(interp, ioPtr, imPtr, objc - 4, objv + 4);
+}
+
+static int
+TestNRMethodObjCmd(
+    void *clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const *objv)
+{
+    return Tcl_NRCallObjProc(interp, TestNRMethodCmd, clientData, objc, objv);
+}
+
+/*
+ *  ::itcl::ctest::define className a|b|bad|extended ?baseName?
+ *
+ *  Defines a class with Itcl_DefineClass().  The variants "a" and "b"
+ *  differ in the C procedure implementing the method "hello", "bad"
+ *  fails after registering it, and "extended" defines an
+ *  itcl::extendedclass with an option.
+ */
+static int
+TestHelloProc(
+    void *clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const *objv)
+{
+    Tcl_Obj *resultPtr;
+
+    resultPtr = Tcl_NewStringObj((const char *)clientData, TCL_INDEX_NONE);
+    if (objc > 1) {
+	Tcl_ListObjAppendList(NULL, resultPtr,
+		Tcl_NewListObj(objc - 1, objv + 1));
+    }
+    Tcl_SetObjResult(interp, resultPtr);
+    return TCL_OK;
+}
+
+static int
+TestHelloProc2(
+    void *clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const *objv)
+{
+    return TestHelloProc(clientData, interp, objc, objv);
+}
+
+static const Itcl_VariableSpec testVariables[] = {
+    {"count", 0, 0, "0", NULL},
+    {"total", 0, ITCL_MEMBER_COMMON, "10", NULL},
+    {"label", ITCL_PUBLIC, 0, "none", "incr count"},
+    {NULL, 0, 0, NULL, NULL}
+};
+
+static const Itcl_MethodSpec testMethodsA[] = {
+    {"get", 0, 0, NULL, "return $count", NULL, NULL},
+    {"getTotal", 0, ITCL_MEMBER_COMMON, NULL, "return $total", NULL, NULL},
+    {"hello", 0, 0, NULL, NULL, TestHelloProc, (void *)"a"},
+    {NULL, 0, 0, NULL, NULL, NULL, NULL}
+};
+
+static const Itcl_MethodSpec testMethodsB[] = {
+    {"get", 0, 0, NULL, "return $count", NULL, NULL},
+    {"hello", 0, 0, NULL, NULL, TestHelloProc2, (void *)"b"},
+    {NULL, 0, 0, NULL, NULL, NULL, NULL}
+};
+
+static const Itcl_MethodSpec testMethodsBad[] = {
+    {"hello", 0, 0, NULL, NULL, TestHelloProc2, (void *)"bad"},
+    {"broken", 0, 0, "{", "return", NULL, NULL},
+    {NULL, 0, 0, NULL, NULL, NULL, NULL}
+};
+
+static const Itcl_OptionSpec testOptions[] = {
+    {"-color", "color", "Color", "red"},
+    {NULL, NULL, NULL, NULL}
+};
+
+static int
+TestDefineCmd(
+    TCL_UNUSED(void *),
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const *objv)
+{
+    static const char *const variants[] = {
+	"a", "b", "bad", "extended", NULL
+    };
+    enum { DEFINE_A, DEFINE_B, DEFINE_BAD, DEFINE_EXTENDED };
+    Itcl_ClassSpec spec;
+    const char *bases[2];
+    int variant;
+
+    if ((objc < 3) || (objc > 4)) {
+	Tcl_WrongNumArgs(interp, 1, objv, "className variant ?baseName?");
+	return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[2], variants, "variant", 0,
+	    &variant) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    memset(&spec, 0, sizeof(spec));
+    spec.name = Tcl_GetString(objv[1]);
+    if (objc == 4) {
+	bases[0] = Tcl_GetString(objv[3]);
+	bases[1] = NULL;
+	spec.bases = bases;
+    }
+    switch (variant) {
+    case DEFINE_A:
+	spec.variables = testVariables;
+	spec.methods = testMethodsA;
+	break;
+    case DEFINE_B:
+	spec.variables = testVariables;
+	spec.methods = testMethodsB;
+	break;
+    case DEFINE_BAD:
+	spec.methods = testMethodsBad;
+	break;
+    case DEFINE_EXTENDED:
+	spec.flags = ITCL_DEFINE_EXTENDED;
+	spec.methods = testMethodsA;
+	spec.options = testOptions;
+	break;
+    }
+    return Itcl_DefineClass(interp, &spec);
+}
 
 void
 RegisterDebugCFunctions(Tcl_Interp *interp)
 {
     int result;
 
+    Tcl_CreateObjCommand(interp, "::itcl::ctest::hook", TestHookCmd,
+	    NULL, NULL);
+    Tcl_CreateObjCommand(interp, "::itcl::ctest::var", TestVarCmd,
+	    NULL, NULL);
+    Tcl_CreateObjCommand(interp, "::itcl::ctest::method", TestMethodCmd,
+	    NULL, NULL);
+    Tcl_NRCreateCommand(interp, "::itcl::ctest::nrmethod", TestNRMethodObjCmd,
+	    TestNRMethodCmd, NULL, NULL);
+    Tcl_CreateObjCommand(interp, "::itcl::ctest::define", TestDefineCmd,
+	    NULL, NULL);
+
     /* args: interp, name, c-function, clientdata, deleteproc */
     result = Itcl_RegisterC(interp, "cArgFunc", cArgFunc, NULL, NULL);
     result = Itcl_RegisterObjC(interp, "cObjFunc", cObjFunc, NULL, NULL);
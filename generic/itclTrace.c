@@ -0,0 +1,684 @@
+/*
+ * itclTrace.c --
+ *
+ *	This file contains the event tracer of [incr Tcl], which is accessible
+ *	through the "itcl::trace" command.  While the tracer is running, the
+ *	creation and destruction of objects and the calls of constructors,
+ *	destructors, methods and "configure" are recorded as spans into a ring
+ *	buffer of fixed size.  The buffer can be written at any time in the
+ *	trace event format of Chrome (chrome://tracing) and Perfetto.
+ *
+ * See the file "license.terms" for information on usage and redistribution of
+ * this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ */
+
+#include <limits.h>
+#include "itclInt.h"
+
+/*
+ * Categories of events.  They can be selected with the -categories option
+ * of "itcl::trace start" and show up as "cat" in the trace.
+ */
+
+#define ITCL_TRACE_CAT_OBJECT     0x01  /* creation/destruction of objects */
+#define ITCL_TRACE_CAT_CONSTRUCT  0x02  /* constructors and destructors */
+#define ITCL_TRACE_CAT_METHOD     0x04  /* methods and procs */
+#define ITCL_TRACE_CAT_CONFIGURE  0x08  /* the "configure" method */
+#define ITCL_TRACE_CAT_ALL        0x0f
+
+static const char *const traceCategories[] = {
+    "object", "construct", "method", "configure", NULL
+};
+
+#define ITCL_TRACE_CALL           0     /* kind of a function call span */
+#define ITCL_TRACE_BUFFER_SIZE    65536 /* default number of events */
+
+/*
+ * One event in the ring buffer.  All events are complete spans ("X" in
+ * the trace event format), recorded when the span ends.
+ */
+
+typedef struct ItclTraceEvent {
+    int kind;                     /* ITCL_TRACE_CALL, ITCL_TRACE_CREATE or
+                                   * ITCL_TRACE_DESTROY */
+    int category;                 /* one of ITCL_TRACE_CAT_* */
+    int result;                   /* completion code of the call */
+    Tcl_Obj *namePtr;             /* function name or class name */
+    Tcl_Obj *objectPtr;           /* object name or NULL */
+    Tcl_WideInt start;            /* start time in ns */
+    Tcl_WideInt duration;         /* duration in ns */
+} ItclTraceEvent;
+
+/*
+ * An active call on the shadow stack of the tracer.
+ */
+
+typedef struct ItclTraceFrame {
+    ItclMemberFunc *imPtr;        /* function called, used as key only */
+    Tcl_Obj *objectPtr;           /* object name or NULL */
+    int category;                 /* one of ITCL_TRACE_CAT_* */
+    Tcl_WideInt start;            /* time in ns when it was entered */
+} ItclTraceFrame;
+
+typedef struct ItclTraceInfo {
+    int categories;               /* mask of ITCL_TRACE_CAT_* recorded */
+    Tcl_WideInt epoch;            /* time in ns of the first start, all
+                                   * timestamps are relative to it */
+    ItclTraceEvent *events;       /* the ring buffer */
+    Tcl_Size bufferSize;          /* number of events in the ring buffer */
+    Tcl_Size first;               /* index of the oldest event */
+    Tcl_Size numEvents;           /* number of events in the buffer */
+    Tcl_WideInt dropped;          /* events overwritten since last clear */
+    ItclTraceFrame *frames;       /* shadow stack of active calls */
+    Tcl_Size numFrames;           /* number of used frames */
+    Tcl_Size maxFrames;           /* number of allocated frames */
+} ItclTraceInfo;
+
+static Tcl_ObjCmdProc Itcl_TraceStartCmd;
+static Tcl_ObjCmdProc Itcl_TraceStopCmd;
+static Tcl_ObjCmdProc Itcl_TraceClearCmd;
+static Tcl_ObjCmdProc Itcl_TraceDumpCmd;
+static void AddTraceEvent(ItclTraceInfo *tracePtr, int kind, int category,
+	int result, Tcl_Obj *namePtr, Tcl_Obj *objectPtr, Tcl_WideInt start,
+	Tcl_WideInt end);
+static void AppendJsonString(Tcl_Obj *objPtr, Tcl_Obj *valuePtr);
+static void ClearTraceEvents(ItclTraceInfo *tracePtr);
+static void ClearTraceFrames(ItclTraceInfo *tracePtr);
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclTraceInit()
+ *
+ *  Invoked by Itcl_Init() to install the "itcl::trace" ensemble.
+ * ------------------------------------------------------------------------
+ */
+int
+ItclTraceInit(
+    Tcl_Interp *interp,          /* interpreter to be updated */
+    ItclObjectInfo *infoPtr)     /* info regarding all known objects */
+{
+    if (Itcl_CreateEnsemble(interp, "::itcl::trace") != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (Itcl_AddEnsemblePart(interp, "::itcl::trace",
+            "start", "?-buffersize events? ?-categories list?",
+	    Itcl_TraceStartCmd,
+            infoPtr, Itcl_ReleaseData) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    Itcl_PreserveData(infoPtr);
+
+    if (Itcl_AddEnsemblePart(interp, "::itcl::trace",
+            "stop", "", Itcl_TraceStopCmd,
+            infoPtr, Itcl_ReleaseData) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    Itcl_PreserveData(infoPtr);
+
+    if (Itcl_AddEnsemblePart(interp, "::itcl::trace",
+            "clear", "", Itcl_TraceClearCmd,
+            infoPtr, Itcl_ReleaseData) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    Itcl_PreserveData(infoPtr);
+
+    if (Itcl_AddEnsemblePart(interp, "::itcl::trace",
+            "dump", "fileName", Itcl_TraceDumpCmd,
+            infoPtr, Itcl_ReleaseData) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    Itcl_PreserveData(infoPtr);
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclTraceFinish()
+ *
+ *  Invoked when the interpreter is deleted.  Frees all data of the
+ *  tracer.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclTraceFinish(
+    ItclObjectInfo *infoPtr)
+{
+    ItclTraceInfo *tracePtr = infoPtr->traceInfoPtr;
+
+    if (tracePtr == NULL) {
+        return;
+    }
+    infoPtr->instrumentFlags &= ~ITCL_INSTRUMENT_TRACE;
+    ClearTraceFrames(tracePtr);
+    ClearTraceEvents(tracePtr);
+    if (tracePtr->frames != NULL) {
+	ckfree((char *)tracePtr->frames);
+    }
+    ckfree((char *)tracePtr->events);
+    ckfree((char *)tracePtr);
+    infoPtr->traceInfoPtr = NULL;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclTraceEnter()
+ *
+ *  Called by ItclCheckCallMethod() when a member function is entered
+ *  while the tracer is running.  Pushes a frame onto the shadow stack
+ *  if the category of the function is recorded.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclTraceEnter(
+    ItclObjectInfo *infoPtr,
+    ItclMemberFunc *imPtr,
+    ItclObject *ioPtr)           /* object called or NULL */
+{
+    ItclTraceInfo *tracePtr = infoPtr->traceInfoPtr;
+    ItclTraceFrame *framePtr;
+    int category;
+
+    if (imPtr->flags & (ITCL_CONSTRUCTOR|ITCL_DESTRUCTOR)) {
+	category = ITCL_TRACE_CAT_CONSTRUCT;
+    } else if (strcmp(Tcl_GetString(imPtr->namePtr), "configure") == 0) {
+	category = ITCL_TRACE_CAT_CONFIGURE;
+    } else {
+	category = ITCL_TRACE_CAT_METHOD;
+    }
+    if (!(tracePtr->categories & category)) {
+	return;
+    }
+
+    if (tracePtr->numFrames >= tracePtr->maxFrames) {
+	tracePtr->maxFrames = tracePtr->maxFrames ? 2 * tracePtr->maxFrames : 32;
+	tracePtr->frames = (ItclTraceFrame *)ckrealloc(
+		(char *)tracePtr->frames,
+		tracePtr->maxFrames * sizeof(ItclTraceFrame));
+    }
+    framePtr = &tracePtr->frames[tracePtr->numFrames++];
+    framePtr->imPtr = imPtr;
+    framePtr->category = category;
+    framePtr->objectPtr = NULL;
+    if ((ioPtr != NULL) && (ioPtr->namePtr != NULL)) {
+	framePtr->objectPtr = ioPtr->namePtr;
+	Tcl_IncrRefCount(framePtr->objectPtr);
+    }
+    framePtr->start = ItclGetMonotonicTime();
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclTraceLeave()
+ *
+ *  Called by ItclAfterCallMethod() when a member function returns while
+ *  the tracer is running.  Pops the matching frame and records the span.
+ *  Calls entered before the tracer was started have no frame and are
+ *  ignored, frames left over above the matching one are discarded.
+ * ------------------------------------------------------------------------
+ */
+void
+ItclTraceLeave(
+    ItclObjectInfo *infoPtr,
+    ItclMemberFunc *imPtr,
+    int result)
+{
+    ItclTraceInfo *tracePtr = infoPtr->traceInfoPtr;
+    ItclTraceFrame *framePtr;
+    Tcl_WideInt end = ItclGetMonotonicTime();
+    Tcl_Size i;
+
+    for (i = tracePtr->numFrames - 1; i >= 0; i--) {
+	if (tracePtr->frames[i].imPtr == imPtr) {
+	    break;
+	}
+    }
+    if (i < 0) {
+	return;
+    }
+    while (tracePtr->numFrames > i + 1) {
+	framePtr = &tracePtr->frames[--tracePtr->numFrames];
+	if (framePtr->objectPtr != NULL) {
+	    Tcl_DecrRefCount(framePtr->objectPtr);
+	}
+    }
+    framePtr = &tracePtr->frames[--tracePtr->numFrames];
+    AddTraceEvent(tracePtr, ITCL_TRACE_CALL, framePtr->category, result,
+	    imPtr->fullNamePtr, framePtr->objectPtr, framePtr->start, end);
+    if (framePtr->objectPtr != NULL) {
+	Tcl_DecrRefCount(framePtr->objectPtr);
+    }
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ItclTraceObject()
+ *
+ *  Called by ItclCreateObject() and when an object is destroyed while
+ *  the tracer is running.  Records the span of the creation (including
+ *  the constructors) or the destruction (including the destructors).
+ * ------------------------------------------------------------------------
+ */
+void
+ItclTraceObject(
+    ItclObjectInfo *infoPtr,
+    int kind,                    /* ITCL_TRACE_CREATE or ITCL_TRACE_DESTROY */
+    ItclObject *ioPtr,           /* object created or destroyed */
+    Tcl_WideInt start,           /* start time from ItclGetMonotonicTime() */
+    int result)                  /* completion code */
+{
+    ItclTraceInfo *tracePtr = infoPtr->traceInfoPtr;
+
+    if (!(tracePtr->categories & ITCL_TRACE_CAT_OBJECT)) {
+	return;
+    }
+    AddTraceEvent(tracePtr, kind, ITCL_TRACE_CAT_OBJECT, result,
+	    ioPtr->iclsPtr->fullNamePtr, ioPtr->namePtr, start,
+	    ItclGetMonotonicTime());
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  AddTraceEvent()
+ *
+ *  Appends an event to the ring buffer, overwriting the oldest event if
+ *  the buffer is full.
+ * ------------------------------------------------------------------------
+ */
+static void
+AddTraceEvent(
+    ItclTraceInfo *tracePtr,
+    int kind,
+    int category,
+    int result,
+    Tcl_Obj *namePtr,
+    Tcl_Obj *objectPtr,
+    Tcl_WideInt start,
+    Tcl_WideInt end)
+{
+    ItclTraceEvent *eventPtr;
+
+    if (tracePtr->numEvents < tracePtr->bufferSize) {
+	eventPtr = &tracePtr->events[(tracePtr->first + tracePtr->numEvents)
+		% tracePtr->bufferSize];
+	tracePtr->numEvents++;
+    } else {
+	eventPtr = &tracePtr->events[tracePtr->first];
+	tracePtr->first = (tracePtr->first + 1) % tracePtr->bufferSize;
+	tracePtr->dropped++;
+	Tcl_DecrRefCount(eventPtr->namePtr);
+	if (eventPtr->objectPtr != NULL) {
+	    Tcl_DecrRefCount(eventPtr->objectPtr);
+	}
+    }
+    eventPtr->kind = kind;
+    eventPtr->category = category;
+    eventPtr->result = result;
+    eventPtr->namePtr = namePtr;
+    Tcl_IncrRefCount(namePtr);
+    eventPtr->objectPtr = objectPtr;
+    if (objectPtr != NULL) {
+	Tcl_IncrRefCount(objectPtr);
+    }
+    eventPtr->start = start;
+    eventPtr->duration = end - start;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ClearTraceEvents()
+ *
+ *  Discards all events of the ring buffer.
+ * ------------------------------------------------------------------------
+ */
+static void
+ClearTraceEvents(
+    ItclTraceInfo *tracePtr)
+{
+    ItclTraceEvent *eventPtr;
+
+    while (tracePtr->numEvents > 0) {
+	eventPtr = &tracePtr->events[tracePtr->first];
+	Tcl_DecrRefCount(eventPtr->namePtr);
+	if (eventPtr->objectPtr != NULL) {
+	    Tcl_DecrRefCount(eventPtr->objectPtr);
+	}
+	tracePtr->first = (tracePtr->first + 1) % tracePtr->bufferSize;
+	tracePtr->numEvents--;
+    }
+    tracePtr->first = 0;
+    tracePtr->dropped = 0;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  ClearTraceFrames()
+ *
+ *  Discards the shadow stack.  Called whenever tracing is stopped, since
+ *  the stack does not follow the calls while the tracer is inactive.
+ * ------------------------------------------------------------------------
+ */
+static void
+ClearTraceFrames(
+    ItclTraceInfo *tracePtr)
+{
+    ItclTraceFrame *framePtr;
+
+    while (tracePtr->numFrames > 0) {
+	framePtr = &tracePtr->frames[--tracePtr->numFrames];
+	if (framePtr->objectPtr != NULL) {
+	    Tcl_DecrRefCount(framePtr->objectPtr);
+	}
+    }
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_TraceStartCmd()
+ *
+ *  Starts (or reconfigures) the tracer.  Events recorded earlier are
+ *  kept, unless the size of the buffer is changed.
+ *  Handles the following syntax:
+ *
+ *      itcl::trace start ?-buffersize events? ?-categories list?
+ *
+ * ------------------------------------------------------------------------
+ */
+static int
+Itcl_TraceStartCmd(
+    void *clientData,        /* info for all known objects */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    static const char *const options[] = {
+	"-buffersize", "-categories", NULL
+    };
+    enum TraceOption {
+	TRACE_BUFFERSIZE, TRACE_CATEGORIES
+    };
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)clientData;
+    ItclTraceInfo *tracePtr;
+    Tcl_Obj **catv;
+    Tcl_Size catc;
+    Tcl_Size bufferSize;
+    Tcl_WideInt size;
+    int categories;
+    int index;
+    int pos;
+    Tcl_Size i;
+
+    tracePtr = infoPtr->traceInfoPtr;
+    if (tracePtr != NULL) {
+	bufferSize = tracePtr->bufferSize;
+	categories = tracePtr->categories;
+    } else {
+	bufferSize = ITCL_TRACE_BUFFER_SIZE;
+	categories = ITCL_TRACE_CAT_ALL;
+    }
+    for (pos = 1; pos < objc; pos += 2) {
+	if (Tcl_GetIndexFromObj(interp, objv[pos], options, "option", 0,
+		&index) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	if (pos + 1 >= objc) {
+	    Tcl_AppendResult(interp, "missing value for \"",
+		    Tcl_GetString(objv[pos]), "\"", NULL);
+	    return TCL_ERROR;
+	}
+	switch (index) {
+	case TRACE_BUFFERSIZE:
+	    if (Tcl_GetWideIntFromObj(interp, objv[pos+1], &size) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    if ((size <= 0) || (size > (Tcl_WideInt)(INT_MAX
+		    / sizeof(ItclTraceEvent)))) {
+		Tcl_AppendResult(interp, "bad buffer size \"",
+			Tcl_GetString(objv[pos+1]),
+			"\": must be a positive integer", NULL);
+		return TCL_ERROR;
+	    }
+	    bufferSize = (Tcl_Size)size;
+	    break;
+	case TRACE_CATEGORIES:
+	    if (Tcl_ListObjGetElements(interp, objv[pos+1], &catc,
+		    &catv) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    categories = 0;
+	    for (i = 0; i < catc; i++) {
+		if (Tcl_GetIndexFromObj(interp, catv[i], traceCategories,
+			"category", 0, &index) != TCL_OK) {
+		    return TCL_ERROR;
+		}
+		categories |= 1 << index;
+	    }
+	    break;
+	}
+    }
+
+    if (tracePtr == NULL) {
+	tracePtr = (ItclTraceInfo *)ckalloc(sizeof(ItclTraceInfo));
+	memset(tracePtr, 0, sizeof(ItclTraceInfo));
+	tracePtr->epoch = ItclGetMonotonicTime();
+	infoPtr->traceInfoPtr = tracePtr;
+    }
+    if (bufferSize != tracePtr->bufferSize) {
+	ClearTraceEvents(tracePtr);
+	if (tracePtr->events != NULL) {
+	    ckfree((char *)tracePtr->events);
+	}
+	tracePtr->events = (ItclTraceEvent *)ckalloc(
+		bufferSize * sizeof(ItclTraceEvent));
+	tracePtr->bufferSize = bufferSize;
+    }
+    if (!(infoPtr->instrumentFlags & ITCL_INSTRUMENT_TRACE)) {
+	ClearTraceFrames(tracePtr);
+    }
+    tracePtr->categories = categories;
+    infoPtr->instrumentFlags |= ITCL_INSTRUMENT_TRACE;
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_TraceStopCmd()
+ *
+ *  Stops the tracer.  The events recorded so far are kept.
+ *  Handles the following syntax:
+ *
+ *      itcl::trace stop
+ *
+ * ------------------------------------------------------------------------
+ */
+static int
+Itcl_TraceStopCmd(
+    void *clientData,        /* info for all known objects */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)clientData;
+
+    if (objc != 1) {
+        Tcl_WrongNumArgs(interp, 1, objv, "");
+        return TCL_ERROR;
+    }
+    infoPtr->instrumentFlags &= ~ITCL_INSTRUMENT_TRACE;
+    if (infoPtr->traceInfoPtr != NULL) {
+	ClearTraceFrames(infoPtr->traceInfoPtr);
+    }
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_TraceClearCmd()
+ *
+ *  Discards all events recorded so far.
+ *  Handles the following syntax:
+ *
+ *      itcl::trace clear
+ *
+ * ------------------------------------------------------------------------
+ */
+static int
+Itcl_TraceClearCmd(
+    void *clientData,        /* info for all known objects */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)clientData;
+
+    if (objc != 1) {
+        Tcl_WrongNumArgs(interp, 1, objv, "");
+        return TCL_ERROR;
+    }
+    if (infoPtr->traceInfoPtr != NULL) {
+	ClearTraceEvents(infoPtr->traceInfoPtr);
+    }
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  Itcl_TraceDumpCmd()
+ *
+ *  Writes the events of the ring buffer as a JSON trace in the trace
+ *  event format, one event per line, oldest first.  The buffer is not
+ *  changed and tracing continues.  Returns the number of events written.
+ *  Handles the following syntax:
+ *
+ *      itcl::trace dump fileName
+ *
+ * ------------------------------------------------------------------------
+ */
+static int
+Itcl_TraceDumpCmd(
+    void *clientData,        /* info for all known objects */
+    Tcl_Interp *interp,      /* current interpreter */
+    int objc,                /* number of arguments */
+    Tcl_Obj *const objv[])   /* argument objects */
+{
+    ItclObjectInfo *infoPtr = (ItclObjectInfo *)clientData;
+    ItclTraceInfo *tracePtr = infoPtr->traceInfoPtr;
+    ItclTraceEvent *eventPtr;
+    Tcl_Channel channel;
+    Tcl_Obj *linePtr;
+    Tcl_Size numEvents;
+    Tcl_Size i;
+    Tcl_WideInt start;
+    Tcl_WideInt dropped;
+    int category;
+    int result;
+
+    if (objc != 2) {
+        Tcl_WrongNumArgs(interp, 1, objv, "fileName");
+        return TCL_ERROR;
+    }
+    channel = Tcl_FSOpenFileChannel(interp, objv[1], "w", 0666);
+    if (channel == NULL) {
+	return TCL_ERROR;
+    }
+    Tcl_SetChannelOption(NULL, channel, "-encoding", "utf-8");
+
+    numEvents = (tracePtr != NULL) ? tracePtr->numEvents : 0;
+    dropped = (tracePtr != NULL) ? tracePtr->dropped : 0;
+    linePtr = Tcl_NewStringObj("{\"traceEvents\":[\n", TCL_INDEX_NONE);
+    Tcl_IncrRefCount(linePtr);
+    result = TCL_OK;
+    for (i = 0; i < numEvents; i++) {
+	eventPtr = &tracePtr->events[(tracePtr->first + i)
+		% tracePtr->bufferSize];
+	for (category = 0; !(eventPtr->category & (1 << category));
+		category++) {
+	}
+	Tcl_AppendToObj(linePtr, "{\"name\":\"", TCL_INDEX_NONE);
+	if (eventPtr->kind == ITCL_TRACE_CREATE) {
+	    Tcl_AppendToObj(linePtr, "create ", TCL_INDEX_NONE);
+	} else if (eventPtr->kind == ITCL_TRACE_DESTROY) {
+	    Tcl_AppendToObj(linePtr, "destroy ", TCL_INDEX_NONE);
+	}
+	AppendJsonString(linePtr, eventPtr->namePtr);
+	start = eventPtr->start - tracePtr->epoch;
+	Tcl_AppendPrintfToObj(linePtr, "\",\"cat\":\"%s\",\"ph\":\"X\","
+		"\"ts\":%" TCL_LL_MODIFIER "d.%03d,"
+		"\"dur\":%" TCL_LL_MODIFIER "d.%03d,\"pid\":1,\"tid\":1",
+		traceCategories[category],
+		start / 1000, (int)(start % 1000),
+		eventPtr->duration / 1000, (int)(eventPtr->duration % 1000));
+	if (eventPtr->objectPtr != NULL) {
+	    Tcl_AppendToObj(linePtr, ",\"args\":{\"object\":\"",
+		    TCL_INDEX_NONE);
+	    AppendJsonString(linePtr, eventPtr->objectPtr);
+	    Tcl_AppendToObj(linePtr, "\"", TCL_INDEX_NONE);
+	    if (eventPtr->result != TCL_OK) {
+		Tcl_AppendPrintfToObj(linePtr, ",\"code\":%d",
+			eventPtr->result);
+	    }
+	    Tcl_AppendToObj(linePtr, "}", TCL_INDEX_NONE);
+	} else if (eventPtr->result != TCL_OK) {
+	    Tcl_AppendPrintfToObj(linePtr, ",\"args\":{\"code\":%d}",
+		    eventPtr->result);
+	}
+	Tcl_AppendToObj(linePtr, (i + 1 < numEvents) ? "},\n" : "}\n",
+		TCL_INDEX_NONE);
+	if (Tcl_WriteObj(channel, linePtr) < 0) {
+	    result = TCL_ERROR;
+	    break;
+	}
+	Tcl_SetObjLength(linePtr, 0);
+    }
+    if (result == TCL_OK) {
+	Tcl_AppendPrintfToObj(linePtr, "],\"displayTimeUnit\":\"ns\","
+		"\"otherData\":{\"dropped\":%" TCL_LL_MODIFIER "d}}\n",
+		dropped);
+	if (Tcl_WriteObj(channel, linePtr) < 0) {
+	    result = TCL_ERROR;
+	}
+    }
+    Tcl_DecrRefCount(linePtr);
+    if (result != TCL_OK) {
+	Tcl_AppendResult(interp, "error writing \"",
+		Tcl_GetString(objv[1]), "\": ", Tcl_PosixError(interp), NULL);
+	Tcl_Close(NULL, channel);
+	return TCL_ERROR;
+    }
+    if (Tcl_Close(interp, channel) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    Tcl_SetObjResult(interp, Tcl_NewWideIntObj(numEvents));
+    return TCL_OK;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  AppendJsonString()
+ *
+ *  Appends the string value of an object to a JSON string literal,
+ *  escaping quotes, backslashes and control characters.
+ * ------------------------------------------------------------------------
+ */
+static void
+AppendJsonString(
+    Tcl_Obj *objPtr,
+    Tcl_Obj *valuePtr)
+{
+    Tcl_Size length;
+    const char *start = Tcl_GetStringFromObj(valuePtr, &length);
+    const char *end = start + length;
+    const char *p;
+
+    for (p = start; p < end; p++) {
+	if ((*p == '"') || (*p == '\\') || ((unsigned char)*p < 0x20)) {
+	    Tcl_AppendToObj(objPtr, start, p - start);
+	    if ((*p == '"') || (*p == '\\')) {
+		Tcl_AppendPrintfToObj(objPtr, "\\%c", *p);
+	    } else {
+		Tcl_AppendPrintfToObj(objPtr, "\\u%04x", (unsigned char)*p);
+	    }
+	    start = p + 1;
+	}
+    }
+    Tcl_AppendToObj(objPtr, start, end - start);
+}
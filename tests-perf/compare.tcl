@@ -0,0 +1,125 @@
+#!/usr/bin/tclsh
+
+# ------------------------------------------------------------------------
+#
+# compare.tcl --
+#
+#  This file compares two result files written by the benchmark suite
+#  with -json and flags the benchmarks which became slower, or make
+#  more allocations per operation, than allowed by a threshold:
+#
+#    tclsh compare.tcl ?-threshold percent? ?-match patterns? \
+#        baseline.json current.json
+#
+#  The threshold defaults to 10 percent.  The exit status is 1 if a
+#  regression was found, so that the script can be used to check an
+#  upgrade of itcl before it is made:
+#
+#    make perf PERFFLAGS="-json old.json"    ;# with the old version
+#    make perf PERFFLAGS="-json new.json"    ;# with the new version
+#    tclsh tests-perf/compare.tcl old.json new.json
+#
+#  Timings of short runs are noisy; for a reliable comparison, use the
+#  same machine for both runs and a -time of 500 or more.
+#
+# ------------------------------------------------------------------------
+#
+# See the file "license.terms" for information on usage and redistribution
+# of this file.
+#
+
+if {![namespace exists ::itclTestPerf]} {
+  source [file join [file dirname [info script]] harness.tcl]
+}
+
+namespace eval ::itclTestPerf-Compare {
+
+# compare --
+#
+#  Compares the results of two runs and prints a line for each benchmark
+#  found in both.  Returns the number of regressions.
+#
+proc compare {baseline current threshold patterns} {
+  set base {}
+  foreach r [::itclTestPerf::readJson $baseline] {
+    dict set base [list [dict get $r name] [dict get $r params]] $r
+  }
+  set regressions 0
+  set seen {}
+  puts [format "%-44s %-16s %12s %12s %8s" \
+    benchmark params baseline current change]
+  foreach r [::itclTestPerf::readJson $current] {
+    set key [list [dict get $r name] [dict get $r params]]
+    if {![matches [dict get $r name] $patterns]} {
+      continue
+    }
+    if {![dict exists $base $key]} {
+      puts [format "%-44s %-16s %12s %12.1f %8s" \
+        {*}$key - [dict get $r nsPerOp] new]
+      continue
+    }
+    dict set seen $key 1
+    set b [dict get $base $key]
+    set old [dict get $b nsPerOp]
+    set new [dict get $r nsPerOp]
+    set change [expr {$old > 0 ? ($new - $old) * 100.0 / $old : 0.0}]
+    set flags {}
+    if {$change > $threshold} {
+      lappend flags REGRESSION
+    } elseif {$change < -$threshold} {
+      lappend flags improved
+    }
+    if {[dict exists $b allocsPerOp] && [dict exists $r allocsPerOp]} {
+      set oldAllocs [dict get $b allocsPerOp]
+      set newAllocs [dict get $r allocsPerOp]
+      if {$newAllocs > $oldAllocs * (1 + $threshold / 100.0) + 0.5} {
+        lappend flags [format "ALLOCS %.1f -> %.1f" $oldAllocs $newAllocs]
+      }
+    }
+    if {[regexp {REGRESSION|ALLOCS} $flags]} {
+      incr regressions
+    }
+    puts [format "%-44s %-16s %12.1f %12.1f %+7.1f%% %s" \
+      {*}$key $old $new $change [join $flags {, }]]
+  }
+  dict for {key b} $base {
+    if {![dict exists $seen $key] && [matches [lindex $key 0] $patterns]} {
+      puts [format "%-44s %-16s %12.1f %12s %8s" \
+        {*}$key [dict get $b nsPerOp] - missing]
+    }
+  }
+  return $regressions
+}
+
+proc matches {name patterns} {
+  foreach pattern [split [join $patterns ,] ,] {
+    if {[string match $pattern $name]} {
+      return 1
+    }
+  }
+  return 0
+}
+
+}; # end of ::itclTestPerf-Compare
+
+# ------------------------------------------------------------------------
+
+# if calling direct:
+if {[info exists ::argv0] && [file tail $::argv0] eq [file tail [info script]]} {
+  if {[llength $argv] < 2 || [llength $argv] % 2} {
+    puts stderr "usage: [file tail $::argv0] ?-threshold percent?\
+      ?-match patterns? baseline.json current.json"
+    exit 2
+  }
+  array set in {-threshold 10 -match *}
+  array set in [lrange $argv 0 end-2]
+  lassign [lrange $argv end-1 end] baseline current
+
+  set n [::itclTestPerf-Compare::compare $baseline $current \
+    $in(-threshold) $in(-match)]
+  if {$n} {
+    puts "\n$n regression(s) above $in(-threshold)%"
+    exit 1
+  }
+  puts "\nno regressions above $in(-threshold)%"
+}
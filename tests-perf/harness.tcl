@@ -0,0 +1,285 @@
+# ------------------------------------------------------------------------
+#
+# harness.tcl --
+#
+#  This file provides a small self-contained harness for the itcl
+#  benchmark suites: each benchmark is measured with timerate for a
+#  series of scaling parameters, so that the results show how the cost
+#  of an operation grows with the size of the model.
+#
+# ------------------------------------------------------------------------
+#
+# See the file "license.terms" for information on usage and redistribution
+# of this file.
+#
+
+namespace eval ::itclTestPerf {
+
+  namespace export bench group sizes
+
+  ## options (see configure):
+  variable opts
+  array set opts {-time 100 -match * -skip {} -scale 1 -verbose 1}
+
+  ## recorded results, a list of dicts with the keys name, params,
+  ## iterations, nsPerOp and, if Tcl was built with TCL_MEM_DEBUG,
+  ## allocsPerOp:
+  variable results {}
+
+  ## current benchmark group:
+  variable group {}
+
+  ## timerate is a regular command in Tcl 8.7+, but unsupported in 8.6:
+  if {[namespace which -command ::timerate] ne ""} {
+    interp alias {} ::itclTestPerf::timerate {} ::timerate
+  } else {
+    interp alias {} ::itclTestPerf::timerate {} ::tcl::unsupported::timerate
+  }
+}
+
+# configure --
+#
+#  Sets the options of the harness:
+#    -time    milliseconds to spend in each measurement;
+#    -match   glob patterns of the benchmarks to run;
+#    -skip    glob patterns of the benchmarks to skip;
+#             patterns may be given as a list or separated by commas,
+#             which is easier to pass through make;
+#    -scale   factor applied to the scaling parameters of sizes;
+#    -verbose 0 to suppress the result lines on stdout.
+#
+proc ::itclTestPerf::configure {args} {
+  variable opts
+  foreach {opt val} $args {
+    if {![info exists opts($opt)]} {
+      return -code error "bad option \"$opt\": must be\
+        [join [lsort [array names opts]] {, }]"
+    }
+    set opts($opt) $val
+  }
+}
+
+# group --
+#
+#  Starts a group of benchmarks; its name prefixes the benchmark names.
+#
+proc ::itclTestPerf::group {name} {
+  variable group $name
+  variable opts
+  if {$opts(-verbose)} {
+    puts "==== $name ===="
+  }
+}
+
+# selected --
+#
+#  Returns 1 if the benchmark with the given full name should run.
+#
+proc ::itclTestPerf::selected {name} {
+  variable opts
+  set ok 0
+  foreach pattern [split [join $opts(-match) ,] ,] {
+    if {[string match $pattern $name]} {
+      set ok 1
+      break
+    }
+  }
+  foreach pattern [split [join $opts(-skip) ,] ,] {
+    if {[string match $pattern $name]} {
+      return 0
+    }
+  }
+  return $ok
+}
+
+# sizes --
+#
+#  Returns the scaling parameters multiplied by the -scale option, so
+#  that a quick run can be made with "-scale 0.1".
+#
+proc ::itclTestPerf::sizes {args} {
+  variable opts
+  set result {}
+  foreach n $args {
+    lappend result [expr {max(1, int($n * $opts(-scale)))}]
+  }
+  return $result
+}
+
+# bench --
+#
+#  Measures one benchmark for one set of parameters.  The setup script
+#  runs once before the measurement, the cleanup script once after; all
+#  scripts are evaluated in the global namespace.  The params argument
+#  is a dict describing the scaling parameters, like {n 1000}; the
+#  optional maxCount limits the number of iterations for operations
+#  which consume a resource, like creating named objects.
+#
+proc ::itclTestPerf::bench {name params script args} {
+  variable opts
+  variable group
+  variable results
+  array set o {-setup {} -cleanup {} -maxcount {}}
+  array set o $args
+
+  if {$group ne ""} {
+    set name $group/$name
+  }
+  if {![selected $name]} {
+    return
+  }
+  uplevel #0 $o(-setup)
+  set mallocs [mallocs]
+  set code [catch {
+    uplevel #0 [list ::itclTestPerf::timerate $script $opts(-time) \
+      {*}$o(-maxcount)]
+  } r]
+  set mallocs [expr {$mallocs eq "" ? "" : [mallocs] - $mallocs}]
+  uplevel #0 $o(-cleanup)
+  if {$code} {
+    return -code error "benchmark $name ($params) failed: $r"
+  }
+
+  ## timerate returns "<us> us/# <count> # <rate> #/sec <net> net-ms":
+  set nsPerOp [expr {[lindex $r 0] * 1000.0}]
+  set iterations [lindex $r 2]
+  set result [dict create name $name params $params \
+    iterations $iterations nsPerOp $nsPerOp]
+  if {$mallocs ne "" && $iterations > 0} {
+    dict set result allocsPerOp [expr {double($mallocs) / $iterations}]
+  }
+  lappend results $result
+  if {$opts(-verbose)} {
+    puts [format "%-44s %-22s %12.1f ns/op %10d #" \
+      $name $params $nsPerOp $iterations]
+  }
+}
+
+# mallocs --
+#
+#  Returns the number of allocations made so far, or an empty string if
+#  Tcl was not built with TCL_MEM_DEBUG.  The count includes the
+#  allocations of timerate itself, which are few compared to the
+#  iterations measured.
+#
+proc ::itclTestPerf::mallocs {} {
+  if {[namespace which -command ::memory] eq ""
+      || ![regexp -line {^total mallocs\s+(\d+)} [::memory info] -> n]} {
+    return ""
+  }
+  return $n
+}
+
+# results --
+#
+#  Returns the results recorded so far.
+#
+proc ::itclTestPerf::results {} {
+  variable results
+  return $results
+}
+
+# writeJson --
+#
+#  Writes the results recorded so far to fileName as a JSON object:
+#
+#    {"itcl": version, "tcl": version, "time": ms, "results": [
+#      {"name": name, "params": {param: value, ...}, "iterations": n,
+#       "nsPerOp": ns, "allocsPerOp": n}, ...]}
+#
+#  where allocsPerOp is only present if allocations could be counted.
+#
+proc ::itclTestPerf::writeJson {fileName} {
+  variable opts
+  variable results
+  set entries {}
+  foreach r $results {
+    set params {}
+    dict for {key value} [dict get $r params] {
+      lappend params "[jsonValue $key]: [jsonValue $value]"
+    }
+    set fields [list \
+      "\"name\": [jsonValue [dict get $r name]]" \
+      "\"params\": \{[join $params {, }]\}" \
+      "\"iterations\": [dict get $r iterations]" \
+      "\"nsPerOp\": [format %.3f [dict get $r nsPerOp]]"]
+    if {[dict exists $r allocsPerOp]} {
+      lappend fields "\"allocsPerOp\": [format %.3f [dict get $r allocsPerOp]]"
+    }
+    lappend entries "    \{[join $fields {, }]\}"
+  }
+  set f [open $fileName w]
+  try {
+    puts $f "\{"
+    puts $f "  \"itcl\": [jsonValue [package provide itcl]],"
+    puts $f "  \"tcl\": [jsonValue [info patchlevel]],"
+    puts $f "  \"time\": $opts(-time),"
+    puts $f "  \"results\": \["
+    puts $f [join $entries ",\n"]
+    puts $f "  \]"
+    puts $f "\}"
+  } finally {
+    close $f
+  }
+}
+
+# jsonValue --
+#
+#  Returns a number unchanged and any other value as a JSON string.
+#
+proc ::itclTestPerf::jsonValue {value} {
+  if {[regexp {^-?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][-+]?[0-9]+)?$} $value]} {
+    return $value
+  }
+  return "\"[string map {\\ \\\\ \" \\\" \n \\n \t \\t} $value]\""
+}
+
+# readJson --
+#
+#  Reads a file written by writeJson and returns its results, a list of
+#  dicts as recorded by bench.  Only the subset of JSON produced by
+#  writeJson is understood.
+#
+proc ::itclTestPerf::readJson {fileName} {
+  set f [open $fileName]
+  try {
+    set data [read $f]
+  } finally {
+    close $f
+  }
+  set results {}
+  foreach line [split $data \n] {
+    if {![regexp {^\s*\{"name"} $line]} {
+      continue
+    }
+    set r {}
+    foreach key {name iterations nsPerOp allocsPerOp} {
+      if {[regexp "\"$key\": (\"(?:\[^\"\\\\\]|\\\\.)*\"|\[-0-9.eE+\]+)" \
+          $line -> value]} {
+        dict set r $key [jsonString $value]
+      }
+    }
+    set params {}
+    if {[regexp {"params": \{([^\}]*)\}} $line -> p]} {
+      foreach {-> key value} [regexp -all -inline \
+          {("(?:[^"\\]|\\.)*"): ("(?:[^"\\]|\\.)*"|[-0-9.eE+]+)} $p] {
+        dict set params [jsonString $key] [jsonString $value]
+      }
+    }
+    dict set r params $params
+    lappend results $r
+  }
+  return $results
+}
+
+# jsonString --
+#
+#  Returns the value of a JSON string or number read by readJson.
+#
+proc ::itclTestPerf::jsonString {value} {
+  if {[string index $value 0] ne "\""} {
+    return $value
+  }
+  return [string map {\\\\ \\ \\\" \" \\n \n \\t \t} \
+    [string range $value 1 end-1]]
+}
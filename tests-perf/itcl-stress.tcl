@@ -0,0 +1,270 @@
+#!/usr/bin/tclsh
+
+# ------------------------------------------------------------------------
+#
+# itcl-stress.tcl --
+#
+#  This file provides a scalability stress harness.  Each scenario runs
+#  an operation at growing sizes, measures the total time it takes and
+#  fits the growth exponent k of time ~ size**k by least squares on the
+#  logarithms.  A scenario fails if k exceeds the bound declared for it,
+#  which catches operations becoming quadratic long before a small test
+#  case would notice.
+#
+#  Run it with "make stress", or directly:
+#
+#    tclsh itcl-stress.tcl ?-sizes list? ?-depths list? ?-repeat n? \
+#        ?-match patterns? ?-maxtime seconds? ?-load script? ?-lib library?
+#
+#  The default sizes are 1000 10000 100000; add 1000000 to -sizes for a
+#  full run, which needs a few GB of memory.  The exit status is 1 if a
+#  scenario exceeded its bound.
+#
+# ------------------------------------------------------------------------
+#
+# See the file "license.terms" for information on usage and redistribution
+# of this file.
+#
+
+namespace eval ::itclTestStress {
+
+variable opts
+array set opts {
+  -sizes {1000 10000 100000} -depths {1 2 5 10 20 50}
+  -repeat 3 -match * -maxtime 30
+}
+
+## scenarios: name -> {bound scale setup script cleanup}:
+variable scenarios {}
+
+# scenario --
+#
+#  Declares a scenario.  The setup, script and cleanup are evaluated in
+#  the global namespace with the variable n set to the size; only the
+#  script is timed.  The scale is "sizes" or "depths".
+#
+proc scenario {name bound scale setup script cleanup} {
+  variable scenarios
+  dict set scenarios $name [list $bound $scale $setup $script $cleanup]
+}
+
+# measure --
+#
+#  Returns the smallest time of -repeat runs of a scenario at size n, in
+#  microseconds.
+#
+proc measure {setup script cleanup n} {
+  variable opts
+  set best {}
+  for {set i 0} {$i < $opts(-repeat)} {incr i} {
+    set ::n $n
+    uplevel #0 $setup
+    set t [lindex [uplevel #0 [list time $script]] 0]
+    uplevel #0 $cleanup
+    if {$best eq "" || $t < $best} {
+      set best $t
+    }
+  }
+  return [expr {max($best, 1)}]
+}
+
+# fit --
+#
+#  Returns the slope of the least squares line through the points
+#  (log size, log time).
+#
+proc fit {points} {
+  set sx 0.0; set sy 0.0; set sxx 0.0; set sxy 0.0
+  set m [expr {[llength $points] / 2}]
+  foreach {x y} $points {
+    set x [expr {log($x)}]
+    set y [expr {log($y)}]
+    set sx [expr {$sx + $x}]
+    set sy [expr {$sy + $y}]
+    set sxx [expr {$sxx + $x*$x}]
+    set sxy [expr {$sxy + $x*$y}]
+  }
+  set d [expr {$m*$sxx - $sx*$sx}]
+  if {$m < 2 || $d == 0} {
+    return 0.0
+  }
+  return [expr {($m*$sxy - $sx*$sy) / $d}]
+}
+
+# run --
+#
+#  Runs all scenarios matching -match and returns the number of
+#  scenarios which exceeded their bound.
+#
+proc run {} {
+  variable opts
+  variable scenarios
+  set failures 0
+  dict for {name def} $scenarios {
+    lassign $def bound scale setup script cleanup
+    set match 0
+    foreach pattern [split [join $opts(-match) ,] ,] {
+      if {[string match $pattern $name]} {
+        set match 1
+      }
+    }
+    if {!$match} {
+      continue
+    }
+    puts "==== $name (bound $bound) ===="
+    set points {}
+    foreach n $opts(-$scale) {
+      set t [measure $setup $script $cleanup $n]
+      puts [format "  %-8s %10d %14.0f us" [string trimright $scale s] $n $t]
+      lappend points $n $t
+      ## a super-linear scenario may take very long at the next size,
+      ## but its exponent is already known:
+      if {$t > $opts(-maxtime) * 1e6} {
+        puts "  stopped after [expr {$t / 1e6}] s"
+        break
+      }
+    }
+    set k [fit $points]
+    if {$k > $bound} {
+      incr failures
+      puts [format "  exponent %.2f exceeds bound %.2f: FAILED" $k $bound]
+    } else {
+      puts [format "  exponent %.2f" $k]
+    }
+  }
+  return $failures
+}
+
+# ------------------------------------------------------------------------
+
+## deleting a class deletes its objects, which are found by a scan of
+## all objects; the objects of other classes must not be scanned again
+## for each object deleted.  The class has a fixed number of objects,
+## since TclOO keeps the instances of a class in an array, which makes
+## deleting many instances of one class quadratic in Tcl itself:
+scenario class-delete 0.8 sizes {
+  itcl::class ::stress::Other {public variable a 0}
+  itcl::class ::stress::K {public variable a 0}
+  for {set i 0} {$i < $n} {incr i} {
+    ::stress::Other ::stress::other$i
+  }
+  for {set i 0} {$i < 1000} {incr i} {
+    ::stress::K ::stress::k$i
+  }
+} {
+  itcl::delete class ::stress::K
+} {
+  namespace delete ::stress
+}
+
+## find objects walks the commands of all namespaces once.  The exponent
+## is about 1.2, as the growing tables leave the caches; the bound leaves
+## room for noise on loaded machines, a quadratic walk gives 2:
+scenario find-objects 1.6 sizes {
+  itcl::class ::stress::C {public variable a 0}
+  for {set i 0} {$i < $n} {incr i} {
+    ::stress::C ::stress::c$i
+  }
+} {
+  itcl::find objects -class ::stress::C
+} {
+  namespace delete ::stress
+}
+
+## the parts of an ensemble are kept sorted; inserting them in reverse
+## order puts each one in front of all the others.  Moving the others is
+## linear, but so cheap that it shows only above 100000 parts, hence the
+## higher bound; updating the map of the Tcl ensemble must be constant:
+scenario ensemble-insert 1.5 sizes {
+  namespace eval ::stress {}
+} {
+  for {set i $n} {$i > 0} {incr i -1} {
+    itcl::ensemble ::stress::ens part [format p%07d $i] {} {}
+  }
+} {
+  namespace delete ::stress
+}
+
+## inheriting from a deep hierarchy builds the virtual tables of the new
+## class, which hold the members of all of its base classes:
+scenario inherit-depth 1.5 depths {
+  itcl::class ::stress::B1 {
+    for {set j 0} {$j < 20} {incr j} {
+      public method m$j {} {}
+      public variable v$j 0
+    }
+  }
+  for {set i 2} {$i < $n} {incr i} {
+    itcl::class ::stress::B$i "
+      inherit ::stress::B[expr {$i - 1}]
+      for {set j 0} {\$j < 20} {incr j} {
+        public method m$i\$j {} {}
+        public variable v$i\$j 0
+      }
+    "
+  }
+  set base [expr {$n > 1 ? "inherit ::stress::B[expr {$n - 1}]" : ""}]
+} {
+  itcl::class ::stress::D "$base; public method m {} {}"
+  ::stress::D ::stress::d
+  ::stress::d m
+} {
+  namespace delete ::stress
+}
+
+## classes in deeply nested namespaces resolve their members through the
+## class tables, whose cost must not depend much on the depth:
+scenario namespace-depth 1.5 depths {
+  set ns ::stress
+  for {set i 1} {$i < $n} {incr i} {
+    append ns ::s$i
+  }
+  namespace eval $ns {}
+} {
+  itcl::class ${ns}::C {
+    public common count 0
+    public variable a 0
+    public method m {} {incr count; set a $count}
+  }
+  for {set i 0} {$i < 1000} {incr i} {
+    ${ns}::C ${ns}::o$i
+    ${ns}::o$i m
+  }
+  itcl::delete class ${ns}::C
+} {
+  namespace delete ::stress
+}
+
+}; # end of ::itclTestStress
+
+# ------------------------------------------------------------------------
+
+# if calling direct:
+if {[info exists ::argv0] && [file tail $::argv0] eq [file tail [info script]]} {
+  array set in {-lib {} -load {}}
+  array set in $argv
+  if {$in(-load) ne ""} {
+    eval $in(-load)
+  }
+  if {![namespace exists ::itcl]} {
+    if {$in(-lib) eq ""} {
+      package require itcl
+    } else {
+      puts "testing with $in(-lib)"
+      load $in(-lib) itcl
+    }
+  }
+  puts "itcl [package provide itcl], Tcl [info patchlevel]"
+  foreach opt [array names ::itclTestStress::opts] {
+    if {[info exists in($opt)]} {
+      set ::itclTestStress::opts($opt) $in($opt)
+    }
+  }
+
+  set failures [::itclTestStress::run]
+  if {$failures} {
+    puts "\n$failures scenario(s) exceeded their bound"
+    exit 1
+  }
+  puts \n**OK**
+}
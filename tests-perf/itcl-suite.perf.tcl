@@ -0,0 +1,396 @@
+#!/usr/bin/tclsh
+
+# ------------------------------------------------------------------------
+#
+# itcl-suite.perf.tcl --
+#
+#  This file provides the itcl benchmark suite.  Each benchmark is run
+#  for a series of scaling parameters (number of live objects, depth of
+#  the class hierarchy, number of members, ...), so that the results
+#  show the complexity of an operation and not only a single point.
+#
+#  Run it with "make perf", or directly:
+#
+#    tclsh itcl-suite.perf.tcl ?-time ms? ?-match patterns? \
+#        ?-skip patterns? ?-scale factor? ?-json fileName? \
+#        ?-load script? ?-lib library?
+#
+#  The benchmark names are "group/name", so "-match {dispatch/*}" runs
+#  the method dispatch benchmarks only.  With -json, the results are
+#  also written to fileName, which can be compared with the results of
+#  another run by compare.tcl.
+#
+# ------------------------------------------------------------------------
+#
+# See the file "license.terms" for information on usage and redistribution
+# of this file.
+#
+
+if {![namespace exists ::itclTestPerf]} {
+  source [file join [file dirname [info script]] harness.tcl]
+}
+
+namespace eval ::itclTestPerf-Suite {
+
+namespace import ::itclTestPerf::bench ::itclTestPerf::group \
+  ::itclTestPerf::sizes
+
+## the maximal depth of the class hierarchies:
+variable maxDepth 16
+
+# ------------------------------------------------------------------------
+
+## helpers creating and deleting the classes and objects measured:
+
+proc hierarchy {} {
+  variable maxDepth
+  itcl::class ::perf::H1 {
+    public variable h1 0
+    public method base {} {return 1}
+    protected method prot {} {return 1}
+    public method callProt {} {prot}
+    public method ch {} {return 1}
+  }
+  for {set i 2} {$i <= $maxDepth} {incr i} {
+    itcl::class ::perf::H$i [string map [list \$i $i \$p [expr {$i-1}]] {
+      inherit ::perf::H$p
+      public variable h$i 0
+      public method ch {} {chain}
+    }]
+  }
+}
+
+proc population {cls n} {
+  for {set i 1} {$i <= $n} {incr i} {
+    $cls ::perf::pop$i
+  }
+}
+
+proc depopulate {n} {
+  for {set i 1} {$i <= $n} {incr i} {
+    itcl::delete object ::perf::pop$i
+  }
+}
+
+proc members {n body} {
+  set result {}
+  for {set i 1} {$i <= $n} {incr i} {
+    append result [string map [list \$i $i] $body] \n
+  }
+  return $result
+}
+
+proc setup {} {
+  namespace eval ::perf {}
+  hierarchy
+  itcl::class ::perf::Plain {
+    public variable a 0
+    public variable b 0
+    public method m {} {return $a}
+  }
+  itcl::type ::perf::Type {
+    variable a 0
+    variable b 0
+    method m {} {return $a}
+  }
+  itcl::extendedclass ::perf::Extended {
+    public variable a 0
+    public variable b 0
+    public method m {} {return $a}
+  }
+}
+
+proc cleanup {} {
+  namespace delete ::perf
+}
+
+# ------------------------------------------------------------------------
+
+## object creation and deletion, depending on the number of live objects
+## of the class and the depth of the hierarchy:
+proc test-object {} {
+  variable maxDepth
+  group object
+  foreach n [sizes 10 1000 10000] {
+    foreach cls {Plain Type Extended} {
+      bench create-delete-[string tolower $cls] [list live $n] \
+        "::perf::$cls ::perf::o; itcl::delete object ::perf::o" \
+        -setup [list [namespace current]::population ::perf::$cls $n] \
+        -cleanup [list [namespace current]::depopulate $n]
+    }
+    bench create-delete-autoname [list live $n] {
+      itcl::delete object [::perf::Plain ::perf::#auto]
+    } -setup [list [namespace current]::population ::perf::Plain $n] \
+      -cleanup [list [namespace current]::depopulate $n]
+  }
+  foreach d [list 1 4 $maxDepth] {
+    bench create-delete-hierarchy [list depth $d] \
+      "::perf::H$d ::perf::o; itcl::delete object ::perf::o"
+  }
+}
+
+## method dispatch, depending on the depth of the hierarchy between the
+## class of the object and the class of the method:
+proc test-dispatch {} {
+  variable maxDepth
+  group dispatch
+  foreach d [list 1 4 $maxDepth] {
+    set setup "::perf::H$d ::perf::o"
+    set cleanup {itcl::delete object ::perf::o}
+    bench public [list depth $d] {::perf::o base} \
+      -setup $setup -cleanup $cleanup
+    bench protected [list depth $d] {::perf::o callProt} \
+      -setup $setup -cleanup $cleanup
+    bench qualified [list depth $d] {::perf::o ::perf::H1::base} \
+      -setup $setup -cleanup $cleanup
+    bench chain [list depth $d] {::perf::o ch} \
+      -setup $setup -cleanup $cleanup
+  }
+}
+
+## access to instance and common variables inside methods, depending on
+## the number of variables of the class:
+proc test-variable {} {
+  group variable
+  foreach n [sizes 10 100 1000] {
+    set setup [list itcl::class ::perf::V "[members $n {
+      public variable v$i 0
+      public common c$i 0
+    }]
+      public method getInst {} {set v1}
+      public method setInst {} {set v1 x}
+      public method getCommon {} {set c1}
+      public method setCommon {} {set c1 x}
+    "]
+    append setup \n {::perf::V ::perf::o}
+    set cleanup {itcl::delete class ::perf::V}
+    foreach method {getInst setInst getCommon setCommon} {
+      bench [string tolower $method] [list vars $n] "::perf::o $method" \
+        -setup $setup -cleanup $cleanup
+    }
+  }
+}
+
+## configure and cget on public variables of classes and on options of
+## types, depending on the number of variables or options:
+proc test-configure {} {
+  group configure
+  foreach n [sizes 10 100 1000] {
+    set defs [list \
+      class [list itcl::class ::perf::C [members $n {public variable p$i 0}]] \
+      type [list itcl::type ::perf::C [members $n {option -p$i 0}]] \
+    ]
+    foreach {kind def} $defs {
+      set setup "$def; ::perf::C ::perf::o"
+      set cleanup {itcl::delete object ::perf::o; itcl::delete class ::perf::C}
+      bench configure-$kind-first [list options $n] {::perf::o configure -p1 x} \
+        -setup $setup -cleanup $cleanup
+      bench configure-$kind-last [list options $n] "::perf::o configure -p$n x" \
+        -setup $setup -cleanup $cleanup
+      bench cget-$kind [list options $n] {::perf::o cget -p1} \
+        -setup $setup -cleanup $cleanup
+    }
+  }
+}
+
+## delegation of methods and options of types to components, depending
+## on the number of delegated methods:
+proc test-delegation {} {
+  group delegation
+  foreach n [sizes 1 10 100] {
+    set setup [list itcl::class ::perf::Target "public variable v 0\n[members $n {
+      public method t$i {} {return $i}
+    }]"]
+    append setup \n [list itcl::type ::perf::Explicit "
+      component c
+      [members $n {delegate method t$i to c}]
+      delegate option -v to c
+      constructor {} {set c \[::perf::Target ::perf::#auto\]}
+      destructor {itcl::delete object \$c}
+    "]
+    append setup \n [list itcl::type ::perf::Wildcard "
+      component c
+      delegate method * to c
+      constructor {} {set c \[::perf::Target ::perf::#auto\]}
+      destructor {itcl::delete object \$c}
+    "]
+    append setup \n {::perf::Explicit ::perf::e; ::perf::Wildcard ::perf::w}
+    set cleanup {
+      itcl::delete object ::perf::e ::perf::w
+      itcl::delete class ::perf::Explicit ::perf::Wildcard ::perf::Target
+    }
+    bench method-explicit [list delegated $n] {::perf::e t1} \
+      -setup $setup -cleanup $cleanup
+    bench method-wildcard [list delegated $n] {::perf::w t1} \
+      -setup $setup -cleanup $cleanup
+    bench option-cget [list delegated $n] {::perf::e cget -v} \
+      -setup $setup -cleanup $cleanup
+  }
+}
+
+## ensembles, depending on the number of parts:
+proc test-ensemble {} {
+  group ensemble
+  foreach n [sizes 10 100 1000] {
+    set setup [list itcl::ensemble ::perf::ens [members $n {
+      part p$i {} {return $i}
+    }]]
+    set cleanup {rename ::perf::ens {}}
+    bench dispatch-first [list parts $n] {::perf::ens p1} \
+      -setup $setup -cleanup $cleanup
+    bench dispatch-last [list parts $n] "::perf::ens p$n" \
+      -setup $setup -cleanup $cleanup
+    bench add-part [list parts $n] {
+      itcl::ensemble ::perf::ens part x[incr ::perf::i] {} {}
+    } -setup "$setup; set ::perf::i 0" -cleanup $cleanup -maxcount 1000
+  }
+}
+
+## filters, depending on their number, and changes of the filters of a
+## class which do not change them, in a deep hierarchy:
+proc test-filter {} {
+  variable maxDepth
+  group filter
+  foreach n {0 1 2 4} {
+    set setup [list itcl::extendedclass ::perf::Filtered "
+      public variable a 0
+      public method m {} {return \$a}
+      [members $n {public method f$i {args} {next {*}$args}}]
+    "]
+    for {set i 1} {$i <= $n} {incr i} {
+      append setup \n [list itcl::filter add ::perf::Filtered f$i]
+    }
+    append setup \n {::perf::Filtered ::perf::o}
+    set cleanup {itcl::delete class ::perf::Filtered}
+    bench method [list filters $n] {::perf::o m} \
+      -setup $setup -cleanup $cleanup
+  }
+  set setup [list itcl::extendedclass ::perf::Filtered {
+    public method m {} {}
+    public method f {args} {next {*}$args}
+  }]
+  append setup \n {itcl::filter add ::perf::Filtered f} \
+    \n "::perf::H$maxDepth ::perf::o" \n {::perf::o ch}
+  set cleanup {
+    itcl::delete object ::perf::o
+    itcl::delete class ::perf::Filtered
+  }
+  bench add-existing [list depth $maxDepth] {
+    itcl::filter add ::perf::Filtered f
+    ::perf::o ch
+  } -setup $setup -cleanup $cleanup
+}
+
+## isa, find objects and info queries, depending on the number of live
+## objects and the depth of the hierarchy:
+proc test-query {} {
+  variable maxDepth
+  group query
+  foreach d [list 1 4 $maxDepth] {
+    set setup "::perf::H$d ::perf::o"
+    set cleanup {itcl::delete object ::perf::o}
+    bench isa [list depth $d] {::perf::o isa ::perf::H1} \
+      -setup $setup -cleanup $cleanup
+    bench info-heritage [list depth $d] {::perf::o info heritage} \
+      -setup $setup -cleanup $cleanup
+    bench info-variable [list depth $d] {::perf::o info variable h1} \
+      -setup $setup -cleanup $cleanup
+  }
+  foreach n [sizes 100 1000 10000] {
+    set setup [list [namespace current]::population ::perf::Plain $n]
+    append setup \n {::perf::H4 ::perf::o}
+    set cleanup [list [namespace current]::depopulate $n]
+    append cleanup \n {itcl::delete object ::perf::o}
+    bench find-objects-class [list live $n] {
+      itcl::find objects -class ::perf::H4
+    } -setup $setup -cleanup $cleanup
+    bench find-objects-isa [list live $n] {
+      itcl::find objects -isa ::perf::H1
+    } -setup $setup -cleanup $cleanup
+    bench find-objects-pattern [list live $n] {
+      itcl::find objects ::perf::o
+    } -setup $setup -cleanup $cleanup
+    bench info-class [list live $n] {::perf::o info class} \
+      -setup $setup -cleanup $cleanup
+  }
+}
+
+## definition and deletion of a class, depending on the number of
+## methods, which mostly share a few argument lists:
+proc test-define {} {
+  group define
+  foreach n [sizes 10 100 1000] {
+    set body [members $n {
+      public method a$i {} {}
+      public method b$i {args} {}
+      public method c$i {x {y 1}} {}
+    }]
+    bench class [list methods [expr {3 * $n}]] [string map [list \$body $body] {
+      itcl::class ::perf::D {$body}
+      itcl::delete class ::perf::D
+    }] -maxcount 1000
+  }
+}
+
+## deletion of a class with many live objects:
+proc test-class-delete {} {
+  group classdelete
+  foreach n [sizes 100 1000 10000] {
+    bench instances [list live $n] {
+      itcl::delete class ::perf::K
+    } -setup [string map [list \$n $n] {
+      itcl::class ::perf::K {public variable a 0}
+      for {set i 1} {$i <= $n} {incr i} {::perf::K ::perf::k$i}
+    }] -maxcount 1
+  }
+}
+
+# ------------------------------------------------------------------------
+
+proc test {} {
+  setup
+  try {
+    test-object
+    test-dispatch
+    test-variable
+    test-configure
+    test-delegation
+    test-ensemble
+    test-filter
+    test-query
+    test-define
+    test-class-delete
+  } finally {
+    cleanup
+  }
+  puts \n**OK**
+}
+
+}; # end of ::itclTestPerf-Suite
+
+# ------------------------------------------------------------------------
+
+# if calling direct:
+if {[info exists ::argv0] && [file tail $::argv0] eq [file tail [info script]]} {
+  array set in {-time 100 -match * -skip {} -scale 1 -json {} -lib {} -load {}}
+  array set in $argv
+  if {$in(-load) ne ""} {
+    eval $in(-load)
+  }
+  if {![namespace exists ::itcl]} {
+    if {$in(-lib) eq ""} {
+      package require itcl
+    } else {
+      puts "testing with $in(-lib)"
+      load $in(-lib) itcl
+    }
+  }
+  puts "itcl [package provide itcl], Tcl [info patchlevel]"
+  ::itclTestPerf::configure -time $in(-time) -match $in(-match) \
+    -skip $in(-skip) -scale $in(-scale)
+
+  ::itclTestPerf-Suite::test
+  if {$in(-json) ne ""} {
+    ::itclTestPerf::writeJson $in(-json)
+  }
+}